@@ -0,0 +1,414 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+// Times network generation on one model and appends a single-line JSON
+// record of the result to a results file.  The bench target in this
+// directory runs it once per model and mode, in a fresh process each
+// time so that the peak RSS belongs to that run alone.
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <exception>
+#include <ctime>
+#include <cstdlib>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "utl/arg.hh"
+#include "mzr/moleculizer.hh"
+#include "mzr/expansionHeuristic.hh"
+#include "fnd/expansionProfiler.hh"
+#include "syntheticModels.hpp"
+
+enum RunMode { Full = 0,
+               BoundedRun = 1 };
+
+struct benchArgsStruct
+{
+    std::string modelName;
+    std::string fileName;
+    std::string syntheticSpec;
+
+    std::string resultsFile;
+    std::string label;
+    std::string dumpModelFile;
+
+    int runMode;
+    int maxSpecies;
+    int maxRxns;
+
+    // Empty for catalog order.
+    std::string expansionHeuristic;
+
+    benchArgsStruct()
+        :
+        runMode( Full ),
+        maxSpecies( -1 ),
+        maxRxns( -1 )
+    {}
+};
+
+void
+processCommandLineArgs( int argc, char* argv[], benchArgsStruct& benchArgs );
+
+void
+displayHelpAndExitProgram();
+
+double
+secondsNow();
+
+long
+peakResidentKilobytes();
+
+std::string
+jsonString( const std::string& str );
+
+std::string
+runModeName( const benchArgsStruct& benchArgs );
+
+// "full", "bounded", or "bounded/<heuristic>", so that runs with different
+// expansion orders are compared separately.
+std::string
+runModeName( const benchArgsStruct& benchArgs )
+{
+    if ( benchArgs.runMode == Full ) return "full";
+    if ( benchArgs.expansionHeuristic.empty() ) return "bounded";
+    return "bounded/" + benchArgs.expansionHeuristic;
+}
+
+void
+writeResult( std::ostream& os,
+             const benchArgsStruct& benchArgs,
+             int initialSpecies,
+             int initialRxns,
+             int finalSpecies,
+             int finalRxns,
+             double loadSeconds,
+             double expandSeconds,
+             const fnd::expansionProfiler& rProfiler );
+
+int main( int argc, char* argv[] )
+{
+    benchArgsStruct benchArgs;
+    processCommandLineArgs( argc, argv, benchArgs );
+
+    try
+    {
+        mzr::moleculizer theMoleculizer;
+
+        double loadStart = secondsNow();
+        if ( ! benchArgs.syntheticSpec.empty() )
+        {
+            std::string document = makeSyntheticModel( benchArgs.syntheticSpec );
+
+            if ( ! benchArgs.dumpModelFile.empty() )
+            {
+                std::ofstream dumpStream( benchArgs.dumpModelFile.c_str() );
+                dumpStream << document << std::endl;
+            }
+
+            theMoleculizer.loadXmlString( document );
+        }
+        else
+        {
+            theMoleculizer.loadXmlFileName( benchArgs.fileName );
+        }
+        double loadSeconds = secondsNow() - loadStart;
+
+        int initialSpecies = theMoleculizer.getTotalNumberSpecies();
+        int initialRxns = theMoleculizer.getTotalNumberReactions();
+
+        // Only the expansion is profiled; loading the model recognizes the
+        // explicit species, which is not what is being measured.
+        fnd::expansionProfiler& rProfiler = theMoleculizer.getExpansionProfiler();
+        rProfiler.reset();
+        rProfiler.setEnabled( true );
+
+        int finalSpecies = 0;
+        int finalRxns = 0;
+
+        double expandStart = secondsNow();
+        if ( benchArgs.runMode == Full )
+        {
+            theMoleculizer.generateCompleteNetwork();
+            finalSpecies = theMoleculizer.getTotalNumberSpecies();
+            finalRxns = theMoleculizer.getTotalNumberReactions();
+        }
+        else
+        {
+            if ( ! benchArgs.expansionHeuristic.empty() )
+            {
+                theMoleculizer.setExpansionHeuristic( mzr::makeExpansionHeuristic( benchArgs.expansionHeuristic ) );
+            }
+
+            mzr::moleculizer::CachePosition pos
+                = theMoleculizer.generateCompleteNetwork( benchArgs.maxSpecies,
+                                                          benchArgs.maxRxns );
+            finalSpecies = std::distance( theMoleculizer.theDeltaSpeciesList.begin(), pos.first );
+            finalRxns = std::distance( theMoleculizer.theDeltaReactionList.begin(), pos.second );
+        }
+        double expandSeconds = secondsNow() - expandStart;
+
+        rProfiler.setEnabled( false );
+
+        if ( benchArgs.resultsFile.empty() )
+        {
+            writeResult( std::cout, benchArgs,
+                         initialSpecies, initialRxns,
+                         finalSpecies, finalRxns,
+                         loadSeconds, expandSeconds,
+                         rProfiler );
+        }
+        else
+        {
+            std::ofstream resultsStream( benchArgs.resultsFile.c_str(),
+                                         std::ios::out | std::ios::app );
+            if ( ! resultsStream )
+            {
+                std::cerr << "Could not open results file "
+                          << benchArgs.resultsFile << std::endl;
+                return 1;
+            }
+
+            writeResult( resultsStream, benchArgs,
+                         initialSpecies, initialRxns,
+                         finalSpecies, finalRxns,
+                         loadSeconds, expandSeconds,
+                         rProfiler );
+        }
+    }
+    catch ( const utl::xcpt& xcpt )
+    {
+        std::cerr << benchArgs.modelName << ": " << xcpt.getMessage() << std::endl;
+        return 1;
+    }
+    catch ( const std::exception& )
+    {
+        std::cerr << benchArgs.modelName << ": benchmark failed." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+double
+secondsNow()
+{
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec + now.tv_nsec * 1.0e-9;
+}
+
+long
+peakResidentKilobytes()
+{
+    rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) ) return -1;
+
+#ifdef __APPLE__
+    // Darwin reports bytes where Linux reports kilobytes.
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+std::string
+jsonString( const std::string& str )
+{
+    std::string quoted( "\"" );
+    for ( std::string::const_iterator iChar = str.begin();
+          iChar != str.end();
+          ++iChar )
+    {
+        if ( *iChar == '"' || *iChar == '\\' ) quoted += '\\';
+        quoted += *iChar;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+void
+writeResult( std::ostream& os,
+             const benchArgsStruct& benchArgs,
+             int initialSpecies,
+             int initialRxns,
+             int finalSpecies,
+             int finalRxns,
+             double loadSeconds,
+             double expandSeconds,
+             const fnd::expansionProfiler& rProfiler )
+{
+    int newSpecies = finalSpecies > initialSpecies ? finalSpecies - initialSpecies : 0;
+    int newRxns = finalRxns > initialRxns ? finalRxns - initialRxns : 0;
+
+    double speciesRate = expandSeconds > 0.0 ? newSpecies / expandSeconds : 0.0;
+    double rxnsRate = expandSeconds > 0.0 ? newRxns / expandSeconds : 0.0;
+
+    std::ostringstream record;
+    record.precision( 6 );
+
+    record << "{\"label\": " << jsonString( benchArgs.label )
+           << ", \"model\": " << jsonString( benchArgs.modelName )
+           << ", \"mode\": " << jsonString( runModeName( benchArgs ) )
+           << ", \"max-species\": " << benchArgs.maxSpecies
+           << ", \"max-reactions\": " << benchArgs.maxRxns
+           << ", \"species\": " << finalSpecies
+           << ", \"reactions\": " << finalRxns
+           << ", \"load-seconds\": " << loadSeconds
+           << ", \"expand-seconds\": " << expandSeconds
+           << ", \"species-per-second\": " << speciesRate
+           << ", \"reactions-per-second\": " << rxnsRate
+           << ", \"peak-rss-kb\": " << peakResidentKilobytes()
+           << ", \"phases\": {";
+
+    for ( int phaseNdx = 0;
+          phaseNdx < fnd::expansionProfiler::PHASE_COUNT;
+          ++phaseNdx )
+    {
+        fnd::expansionProfiler::phase thePhase
+            = static_cast<fnd::expansionProfiler::phase>( phaseNdx );
+        const fnd::expansionProfiler::phaseStats& rStats
+            = rProfiler.getPhaseStats( thePhase );
+
+        record << ( phaseNdx ? ", " : "" )
+               << jsonString( fnd::expansionProfiler::getPhaseName( thePhase ) )
+               << ": {\"calls\": " << rStats.calls
+               << ", \"cache-hits\": " << rStats.cacheHits
+               << ", \"seconds\": " << rStats.nanoseconds * 1.0e-9
+               << ", \"self-seconds\": " << rStats.selfNanoseconds * 1.0e-9
+               << ", \"fraction\": "
+               << ( expandSeconds > 0.0 ? rStats.selfNanoseconds * 1.0e-9 / expandSeconds : 0.0 )
+               << "}";
+    }
+
+    record << "}}";
+
+    os << record.str() << std::endl;
+}
+
+void processCommandLineArgs( int argc, char* argv[], benchArgsStruct& benchArgs )
+{
+    // Skip the command name
+    argc--;
+    argv++;
+
+    if ( argc == 0 )
+    {
+        displayHelpAndExitProgram();
+    }
+
+    while ( 0 < argc )
+    {
+        // -x/--xml           model file to expand
+        // -g/--synthetic     synthetic model spec, e.g. chain:8
+        // -n/--name          model name in the results (defaults to the file or spec)
+        // -s/--maxspecies    bounded run, at most s species
+        // -r/--maxreactions  bounded run, at most r reactions
+        // -e/--heuristic     order a bounded run by max-rate, path-flux or mol-count
+        // -o/--output        append the result to this file instead of stdout
+        // -l/--label         label for the result, e.g. the commit it was built from
+        // -d/--dump          write the synthetic model document to this file
+
+        std::string arg( *argv );
+        argv++;
+        argc--;
+
+        if ( arg == "--help" )
+        {
+            displayHelpAndExitProgram();
+        }
+        else if ( arg == "-x" || arg == "--xml" )
+        {
+            benchArgs.fileName = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-g" || arg == "--synthetic" )
+        {
+            benchArgs.syntheticSpec = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-n" || arg == "--name" )
+        {
+            benchArgs.modelName = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-s" || arg == "--maxspecies" )
+        {
+            benchArgs.maxSpecies = utl::argMustBeNNInt( utl::mustGetArg( argc, argv ) );
+            benchArgs.runMode = BoundedRun;
+        }
+        else if ( arg == "-r" || arg == "--maxreactions" )
+        {
+            benchArgs.maxRxns = utl::argMustBeNNInt( utl::mustGetArg( argc, argv ) );
+            benchArgs.runMode = BoundedRun;
+        }
+        else if ( arg == "-e" || arg == "--heuristic" )
+        {
+            benchArgs.expansionHeuristic = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-o" || arg == "--output" )
+        {
+            benchArgs.resultsFile = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-l" || arg == "--label" )
+        {
+            benchArgs.label = utl::mustGetArg( argc, argv );
+        }
+        else if ( arg == "-d" || arg == "--dump" )
+        {
+            benchArgs.dumpModelFile = utl::mustGetArg( argc, argv );
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            displayHelpAndExitProgram();
+        }
+    }
+
+    if ( benchArgs.fileName.empty() == benchArgs.syntheticSpec.empty() )
+    {
+        std::cerr << "Exactly one of -x and -g must be given." << std::endl;
+        exit( 1 );
+    }
+
+    if ( benchArgs.modelName.empty() )
+    {
+        benchArgs.modelName = benchArgs.syntheticSpec.empty()
+            ? benchArgs.fileName
+            : benchArgs.syntheticSpec;
+    }
+}
+
+void displayHelpAndExitProgram()
+{
+    std::cout << "Usage: network_benchmark (-x <FILE> | -g <kind:size>) [-s <N>] [-r <N>] [-e <HEURISTIC>] [-o <FILE>] [-l <LABEL>]" << std::endl;
+    std::cout << "Times full (or, with -s/-r, bounded) expansion of one model and writes" << std::endl;
+    std::cout << "a one-line JSON record with species/sec, reactions/sec, peak RSS and the" << std::endl;
+    std::cout << "time spent in each phase of expansion." << std::endl;
+    std::cout << "Synthetic kinds are chain, scaffold and phospho; see syntheticModels.hpp." << std::endl;
+
+    exit( 0 );
+}
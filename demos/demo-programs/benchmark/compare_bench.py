@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+#
+# Compares two results files written by "make bench", e.g. one from
+# before a change and one from after it.
+#
+#   compare_bench.py baseline.json candidate.json
+#
+# Runs are matched on model, mode and bounds.  For each, prints the
+# expansion throughput and peak RSS of both and the ratio candidate /
+# baseline.  If a file holds several runs of the same case (bench
+# appends), the last one counts.
+
+from __future__ import print_function
+
+import json
+import sys
+
+
+def readResults(fileName):
+    results = {}
+    with open(fileName) as resultsFile:
+        for line in resultsFile:
+            line = line.strip()
+            if not line:
+                continue
+            record = json.loads(line)
+            key = (record["model"], record["mode"],
+                   record["max-species"], record["max-reactions"])
+            results[key] = record
+    return results
+
+
+def ratio(new, old):
+    if not old:
+        return "-"
+    return "%.2f" % (float(new) / old)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print("Usage: compare_bench.py <baseline> <candidate>", file=sys.stderr)
+        return 2
+
+    baseline = readResults(argv[1])
+    candidate = readResults(argv[2])
+
+    print("%-40s %-8s %12s %12s %6s %10s %10s %6s" %
+          ("model", "mode", "spec/s old", "spec/s new", "x",
+           "rss old", "rss new", "x"))
+
+    for key in sorted(set(baseline) & set(candidate)):
+        old = baseline[key]
+        new = candidate[key]
+
+        if (old["species"], old["reactions"]) != (new["species"], new["reactions"]):
+            print("%s %s: network differs (%d/%d species, %d/%d reactions)" %
+                  (key[0], key[1], old["species"], new["species"],
+                   old["reactions"], new["reactions"]))
+
+        print("%-40s %-8s %12.1f %12.1f %6s %10d %10d %6s" %
+              (key[0][-40:], key[1],
+               old["species-per-second"], new["species-per-second"],
+               ratio(new["species-per-second"], old["species-per-second"]),
+               old["peak-rss-kb"], new["peak-rss-kb"],
+               ratio(new["peak-rss-kb"], old["peak-rss-kb"])))
+
+        for phase in sorted(old["phases"]):
+            oldSeconds = old["phases"][phase]["self-seconds"]
+            newSeconds = new["phases"].get(phase, {}).get("self-seconds", 0.0)
+            print("    %-36s %10.4fs %10.4fs %6s" %
+                  (phase, oldSeconds, newSeconds, ratio(newSeconds, oldSeconds)))
+
+    for key in sorted(set(baseline) ^ set(candidate)):
+        print("%s %s: only in one file" % (key[0], key[1]))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,261 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+// Times the member index of plex families on a synthetic k-site model:
+// a scaffold holding k substrates, each of which is phosphorylated or
+// not, so that the family has 2^k members keyed by k + 1 mol states.
+// Each member is made once and then looked up many times in a scrambled
+// order, as expansion does when it makes reaction products, first with
+// the std::map based autoCache that plex families used to be, then with
+// the autoHashCache that they are now.  Writes a single-line JSON record
+// per index.
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <ctime>
+#include "utl/arg.hh"
+#include "utl/autoCache.hh"
+#include "utl/hashCache.hh"
+#include "cpx/molState.hh"
+
+class testMember
+{
+public:
+    int ordinal;
+
+    testMember( int theOrdinal )
+        :
+        ordinal( theOrdinal )
+    {}
+};
+
+class mapIndex :
+    public utl::autoCache<std::vector<cpx::molParam>, testMember>
+{
+public:
+    mapIndex( void )
+        :
+        madeCount( 0 )
+    {}
+
+    int madeCount;
+
+    testMember*
+    makeMember( const std::vector<cpx::molParam>& rKey )
+    {
+        return new testMember( madeCount++ );
+    }
+};
+
+class hashIndex :
+    public utl::autoHashCache<cpx::molParam, testMember>
+{
+public:
+    hashIndex( void )
+        :
+        madeCount( 0 )
+    {}
+
+    int madeCount;
+
+    testMember*
+    makeMember( const std::vector<cpx::molParam>& rKey )
+    {
+        return new testMember( madeCount++ );
+    }
+};
+
+double
+secondsNow()
+{
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec + now.tv_nsec * 1.0e-9;
+}
+
+// Makes every member, then looks them all up lookupRounds times.  Returns
+// a checksum of the members found, so that the lookups can't be dropped.
+template<class indexT>
+long
+timeIndex( const std::vector<std::vector<cpx::molParam> >& rKeys,
+           const std::vector<int>& rLookupOrder,
+           int lookupRounds,
+           double& rMakeSeconds,
+           double& rLookupSeconds )
+{
+    indexT index;
+    long checksum = 0;
+
+    double makeStart = secondsNow();
+    for ( size_t keyNdx = 0; keyNdx < rKeys.size(); ++keyNdx )
+    {
+        checksum += index.getMember( rKeys[keyNdx] )->ordinal;
+    }
+    rMakeSeconds = secondsNow() - makeStart;
+
+    double lookupStart = secondsNow();
+    for ( int round = 0; round < lookupRounds; ++round )
+    {
+        for ( size_t orderNdx = 0; orderNdx < rLookupOrder.size(); ++orderNdx )
+        {
+            checksum += index.getMember( rKeys[rLookupOrder[orderNdx]] )->ordinal;
+        }
+    }
+    rLookupSeconds = secondsNow() - lookupStart;
+
+    return checksum;
+}
+
+void
+writeResult( const std::string& indexName,
+             int siteCount,
+             int memberCount,
+             long lookups,
+             double makeSeconds,
+             double lookupSeconds,
+             long checksum )
+{
+    std::ostringstream record;
+    record.precision( 6 );
+
+    record << "{\"model\": \"k-site:" << siteCount << "\""
+           << ", \"index\": \"" << indexName << "\""
+           << ", \"members\": " << memberCount
+           << ", \"lookups\": " << lookups
+           << ", \"make-seconds\": " << makeSeconds
+           << ", \"lookup-seconds\": " << lookupSeconds
+           << ", \"lookups-per-second\": "
+           << ( lookupSeconds > 0.0 ? lookups / lookupSeconds : 0.0 )
+           << ", \"checksum\": " << checksum
+           << "}";
+
+    std::cout << record.str() << std::endl;
+}
+
+void
+displayHelpAndExitProgram()
+{
+    std::cout << "Usage: member_index_benchmark -k <SITES> [-r <ROUNDS>]" << std::endl;
+    std::cout << "Times plex family member lookup, std::map against hashed, on a scaffold" << std::endl;
+    std::cout << "holding SITES two-state substrates, looking every member up ROUNDS times." << std::endl;
+
+    exit( 0 );
+}
+
+int main( int argc, char* argv[] )
+{
+    int siteCount = -1;
+    int lookupRounds = 20;
+
+    // Skip the command name
+    argc--;
+    argv++;
+
+    try
+    {
+        while ( 0 < argc )
+        {
+            std::string arg( *argv );
+            argv++;
+            argc--;
+
+            if ( arg == "-k" || arg == "--sites" )
+            {
+                siteCount = utl::argMustBePosInt( utl::mustGetArg( argc, argv ) );
+            }
+            else if ( arg == "-r" || arg == "--rounds" )
+            {
+                lookupRounds = utl::argMustBePosInt( utl::mustGetArg( argc, argv ) );
+            }
+            else
+            {
+                displayHelpAndExitProgram();
+            }
+        }
+    }
+    catch ( const utl::xcpt& xcpt )
+    {
+        std::cerr << xcpt.getMessage() << std::endl;
+        return 1;
+    }
+
+    if ( siteCount < 1 || 24 < siteCount ) displayHelpAndExitProgram();
+
+    // The scaffold has one state; each substrate has its own two.
+    std::vector<cpx::molState*> states;
+    states.push_back( new cpx::molState( 1.0 ) );
+    for ( int stateNdx = 0; stateNdx < 2 * siteCount; ++stateNdx )
+    {
+        states.push_back( new cpx::molState( 1.0 ) );
+    }
+
+    int memberCount = 1 << siteCount;
+    std::vector<std::vector<cpx::molParam> > keys( memberCount );
+    for ( int memberNdx = 0; memberNdx < memberCount; ++memberNdx )
+    {
+        keys[memberNdx].push_back( states[0] );
+        for ( int siteNdx = 0; siteNdx < siteCount; ++siteNdx )
+        {
+            int phosphorylated = ( memberNdx >> siteNdx ) & 1;
+            keys[memberNdx].push_back( states[1 + 2 * siteNdx + phosphorylated] );
+        }
+    }
+
+    std::vector<int> lookupOrder( memberCount );
+    for ( int memberNdx = 0; memberNdx < memberCount; ++memberNdx )
+    {
+        lookupOrder[memberNdx] = memberNdx;
+    }
+    srand( 17 );
+    for ( int memberNdx = memberCount - 1; 0 < memberNdx; --memberNdx )
+    {
+        std::swap( lookupOrder[memberNdx], lookupOrder[rand() % ( memberNdx + 1 )] );
+    }
+
+    long lookups = ( long ) lookupRounds * memberCount;
+    double makeSeconds = 0.0;
+    double lookupSeconds = 0.0;
+
+    long checksum = timeIndex<mapIndex>( keys, lookupOrder, lookupRounds,
+                                         makeSeconds, lookupSeconds );
+    writeResult( "map", siteCount, memberCount, lookups,
+                 makeSeconds, lookupSeconds, checksum );
+
+    checksum = timeIndex<hashIndex>( keys, lookupOrder, lookupRounds,
+                                     makeSeconds, lookupSeconds );
+    writeResult( "hash", siteCount, memberCount, lookups,
+                 makeSeconds, lookupSeconds, checksum );
+
+    for ( size_t stateNdx = 0; stateNdx < states.size(); ++stateNdx )
+    {
+        delete states[stateNdx];
+    }
+
+    return 0;
+}
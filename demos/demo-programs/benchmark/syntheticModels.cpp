@@ -0,0 +1,290 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <sstream>
+#include <iostream>
+#include <exception>
+#include <cstdlib>
+#include "syntheticModels.hpp"
+
+namespace
+{
+    void
+    splitSpec( const std::string& spec,
+               std::string& kind,
+               int& size )
+    {
+        std::string::size_type colon = spec.find( ':' );
+        if ( colon == std::string::npos )
+        {
+            std::cerr << "Synthetic model '" << spec
+                      << "' should look like kind:size." << std::endl;
+            throw std::exception();
+        }
+
+        kind = spec.substr( 0, colon );
+
+        std::string sizeString = spec.substr( colon + 1 );
+        char* pEnd = 0;
+        long value = std::strtol( sizeString.c_str(), &pEnd, 10 );
+        if ( sizeString.empty() || *pEnd != '\0' || value < 1 )
+        {
+            std::cerr << "Synthetic model '" << spec
+                      << "' needs a positive size." << std::endl;
+            throw std::exception();
+        }
+
+        size = static_cast<int>( value );
+    }
+
+    std::string
+    numbered( const std::string& prefix, int number )
+    {
+        std::ostringstream oss;
+        oss << prefix << number;
+        return oss.str();
+    }
+
+    void
+    writeBindingSite( std::ostream& os, const std::string& siteName )
+    {
+        os << "<binding-site name=\"" << siteName << "\">"
+           << "<default-shape-ref name=\"default\"/>"
+           << "<site-shape name=\"default\"/>"
+           << "</binding-site>";
+    }
+
+    void
+    writeDimerizationGen( std::ostream& os,
+                          const std::string& leftMol,
+                          const std::string& leftSite,
+                          const std::string& rightMol,
+                          const std::string& rightSite )
+    {
+        os << "<dimerization-gen>"
+           << "<mol-ref name=\"" << leftMol << "\">"
+           << "<site-ref name=\"" << leftSite << "\"/></mol-ref>"
+           << "<mol-ref name=\"" << rightMol << "\">"
+           << "<site-ref name=\"" << rightSite << "\"/></mol-ref>"
+           << "<default-on-rate value=\"1.0e8\"/>"
+           << "<default-off-rate value=\"1.0\"/>"
+           << "</dimerization-gen>";
+    }
+
+    void
+    writeSingleton( std::ostream& os, const std::string& molName )
+    {
+        os << "<plex-species name=\"" << molName << "-singleton\">"
+           << "<plex><mol-instance name=\"the-" << molName << "\">"
+           << "<mol-ref name=\"" << molName << "\"/>"
+           << "</mol-instance></plex>"
+           << "</plex-species>";
+    }
+
+    void
+    writeHead( std::ostream& os )
+    {
+        os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+           << "<moleculizer-input><model>";
+    }
+
+    void
+    writeTail( std::ostream& os )
+    {
+        os << "<explicit-reactions/>"
+           << "<volume liters=\"1.0e-12\"/>"
+           << "</model></moleculizer-input>";
+    }
+
+    std::string
+    makeChain( int length )
+    {
+        std::ostringstream os;
+        writeHead( os );
+
+        os << "<modifications/><mols>";
+        for ( int molNdx = 1; molNdx <= length; ++molNdx )
+        {
+            os << "<mod-mol name=\"" << numbered( "M", molNdx ) << "\">"
+               << "<weight daltons=\"100.0\"/>";
+            writeBindingSite( os, "left" );
+            writeBindingSite( os, "right" );
+            os << "</mod-mol>";
+        }
+        os << "</mols><allosteric-plexes/><allosteric-omnis/>";
+
+        os << "<reaction-gens>";
+        for ( int molNdx = 1; molNdx < length; ++molNdx )
+        {
+            writeDimerizationGen( os,
+                                  numbered( "M", molNdx ), "right",
+                                  numbered( "M", molNdx + 1 ), "left" );
+        }
+        os << "</reaction-gens>";
+
+        os << "<explicit-species>";
+        for ( int molNdx = 1; molNdx <= length; ++molNdx )
+        {
+            writeSingleton( os, numbered( "M", molNdx ) );
+        }
+        os << "</explicit-species>";
+
+        writeTail( os );
+        return os.str();
+    }
+
+    std::string
+    makeScaffold( int siteCount )
+    {
+        std::ostringstream os;
+        writeHead( os );
+
+        os << "<modifications/><mols>"
+           << "<mod-mol name=\"S\"><weight daltons=\"1000.0\"/>";
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            writeBindingSite( os, numbered( "to-P", siteNdx ) );
+        }
+        os << "</mod-mol>";
+
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            os << "<mod-mol name=\"" << numbered( "P", siteNdx ) << "\">"
+               << "<weight daltons=\"100.0\"/>";
+            writeBindingSite( os, "to-S" );
+            os << "</mod-mol>";
+        }
+        os << "</mols><allosteric-plexes/><allosteric-omnis/>";
+
+        os << "<reaction-gens>";
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            writeDimerizationGen( os,
+                                  "S", numbered( "to-P", siteNdx ),
+                                  numbered( "P", siteNdx ), "to-S" );
+        }
+        os << "</reaction-gens>";
+
+        os << "<explicit-species>";
+        writeSingleton( os, "S" );
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            writeSingleton( os, numbered( "P", siteNdx ) );
+        }
+        os << "</explicit-species>";
+
+        writeTail( os );
+        return os.str();
+    }
+
+    void
+    writeSiteFlip( std::ostream& os,
+                   const std::string& siteName,
+                   const std::string& fromMod,
+                   const std::string& toMod,
+                   const std::string& enzyme )
+    {
+        os << "<uni-mol-gen>"
+           << "<enabling-mol name=\"Sub\"/>"
+           << "<enabling-modifications>"
+           << "<mod-site-ref name=\"" << siteName << "\">"
+           << "<mod-ref name=\"" << fromMod << "\"/></mod-site-ref>"
+           << "</enabling-modifications>"
+           << "<modification-exchanges><modification-exchange>"
+           << "<mod-site-ref name=\"" << siteName << "\"/>"
+           << "<installed-mod-ref name=\"" << toMod << "\"/>"
+           << "</modification-exchange></modification-exchanges>"
+           << "<additional-reactant-species name=\"" << enzyme << "\"/>"
+           << "<additional-product-species name=\"" << enzyme << "\"/>"
+           << "<rate value=\"1.0e6\"/>"
+           << "</uni-mol-gen>";
+    }
+
+    std::string
+    makePhospho( int siteCount )
+    {
+        std::ostringstream os;
+        writeHead( os );
+
+        os << "<modifications>"
+           << "<modification name=\"none\">"
+           << "<weight-delta daltons=\"0.0\"/></modification>"
+           << "<modification name=\"phosphorylated\">"
+           << "<weight-delta daltons=\"42.0\"/></modification>"
+           << "</modifications>";
+
+        os << "<mols><mod-mol name=\"Sub\"><weight daltons=\"1000.0\"/>";
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            os << "<mod-site name=\"" << numbered( "phos-site-", siteNdx ) << "\">"
+               << "<default-mod-ref name=\"none\"/>"
+               << "</mod-site>";
+        }
+        os << "</mod-mol></mols><allosteric-plexes/><allosteric-omnis/>";
+
+        os << "<reaction-gens>";
+        for ( int siteNdx = 1; siteNdx <= siteCount; ++siteNdx )
+        {
+            std::string siteName = numbered( "phos-site-", siteNdx );
+            writeSiteFlip( os, siteName, "none", "phosphorylated", "the-kinase" );
+            writeSiteFlip( os, siteName, "phosphorylated", "none", "the-ptase" );
+        }
+        os << "</reaction-gens>";
+
+        os << "<explicit-species>";
+        writeSingleton( os, "Sub" );
+        os << "<stoch-species name=\"the-kinase\">"
+           << "<weight daltons=\"1000.0\"/></stoch-species>"
+           << "<stoch-species name=\"the-ptase\">"
+           << "<weight daltons=\"1000.0\"/></stoch-species>"
+           << "</explicit-species>";
+
+        writeTail( os );
+        return os.str();
+    }
+}
+
+bool
+isSyntheticModelSpec( const std::string& spec )
+{
+    return spec.find( ':' ) != std::string::npos;
+}
+
+std::string
+makeSyntheticModel( const std::string& spec )
+{
+    std::string kind;
+    int size = 0;
+    splitSpec( spec, kind, size );
+
+    if ( kind == "chain" ) return makeChain( size );
+    if ( kind == "scaffold" ) return makeScaffold( size );
+    if ( kind == "phospho" ) return makePhospho( size );
+
+    std::cerr << "Unknown synthetic model kind '" << kind
+              << "'; expected chain, scaffold or phospho." << std::endl;
+    throw std::exception();
+}
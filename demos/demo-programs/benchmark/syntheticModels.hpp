@@ -0,0 +1,56 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef SYNTHETICMODELS_HPP
+#define SYNTHETICMODELS_HPP
+
+#include <string>
+
+// Scalable models for benchmarking network generation.  Each is written
+// as a moleculizer-input document, so it goes through the same parser as
+// the sample models.
+//
+//   chain:N     Mols M1..MN, where Mi's "right" site binds the "left"
+//               site of Mi+1.  The network is every contiguous run of
+//               mols, N(N+1)/2 species.
+//
+//   scaffold:N  A scaffold mol with N sites, each binding its own
+//               partner mol.  The network is 2^N scaffold complexes
+//               plus the N free partners.
+//
+//   phospho:K   A substrate with K independent phosphorylation sites,
+//               each phosphorylated and dephosphorylated by a
+//               uni-mol-gen.  The network is 2^K states of the
+//               substrate.
+
+bool
+isSyntheticModelSpec( const std::string& spec );
+
+// Throws std::exception on a malformed spec.
+std::string
+makeSyntheticModel( const std::string& spec );
+
+#endif
@@ -0,0 +1,172 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+// Compares two saved networks, or merges two partial expansions of the
+// same model into one state file.  Like diff, a comparison exits with 0
+// when the networks are the same, 1 when they differ and 2 on error.
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include "utl/arg.hh"
+#include "mzr/networkDiff.hh"
+
+struct diffArgsStruct
+{
+    std::string firstFileName;
+    std::string secondFileName;
+    std::string mergeFileName;
+
+    double rateTolerance;
+    bool merge;
+
+    diffArgsStruct()
+        :
+        rateTolerance( 0.0 ),
+        merge( false )
+    {}
+};
+
+void
+processCommandLineArgs( int argc, char* argv[], diffArgsStruct& diffArgs );
+
+void
+displayHelpAndExitProgram( int exitCode );
+
+int main( int argc, char* argv[] )
+{
+    diffArgsStruct diffArgs;
+    processCommandLineArgs( argc, argv, diffArgs );
+
+    try
+    {
+        mzr::savedNetwork firstNetwork( diffArgs.firstFileName );
+        mzr::savedNetwork secondNetwork( diffArgs.secondFileName );
+
+        if ( diffArgs.merge )
+        {
+            mzr::mergeNetworks( firstNetwork, secondNetwork, diffArgs.mergeFileName );
+            return 0;
+        }
+
+        mzr::networkDiff theDiff;
+        mzr::diffNetworks( firstNetwork, secondNetwork, theDiff, diffArgs.rateTolerance );
+        theDiff.write( std::cout );
+
+        return theDiff.empty() ? 0 : 1;
+    }
+    catch ( const utl::xcpt& xcpt )
+    {
+        std::cerr << xcpt.getMessage() << std::endl;
+    }
+    catch ( const std::exception& )
+    {
+        std::cerr << "network_diff failed." << std::endl;
+    }
+
+    return 2;
+}
+
+void processCommandLineArgs( int argc, char* argv[], diffArgsStruct& diffArgs )
+{
+    // Skip the command name
+    argc--;
+    argv++;
+
+    std::vector<std::string> fileNames;
+
+    try
+    {
+        while ( 0 < argc )
+        {
+            // -t/--tolerance  relative difference below which rates are the same
+            // -m/--merge      merge the two networks rather than compare them
+            // -o/--output     file to write the merged network to
+
+            std::string arg( *argv );
+            argv++;
+            argc--;
+
+            if ( arg == "--help" )
+            {
+                displayHelpAndExitProgram( 0 );
+            }
+            else if ( arg == "-t" || arg == "--tolerance" )
+            {
+                diffArgs.rateTolerance = utl::argMustBeNNDouble( utl::mustGetArg( argc, argv ) );
+            }
+            else if ( arg == "-m" || arg == "--merge" )
+            {
+                diffArgs.merge = true;
+            }
+            else if ( arg == "-o" || arg == "--output" )
+            {
+                diffArgs.mergeFileName = utl::mustGetArg( argc, argv );
+            }
+            else if ( !arg.empty() && arg[0] == '-' )
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+                exit( 2 );
+            }
+            else
+            {
+                fileNames.push_back( arg );
+            }
+        }
+    }
+    catch ( const utl::xcpt& xcpt )
+    {
+        std::cerr << xcpt.getMessage() << std::endl;
+        exit( 2 );
+    }
+
+    if ( fileNames.size() != 2 )
+    {
+        displayHelpAndExitProgram( 2 );
+    }
+    if ( diffArgs.merge == diffArgs.mergeFileName.empty() )
+    {
+        std::cerr << "-o is given with, and only with, -m." << std::endl;
+        exit( 2 );
+    }
+
+    diffArgs.firstFileName = fileNames[0];
+    diffArgs.secondFileName = fileNames[1];
+}
+
+void displayHelpAndExitProgram( int exitCode )
+{
+    std::cout << "Usage: network_diff [-t <TOLERANCE>] <OLD> <NEW>" << std::endl;
+    std::cout << "       network_diff -m -o <OUTPUT> <FIRST> <SECOND>" << std::endl;
+    std::cout << "Compares two state files written by moleculizer, matching species by" << std::endl;
+    std::cout << "their unique ids, and lists the species and reactions added or removed" << std::endl;
+    std::cout << "and the reactions whose rates changed by more than TOLERANCE (relative)." << std::endl;
+    std::cout << "With -m, merges two expansions of the same model into one state file" << std::endl;
+    std::cout << "that loads without re-expansion." << std::endl;
+
+    exit( exitCode );
+}
@@ -36,6 +36,7 @@
 #include "utl/arg.hh"
 #include "mzr/unitsMgr.hh"
 #include "mzr/moleculizer.hh"
+#include "mzr/expansionHeuristic.hh"
 #include "plex/mzrPlexFamily.hh"
 
 using namespace std;
@@ -64,6 +65,9 @@ struct inputArgsStruct
 
     int runMode;
 
+    // Empty for catalog order.
+    std::string expansionHeuristic;
+
 
     inputArgsStruct()
         :
@@ -337,6 +341,7 @@ void processCommandLineArgs( int argc, char* argv[], inputArgsStruct& theInputAr
         // -o/--output write to an output file
         // -s/--maxspecies Bound the generated network by s species
         // -r/--maxreactions  Bound the generated network by r reactions
+        // -e/--heuristic  Expand the bounded network by max-rate, path-flux or mol-count
         // -n Perform number of iterations on the network
         
         std::string arg( *argv );
@@ -451,6 +456,10 @@ void processCommandLineArgs( int argc, char* argv[], inputArgsStruct& theInputAr
             theInputArgs.maxRxns = maxRxns;
             theInputArgs.runMode = BoundedRun;
         }
+        if(arg == "-e" || arg == "--heuristic" )
+        {
+            theInputArgs.expansionHeuristic = utl::mustGetArg( argc, argv);
+        }
     }
 
 }
@@ -586,5 +595,10 @@ void runBoundedRunMoleculizer( mzr::moleculizer& mzr, const inputArgsStruct& inp
         std::cout << ") " << std::endl;
     }
 
+    if ( !inputArgsStruct.expansionHeuristic.empty() )
+    {
+        mzr.setExpansionHeuristic( mzr::makeExpansionHeuristic( inputArgsStruct.expansionHeuristic ) );
+    }
+
     pos = createBoundedNetwork( mzr, inputArgsStruct.maxSpecies, inputArgsStruct.maxRxns );
 }
@@ -39,6 +39,7 @@
 #include "utl/xcpt.hh"
 #include "cpx/siteShape.hh"
 #include "cpx/molState.hh"
+#include "nmr/nameInterner.hh"
 
 namespace cpx
 {
@@ -50,6 +51,9 @@ namespace cpx
         // The name of the mol, e.g. Ste11.
         typename std::string name;
         
+        // The name as interned for canonical naming.
+        nmr::NameInterner::NameId nameId;
+        
         // Index for looking up binding sites by name.
         typedef typename std::map<typename std::string, int> indexMap;
         typedef typename indexMap::value_type indexValueType;
@@ -80,6 +84,12 @@ namespace cpx
             return name;
         }
         
+        nmr::NameInterner::NameId
+        getNameId( void ) const
+        {
+            return nameId;
+        }
+        
         bindingSiteIterator
         getBindingSitesBegin()
         {
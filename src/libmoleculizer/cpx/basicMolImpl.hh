@@ -64,6 +64,7 @@ namespace cpx
         throw( typename utl::xcpt ) :
         std::vector<bndSiteT> ( rSites ),
         name( rName ),
+        nameId( nmr::NameInterner::intern( rName ) ),
         defaultShapes( getDefaultSiteParams() )
     {
         int siteNdx = this->size();
@@ -86,6 +87,7 @@ namespace cpx
     basicMol( const basicMol& rOriginal ) :
         std::vector<bndSiteT> ( rOriginal ),
         name( rOriginal.getName() ),
+        nameId( rOriginal.getNameId() ),
         siteNameToNdx( rOriginal.siteNameToNdx ),
         defaultShapes( getDefaultSiteParams() )
     {}
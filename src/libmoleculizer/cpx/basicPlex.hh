@@ -35,6 +35,7 @@
 #include "cpx/binding.hh"
 #include "cpx/ftrSpec.hh"
 #include "cpx/plexIso.hh"
+#include "cpx/siteOccupancy.hh"
 
 namespace cpx
 {
@@ -59,26 +59,9 @@ namespace cpx
     basicPlex<molT>::
     makeFreeSiteVector( typename std::vector<siteSpec>& rFreeSiteVector ) const
     {
-        // Make the map from sites to the bindings they're involved in.
-        std::map<siteSpec, int> siteToBindings;
-        makeSiteToBindings( siteToBindings );
-        
-        // Enumerate the sites in this plex.  If a site doesn't appear
-        // in the sites to bindings map, it's a free site, so insert it
-        // into the vector of free sites.
-        int molNdx = mols.size();
-        while ( 0 < molNdx-- )
-        {
-            molT* pMol = mols[molNdx];
-            
-            int siteNdx = pMol->getSiteCount();
-            while ( 0 < siteNdx-- )
-            {
-                siteSpec theSpec( molNdx, siteNdx );
-                if ( siteToBindings.find( theSpec ) == siteToBindings.end() )
-                    rFreeSiteVector.push_back( theSpec );
-            }
-        }
+        siteOccupancy occupancy;
+        occupancy.build( *this );
+        occupancy.appendFreeSites( rFreeSiteVector );
     }
     
     template<class molT>
@@ -235,8 +218,8 @@ namespace cpx
     basicPlex<molT>::
     hashValue( void ) const
     {
-        typename std::map<siteSpec, int> siteToBindings;
-        makeSiteToBindings( siteToBindings );
+        siteOccupancy occupancy;
+        occupancy.build( *this );
         
         int molNdx = mols.size();
         size_t hashValue = 0;
@@ -245,7 +228,7 @@ namespace cpx
             typename std::set<int> molsSeen;
             
             hashMolRec<molT> hmr( *this,
-                                  siteToBindings,
+                                  occupancy,
                                   molsSeen );
             
             hashValue += hmr( molNdx,
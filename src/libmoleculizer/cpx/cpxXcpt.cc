@@ -146,4 +146,18 @@ namespace cpx
         return msgStream.str();
     }
     
+    std::string
+    tooManyModificationsXcpt::
+    mkMsg( const std::string& rModName,
+           int maxModificationCount )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Cannot make modification `"
+                  << rModName
+                  << "': at most "
+                  << maxModificationCount
+                  << " modifications may exist at once.";
+        return msgStream.str();
+    }
+    
 }
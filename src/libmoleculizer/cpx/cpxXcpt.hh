@@ -189,6 +189,23 @@ namespace cpx
         {}
     };
     
+    // Thrown when a modification is made while every modification code
+    // is held by a live modification.
+    class tooManyModificationsXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rModName,
+               int maxModificationCount );
+        
+    public:
+        tooManyModificationsXcpt( const std::string& rModName,
+                                  int maxModificationCount ) :
+            utl::xcpt( mkMsg( rModName,
+                              maxModificationCount ) )
+        {}
+    };
+    
 }
 
 #endif
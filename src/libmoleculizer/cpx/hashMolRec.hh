@@ -33,6 +33,7 @@
 #define CPX_HASHMOLREC_H
 
 #include "utl/linearHash.hh"
+#include "cpx/siteOccupancy.hh"
 
 namespace cpx
 {
@@ -41,15 +42,15 @@ namespace cpx
     class hashMolRec
     {
         const basicPlex<molT>& rPlex;
-        const typename std::map<siteSpec, int>& rSiteToBindings;
+        const siteOccupancy& rOccupancy;
         typename std::set<int>& rMolsSeen;
         
     public:
         hashMolRec( const basicPlex<molT>& refPlex,
-                    const typename std::map<siteSpec, int>& refSiteToBindings,
+                    const siteOccupancy& refOccupancy,
                     typename std::set<int>& refMolsSeen ) :
             rPlex( refPlex ),
-            rSiteToBindings( refSiteToBindings ),
+            rOccupancy( refOccupancy ),
             rMolsSeen( refMolsSeen )
         {}
         
@@ -64,14 +64,11 @@ namespace cpx
                   siteNdx < ( int ) pMol->getSiteCount();
                   siteNdx++ )
             {
-                siteSpec curSiteSpec( molNdx, siteNdx );
+                int bindingNdx
+                    = rOccupancy.getBinding( siteSpec( molNdx, siteNdx ) );
                 
-                typename std::map<siteSpec, int>::const_iterator iPair
-                    = rSiteToBindings.find( curSiteSpec );
-                
-                if ( iPair != rSiteToBindings.end() )
+                if ( 0 <= bindingNdx )
                 {
-                    int bindingNdx = iPair->second;
                     const binding& rBinding
                         = rPlex.bindings[bindingNdx];
                     
@@ -72,6 +72,7 @@ namespace cpx
             if ( insertOk )
             {
                 modSiteNames.push_back( rSiteName );
+                modSiteNameIds.push_back( nmr::NameInterner::intern( rSiteName ) );
             }
             else
             {
@@ -139,7 +140,8 @@ namespace cpx
             
             int modNdx = iCatEntry->second;
             
-            rTarget[modNdx] = pMod;
+            rTarget.setModification( modNdx,
+                                     pMod );
         }
     };
     
@@ -178,15 +180,7 @@ namespace cpx
     modMolMixin::modStateMatch::
     operator()( const modStateMixin& rMixinToTest ) const
     {
-        int modNdx = rMatch.size();
-        while ( 0 < modNdx-- )
-        {
-            const modification* pMatchMod = rMatch[modNdx];
-            
-            if (( 0 != pMatchMod )
-                && ( rMixinToTest[modNdx] != pMatchMod ) ) return false;
-        }
-        return true;
+        return rMixinToTest.matches( rMatch );
     }
     
     bool
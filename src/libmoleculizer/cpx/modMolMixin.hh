@@ -64,6 +64,10 @@ namespace cpx
         std::map<std::string, int> modSiteNameToNdx;
         std::vector<std::string> modSiteNames;
         
+        // The modification site names as interned for canonical naming,
+        // parallel to modSiteNames.
+        std::vector<nmr::NameInterner::NameId> modSiteNameIds;
+        
         // This may be superfluous and repeated elsewhere, however, I cannot find it.
         // If there is an easier/better way to get at the default modifications, someone
         // let me know and remove this.  That said, it really isn't that heavyweight.
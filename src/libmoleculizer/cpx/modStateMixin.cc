@@ -33,32 +33,131 @@
 
 namespace cpx
 {
-    class accumWeightDelta :
-        public std::unary_function<const modification*, void>
+    modStateMixin::
+    modStateMixin( const modification* pMod,
+                   int count ) :
+        siteCount( count ),
+        headWord( 0 ),
+        tailWords( count > sitesPerWord
+                   ? ( count - 1 ) / sitesPerWord
+                   : 0,
+                   0 )
     {
-        double& rTotal;
+        for ( int siteNdx = 0;
+              siteNdx < count;
+              ++siteNdx )
+        {
+            setCode( siteNdx,
+                     pMod ? pMod->getCode() : 0 );
+        }
+        updateWeightDelta();
+    }
+    
+    modStateMixin::
+    modStateMixin( const std::vector<const modification*>& rModifications ) :
+        siteCount( rModifications.size() ),
+        headWord( 0 ),
+        tailWords( siteCount > sitesPerWord
+                   ? ( siteCount - 1 ) / sitesPerWord
+                   : 0,
+                   0 )
+    {
+        for ( int siteNdx = 0;
+              siteNdx < siteCount;
+              ++siteNdx )
+        {
+            const modification* pMod = rModifications[siteNdx];
+            setCode( siteNdx,
+                     pMod ? pMod->getCode() : 0 );
+        }
+        updateWeightDelta();
+    }
+    
+    void
+    modStateMixin::
+    setCode( int siteNdx,
+             modCode code )
+    {
+        packWord& rWord = siteWord( siteNdx );
+        int shift = siteShift( siteNdx );
+        packWord fieldMask = static_cast<packWord>( static_cast<modCode>( ~0 ) ) << shift;
         
-    public:
-        accumWeightDelta( double& rTotalWeightDelta ) :
-            rTotal( rTotalWeightDelta )
-        {}
+        rWord = ( rWord & ~fieldMask )
+            | ( static_cast<packWord>( code ) << shift );
+    }
+    
+    // Sums in site order, as the weight was summed before states were
+    // packed, so that molecular weights come out bit-for-bit the same.
+    void
+    modStateMixin::
+    updateWeightDelta( void )
+    {
+        weightDelta = 0.0;
         
-        void
-        operator()( const modification* pModification ) const
+        for ( int siteNdx = 0;
+              siteNdx < siteCount;
+              ++siteNdx )
         {
-            rTotal += pModification->getWeightDelta();
+            const modification* pMod = ( *this )[siteNdx];
+            if ( pMod ) weightDelta += pMod->getWeightDelta();
         }
-    };
+    }
     
-    double
-    modStateMixin::totalWeightDelta( void ) const
+    namespace
     {
-        double totalDelta = 0.0;
+        typedef modStateMixin::packWord packWord;
+        
+        const packWord fieldMax
+        = static_cast<packWord>( static_cast<modCode>( ~0 ) );
         
-        std::for_each( begin(),
-                       end(),
-                       accumWeightDelta( totalDelta ) );
+        // The low and high bit of every field in a word.
+        const packWord lowBits = ~static_cast<packWord>( 0 ) / fieldMax;
+        const packWord highBits = lowBits << ( modStateMixin::codeBits - 1 );
         
-        return totalDelta;
+        // Mask covering the fields of a pattern word that are non-null,
+        // without looking at the fields one by one.
+        packWord
+        nonNullMask( packWord patternWord )
+        {
+            packWord nonNullHighBits
+                = ((( patternWord & ~highBits ) + ~highBits ) | patternWord )
+                & highBits;
+            
+            return ( nonNullHighBits >> ( modStateMixin::codeBits - 1 ) ) * fieldMax;
+        }
+    }
+    
+    bool
+    modStateMixin::
+    matches( const modStateMixin& rPattern ) const
+    {
+        if ( ( headWord ^ rPattern.headWord ) & nonNullMask( rPattern.headWord ) )
+            return false;
+        
+        for ( size_t wordNdx = 0;
+              wordNdx < rPattern.tailWords.size();
+              ++wordNdx )
+        {
+            packWord patternWord = rPattern.tailWords[wordNdx];
+            
+            if ( ( tailWords[wordNdx] ^ patternWord ) & nonNullMask( patternWord ) )
+                return false;
+        }
+        return true;
+    }
+    
+    size_t
+    modStateMixin::
+    hashValue( void ) const
+    {
+        size_t hash = headWord;
+        
+        for ( std::vector<packWord>::const_iterator iWord = tailWords.begin();
+              iWord != tailWords.end();
+              ++iWord )
+        {
+            hash = ( hash * 2654435761ul ) ^ *iWord;
+        }
+        return hash ^ ( hash >> 16 );
     }
 }
@@ -32,6 +32,8 @@
 #ifndef CPX_MODSTATEMIXIN_H
 #define CPX_MODSTATEMIXIN_H
 
+#include <climits>
+#include <vector>
 #include "utl/defs.hh"
 #include "cpx/modification.hh"
 
@@ -42,23 +44,133 @@ namespace cpx
     //
     // It is also used as the "core" of a query in which modifications
     // match themselves and the null pointer represents a wildcard.
-    class modStateMixin :
-        public std::vector<const modification*>
+    //
+    // The modification at each site is stored as its modCode, codeBits
+    // wide, packed into words starting from the low bits of headWord.
+    // Mols rarely have more than sitesPerWord modification sites, so
+    // ordering, equality and hashing of states are usually operations on
+    // the single word headWord, and copying a state doesn't allocate.
+    class modStateMixin
     {
+    public:
+        typedef unsigned long packWord;
+        
+        static const int codeBits = CHAR_BIT * sizeof( modCode );
+        static const int sitesPerWord = CHAR_BIT * sizeof( packWord ) / codeBits;
+        
+    private:
+        int siteCount;
+        
+        // Sites 0 through sitesPerWord - 1.
+        packWord headWord;
+        
+        // Any sites beyond the first sitesPerWord, sitesPerWord to a word.
+        std::vector<packWord> tailWords;
+        
+        // Total weight of the modifications, kept up to date by
+        // setModification so that getMolWeight needn't decode.
+        double weightDelta;
+        
+        const packWord&
+        siteWord( int siteNdx ) const
+        {
+            return siteNdx < sitesPerWord
+                ? headWord
+                : tailWords[siteNdx / sitesPerWord - 1];
+        }
+        
+        packWord&
+        siteWord( int siteNdx )
+        {
+            return siteNdx < sitesPerWord
+                ? headWord
+                : tailWords[siteNdx / sitesPerWord - 1];
+        }
+        
+        static int
+        siteShift( int siteNdx )
+        {
+            return ( siteNdx % sitesPerWord ) * codeBits;
+        }
+        
+        void
+        setCode( int siteNdx,
+                 modCode code );
+        
+        void
+        updateWeightDelta( void );
+        
     public:
         modStateMixin( const modification* pMod,
-                       int count ) :
-            std::vector<const modification*> ( count, pMod )
-        {}
+                       int count );
+        
+        modStateMixin( const std::vector<const modification*>& rModifications );
+        
+        size_t
+        size( void ) const
+        {
+            return siteCount;
+        }
         
-        modStateMixin( const std::vector<const modification*>& rModifications ) :
-            std::vector<const modification*> ( rModifications )
-        {}
+        modCode
+        getCode( int siteNdx ) const
+        {
+            return static_cast<modCode>( siteWord( siteNdx )
+                                         >> siteShift( siteNdx ) );
+        }
+        
+        // Returns the modification at the given site, or null for a
+        // wildcard.
+        const modification*
+        operator[]( int siteNdx ) const
+        {
+            return modification::fromCode( getCode( siteNdx ) );
+        }
+        
+        void
+        setModification( int siteNdx,
+                         const modification* pMod )
+        {
+            setCode( siteNdx,
+                     pMod ? pMod->getCode() : 0 );
+            updateWeightDelta();
+        }
         
         double
-        totalWeightDelta( void ) const;
+        totalWeightDelta( void ) const
+        {
+            return weightDelta;
+        }
+        
+        // Tests whether this state agrees with rPattern at every site where
+        // rPattern has a (non-null) modification.
+        bool
+        matches( const modStateMixin& rPattern ) const;
+        
+        size_t
+        hashValue( void ) const;
+        
+        bool
+        operator<( const modStateMixin& rRight ) const
+        {
+            if ( headWord != rRight.headWord ) return headWord < rRight.headWord;
+            if ( siteCount != rRight.siteCount ) return siteCount < rRight.siteCount;
+            return tailWords < rRight.tailWords;
+        }
         
+        bool
+        operator==( const modStateMixin& rRight ) const
+        {
+            return ( headWord == rRight.headWord )
+                && ( siteCount == rRight.siteCount )
+                && ( tailWords == rRight.tailWords );
+        }
         
+        bool
+        operator!=( const modStateMixin& rRight ) const
+        {
+            return ! operator==( rRight );
+        }
     };
 }
 
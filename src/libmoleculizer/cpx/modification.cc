@@ -0,0 +1,91 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+// Original Author:
+//   Larry Lok, Research Fellow, Molecular Sciences Institute, 2001
+//
+// Modifing Authors:
+//
+//
+
+#include <pthread.h>
+#include "cpx/modification.hh"
+#include "cpx/cpxXcpt.hh"
+
+namespace cpx
+{
+    namespace
+    {
+        // Modifications are made and destroyed by every moleculizer in
+        // the process, so the code table is shared, and guarded.
+        pthread_mutex_t codeTableMutex = PTHREAD_MUTEX_INITIALIZER;
+        
+        class codeTableLock
+        {
+        public:
+            codeTableLock( void )
+            {
+                pthread_mutex_lock( &codeTableMutex );
+            }
+            
+            ~codeTableLock( void )
+            {
+                pthread_mutex_unlock( &codeTableMutex );
+            }
+        };
+    }
+    
+    const modification* modification::codeTable[modification::codeCount];
+    
+    modCode
+    modification::
+    acquireCode( const modification* pModification )
+        throw( utl::xcpt )
+    {
+        codeTableLock lock;
+        
+        for ( int code = 1;
+              code < codeCount;
+              ++code )
+        {
+            if ( ! codeTable[code] )
+            {
+                codeTable[code] = pModification;
+                return static_cast<modCode>( code );
+            }
+        }
+        
+        throw tooManyModificationsXcpt( pModification->getName(),
+                                        codeCount - 1 );
+    }
+    
+    void
+    modification::
+    releaseCode( modCode theCode )
+    {
+        codeTableLock lock;
+        
+        codeTable[theCode] = 0;
+    }
+}
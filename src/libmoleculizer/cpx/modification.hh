@@ -34,34 +34,101 @@
 
 #include <string>
 #include "utl/dom.hh"
+#include "utl/xcpt.hh"
+#include "nmr/nameInterner.hh"
 
 namespace cpx
 {
+    // Small integer code for a live modification, used to pack modification
+    // states into words (see modStateMixin.)  Code 0 is never assigned; it
+    // stands for the null modification, which is a wildcard in queries.
+    //
+    // The codes are process-wide: at most codeCount - 1 = 255 modifications
+    // may exist at once across all the moleculizers in the process, and
+    // making one more throws tooManyModificationsXcpt.  The table is
+    // guarded, so modifications may be made and destroyed from any thread.
+    typedef unsigned char modCode;
+    
     class modification
     {
+    public:
+        // Number of distinct codes, including the null code 0.
+        static const int codeCount = 256;
+        
+    private:
+        // Table from code to the live modification holding it.
+        static const modification* codeTable[codeCount];
+        
+        // Claims the first free code for pModification, throwing
+        // tooManyModificationsXcpt if all are in use.
+        static modCode
+        acquireCode( const modification* pModification )
+            throw( utl::xcpt );
+        
+        static void
+        releaseCode( modCode theCode );
+        
+        // Codes are owned by the modification, so it can't be copied.
+        modification( const modification& rOriginal );
+        modification&
+        operator=( const modification& rRight );
+        
         std::string name;
         
+        // The name as interned for canonical naming.
+        nmr::NameInterner::NameId nameId;
+        
         // The amount by which the modification changes the molecular weight.
         double weightDelta;
         
+        modCode code;
+        
     public:
         modification( const std::string& rName,
                       double molWeightDelta ) :
             name( rName ),
-            weightDelta( molWeightDelta )
+            nameId( nmr::NameInterner::intern( rName ) ),
+            weightDelta( molWeightDelta ),
+            code( acquireCode( this ) )
         {}
         
+        ~modification( void )
+        {
+            releaseCode( code );
+        }
+        
+        // Returns the modification with the given code, or null for code 0.
+        // Not locked: a code is only looked up while its modification is
+        // alive, and it isn't reassigned until that modification is gone.
+        static const modification*
+        fromCode( modCode theCode )
+        {
+            return codeTable[theCode];
+        }
+        
         const std::string&
         getName( void ) const
         {
             return name;
         }
         
+        nmr::NameInterner::NameId
+        getNameId( void ) const
+        {
+            return nameId;
+        }
+        
         double
         getWeightDelta( void ) const
         {
             return weightDelta;
         }
+        
+        modCode
+        getCode( void ) const
+        {
+            return code;
+        }
     };
 }
 
@@ -88,6 +88,13 @@ namespace cpx
         respond( const typename omniPlexFeature::stimulusType& rNewFeatureContext );
 
 
+        // Overrides fnd::feature<cpx::cxOmni>::recordContext so that only
+        // species satisfying the omni's state query are remembered, as in
+        // respond.
+        virtual
+        void
+        recordContext( const typename omniPlexFeature::stimulusType& rStim );
+
         virtual 
         void 
         dumpablesRespond( const typename omniPlexFeature::stimulusType& rStim );
@@ -145,6 +152,31 @@ namespace cpx
         }
     }
 
+    template<class molT,
+             class plexSpeciesT,
+             class plexFamilyT,
+             class omniPlexT>
+    void
+    omniPlexFeature<molT,
+                    plexSpeciesT,
+                    plexFamilyT,
+                    omniPlexT>::
+    recordContext( const typename omniPlexFeature::stimulusType& rStim )
+    {
+        const typename omniPlexFeature::contextType& rNewContext
+            = rStim.getContext();
+        
+        omniPlexType* pOmni = rNewContext.getOmni();
+        const typename omniPlexFeature::stateQueryType& rQuery
+            = * ( pOmni->getStateQuery() );
+        
+        if ( rQuery.applyTracked( * ( rNewContext.getSpecies() ),
+                                  rNewContext.getSpec() ) )
+        {
+            fnd::feature<contextType>::recordContext( rStim );
+        }
+    }
+
     template<class molT,
              class plexSpeciesT,
              class plexFamilyT,
@@ -163,13 +195,18 @@ namespace cpx
             const typename omniPlexFeature::contextType& rNewContext
                 = rStim.getContext();
         
+            plexSpeciesType* pSpecies
+                = rNewContext.getSpecies();
+            
+            // The species reaches this feature once for each embedding
+            // of the omniplex, so skip the state query once it's in.
+            if ( pDumpable->speciesInSpeciesStream( pSpecies ) ) return;
+            
             // Does the new species satisfy the omni's state query?
             omniPlexType* pOmni = rNewContext.getOmni();
             const typename omniPlexFeature::stateQueryType& rQuery
                 = * ( pOmni->getStateQuery() );
         
-            plexSpeciesType* pSpecies
-                = rNewContext.getSpecies();
             const subPlexSpec<omniPlexType>& rSpec
                 = rNewContext.getSpec();
             if ( rQuery.applyTracked( *pSpecies,
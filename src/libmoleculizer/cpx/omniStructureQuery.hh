@@ -34,6 +34,7 @@
 
 #include "cpx/plexIso.hh"
 #include "cpx/ftrSpec.hh"
+#include "cpx/siteOccupancy.hh"
 
 namespace cpx
 {
@@ -44,10 +45,16 @@ namespace cpx
         const plexT& rPlex;
         const plexIso& rInjection;
         
+        // The plex's site occupancy, if it has been worked out; otherwise
+        // queries search the plex's bindings.
+        const siteOccupancy* pOccupancy;
+        
         omniStructureQueryArg( const plexT& rStructurePlex,
-                               const plexIso& rInjectionIso ) :
+                               const plexIso& rInjectionIso,
+                               const siteOccupancy* pPlexOccupancy = 0 ) :
             rPlex( rStructurePlex ),
-            rInjection( rInjectionIso )
+            rInjection( rInjectionIso ),
+            pOccupancy( pPlexOccupancy )
         {}
     };
     
@@ -70,6 +70,8 @@ namespace cpx
         siteSpec translatedSiteSpec
             = rInjection.forward.applyToSiteSpec( freeSiteSpec );
         
+        if ( rArg.pOccupancy ) return rArg.pOccupancy->siteIsFree( translatedSiteSpec );
+        
         // Return true if no binding in the plex contains the translated site
         // spec; i.e. if the site specified by freeSiteSpec in the omni
         // is also free in the plex where the omni is embedded.
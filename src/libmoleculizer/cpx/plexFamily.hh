@@ -43,7 +43,7 @@
 #include <vector>
 #include <map>
 #include <functional>
-#include "utl/autoCache.hh"
+#include "utl/hashCache.hh"
 #include "utl/autoVector.hh"
 #include "fnd/featureMap.hh"
 #include "fnd/sensitive.hh"
@@ -56,6 +56,7 @@
 #include "cpx/omniPlex.hh"
 #include "cpx/omniStructureQuery.hh"
 #include "cpx/knownBindings.hh"
+#include "cpx/siteOccupancy.hh"
 
 namespace cpx
 {
@@ -80,7 +81,7 @@ namespace cpx
              class plexFamilyT,
              class omniPlexT>
     class plexFamily :
-        public utl::autoCache<std::vector<molParam>, plexSpeciesT>,
+        public utl::autoHashCache<molParam, plexSpeciesT>,
         public fnd::sensitive<fnd::newSpeciesStimulus<plexSpeciesT> >
     {
         //   There are two phases of manipulations to the plexFamilies that must
@@ -140,6 +141,10 @@ namespace cpx
         // the "official" ordering of the mols and bindings.
         plexType paradigm;
         
+        // Which of the paradigm's sites are bound, and by which bindings.
+        // All the species in the family share the paradigm's structure.
+        siteOccupancy paradigmOccupancy;
+        
         // The omniPlexes with structure given by the paradigm of this
         // plexFamily.  Putting these here makes it possible, after determining
         // that a new plexSpecies has structure with this plexFamily's structure
@@ -224,6 +229,11 @@ namespace cpx
         void 
         dumpablesRespond( const fnd::newSpeciesStimulus<plexSpeciesType>& rStim );
         
+        // Record a species that is being restored as already expanded with
+        // the features, without generating any reactions.
+        void
+        recordContexts( const fnd::newSpeciesStimulus<plexSpeciesType>& rStim );
+        
         void
         accumulateSpecies( std::vector<plexSpeciesType*>& rAllSpecies );
         
@@ -233,6 +243,12 @@ namespace cpx
             return paradigm;
         }
         
+        const siteOccupancy&
+        getSiteOccupancy( void ) const
+        {
+            return paradigmOccupancy;
+        }
+        
         plexSpeciesType*
         makeMember( const std::vector<molParam>& rMolParams );
         
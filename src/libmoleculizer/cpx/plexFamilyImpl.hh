@@ -53,7 +53,9 @@ namespace cpx
         paradigm( rParadigm ),
         rKnownBindings( refKnownBindings ),
         rOmniPlexFamilies( refOmniplexFamilies )
-    {}
+    {
+        paradigmOccupancy.build( paradigm );
+    }
     
     template<class molT,
              class plexT,
@@ -94,6 +96,25 @@ namespace cpx
         omniFeatures.dumpablesRespond( rStim );
     }
     
+    template<class molT,
+             class plexT,
+             class plexSpeciesT,
+             class plexFamilyT,
+             class omniPlexT>
+    void
+    plexFamily<molT,
+               plexT,
+               plexSpeciesT,
+               plexFamilyT,
+               omniPlexT>::
+    recordContexts( const fnd::newSpeciesStimulus<plexSpeciesType>& rStim )
+    {
+        freeSiteFeatures.recordContexts( rStim );
+        bindingFeatures.recordContexts( rStim );
+        molFeatures.recordContexts( rStim );
+        omniFeatures.recordContexts( rStim );
+    }
+    
     // For accumulating all the plexSpecies in order to update them
     // by zero when regenerating reaction network.
     template<class plexSpeciesT,
@@ -404,7 +425,8 @@ namespace cpx
                 = pOmniPlex->getStructureQuery();
             
             omniStructureQueryArg<plexType> queryArg( rFamily.getParadigm(),
-                                                      rInjection );
+                                                      rInjection,
+                                                      &rFamily.getSiteOccupancy() );
             
             if ( rQuery( queryArg ) )
             {
@@ -480,7 +502,7 @@ namespace cpx
     {
         // Locate the free structural sites.
         std::vector<siteSpec> freeSiteVector;
-        paradigm.makeFreeSiteVector( freeSiteVector );
+        paradigmOccupancy.appendFreeSites( freeSiteVector );
         
         // Install each free structural site's feature in the free-site
         // feature map.
@@ -108,6 +108,18 @@ namespace cpx
             rQuery( rMolStateQuery )
         {}
         
+        molSpec
+        getMolSpec( void ) const
+        {
+            return theMolSpec;
+        }
+        
+        const cpx::molStateQuery&
+        getMolStateQuery( void ) const
+        {
+            return rQuery;
+        }
+        
         bool
         operator()
         ( const typename molStatePlexQuery::plexSpeciesType& rPlexSpecies ) const;
@@ -37,6 +37,7 @@
 #include "cpx/molState.hh"
 #include "nmr/namedMolecule.hh"
 #include "nmr/complexSpecies.hh"
+#include "nmr/internedComplexSpecies.hh"
 #include "nmr/mangledNameAssembler.hh"
 #include "nmr/basicNameAssembler.hh"
 #include "nmr/readableNameAssembler.hh"
@@ -93,6 +94,11 @@ namespace cpx
         void
         createComplexRepresentation( ComplexRepresentation& aComplexRepresentation ) const;
         
+        // The same complex as integer records, built from the names the mols
+        // and modifications interned when the rules were loaded.
+        void
+        createInternedRepresentation( nmr::InternedComplexSpecies& anInternedRepresentation ) const;
+        
     };
 }
 
@@ -124,6 +124,61 @@ namespace cpx
     }
     
     
+    template <class plexFamilyT>
+    void
+    plexSpeciesMixin<plexFamilyT>::
+    createInternedRepresentation( nmr::InternedComplexSpecies& anInternedRepresentation ) const
+    {
+        anInternedRepresentation.clear();
+        
+        const std::vector<typename plexFamilyT::molType*>& rMols = rFamily.getParadigm().mols;
+        const std::vector<cpx::binding>& rBindings  = rFamily.getParadigm().bindings;
+        
+        for ( unsigned int molNdx = 0;
+              molNdx != rMols.size();
+              ++molNdx )
+        {
+            typename plexFamilyT::molType* pMol = rMols[molNdx];
+            
+            nmr::InternedMol aMol( pMol->getNameId() );
+            
+            const cpx::modMol<typename plexFamilyT::molType>* aModMol =
+                dynamic_cast<const cpx::modMol<typename plexFamilyT::molType>* >( pMol );
+            
+            if ( aModMol )
+            {
+                const cpx::modMolState& nuMolParam = aModMol->externState( molParams[molNdx] );
+                
+                if ( nuMolParam.size() != aModMol->modSiteNameIds.size() )
+                {
+                    throw utl::xcpt( "Unknown Error in plexSpeciesMixin::createInternedRepresentation." );
+                }
+                
+                // modSiteNames are in name order, as MinimalMol keeps them.
+                aMol.theModifications.reserve( nuMolParam.size() );
+                for ( unsigned int ndx = 0;
+                      ndx != aModMol->modSiteNameIds.size();
+                      ++ndx )
+                {
+                    aMol.theModifications.push_back( std::make_pair( aModMol->modSiteNameIds[ndx],
+                                                                     nuMolParam[ndx]->getNameId() ) );
+                }
+            }
+            
+            anInternedRepresentation.addMolToComplex( aMol );
+        }
+        
+        for ( std::vector<cpx::binding>::const_iterator iter = rBindings.begin();
+              iter != rBindings.end();
+              ++iter )
+        {
+            anInternedRepresentation.addBindingToComplex( ( *iter ).leftSite().molNdx(),
+                                                          ( *iter ).leftSite().siteNdx(),
+                                                          ( *iter ).rightSite().molNdx(),
+                                                          ( *iter ).rightSite().siteNdx() );
+        }
+    }
+    
     template <class plexFamilyT>
     std::string
     plexSpeciesMixin<plexFamilyT>::getCanonicalName( void ) const
@@ -140,8 +195,8 @@ namespace cpx
     plexSpeciesMixin<plexFamilyT>::
     getCanonicalName( const nmr::NameAssembler* const ptrNameAssembler ) const
     {
-        nmr::ComplexSpecies aComplexSpecies;
-        createComplexRepresentation( aComplexSpecies );
+        nmr::InternedComplexSpecies aComplexSpecies;
+        createInternedRepresentation( aComplexSpecies );
         std::string theName( ptrNameAssembler->createCanonicalName( aComplexSpecies ) );
         
         return theName;
@@ -32,7 +32,11 @@
 #ifndef CPX_QUERYALLOLIST_H
 #define CPX_QUERYALLOLIST_H
 
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <map>
+#include <vector>
 #include "cpx/plexQuery.hh"
 
 
@@ -42,6 +46,9 @@ namespace cpx
     // its components satisfy state queries.  This optimizes traversal,
     // since we must run through all the queries for every new species
     // in the plex family.
+    //
+    // A new species is only run through the queries that the states of
+    // its mols allow; see compile below.
     template<class plexSpeciesT,
              class omniPlexT>
     class queryAllosteryList :
@@ -90,6 +97,52 @@ namespace cpx
         void
         setSatisfiedQuerySiteShapes( plexSpeciesT& rSpecies,
                                      const specType& rSubPlexSpec ) const;
+        
+    private:
+        typedef plexQuery<plexSpeciesT,
+                          omniPlexT> plexQueryType;
+        
+        typedef molStatePlexQuery<plexSpeciesT,
+                                  omniPlexT> molStatePlexQueryType;
+        
+        // A bit for each query in the list, in list order.
+        typedef std::vector<unsigned long> queryBits;
+        
+        // The queries of the states of the mol at one index in the
+        // complex, with the index in the list of the query each is part
+        // of.  Since these depend only on the mol's state, their
+        // combined answer for each state that has turned up is kept.
+        class molStateTests
+        {
+        public:
+            molSpec theMolSpec;
+            
+            std::vector<std::pair<int, const molStateQuery*> > stateQueries;
+            
+            // The queries in the list that the mol's state doesn't rule
+            // out.
+            std::map<molParam, queryBits> passingByState;
+        };
+        
+        // The list, compiled into tests by mol index the first time a
+        // species is tested after a query is added.  Conjuncts that are
+        // not mol state queries are applied as they always were, but only
+        // to species that pass the mol state queries.
+        mutable int compiledQueryCount;
+        mutable std::vector<molStateTests> testsByMol;
+        mutable std::vector<std::vector<const plexQueryType*> > otherConjuncts;
+        
+        void
+        compile( void ) const;
+        
+        const queryBits&
+        passingQueries( molStateTests& rTests,
+                        molParam theMolParam ) const;
+        
+    public:
+        queryAllosteryList( void ) :
+            compiledQueryCount( 0 )
+        {}
     };
 }
 
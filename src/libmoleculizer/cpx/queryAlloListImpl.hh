@@ -39,36 +39,99 @@ namespace cpx
     addQueryAndMap( const queryType* pQuery,
                     const siteToShapeMap& rSiteToShapeMap )
     {
-        push_back( std::make_pair( pQuery, rSiteToShapeMap ) );
+        this->push_back( std::make_pair( pQuery, rSiteToShapeMap ) );
     }
     
     template<class plexSpeciesT,
              class omniPlexT>
-    class setShapesIfSatisfied :
-        public std::unary_function<typename queryAllosteryList<plexSpeciesT,
-                                                               omniPlexT>::value_type,
-                                   void>
+    void
+    queryAllosteryList<plexSpeciesT,
+                       omniPlexT>::
+    compile( void ) const
     {
-        plexSpeciesT& rSpecies;
+        testsByMol.clear();
+        otherConjuncts.clear();
         
-    public:
-        setShapesIfSatisfied( plexSpeciesT& refSpecies ) :
-            rSpecies( refSpecies )
-        {}
+        std::map<molSpec, int> testsNdxByMol;
         
-        void
-        operator()( const typename setShapesIfSatisfied::argument_type& rQueryShapeMapPair ) const
+        int queryNdx = 0;
+        for ( typename queryAllosteryList::const_iterator iEntry = this->begin();
+              iEntry != this->end();
+              ++iEntry, ++queryNdx )
         {
-            const andPlexQueries<plexSpeciesT, omniPlexT>& rQuery
-                = * ( rQueryShapeMapPair.first );
+            otherConjuncts.push_back( std::vector<const plexQueryType*>() );
+            
+            const std::vector<const plexQueryType*>& rConjuncts
+                = iEntry->first->getQueries();
             
-            if ( rQuery( rSpecies ) )
+            for ( typename std::vector<const plexQueryType*>::const_iterator iConjunct
+                      = rConjuncts.begin();
+                  iConjunct != rConjuncts.end();
+                  ++iConjunct )
             {
-                const siteToShapeMap& rSiteToShapeMap = rQueryShapeMapPair.second;
-                rSpecies.siteParams.setSiteShapes( rSiteToShapeMap );
+                const molStatePlexQueryType* pMolStateQuery
+                    = dynamic_cast<const molStatePlexQueryType*>( *iConjunct );
+                
+                if ( ! pMolStateQuery )
+                {
+                    otherConjuncts.back().push_back( *iConjunct );
+                    continue;
+                }
+                
+                molSpec theMolSpec = pMolStateQuery->getMolSpec();
+                std::map<molSpec, int>::iterator iTestsNdx
+                    = testsNdxByMol.find( theMolSpec );
+                if ( iTestsNdx == testsNdxByMol.end() )
+                {
+                    iTestsNdx = testsNdxByMol.insert
+                        ( std::make_pair( theMolSpec,
+                                          ( int ) testsByMol.size() ) ).first;
+                    testsByMol.push_back( molStateTests() );
+                    testsByMol.back().theMolSpec = theMolSpec;
+                }
+                
+                testsByMol[iTestsNdx->second].stateQueries.push_back
+                    ( std::make_pair( queryNdx,
+                                      &( pMolStateQuery->getMolStateQuery() ) ) );
             }
         }
-    };
+        
+        compiledQueryCount = queryNdx;
+    }
+    
+    template<class plexSpeciesT,
+             class omniPlexT>
+    const typename queryAllosteryList<plexSpeciesT,
+                                      omniPlexT>::queryBits&
+    queryAllosteryList<plexSpeciesT,
+                       omniPlexT>::
+    passingQueries( molStateTests& rTests,
+                    molParam theMolParam ) const
+    {
+        typename std::map<molParam, queryBits>::iterator iPassing
+            = rTests.passingByState.find( theMolParam );
+        if ( iPassing != rTests.passingByState.end() ) return iPassing->second;
+        
+        const int wordBits = std::numeric_limits<unsigned long>::digits;
+        
+        queryBits passing( ( compiledQueryCount + wordBits - 1 ) / wordBits,
+                           ~0UL );
+        
+        for ( typename std::vector<std::pair<int, const molStateQuery*> >::const_iterator
+                  iStateQuery = rTests.stateQueries.begin();
+              iStateQuery != rTests.stateQueries.end();
+              ++iStateQuery )
+        {
+            int queryNdx = iStateQuery->first;
+            if ( ! ( *( iStateQuery->second ) )( theMolParam ) )
+            {
+                passing[queryNdx / wordBits] &= ~( 1UL << ( queryNdx % wordBits ) );
+            }
+        }
+        
+        return rTests.passingByState.insert( std::make_pair( theMolParam,
+                                                             passing ) ).first->second;
+    }
     
     template<class plexSpeciesT,
              class omniPlexT>
@@ -77,12 +140,48 @@ namespace cpx
                        omniPlexT>::
     setSatisfiedQuerySiteShapes( plexSpeciesT& rSpecies ) const
     {
-        setShapesIfSatisfied<plexSpeciesT, omniPlexT>
-            setShapes( rSpecies );
+        if ( compiledQueryCount != ( int ) this->size() ) compile();
         
-        std::for_each( this->begin(),
-                       this->end(),
-                       setShapes );
+        const int wordBits = std::numeric_limits<unsigned long>::digits;
+        
+        queryBits candidates( ( compiledQueryCount + wordBits - 1 ) / wordBits,
+                              ~0UL );
+        
+        for ( typename std::vector<molStateTests>::iterator iTests = testsByMol.begin();
+              iTests != testsByMol.end();
+              ++iTests )
+        {
+            const queryBits& rPassing
+                = passingQueries( *iTests,
+                                  rSpecies.molParams[iTests->theMolSpec] );
+            
+            for ( size_t wordNdx = 0;
+                  wordNdx < candidates.size();
+                  ++wordNdx )
+            {
+                candidates[wordNdx] &= rPassing[wordNdx];
+            }
+        }
+        
+        // Shapes are set in list order, as they always were, so that where
+        // satisfied queries disagree about a site, the later one wins.
+        int queryNdx = 0;
+        for ( typename queryAllosteryList::const_iterator iEntry = this->begin();
+              iEntry != this->end();
+              ++iEntry, ++queryNdx )
+        {
+            if ( ! ( candidates[queryNdx / wordBits] & ( 1UL << ( queryNdx % wordBits ) ) ) ) continue;
+            
+            const std::vector<const plexQueryType*>& rOtherConjuncts
+                = otherConjuncts[queryNdx];
+            
+            if ( rOtherConjuncts.end()
+                 != std::find_if( rOtherConjuncts.begin(),
+                                  rOtherConjuncts.end(),
+                                  fnd::queryReturnsFalse<plexQueryType> ( rSpecies ) ) ) continue;
+            
+            rSpecies.siteParams.setSiteShapes( iEntry->second );
+        }
     }
     
     template<class plexSpeciesT,
@@ -136,6 +235,6 @@ namespace cpx
         
         std::for_each( this->begin(),
                        this->end(),
-                       this->setMixinShapes );
+                       setShapes );
     }
 }
@@ -34,6 +34,8 @@
 
 #include "cpx/plexIso.hh"
 #include "cpx/plexFamily.hh"
+#include "fnd/expansionProfiler.hh"
+#include "fnd/memoryAccount.hh"
 
 namespace cpx
 {
@@ -60,12 +62,24 @@ namespace cpx
         // Cache for immediate recognition of previously encountered plexes.
         std::map<plexType, recognition> recognizedCache;
         
+        // Charged for the cache and for the plex families.
+        fnd::memoryAccount& rAccount;
+        
+        // Times recognition, and the connection of new families.
+        fnd::expansionProfiler& rProfiler;
+        
     public:
         // Publicized in order to traverse all the plexFamilies.
         //
         // In particular, for plexUnit::prepareToRun().
         std::multimap<int, plexFamilyType*> plexHasher;
         
+        recognizer( fnd::memoryAccount& rMemoryAccount,
+                    fnd::expansionProfiler& rExpansionProfiler ) :
+            rAccount( rMemoryAccount ),
+            rProfiler( rExpansionProfiler )
+        {}
+        
         virtual
         ~recognizer( void );
         
@@ -77,6 +91,13 @@ namespace cpx
             return plexHasher.size();
         }
         
+        // For the families, which time their own naming.
+        fnd::expansionProfiler&
+        getExpansionProfiler( void ) const
+        {
+            return rProfiler;
+        }
+        
         // Finds the plexFamily of a plex, and gives the isomorphism of the
         // given plex with the plexFamily's paradigm.  This just runs the
         // bare constructor of the plexFamily, leaving undone the "phase
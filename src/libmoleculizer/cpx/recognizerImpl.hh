@@ -117,6 +117,9 @@ namespace cpx
            plexFamilyType*& rpFamily,
            plexIso* pIso )
     {
+        fnd::profilePhase profile( rProfiler,
+                                   fnd::expansionProfiler::RECOGNITION );
+        
         // Check the cache to see if this plex has ever been recognized
         // before.
         std::pair<typename std::map<plexType, recognition>::iterator, bool> insertResult
@@ -134,6 +137,13 @@ namespace cpx
         bool familyIsNew = false;
         if ( insertResult.second )
         {
+            // The cached plex and the isomorphism, which maps each mol and
+            // binding both ways.
+            rAccount.charge( fnd::memoryAccount::RECOGNIZER_CACHE,
+                             fnd::memoryAccount::treeNodeBytes( sizeof( typename std::map<plexType, recognition>::value_type ) )
+                             + aPlex.mols.size() * ( sizeof( aPlex.mols[0] ) + 2 * sizeof( int ) )
+                             + aPlex.bindings.size() * ( sizeof( aPlex.bindings[0] ) + 2 * sizeof( int ) ) );
+            
             // Get the plex's hash value.
             int plexHashValue = aPlex.hashValue();
             
@@ -145,11 +155,15 @@ namespace cpx
             
             // Scan the plex isomorphism classes having the same hash value
             // as this plex for the correct isomorphism class of this plex.
-            typename std::multimap<int, plexFamilyType*>::iterator iEntry
-                = find_if( rangeIterPair.first,
-                           rangeIterPair.second,
-                           thisPlexFamilyIso<plexType, plexFamilyType> ( aPlex,
-                                                                         rIso ) );
+            typename std::multimap<int, plexFamilyType*>::iterator iEntry;
+            {
+                fnd::profilePhase isoProfile( rProfiler,
+                                              fnd::expansionProfiler::ISOMORPHISM_SEARCH );
+                iEntry = find_if( rangeIterPair.first,
+                                  rangeIterPair.second,
+                                  thisPlexFamilyIso<plexType, plexFamilyType> ( aPlex,
+                                                                                rIso ) );
+            }
             
             if ( iEntry == rangeIterPair.second )
             {
@@ -168,6 +182,9 @@ namespace cpx
                 // Rememember this family, in case we ever see it again.
                 plexHasher.insert( std::make_pair( plexHashValue,
                                                    rFamilyPtr ) );
+                rAccount.charge( fnd::memoryAccount::PLEX_FAMILIES,
+                                 sizeof( plexFamilyType )
+                                 + fnd::memoryAccount::treeNodeBytes( sizeof( std::pair<int, plexFamilyType*> ) ) );
             }
             else
             {
@@ -176,6 +193,10 @@ namespace cpx
                 rFamilyPtr = iEntry->second;
             }
         }
+        else if ( rProfiler.isEnabled() )
+        {
+            rProfiler.noteCacheHit( fnd::expansionProfiler::RECOGNITION );
+        }
         
         // Return plexFamily pointer that was installed in the map.
         rpFamily = rFamilyPtr;
@@ -213,6 +234,8 @@ namespace cpx
                     0 ) )
         {
             // Connect the plexFamily to all its features.
+            fnd::profilePhase profile( rProfiler,
+                                       fnd::expansionProfiler::OMNIPLEX_CONNECTION );
             pPlexFamily->connectToFeatures();
         }
         
@@ -240,6 +263,8 @@ namespace cpx
                     &rIso ) )
         {
             // Connect the plexFamily to all its features.
+            fnd::profilePhase profile( rProfiler,
+                                       fnd::expansionProfiler::OMNIPLEX_CONNECTION );
             pPlexFamily->connectToFeatures();
         }
         
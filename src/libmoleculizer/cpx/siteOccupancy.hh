@@ -0,0 +1,152 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef CPX_SITEOCCUPANCY_H
+#define CPX_SITEOCCUPANCY_H
+
+#include <limits>
+#include <vector>
+#include "cpx/binding.hh"
+
+namespace cpx
+{
+    /*! \ingroup plexStructGroup
+      \brief Which sites of a plex are bound, and by which binding.
+      
+      Flat tables indexed by site, with the sites of each mol in order
+      after those of the mols before it, so that asking whether a site
+      is free, or what binds it, doesn't search the plex's bindings. */
+    class siteOccupancy
+    {
+        // The index of each mol's first site, and after the last mol's,
+        // the number of sites in the plex.
+        std::vector<int> molSiteOffsets;
+        
+        // The binding at each site, or -1 where the site is free.
+        std::vector<bindingSpec> siteBindings;
+        
+        // A bit for each site, set where the site is bound.
+        std::vector<unsigned long> boundBits;
+        
+        static int
+        wordBits( void )
+        {
+            return std::numeric_limits<unsigned long>::digits;
+        }
+        
+        int
+        siteIndex( const siteSpec& rSpec ) const
+        {
+            return molSiteOffsets[rSpec.molNdx()] + rSpec.siteNdx();
+        }
+        
+    public:
+        // The plex's mols must not change while the tables are in use,
+        // and should be built again if its bindings do.
+        template<class plexT>
+        void
+        build( const plexT& rPlex )
+        {
+            int molCount = rPlex.mols.size();
+            
+            molSiteOffsets.assign( molCount + 1, 0 );
+            for ( int molNdx = 0;
+                  molNdx < molCount;
+                  ++molNdx )
+            {
+                molSiteOffsets[molNdx + 1]
+                    = molSiteOffsets[molNdx] + rPlex.mols[molNdx]->getSiteCount();
+            }
+            
+            int siteCount = molSiteOffsets.back();
+            siteBindings.assign( siteCount, -1 );
+            boundBits.assign( ( siteCount + wordBits() - 1 ) / wordBits(), 0UL );
+            
+            // Where a site is (wrongly) in more than one binding, the
+            // last binding wins, as it does in makeSiteToBindings.
+            bindingSpec spec = rPlex.bindings.size();
+            while ( 0 < spec-- )
+            {
+                const binding& rBinding = rPlex.bindings[spec];
+                markBound( siteIndex( rBinding.leftSite() ), spec );
+                markBound( siteIndex( rBinding.rightSite() ), spec );
+            }
+        }
+        
+        int
+        getSiteCount( void ) const
+        {
+            return siteBindings.size();
+        }
+        
+        bool
+        siteIsFree( const siteSpec& rSpec ) const
+        {
+            int siteNdx = siteIndex( rSpec );
+            return ! ( boundBits[siteNdx / wordBits()] & ( 1UL << ( siteNdx % wordBits() ) ) );
+        }
+        
+        // The binding at the site, or -1 if the site is free.
+        bindingSpec
+        getBinding( const siteSpec& rSpec ) const
+        {
+            return siteBindings[siteIndex( rSpec )];
+        }
+        
+        // Pushes the free sites onto the vector in the order that
+        // basicPlex::makeFreeSiteVector always has: last mol first, and
+        // each mol's sites from last to first.
+        void
+        appendFreeSites( std::vector<siteSpec>& rFreeSites ) const
+        {
+            int molNdx = molSiteOffsets.size() - 1;
+            while ( 0 < molNdx-- )
+            {
+                int siteNdx = molSiteOffsets[molNdx + 1] - molSiteOffsets[molNdx];
+                while ( 0 < siteNdx-- )
+                {
+                    if ( siteBindings[molSiteOffsets[molNdx] + siteNdx] < 0 )
+                    {
+                        rFreeSites.push_back( siteSpec( molNdx, siteNdx ) );
+                    }
+                }
+            }
+        }
+        
+    private:
+        void
+        markBound( int siteNdx,
+                   bindingSpec spec )
+        {
+            if ( 0 <= siteBindings[siteNdx] ) return;
+            
+            siteBindings[siteNdx] = spec;
+            boundBits[siteNdx / wordBits()] |= 1UL << ( siteNdx % wordBits() );
+        }
+    };
+}
+
+#endif // CPX_SITEOCCUPANCY_H
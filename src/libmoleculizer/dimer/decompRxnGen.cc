@@ -33,6 +33,7 @@
 #include "mzr/mzrReaction.hh"
 #include "cpx/cxBinding.hh"
 #include "mol/mzrBndSite.hh"
+#include "fnd/expansionProfiler.hh"
 #include "plex/plexUnit.hh"
 #include "dimer/decompRxnGen.hh"
 #include "dimer/dimerUnit.hh"
@@ -44,6 +45,11 @@ namespace dimer
     decompRxnGen::
     respond( const fnd::featureStimulus<cpx::cxBinding<plx::mzrPlexSpecies, plx::mzrPlexFamily> >& rStimulus )
     {
+        fnd::expansionProfiler& rProfiler = rMzrUnit.rMolzer.getExpansionProfiler();
+        fnd::profileRxnGen profile( rProfiler,
+                                    this,
+                                    "decomposition-gen" );
+        
         const cpx::cxBinding<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rNewContext
             = rStimulus.getContext();
         
@@ -64,7 +70,11 @@ namespace dimer
                                 1 );
         
         // Extrapolate the rate of the reaction.
-        pReaction->setRate( pExtrap->getRate( rNewContext ) );
+        {
+            fnd::profilePhase extrapProfile( rProfiler,
+                                             fnd::expansionProfiler::RATE_EXTRAPOLATION );
+            pReaction->setRate( pExtrap->getRate( rNewContext ) );
+        }
         
         // Ingredients for the mandatory result species.
         std::vector<cpx::molParam> mndtryResultParams;
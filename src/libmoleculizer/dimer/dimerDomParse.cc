@@ -32,6 +32,7 @@
 #include <vector>
 #include "utl/domXcpt.hh"
 #include "fnd/pchem.hh"
+#include "fnd/expansionProfiler.hh"
 #include "mzr/moleculizer.hh"
 #include "mzr/mzrUnit.hh"
 #include "mzr/mzrEltName.hh"
@@ -427,7 +428,9 @@ namespace dimer
             if( rMzrUnit.rMolzer.getRateExtrapolation() )
             {
                 pDimerizeExtrap = new dimerizeMassExtrap(leftMolWeight,
-                                                         rightMolWeight);
+                                                         rightMolWeight,
+                                                         &rMzrUnit.rMolzer.getMemoryAccount(),
+                                                         &rMzrUnit.rMolzer.getExpansionProfiler());
                 
                 // What is this?
                 // pDimerizeExtrap = new dimerizeConstantRate();
@@ -509,8 +512,28 @@ namespace dimer
             rMzrUnit.addReactionFamily( pDimerizeFam );
             
             // Attach the dimerization reaction generator the site features.
-            rLeftSiteFeature.addSensitive( pDimerizeFam->getLeftRxnGen() );
-            rRightSiteFeature.addSensitive( pDimerizeFam->getRightRxnGen() );
+            fnd::memoryAccount& rAccount = rMzrUnit.rMolzer.getMemoryAccount();
+            if ( rLeftSiteFeature.addSensitive( pDimerizeFam->getLeftRxnGen() ) )
+            {
+                rAccount.charge( fnd::memoryAccount::SENSITIVITY_LISTS,
+                                 fnd::memoryAccount::treeNodeBytes( sizeof( void* ) ) );
+            }
+            if ( rRightSiteFeature.addSensitive( pDimerizeFam->getRightRxnGen() ) )
+            {
+                rAccount.charge( fnd::memoryAccount::SENSITIVITY_LISTS,
+                                 fnd::memoryAccount::treeNodeBytes( sizeof( void* ) ) );
+            }
+            
+            // Name both generators for the expansion profiler.
+            std::string bindingName = pLeftMol->getName() + "(" + rLeftSite.getName() + ")"
+                + " " + pRightMol->getName() + "(" + rRightSite.getName() + ")";
+            fnd::expansionProfiler& rProfiler = rMzrUnit.rMolzer.getExpansionProfiler();
+            rProfiler.nameRxnGen( pDimerizeFam->getRxnGenPair(),
+                                  eltName::dimerizationGen,
+                                  bindingName );
+            rProfiler.nameRxnGen( pDecompFam->getRxnGen(),
+                                  "decomposition-gen",
+                                  bindingName );
 
         }
     };
@@ -94,6 +94,9 @@ namespace dimer
         {
             insertResult.first->second = invariant;
         }
+        
+        // Allosteric rates are written over default rates.
+        memoizedInvariants.forget();
     }
     
     double
@@ -101,22 +104,55 @@ namespace dimer
     getRate( const cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rLeftContext,
              const cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rRightContext ) const
     {
-        // Since the rates were stored with the key pair in only one
-        // order, we have to check for both orders when looking it up.
-        invMapType::const_iterator iEntry
-            = invariantMap.find( std::make_pair( rLeftContext.getSiteParam(),
-                                                 rRightContext.getSiteParam() ) );
-        if ( iEntry == invariantMap.end() )
+        double rate;
+        if ( ! findRate( rLeftContext.getSiteParam(),
+                         rRightContext.getSiteParam(),
+                         rLeftContext.getPlexWeight(),
+                         rRightContext.getPlexWeight(),
+                         rate ) )
+            throw missingDimerizeInvariantXcpt( rLeftContext,
+                                                rRightContext );
+        
+        return rate;
+    }
+    
+    bool
+    dimerizeMassExtrap::
+    findRate( cpx::siteParam leftParam,
+              cpx::siteParam rightParam,
+              double leftWeight,
+              double rightWeight,
+              double& rRate ) const
+    {
+        std::pair<cpx::siteParam, cpx::siteParam> key( leftParam,
+                                                       rightParam );
+        
+        double invariant;
+        const double* pInvariant = memoizedInvariants.find( key );
+        if ( pInvariant )
+        {
+            invariant = *pInvariant;
+        }
+        else
         {
-            iEntry = invariantMap.find( std::make_pair( rRightContext.getSiteParam(),
-                                                        rLeftContext.getSiteParam() ) );
+            // Since the rates were stored with the key pair in only one
+            // order, we have to check for both orders when looking it up.
+            invMapType::const_iterator iEntry
+                = invariantMap.find( key );
             if ( iEntry == invariantMap.end() )
-                throw missingDimerizeInvariantXcpt( rLeftContext,
-                                                    rRightContext );
+            {
+                iEntry = invariantMap.find( std::make_pair( rightParam,
+                                                            leftParam ) );
+                if ( iEntry == invariantMap.end() ) return false;
+            }
+            
+            invariant = memoizedInvariants.remember( key,
+                                                     iEntry->second );
         }
         
-        return fnd::bindingRate( iEntry->second,
-                                 rLeftContext.getPlexWeight(),
-                                 rRightContext.getPlexWeight() );
+        rRate = fnd::bindingRate( invariant,
+                                  leftWeight,
+                                  rightWeight );
+        return true;
     }
 }
@@ -33,6 +33,7 @@
 #define DIMERIZEEXTRAP_H
 
 #include "fnd/pchem.hh"
+#include "fnd/rateMemo.hh"
 #include "cpx/siteShape.hh"
 #include "cpx/cxSite.hh"
 #include "plex/mzrPlexSpecies.hh"
@@ -116,13 +117,24 @@ namespace dimer
         
         invMapType invariantMap;
         
+        // The binding invariant for each ordered pair of site shapes, as
+        // found in invariantMap in either order.  The weights vary from
+        // reaction to reaction, so the rate itself is computed each time.
+        mutable fnd::rateMemo<std::pair<cpx::siteParam, cpx::siteParam> > memoizedInvariants;
+        
     public:
         // The masses given to this constructor are used to convert
-        // to/from binding invariant to rate and back.
+        // to/from binding invariant to rate and back.  The memoized
+        // invariants are charged to the memory account, and their hits
+        // counted by the profiler, if they are given.
         dimerizeMassExtrap( double leftMolMass,
-                            double rightMolMass ) :
+                            double rightMolMass,
+                            fnd::memoryAccount* pMemoryAccount = 0,
+                            fnd::expansionProfiler* pExpansionProfiler = 0 ) :
             leftMass( leftMolMass ),
-            rightMass( rightMolMass )
+            rightMass( rightMolMass ),
+            memoizedInvariants( pMemoryAccount,
+                                pExpansionProfiler )
         {}
         
         // Both for inserting default rates and for writing allosteric
@@ -139,6 +151,16 @@ namespace dimer
         double
         getRate( const cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rLeftContext,
                  const cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rRightContext ) const;
+        
+        // Finds the rate for sites of the given shapes on complexes of the
+        // given weights.  Returns false if no rate was given for the pair of
+        // site shapes.
+        bool
+        findRate( cpx::siteParam leftParam,
+                  cpx::siteParam rightParam,
+                  double leftWeight,
+                  double rightWeight,
+                  double& rRate ) const;
     };
 }
 
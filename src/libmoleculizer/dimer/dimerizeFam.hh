@@ -57,6 +57,13 @@ namespace dimer
                      pExtrap )
         {}
         
+        // The pair is what the expansion profiler sees generating.
+        const dimerizeRxnGenPair*
+        getRxnGenPair( void ) const
+        {
+            return &rxnGens;
+        }
+        
         fnd::rxnGen<cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily> >*
         getLeftRxnGen( void )
         {
@@ -31,6 +31,7 @@
 
 #include "mzr/mzrReaction.hh"
 #include "fnd/pchem.hh"
+#include "fnd/expansionProfiler.hh"
 #include "mzr/moleculizer.hh"
 #include "mol/mzrMol.hh"
 #include "cpx/cxSite.hh"
@@ -73,6 +74,10 @@ namespace dimer
       const cpx::cxSite<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rRightContext,
       int generateDepth ) const
     {
+        fnd::expansionProfiler& rProfiler = rMzrUnit.rMolzer.getExpansionProfiler();
+        fnd::profileRxnGen profile( rProfiler,
+                                    this,
+                                    "dimerization-gen" );
         
         // Construct the (only) new reaction and install it in the family
         // of dimerization reactions.
@@ -93,8 +98,12 @@ namespace dimer
                                 1 );
         
         // Extrapolate the rate for the new reaction.
-        pReaction->setRate( pExtrap->getRate( rLeftContext,
-                                              rRightContext ) );
+        {
+            fnd::profilePhase extrapProfile( rProfiler,
+                                             fnd::expansionProfiler::RATE_EXTRAPOLATION );
+            pReaction->setRate( pExtrap->getRate( rLeftContext,
+                                                  rRightContext ) );
+        }
         
         // Now start cooking up the product species.
         std::vector<cpx::molParam> resultMolParams;
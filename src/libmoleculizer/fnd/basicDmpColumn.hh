@@ -32,6 +32,8 @@
 #ifndef FND_BASICDMPCOLUMN_H
 #define FND_BASICDMPCOLUMN_H
 
+#include <string>
+
 namespace fnd
 {
     // Base class for dmpColumn classes, of which
@@ -48,6 +50,16 @@ namespace fnd
         
         virtual void
         doDump( void ) = 0;
+        
+        // For binary dump streams.
+        virtual const std::string&
+        getName( void ) const = 0;
+        
+        virtual bool
+        hasValue( void ) const = 0;
+        
+        virtual double
+        getValue( void ) const = 0;
     };
     
 }
@@ -0,0 +1,196 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <cstring>
+#include "fnd/fndXcpt.hh"
+#include "fnd/binaryDumpReader.hh"
+
+namespace fnd
+{
+    namespace binaryDump
+    {
+        const char magic[8] = { 'M', 'Z', 'R', 'D', 'M', 'P', 'B', '1' };
+        const uint32_t byteOrderMark = 0x01020304;
+        
+        namespace
+        {
+            void
+            writeWord( std::ostream& rOs,
+                       uint32_t word )
+            {
+                rOs.write( reinterpret_cast<const char*>( &word ),
+                           sizeof( word ) );
+            }
+        }
+        
+        void
+        writeHeader( std::ostream& rOs,
+                     const std::vector<std::string>& rColumnNames )
+        {
+            rOs.write( magic,
+                       sizeof( magic ) );
+            writeWord( rOs,
+                       byteOrderMark );
+            writeWord( rOs,
+                       rColumnNames.size() );
+            
+            for ( std::vector<std::string>::const_iterator iName = rColumnNames.begin();
+                  iName != rColumnNames.end();
+                  ++iName )
+            {
+                writeWord( rOs,
+                           iName->size() );
+                rOs.write( iName->data(),
+                           iName->size() );
+            }
+        }
+        
+        void
+        writeChunk( std::ostream& rOs,
+                    int columnCount,
+                    const std::vector<double>& rColumnMajorValues )
+        {
+            if ( columnCount == 0 || rColumnMajorValues.empty() ) return;
+            
+            writeWord( rOs,
+                       rColumnMajorValues.size() / columnCount );
+            rOs.write( reinterpret_cast<const char*>( &rColumnMajorValues[0] ),
+                       rColumnMajorValues.size() * sizeof( double ) );
+        }
+    }
+    
+    binaryDumpReader::
+    binaryDumpReader( const std::string& rFileName )
+        throw( utl::xcpt ) :
+        fileName( rFileName ),
+        is( rFileName.c_str(),
+            std::ios_base::in | std::ios_base::binary )
+    {
+        if ( ! is )
+            throw badBinaryDumpFileXcpt( fileName,
+                                         "could not open for reading" );
+        
+        char fileMagic[sizeof( binaryDump::magic )];
+        mustRead( fileMagic,
+                  sizeof( fileMagic ) );
+        if ( 0 != std::memcmp( fileMagic,
+                               binaryDump::magic,
+                               sizeof( fileMagic ) ) )
+            throw badBinaryDumpFileXcpt( fileName,
+                                         "not a binary dump file" );
+        
+        uint32_t mark;
+        mustRead( &mark,
+                  sizeof( mark ) );
+        if ( mark != binaryDump::byteOrderMark )
+            throw badBinaryDumpFileXcpt( fileName,
+                                         "written with a different byte order" );
+        
+        uint32_t columnCount;
+        mustRead( &columnCount,
+                  sizeof( columnCount ) );
+        
+        for ( uint32_t columnNdx = 0;
+              columnNdx < columnCount;
+              ++columnNdx )
+        {
+            uint32_t nameLength;
+            mustRead( &nameLength,
+                      sizeof( nameLength ) );
+            
+            std::string name( nameLength, ' ' );
+            if ( nameLength ) mustRead( &name[0],
+                                        nameLength );
+            columnNames.push_back( name );
+        }
+    }
+    
+    void
+    binaryDumpReader::
+    mustRead( void* pData,
+              size_t byteCount )
+        throw( utl::xcpt )
+    {
+        is.read( static_cast<char*>( pData ),
+                 byteCount );
+        if ( static_cast<size_t>( is.gcount() ) != byteCount )
+            throw badBinaryDumpFileXcpt( fileName,
+                                         "truncated" );
+    }
+    
+    int
+    binaryDumpReader::
+    findColumn( const std::string& rColumnName ) const
+    {
+        for ( unsigned int columnNdx = 0;
+              columnNdx != columnNames.size();
+              ++columnNdx )
+        {
+            if ( columnNames[columnNdx] == rColumnName ) return columnNdx;
+        }
+        return -1;
+    }
+    
+    bool
+    binaryDumpReader::
+    readChunk( std::vector<std::vector<double> >& rColumns )
+        throw( utl::xcpt )
+    {
+        uint32_t rowCount;
+        is.read( reinterpret_cast<char*>( &rowCount ),
+                 sizeof( rowCount ) );
+        
+        // A clean end of file falls between chunks.
+        if ( is.gcount() == 0 && is.eof() ) return false;
+        if ( is.gcount() != sizeof( rowCount ) )
+            throw badBinaryDumpFileXcpt( fileName,
+                                         "truncated" );
+        
+        rColumns.resize( columnNames.size() );
+        for ( unsigned int columnNdx = 0;
+              columnNdx != columnNames.size();
+              ++columnNdx )
+        {
+            std::vector<double>& rColumn = rColumns[columnNdx];
+            size_t oldSize = rColumn.size();
+            rColumn.resize( oldSize + rowCount );
+            
+            if ( rowCount ) mustRead( &rColumn[oldSize],
+                                      rowCount * sizeof( double ) );
+        }
+        return true;
+    }
+    
+    void
+    binaryDumpReader::
+    readAll( std::vector<std::vector<double> >& rColumns )
+        throw( utl::xcpt )
+    {
+        rColumns.resize( columnNames.size() );
+        while ( readChunk( rColumns ) )
+            ;
+    }
+}
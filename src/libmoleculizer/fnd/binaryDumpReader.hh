@@ -0,0 +1,111 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_BINARYDUMPREADER_H
+#define FND_BINARYDUMPREADER_H
+
+/*! \file binaryDumpReader.hh
+  \brief Binary dump file layout, and a reader for it.
+  
+  A binary dump file holds the same columns as a text .dmp file, as
+  float64 values.  Everything is in the byte order of the machine that
+  wrote it:
+  
+    8 bytes   magic "MZRDMPB1"
+    uint32    byte-order mark 0x01020304
+    uint32    column count
+    for each column: uint32 name length, then the name's bytes
+  
+  followed by any number of chunks, each of which is
+  
+    uint32    row count
+    for each column: row count float64 values
+  
+  so a column's values in a chunk are contiguous.  Continuing a
+  simulation appends more chunks to the same file. */
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "utl/xcpt.hh"
+
+namespace fnd
+{
+    namespace binaryDump
+    {
+        extern const char magic[8];
+        extern const uint32_t byteOrderMark;
+        
+        void
+        writeHeader( std::ostream& rOs,
+                     const std::vector<std::string>& rColumnNames );
+        
+        void
+        writeChunk( std::ostream& rOs,
+                    int columnCount,
+                    const std::vector<double>& rColumnMajorValues );
+    }
+    
+    class binaryDumpReader
+    {
+        std::string fileName;
+        std::ifstream is;
+        std::vector<std::string> columnNames;
+        
+        void
+        mustRead( void* pData,
+                  size_t byteCount )
+            throw( utl::xcpt );
+        
+    public:
+        binaryDumpReader( const std::string& rFileName )
+            throw( utl::xcpt );
+        
+        const std::vector<std::string>&
+        getColumnNames( void ) const
+        {
+            return columnNames;
+        }
+        
+        // Returns -1 if there is no such column.
+        int
+        findColumn( const std::string& rColumnName ) const;
+        
+        // Appends the rows of the next chunk to rColumns, which gets
+        // one vector per column.  Returns false at the end of the file.
+        bool
+        readChunk( std::vector<std::vector<double> >& rColumns )
+            throw( utl::xcpt );
+        
+        // Appends all the remaining rows to rColumns.
+        void
+        readAll( std::vector<std::vector<double> >& rColumns )
+            throw( utl::xcpt );
+    };
+}
+
+#endif // FND_BINARYDUMPREADER_H
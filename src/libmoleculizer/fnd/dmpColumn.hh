@@ -62,6 +62,24 @@ namespace fnd
         {
             pDumpable->doDump( dumpArg );
         }
+        
+        const std::string&
+        getName( void ) const
+        {
+            return pDumpable->getName();
+        }
+        
+        bool
+        hasValue( void ) const
+        {
+            return pDumpable->hasDumpValue();
+        }
+        
+        double
+        getValue( void ) const
+        {
+            return pDumpable->getDumpValue( dumpArg );
+        }
     };
 }
 
@@ -31,19 +31,42 @@
 
 #include "utl/defs.hh"
 #include "fnd/fndXcpt.hh"
+#include "fnd/binaryDumpReader.hh"
 #include "fnd/dumpStream.hh"
 
 namespace fnd
 {
+    const std::string dumpStream::binaryFileSuffix( ".bin" );
+    
     dumpStream::
-    dumpStream( const std::string& rFileName )
+    dumpStream( const std::string& rFileName,
+                outputFormat outputFmt,
+                int rowsPerChunk )
         throw( utl::xcpt ) :
-        fileName( rFileName )
+        fileName( rFileName ),
+        pFileStream( 0 ),
+        format( outputFmt ),
+        pBinaryStream( 0 ),
+        binaryFileHasHeader( false ),
+        chunkRows( rowsPerChunk > 0 ? rowsPerChunk : 1 )
     {
+        // Binary output can only go to a genuine file.  This is checked
+        // before anything is opened, so nothing is left to clean up.
+        if ( format != textFormat
+             && ( fileName == "-" || fileName == "+" ) )
+            throw badDumpFileXcpt( fileName );
+        
         // Establish what the output stream is, opening the output file
         // if called for.  Note that this file doesn't get closed until
         // the destruction of the dumpStream.
-        if ( fileName == "-" ) pOs = &std::cout;
+        if ( ! writesText() )
+        {
+            // Dumpables still get a dumpArg made from getOstream, so
+            // give them an unopened stream that swallows any text.
+            pFileStream = new std::ofstream();
+            pOs = pFileStream;
+        }
+        else if ( fileName == "-" ) pOs = &std::cout;
         else if ( fileName == "+" ) pOs = &std::cerr;
         else
         {
@@ -53,10 +76,80 @@ namespace fnd
             pFileStream = new std::ofstream( fileName.c_str(),
                                              std::ios_base::app );
             if ( !( *pFileStream ) )
+            {
+                delete pFileStream;
                 throw badDumpFileXcpt( fileName );
+            }
             
             pOs = pFileStream;
         }
+        
+        if ( format != textFormat )
+        {
+            binaryFileName = fileName;
+            if ( format == textAndBinaryFormat ) binaryFileName += binaryFileSuffix;
+            
+            // The destructor won't run if construction fails.
+            try
+            {
+                openBinaryFile();
+            }
+            catch ( ... )
+            {
+                delete pBinaryStream;
+                delete pFileStream;
+                throw;
+            }
+        }
+    }
+    
+    dumpStream::
+    ~dumpStream( void )
+    {
+        flush();
+        
+        // These are null if the output stream not actually a file.
+        delete pBinaryStream;
+        delete pFileStream;
+    }
+    
+    void
+    dumpStream::
+    openBinaryFile( void )
+        throw( utl::xcpt )
+    {
+        // Like the text file, the binary file is appended to, so a
+        // continued simulation adds chunks after the ones already there.
+        std::ifstream existing( binaryFileName.c_str(),
+                                std::ios_base::in | std::ios_base::binary );
+        if ( existing && existing.peek() != std::ifstream::traits_type::eof() )
+        {
+            existing.close();
+            binaryDumpReader reader( binaryFileName );
+            existingBinaryColumns = reader.getColumnNames();
+            binaryFileHasHeader = true;
+        }
+        
+        pBinaryStream = new std::ofstream( binaryFileName.c_str(),
+                                           std::ios_base::app | std::ios_base::binary );
+        if ( !( *pBinaryStream ) )
+            throw badDumpFileXcpt( binaryFileName );
+    }
+    
+    void
+    dumpStream::
+    addColumn( basicDmpColumn* pColumn )
+        throw( utl::xcpt )
+    {
+        if ( pBinaryStream && ! pColumn->hasValue() )
+        {
+            std::string columnName( pColumn->getName() );
+            delete pColumn;
+            throw nonNumericDumpColumnXcpt( binaryFileName,
+                                            columnName );
+        }
+        
+        push_back( pColumn );
     }
     
     void
@@ -64,6 +157,39 @@ namespace fnd
     init( void )
         throw( utl::xcpt )
     {
+        if ( pBinaryStream )
+        {
+            std::vector<std::string> columnNames;
+            for ( iterator iEntry = begin();
+                  iEntry != end();
+                  ++iEntry )
+            {
+                basicDmpColumn* pColumn = *iEntry;
+                
+                if ( ! pColumn->hasValue() )
+                    throw nonNumericDumpColumnXcpt( binaryFileName,
+                                                    pColumn->getName() );
+                
+                columnNames.push_back( pColumn->getName() );
+            }
+            
+            if ( ! binaryFileHasHeader )
+            {
+                binaryDump::writeHeader( *pBinaryStream,
+                                         columnNames );
+                binaryFileHasHeader = true;
+            }
+            else if ( columnNames != existingBinaryColumns )
+            {
+                throw badBinaryDumpFileXcpt( binaryFileName,
+                                             "existing columns differ from this stream's" );
+            }
+            
+            bufferedRows.reserve( chunkRows * columnNames.size() );
+        }
+        
+        if ( ! writesText() ) return;
+        
         std::ostream& rOs = getOstream();
         
         // The header line is a "comment line" for gnuplot.
@@ -90,6 +216,20 @@ namespace fnd
     dumpStream::
     doDump( void )
     {
+        if ( pBinaryStream )
+        {
+            for ( iterator iEntry = begin();
+                  iEntry != end();
+                  ++iEntry )
+            {
+                bufferedRows.push_back( ( *iEntry )->getValue() );
+            }
+            
+            if ( bufferedRows.size() >= static_cast<size_t>( chunkRows ) * size() ) flush();
+        }
+        
+        if ( ! writesText() ) return;
+        
         std::ostream& rOs = getOstream();
         
         iterator iEntry = begin();
@@ -107,4 +247,30 @@ namespace fnd
         }
         rOs << std::endl;
     }
+    
+    void
+    dumpStream::
+    flush( void )
+    {
+        if ( ( ! pBinaryStream ) || bufferedRows.empty() ) return;
+        
+        int columnCount = size();
+        int rowCount = bufferedRows.size() / columnCount;
+        
+        columnMajorValues.resize( bufferedRows.size() );
+        for ( int rowNdx = 0; rowNdx < rowCount; ++rowNdx )
+        {
+            for ( int columnNdx = 0; columnNdx < columnCount; ++columnNdx )
+            {
+                columnMajorValues[columnNdx * rowCount + rowNdx]
+                    = bufferedRows[rowNdx * columnCount + columnNdx];
+            }
+        }
+        
+        binaryDump::writeChunk( *pBinaryStream,
+                                columnCount,
+                                columnMajorValues );
+        pBinaryStream->flush();
+        bufferedRows.clear();
+    }
 }
@@ -44,6 +44,26 @@ namespace fnd
     class dumpStream :
         public utl::autoVector<basicDmpColumn>
     {
+    public:
+        // Text is the tab-separated .dmp format.  Binary is the columnar
+        // float64 format described in binaryDumpReader.hh; it's much
+        // cheaper to write, but needs every column to be numeric.  With
+        // both, the binary file is the text file's name plus
+        // binaryFileSuffix.
+        enum outputFormat
+        {
+            textFormat,
+            binaryFormat,
+            textAndBinaryFormat
+        };
+        
+        static const std::string binaryFileSuffix;
+        
+        // Rows are buffered and written to the binary file this many at a
+        // time.
+        static const int defaultChunkRows = 1024;
+        
+    private:
         // Now that the output stream and everything else is passed to
         // the dumpables through a dumpArg, these are here mainly to
         // memory-manage the stream, to emphasize that this class is what
@@ -54,16 +74,42 @@ namespace fnd
         std::ostream* pOs;
         std::ofstream* pFileStream;
         
+        outputFormat format;
+        
+        // Empty and null unless binary output was asked for.
+        std::string binaryFileName;
+        std::ofstream* pBinaryStream;
+        
+        // Columns already in the binary file from an earlier run,
+        // which the appended chunks have to match.
+        std::vector<std::string> existingBinaryColumns;
+        bool binaryFileHasHeader;
+        
+        // Buffered rows, one after another, and the same values
+        // regrouped by column for writing.
+        std::vector<double> bufferedRows;
+        std::vector<double> columnMajorValues;
+        int chunkRows;
+        
+        bool
+        writesText( void ) const
+        {
+            return format != binaryFormat;
+        }
+        
+        void
+        openBinaryFile( void )
+            throw( utl::xcpt );
+        
     public:
         // Use a genuine file path, "-" for std::cout, "+" for std::cerr.
-        dumpStream( const std::string& rFileName )
+        // Binary output can only go to a genuine file.
+        dumpStream( const std::string& rFileName,
+                    outputFormat outputFmt = textFormat,
+                    int rowsPerChunk = defaultChunkRows )
             throw( utl::xcpt );
         
-        ~dumpStream( void )
-        {
-            // This is null if the output stream not actually a file.
-            delete pFileStream;
-        }
+        ~dumpStream( void );
         
         std::ostream&
         getOstream( void ) const
@@ -79,6 +125,21 @@ namespace fnd
             return fileName;
         }
         
+        // Empty if there's no binary output.
+        const std::string&
+        getBinaryFileName( void ) const
+        {
+            return binaryFileName;
+        }
+        
+        // Takes ownership of the column.  A stream with binary output
+        // deletes the column and throws nonNumericDumpColumnXcpt if the
+        // column's dumpable has no numeric value to record; init checks
+        // again, for columns added with push_back.
+        void
+        addColumn( basicDmpColumn* pColumn )
+            throw( utl::xcpt );
+        
         // Initializes output stream and writes column headers.
         void
         init( void )
@@ -87,6 +148,10 @@ namespace fnd
         // Writes a line in the output file.
         void
         doDump( void );
+        
+        // Writes any buffered binary rows out as a chunk.
+        void
+        flush( void );
     };
 }
 
@@ -57,6 +57,21 @@ namespace fnd
         {
             rDumpArg.getOstream() << getName();
         }
+        
+        // Binary dump streams record one number per column per dump,
+        // which dumpables that can supply it report here.  Those that
+        // write anything else can only go into text dump streams.
+        virtual bool
+        hasDumpValue( void ) const
+        {
+            return false;
+        }
+        
+        virtual double
+        getDumpValue( const dumpArgT& rDumpArg ) const
+        {
+            return 0.0;
+        }
     };
 }
 
@@ -0,0 +1,274 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_EVENTQUEUE_H
+#define FND_EVENTQUEUE_H
+
+/*! \file eventQueue.hh
+  \ingroup eventGroup
+  \brief Time-ordered queue of scheduled events. */
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "fnd/event.hh"
+#include "fnd/fndXcpt.hh"
+
+namespace fnd
+{
+    /*! \ingroup eventGroup
+      \brief Time-ordered queue of events for a simulator to advance against.
+      
+      The queue is a binary heap on (time, order of scheduling), so
+      scheduling and firing the next event are O(log n), the time of the
+      next event is O(1), and events due at the same time fire in the
+      order in which they were scheduled.
+      
+      An event can fire once or periodically.  A periodic event fires at
+      firstTime + n * period, so the times don't drift as periods are
+      added up.  The queue owns its events: a one-shot event is deleted
+      after it fires, and periodic events are deleted with the queue.
+      Events may schedule more events while they happen. */
+    template<class applicationType>
+    class eventQueue
+    {
+    public:
+        typedef event<applicationType> eventType;
+        
+    private:
+        class entry
+        {
+        public:
+            double time;
+            unsigned long order;
+            eventType* pEvent;
+            
+            // Zero for a one-shot event.
+            double period;
+            double firstTime;
+            unsigned long firings;
+            
+            // std::push_heap and friends make a max-heap, so the earliest
+            // entry has to compare greatest.
+            bool
+            operator<( const entry& rRight ) const
+            {
+                if ( time != rRight.time ) return rRight.time < time;
+                return rRight.order < order;
+            }
+        };
+        
+        std::vector<entry> heap;
+        unsigned long scheduledCount;
+        double now;
+        
+        void
+        push( const entry& rEntry )
+        {
+            heap.push_back( rEntry );
+            std::push_heap( heap.begin(),
+                            heap.end() );
+        }
+        
+        // Deletes a one-shot event that has fired, or puts a periodic one
+        // back in the queue for its next time.
+        void
+        retire( entry& rFired )
+        {
+            if ( 0.0 == rFired.period )
+            {
+                delete rFired.pEvent;
+            }
+            else
+            {
+                ++rFired.firings;
+                rFired.time = rFired.firstTime + rFired.firings * rFired.period;
+                push( rFired );
+            }
+        }
+        
+        // The queue takes ownership of events even when they can't be
+        // scheduled.
+        void
+        checkTime( double time,
+                   eventType* pEvent ) const
+            throw( utl::xcpt )
+        {
+            if ( time < now )
+            {
+                delete pEvent;
+                throw eventInPastXcpt( now,
+                                       time );
+            }
+        }
+        
+        eventQueue( const eventQueue& rOriginal );
+        eventQueue&
+        operator=( const eventQueue& rRight );
+        
+    public:
+        eventQueue( void ) :
+            scheduledCount( 0 ),
+            now( -std::numeric_limits<double>::infinity() )
+        {}
+        
+        ~eventQueue( void )
+        {
+            clear();
+        }
+        
+        // Schedules the event to happen once, at the given time.
+        void
+        schedule( double time,
+                  eventType* pEvent )
+            throw( utl::xcpt )
+        {
+            checkTime( time,
+                       pEvent );
+            
+            entry newEntry;
+            newEntry.time = time;
+            newEntry.order = scheduledCount++;
+            newEntry.pEvent = pEvent;
+            newEntry.period = 0.0;
+            newEntry.firstTime = time;
+            newEntry.firings = 0;
+            push( newEntry );
+        }
+        
+        // Schedules the event to happen at firstTime and every period after.
+        void
+        schedulePeriodic( double firstTime,
+                          double period,
+                          eventType* pEvent )
+            throw( utl::xcpt )
+        {
+            checkTime( firstTime,
+                       pEvent );
+            if ( ! ( 0.0 < period ) )
+            {
+                delete pEvent;
+                throw badEventPeriodXcpt( period );
+            }
+            
+            entry newEntry;
+            newEntry.time = firstTime;
+            newEntry.order = scheduledCount++;
+            newEntry.pEvent = pEvent;
+            newEntry.period = period;
+            newEntry.firstTime = firstTime;
+            newEntry.firings = 0;
+            push( newEntry );
+        }
+        
+        bool
+        empty( void ) const
+        {
+            return heap.empty();
+        }
+        
+        int
+        size( void ) const
+        {
+            return heap.size();
+        }
+        
+        // Infinity if there are no events.
+        double
+        getNextTime( void ) const
+        {
+            return heap.empty()
+                ? std::numeric_limits<double>::infinity()
+                : heap.front().time;
+        }
+        
+        // The time of the event most recently fired.
+        double
+        getNow( void ) const
+        {
+            return now;
+        }
+        
+        // Fires the next event.  There must be one.  If the event throws,
+        // it is still deleted or rescheduled, as if it had happened.
+        eventResult
+        fireNext( applicationType& rApp )
+            throw( std::exception )
+        {
+            std::pop_heap( heap.begin(),
+                           heap.end() );
+            entry firing = heap.back();
+            heap.pop_back();
+            
+            now = firing.time;
+            
+            eventResult result;
+            try
+            {
+                result = firing.pEvent->happen( rApp );
+            }
+            catch ( ... )
+            {
+                retire( firing );
+                throw;
+            }
+            
+            retire( firing );
+            return result;
+        }
+        
+        // Fires, in order, the events due at or before the given time.
+        // Stops early, leaving later events queued, if an event returns
+        // stop.
+        eventResult
+        fireThrough( double time,
+                     applicationType& rApp )
+            throw( std::exception )
+        {
+            while ( ( ! heap.empty() )
+                    && heap.front().time <= time )
+            {
+                if ( stop == fireNext( rApp ) ) return stop;
+            }
+            return go;
+        }
+        
+        // Deletes all the events.
+        void
+        clear( void )
+        {
+            for ( typename std::vector<entry>::iterator iEntry = heap.begin();
+                  iEntry != heap.end();
+                  ++iEntry )
+            {
+                delete iEntry->pEvent;
+            }
+            heap.clear();
+        }
+    };
+}
+
+#endif // FND_EVENTQUEUE_H
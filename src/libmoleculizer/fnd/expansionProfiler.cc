@@ -0,0 +1,499 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <fstream>
+#include <time.h>
+#include "fnd/fndXcpt.hh"
+#include "fnd/expansionProfiler.hh"
+
+namespace fnd
+{
+    namespace
+    {
+        const char* phaseNames[expansionProfiler::PHASE_COUNT] =
+            {
+                "recognition",
+                "isomorphism-search",
+                "canonical-naming",
+                "omniplex-connection",
+                "rate-extrapolation",
+                "catalog-insertion"
+            };
+        
+        // Semicolons separate frames in folded stacks.
+        std::string
+        stackLabel( const std::string& rText )
+        {
+            std::string label( rText );
+            for ( std::string::iterator iChar = label.begin();
+                  iChar != label.end();
+                  ++iChar )
+            {
+                if ( *iChar == ';' ) *iChar = ',';
+            }
+            return label;
+        }
+        
+        std::string
+        jsonString( const std::string& rText )
+        {
+            std::string quoted( "\"" );
+            for ( std::string::const_iterator iChar = rText.begin();
+                  iChar != rText.end();
+                  ++iChar )
+            {
+                if ( *iChar == '"' || *iChar == '\\' ) quoted += '\\';
+                
+                if ( static_cast<unsigned char>( *iChar ) < 0x20 ) quoted += ' ';
+                else quoted += *iChar;
+            }
+            quoted += '"';
+            return quoted;
+        }
+    }
+    
+    expansionProfiler::stackNode::
+    ~stackNode( void )
+    {
+        for ( std::map<const void*, stackNode*>::iterator iChild = children.begin();
+              iChild != children.end();
+              ++iChild )
+        {
+            delete iChild->second;
+        }
+    }
+    
+    expansionProfiler::stackNode*
+    expansionProfiler::stackNode::
+    findChild( const void* pKey,
+               const std::string& rLabel )
+    {
+        stackNode*& rpChild = children[pKey];
+        if ( ! rpChild )
+        {
+            rpChild = new stackNode();
+            rpChild->label = stackLabel( rLabel );
+        }
+        return rpChild;
+    }
+    
+    void
+    expansionProfiler::stackNode::
+    clearTimes( void )
+    {
+        left = false;
+        selfNanoseconds = 0;
+        
+        for ( std::map<const void*, stackNode*>::iterator iChild = children.begin();
+              iChild != children.end();
+              ++iChild )
+        {
+            iChild->second->clearTimes();
+        }
+    }
+    
+    void
+    expansionProfiler::stackNode::
+    fold( const std::string& rStack,
+          std::map<std::string, unsigned long long>& rFolded ) const
+    {
+        if ( left ) rFolded[rStack] += selfNanoseconds;
+        
+        for ( std::map<const void*, stackNode*>::const_iterator iChild = children.begin();
+              iChild != children.end();
+              ++iChild )
+        {
+            iChild->second->fold( rStack + ';' + iChild->second->label,
+                                  rFolded );
+        }
+    }
+    
+    std::string
+    expansionProfiler::rxnGenStats::
+    getLabel( void ) const
+    {
+        if ( rule.empty() ) return kind;
+        return kind + " " + rule;
+    }
+    
+    expansionProfiler::
+    expansionProfiler( void ) :
+        enabled( false )
+    {}
+    
+    expansionProfiler::
+    ~expansionProfiler( void )
+    {
+        for ( std::vector<rxnGenStats*>::iterator iStats = rxnGensInOrder.begin();
+              iStats != rxnGensInOrder.end();
+              ++iStats )
+        {
+            delete *iStats;
+        }
+    }
+    
+    void
+    expansionProfiler::
+    setEnabled( bool enable )
+    {
+        // Scopes that were opened while enabled still close themselves, so
+        // the open frames are left alone.
+        enabled = enable;
+    }
+    
+    void
+    expansionProfiler::
+    reset( void )
+    {
+        for ( int phaseNdx = 0;
+              phaseNdx < PHASE_COUNT;
+              ++phaseNdx )
+        {
+            phases[phaseNdx] = phaseStats();
+        }
+        
+        for ( std::vector<rxnGenStats*>::iterator iStats = rxnGensInOrder.begin();
+              iStats != rxnGensInOrder.end();
+              ++iStats )
+        {
+            rxnGenStats& rStats = **iStats;
+            std::string kind = rStats.kind;
+            std::string rule = rStats.rule;
+            
+            rStats = rxnGenStats();
+            rStats.kind = kind;
+            rStats.rule = rule;
+        }
+        
+        stackRoot.clearTimes();
+    }
+    
+    void
+    expansionProfiler::
+    nameRxnGen( const void* pRxnGen,
+                const std::string& rKind,
+                const std::string& rRule )
+    {
+        rxnGenStats* pStats = lookupRxnGen( pRxnGen,
+                                            rKind.c_str() );
+        pStats->kind = rKind;
+        pStats->rule = rRule;
+    }
+    
+    std::string
+    expansionProfiler::
+    getRxnGenLabel( const void* pRxnGen ) const
+    {
+        std::map<const void*, rxnGenStats*>::const_iterator iEntry
+            = rxnGensByAddress.find( pRxnGen );
+        
+        if ( iEntry == rxnGensByAddress.end()
+             || iEntry->second->rule.empty() ) return std::string();
+        
+        return iEntry->second->getLabel();
+    }
+    
+    const char*
+    expansionProfiler::
+    getPhaseName( phase thePhase )
+    {
+        return phaseNames[thePhase];
+    }
+    
+    const expansionProfiler::phaseStats&
+    expansionProfiler::
+    getPhaseStats( phase thePhase ) const
+    {
+        return phases[thePhase];
+    }
+    
+    std::vector<expansionProfiler::rxnGenStats>
+    expansionProfiler::
+    getRxnGenStats( void ) const
+    {
+        std::vector<rxnGenStats> result;
+        result.reserve( rxnGensInOrder.size() );
+        
+        for ( std::vector<rxnGenStats*>::const_iterator iStats = rxnGensInOrder.begin();
+              iStats != rxnGensInOrder.end();
+              ++iStats )
+        {
+            result.push_back( **iStats );
+        }
+        return result;
+    }
+    
+    void
+    expansionProfiler::
+    writeJson( std::ostream& rOs ) const
+    {
+        rOs << "{\n  \"phases\": [";
+        for ( int phaseNdx = 0;
+              phaseNdx < PHASE_COUNT;
+              ++phaseNdx )
+        {
+            const phaseStats& rStats = phases[phaseNdx];
+            
+            rOs << ( phaseNdx ? "," : "" )
+                << "\n    {\"name\": " << jsonString( phaseNames[phaseNdx] )
+                << ", \"calls\": " << rStats.calls
+                << ", \"cache-hits\": " << rStats.cacheHits
+                << ", \"nanoseconds\": " << rStats.nanoseconds
+                << ", \"self-nanoseconds\": " << rStats.selfNanoseconds
+                << "}";
+        }
+        rOs << "\n  ],\n  \"rxn-gens\": [";
+        
+        for ( std::vector<rxnGenStats*>::size_type genNdx = 0;
+              genNdx < rxnGensInOrder.size();
+              ++genNdx )
+        {
+            const rxnGenStats& rStats = *rxnGensInOrder[genNdx];
+            
+            rOs << ( genNdx ? "," : "" )
+                << "\n    {\"kind\": " << jsonString( rStats.kind )
+                << ", \"rule\": " << jsonString( rStats.rule )
+                << ", \"invocations\": " << rStats.invocations
+                << ", \"reactions\": " << rStats.reactionsMade
+                << ", \"species\": " << rStats.speciesMade
+                << ", \"recognitions\": " << rStats.recognitions
+                << ", \"cache-hits\": " << rStats.cacheHits
+                << ", \"nanoseconds\": " << rStats.nanoseconds
+                << ", \"self-nanoseconds\": " << rStats.selfNanoseconds
+                << "}";
+        }
+        rOs << "\n  ]\n}\n";
+    }
+    
+    void
+    expansionProfiler::
+    writeFoldedStacks( std::ostream& rOs ) const
+    {
+        // Different nodes can have the same text, when two generators
+        // have the same name.
+        std::map<std::string, unsigned long long> foldedStacks;
+        
+        for ( std::map<const void*, stackNode*>::const_iterator iChild = stackRoot.children.begin();
+              iChild != stackRoot.children.end();
+              ++iChild )
+        {
+            iChild->second->fold( iChild->second->label,
+                                  foldedStacks );
+        }
+        
+        for ( std::map<std::string, unsigned long long>::const_iterator iStack = foldedStacks.begin();
+              iStack != foldedStacks.end();
+              ++iStack )
+        {
+            rOs << iStack->first
+                << ' '
+                << iStack->second
+                << '\n';
+        }
+    }
+    
+    void
+    expansionProfiler::
+    writeProfile( const std::string& rFileName,
+                  outputFormat format ) const
+        throw( utl::xcpt )
+    {
+        std::ofstream os( rFileName.c_str() );
+        if ( !os ) throw badDumpFileXcpt( rFileName );
+        
+        if ( format == FOLDED_STACKS ) writeFoldedStacks( os );
+        else writeJson( os );
+    }
+    
+    void
+    expansionProfiler::
+    enterPhase( phase thePhase )
+    {
+        frame newFrame;
+        newFrame.pRxnGen = 0;
+        newFrame.thePhase = thePhase;
+        newFrame.pStack = currentStack()->findChild( &phases[thePhase],
+                                                     phaseNames[thePhase] );
+        newFrame.childTime = 0;
+        
+        ++phases[thePhase].calls;
+        
+        // Recognitions are charged to the generator that asked for them.
+        if ( thePhase == RECOGNITION )
+        {
+            rxnGenStats* pCurrent = innermostRxnGen();
+            if ( pCurrent ) ++pCurrent->recognitions;
+        }
+        
+        openFrames.push_back( newFrame );
+        openFrames.back().startTime = now();
+    }
+    
+    void
+    expansionProfiler::
+    enterRxnGen( const void* pRxnGen,
+                 const char* kind )
+    {
+        frame newFrame;
+        newFrame.pRxnGen = lookupRxnGen( pRxnGen,
+                                         kind );
+        newFrame.thePhase = PHASE_COUNT;
+        newFrame.pStack = currentStack()->findChild( newFrame.pRxnGen,
+                                                     newFrame.pRxnGen->getLabel() );
+        newFrame.childTime = 0;
+        
+        ++newFrame.pRxnGen->invocations;
+        
+        openFrames.push_back( newFrame );
+        openFrames.back().startTime = now();
+    }
+    
+    void
+    expansionProfiler::
+    leave( void )
+    {
+        unsigned long long endTime = now();
+        
+        if ( openFrames.empty() ) return;
+        
+        const frame& rFrame = openFrames.back();
+        unsigned long long elapsed = endTime - rFrame.startTime;
+        unsigned long long self = ( rFrame.childTime < elapsed )
+            ? elapsed - rFrame.childTime
+            : 0;
+        
+        rFrame.pStack->selfNanoseconds += self;
+        rFrame.pStack->left = true;
+        
+        // Generation at depth can re-enter a generator or phase that is
+        // already open; only the outermost scope adds to the total, so
+        // that time isn't counted twice.
+        bool outermost = true;
+        for ( std::vector<frame>::size_type frameNdx = 0;
+              frameNdx + 1 < openFrames.size();
+              ++frameNdx )
+        {
+            const frame& rOuter = openFrames[frameNdx];
+            if ( rOuter.pRxnGen == rFrame.pRxnGen
+                 && rOuter.thePhase == rFrame.thePhase )
+            {
+                outermost = false;
+                break;
+            }
+        }
+        
+        if ( rFrame.pRxnGen )
+        {
+            if ( outermost ) rFrame.pRxnGen->nanoseconds += elapsed;
+            rFrame.pRxnGen->selfNanoseconds += self;
+        }
+        else if ( rFrame.thePhase != PHASE_COUNT )
+        {
+            if ( outermost ) phases[rFrame.thePhase].nanoseconds += elapsed;
+            phases[rFrame.thePhase].selfNanoseconds += self;
+        }
+        
+        openFrames.pop_back();
+        if ( !openFrames.empty() ) openFrames.back().childTime += elapsed;
+    }
+    
+    void
+    expansionProfiler::
+    noteCacheHit( phase thePhase )
+    {
+        ++phases[thePhase].cacheHits;
+        
+        rxnGenStats* pCurrent = innermostRxnGen();
+        if ( pCurrent ) ++pCurrent->cacheHits;
+    }
+    
+    void
+    expansionProfiler::
+    noteReactionMade( void )
+    {
+        rxnGenStats* pCurrent = innermostRxnGen();
+        if ( pCurrent ) ++pCurrent->reactionsMade;
+    }
+    
+    void
+    expansionProfiler::
+    noteSpeciesMade( void )
+    {
+        rxnGenStats* pCurrent = innermostRxnGen();
+        if ( pCurrent ) ++pCurrent->speciesMade;
+    }
+    
+    unsigned long long
+    expansionProfiler::
+    now( void )
+    {
+        timespec theTime;
+        clock_gettime( CLOCK_MONOTONIC,
+                       &theTime );
+        
+        return static_cast<unsigned long long>( theTime.tv_sec ) * 1000000000ULL
+            + theTime.tv_nsec;
+    }
+    
+    expansionProfiler::rxnGenStats*
+    expansionProfiler::
+    lookupRxnGen( const void* pRxnGen,
+                  const char* kind )
+    {
+        std::map<const void*, rxnGenStats*>::iterator iEntry
+            = rxnGensByAddress.find( pRxnGen );
+        if ( iEntry != rxnGensByAddress.end() ) return iEntry->second;
+        
+        rxnGenStats* pStats = new rxnGenStats();
+        pStats->kind = kind;
+        
+        rxnGensByAddress.insert( std::make_pair( pRxnGen,
+                                                 pStats ) );
+        rxnGensInOrder.push_back( pStats );
+        return pStats;
+    }
+    
+    expansionProfiler::rxnGenStats*
+    expansionProfiler::
+    innermostRxnGen( void )
+    {
+        for ( std::vector<frame>::reverse_iterator iFrame = openFrames.rbegin();
+              iFrame != openFrames.rend();
+              ++iFrame )
+        {
+            if ( iFrame->pRxnGen ) return iFrame->pRxnGen;
+        }
+        return 0;
+    }
+    
+    expansionProfiler::stackNode*
+    expansionProfiler::
+    currentStack( void )
+    {
+        if ( openFrames.empty() ) return &stackRoot;
+        return openFrames.back().pStack;
+    }
+}
@@ -0,0 +1,320 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_EXPANSIONPROFILER_H
+#define FND_EXPANSIONPROFILER_H
+
+/*! \file expansionProfiler.hh
+  \ingroup rxnGenGroup
+  \brief Defines counters and timers for reaction network expansion. */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "utl/xcpt.hh"
+
+namespace fnd
+{
+    /*! \ingroup rxnGenGroup
+      \brief Counters and timers for reaction network expansion.
+      
+      Time is accounted to the phases of expansion (recognition of new
+      complexes, the isomorphism search within recognition, canonical
+      naming, connection of new structural families to their features and
+      omniplexes, rate extrapolation and insertion into the network
+      catalog) and to the reaction generators on whose behalf the work was
+      done.  Since generation at depth recurses through new species into
+      other generators, each timed scope also keeps its self time, and the
+      nesting is kept as stacks for flamegraph output.
+      
+      Each reaction network description has one, which its reaction
+      generators, recognizer and structural families reach through the
+      moleculizer, so that two moleculizers are profiled apart, and the
+      generators that it reports on are those of its own model.  It is off
+      until enabled, and when off each instrumented scope costs one test of
+      a flag.  It is not thread-safe, and neither is expansion. */
+    class expansionProfiler
+    {
+    public:
+        enum phase
+        {
+            RECOGNITION = 0,
+            ISOMORPHISM_SEARCH,
+            CANONICAL_NAMING,
+            OMNIPLEX_CONNECTION,
+            RATE_EXTRAPOLATION,
+            CATALOG_INSERTION,
+            PHASE_COUNT
+        };
+        
+        enum outputFormat
+        {
+            JSON = 0,
+            FOLDED_STACKS
+        };
+        
+        class phaseStats
+        {
+        public:
+            unsigned long calls;
+            unsigned long cacheHits;
+            unsigned long long nanoseconds;
+            unsigned long long selfNanoseconds;
+            
+            phaseStats( void ) :
+                calls( 0 ),
+                cacheHits( 0 ),
+                nanoseconds( 0 ),
+                selfNanoseconds( 0 )
+            {}
+        };
+        
+        class rxnGenStats
+        {
+        public:
+            std::string kind;
+            std::string rule;
+            
+            unsigned long invocations;
+            unsigned long reactionsMade;
+            unsigned long speciesMade;
+            unsigned long recognitions;
+            unsigned long cacheHits;
+            unsigned long long nanoseconds;
+            unsigned long long selfNanoseconds;
+            
+            rxnGenStats( void ) :
+                invocations( 0 ),
+                reactionsMade( 0 ),
+                speciesMade( 0 ),
+                recognitions( 0 ),
+                cacheHits( 0 ),
+                nanoseconds( 0 ),
+                selfNanoseconds( 0 )
+            {}
+            
+            std::string
+            getLabel( void ) const;
+        };
+        
+        expansionProfiler( void );
+        
+        ~expansionProfiler( void );
+        
+        void
+        setEnabled( bool enable );
+        
+        bool
+        isEnabled( void ) const
+        {
+            return enabled;
+        }
+        
+        // Clears all the counters and timers, but not the names of the
+        // reaction generators.
+        void
+        reset( void );
+        
+        // Gives a reaction generator a name for the reports.  The kind is
+        // the kind of generator, such as "dimerization-gen", and the rule
+        // says which one.
+        void
+        nameRxnGen( const void* pRxnGen,
+                    const std::string& rKind,
+                    const std::string& rRule );
+        
+        // The label of a named reaction generator, as in the reports, or
+        // the empty string if it was never named.
+        std::string
+        getRxnGenLabel( const void* pRxnGen ) const;
+        
+        static const char*
+        getPhaseName( phase thePhase );
+        
+        const phaseStats&
+        getPhaseStats( phase thePhase ) const;
+        
+        // Stats of all the reaction generators that have been named or have
+        // run, in the order in which they were first seen.
+        std::vector<rxnGenStats>
+        getRxnGenStats( void ) const;
+        
+        void
+        writeJson( std::ostream& rOs ) const;
+        
+        // One line per distinct stack of scopes, with its self time in
+        // nanoseconds, as read by flamegraph.pl and similar tools.
+        void
+        writeFoldedStacks( std::ostream& rOs ) const;
+        
+        void
+        writeProfile( const std::string& rFileName,
+                      outputFormat format ) const
+            throw( utl::xcpt );
+        
+        // These are for the instrumented code.  Use the scope classes
+        // below rather than calling the enter/leave functions directly.
+        void
+        enterPhase( phase thePhase );
+        
+        void
+        enterRxnGen( const void* pRxnGen,
+                     const char* kind );
+        
+        void
+        leave( void );
+        
+        void
+        noteCacheHit( phase thePhase );
+        
+        void
+        noteReactionMade( void );
+        
+        void
+        noteSpeciesMade( void );
+        
+    private:
+        // A node of the tree of distinct stacks of scopes.  Each node is
+        // labeled when it is made, so that entering a scope only looks up
+        // a child by address, and the stack's text is only put together
+        // for the report.
+        class stackNode
+        {
+        public:
+            std::string label;
+            bool left;
+            unsigned long long selfNanoseconds;
+            
+            // Keyed by the generator's stats or the phase's stats.
+            std::map<const void*, stackNode*> children;
+            
+            stackNode( void ) :
+                left( false ),
+                selfNanoseconds( 0 )
+            {}
+            
+            ~stackNode( void );
+            
+            stackNode*
+            findChild( const void* pKey,
+                       const std::string& rLabel );
+            
+            void
+            clearTimes( void );
+            
+            void
+            fold( const std::string& rStack,
+                  std::map<std::string, unsigned long long>& rFolded ) const;
+        };
+        
+        class frame
+        {
+        public:
+            // Null for a phase frame.
+            rxnGenStats* pRxnGen;
+            phase thePhase;
+            stackNode* pStack;
+            unsigned long long startTime;
+            unsigned long long childTime;
+        };
+        
+        static unsigned long long
+        now( void );
+        
+        rxnGenStats*
+        lookupRxnGen( const void* pRxnGen,
+                      const char* kind );
+        
+        rxnGenStats*
+        innermostRxnGen( void );
+        
+        stackNode*
+        currentStack( void );
+        
+        bool enabled;
+        phaseStats phases[PHASE_COUNT];
+        
+        std::map<const void*, rxnGenStats*> rxnGensByAddress;
+        std::vector<rxnGenStats*> rxnGensInOrder;
+        
+        std::vector<frame> openFrames;
+        stackNode stackRoot;
+        
+        // Not copyable, since the stats are owned.
+        expansionProfiler( const expansionProfiler& );
+        
+        expansionProfiler&
+        operator=( const expansionProfiler& );
+    };
+    
+    // Times a phase of expansion for as long as it is in scope.
+    class profilePhase
+    {
+        expansionProfiler& rProfiler;
+        bool active;
+        
+    public:
+        profilePhase( expansionProfiler& rExpansionProfiler,
+                      expansionProfiler::phase thePhase ) :
+            rProfiler( rExpansionProfiler ),
+            active( rExpansionProfiler.isEnabled() )
+        {
+            if ( active ) rProfiler.enterPhase( thePhase );
+        }
+        
+        ~profilePhase( void )
+        {
+            if ( active ) rProfiler.leave();
+        }
+    };
+    
+    // Times a reaction generator's response to a new species for as long as
+    // it is in scope, and counts the invocation.
+    class profileRxnGen
+    {
+        expansionProfiler& rProfiler;
+        bool active;
+        
+    public:
+        profileRxnGen( expansionProfiler& rExpansionProfiler,
+                       const void* pRxnGen,
+                       const char* kind ) :
+            rProfiler( rExpansionProfiler ),
+            active( rExpansionProfiler.isEnabled() )
+        {
+            if ( active ) rProfiler.enterRxnGen( pRxnGen,
+                                                 kind );
+        }
+        
+        ~profileRxnGen( void )
+        {
+            if ( active ) rProfiler.leave();
+        }
+    };
+}
+
+#endif // FND_EXPANSIONPROFILER_H
@@ -90,6 +90,17 @@ namespace fnd
                                              *this ) );
         }
 
+        // Remembers the context without passing it on to the reaction
+        // generators.  This is how a species that was expanded in a saved
+        // reaction network is put back, so that binary reaction generators
+        // still pair it with species that are expanded later.
+        virtual
+        void
+        recordContext( const newContextStimulus<contextT>& rStimulus )
+        {
+            contexts.push_back( rStimulus.getContext() );
+        }
+        
         // This is part of the refactoring of things.
         virtual void
         dumpablesRespond( const newContextStimulus<contextT>& rStimulus )
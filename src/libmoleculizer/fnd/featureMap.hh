@@ -100,6 +100,31 @@ namespace fnd
             }
         };
         
+        class recordFeatureContext :
+            std::unary_function<typename featureMap::value_type, void>
+        {
+            const typename featureMap::stimulusType& rStimulus;
+            
+        public:
+            recordFeatureContext( const typename featureMap::stimulusType& rNewSpeciesStimulus ) :
+                rStimulus( rNewSpeciesStimulus )
+            {}
+            
+            void operator()( const typename featureMap::value_type& rEntry ) const
+            {
+                const typename contextT::contextSpec& rSpec = rEntry.first;
+                feature<contextT>* pFeature = rEntry.second;
+                
+                contextT newContext( rStimulus.getSpecies(),
+                                     rSpec );
+                
+                newContextStimulus<contextT> stim( newContext,
+                                                   rStimulus.getNotificationDepth() );
+                
+                pFeature->recordContext( stim );
+            }
+        };
+        
     public:
         int
         getNum() const
@@ -135,6 +160,16 @@ namespace fnd
                            this->end(),
                            dumpableNotifyFeature( rStimulus ) );
         }
+        
+        //! Record the new species' context with each feature, without
+        //! generating reactions.
+        void
+        recordContexts( const typename featureMap::stimulusType& rStimulus )
+        {
+            std::for_each( this->begin(),
+                           this->end(),
+                           recordFeatureContext( rStimulus ) );
+        }
     };
     
 }
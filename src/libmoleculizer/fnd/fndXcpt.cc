@@ -46,6 +46,34 @@ namespace fnd
         return msgStream.str();
     }
     
+    std::string
+    badBinaryDumpFileXcpt::
+    mkMsg( const std::string& rFileName,
+           const std::string& rProblem )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Binary dump file `"
+                  << rFileName
+                  << "': "
+                  << rProblem
+                  << ".";
+        return msgStream.str();
+    }
+    
+    std::string
+    nonNumericDumpColumnXcpt::
+    mkMsg( const std::string& rFileName,
+           const std::string& rColumnName )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Column `"
+                  << rColumnName
+                  << "' of binary dump file `"
+                  << rFileName
+                  << "' does not have a numeric value.";
+        return msgStream.str();
+    }
+    
     std::string
     speciesNotMassiveXcpt::
     mkMsg( xmlpp::Node* pOffendingNode )
@@ -121,6 +121,36 @@ namespace fnd
         {}
     };
     
+    class badBinaryDumpFileXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rFileName,
+               const std::string& rProblem );
+        
+    public:
+        badBinaryDumpFileXcpt( const std::string& rFileName,
+                               const std::string& rProblem ) :
+            utl::xcpt( mkMsg( rFileName,
+                              rProblem ) )
+        {}
+    };
+    
+    class nonNumericDumpColumnXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rFileName,
+               const std::string& rColumnName );
+        
+    public:
+        nonNumericDumpColumnXcpt( const std::string& rFileName,
+                                  const std::string& rColumnName ) :
+            utl::xcpt( mkMsg( rFileName,
+                              rColumnName ) )
+        {}
+    };
+    
     class speciesNotMassiveXcpt :
         public utl::xcpt
     {
@@ -130,6 +160,147 @@ namespace fnd
         speciesNotMassiveXcpt( xmlpp::Node* pOffendingNode = 0 );
     };
     
+    // Thrown by eventQueue when an event is scheduled before the time of
+    // the event most recently fired.
+    class eventInPastXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( double now,
+               double badEventTime )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Event scheduled at time "
+                      << badEventTime
+                      << ", which is in the past at simulation time "
+                      << now
+                      << ".";
+            return msgStream.str();
+        }
+        
+    public:
+        eventInPastXcpt( double now,
+                         double badEventTime ) :
+            utl::xcpt( mkMsg( now,
+                              badEventTime ) )
+        {}
+    };
+    
+    class badEventPeriodXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( double badPeriod )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Periodic event given period "
+                      << badPeriod
+                      << "; the period must be positive.";
+            return msgStream.str();
+        }
+        
+    public:
+        badEventPeriodXcpt( double badPeriod ) :
+            utl::xcpt( mkMsg( badPeriod ) )
+        {}
+    };
+    
+    class badSolverStepXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( double badStep )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Solver given time step "
+                      << badStep
+                      << "; the time step must be positive.";
+            return msgStream.str();
+        }
+        
+    public:
+        badSolverStepXcpt( double badStep ) :
+            utl::xcpt( mkMsg( badStep ) )
+        {}
+    };
+    
+    // Thrown when a concentration or sensitivity is infinite or NaN, in the
+    // initial conditions or in every step the solver tried.
+    class nonFiniteStateXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( double time,
+               const std::string& rSpeciesName )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Solution for species "
+                      << rSpeciesName
+                      << " is not finite at time "
+                      << time
+                      << ".";
+            return msgStream.str();
+        }
+        
+    public:
+        nonFiniteStateXcpt( double time,
+                            const std::string& rSpeciesName ) :
+            utl::xcpt( mkMsg( time,
+                              rSpeciesName ) )
+        {}
+    };
+    
+    // Thrown when the solver can't meet its tolerances with any step it can
+    // take, as when the solution blows up in finite time.
+    class solverStepUnderflowXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( double time,
+               double step )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Solver step fell to "
+                      << step
+                      << " at time "
+                      << time
+                      << " without meeting its tolerances.";
+            return msgStream.str();
+        }
+        
+    public:
+        solverStepUnderflowXcpt( double time,
+                                 double step ) :
+            utl::xcpt( mkMsg( time,
+                              step ) )
+        {}
+    };
+    
+    // Thrown when network expansion is asked for after the memory budget
+    // has been reached; see memoryAccount.
+    class memoryBudgetXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( std::size_t usage,
+               std::size_t budget )
+        {
+            std::ostringstream msgStream;
+            msgStream << "Network expansion has used an estimated "
+                      << usage
+                      << " bytes, reaching its memory budget of "
+                      << budget
+                      << " bytes.";
+            return msgStream.str();
+        }
+        
+    public:
+        memoryBudgetXcpt( std::size_t usage,
+                          std::size_t budget ) :
+            utl::xcpt( mkMsg( usage,
+                              budget ) )
+        {}
+    };
     
 }
 
@@ -0,0 +1,423 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+#include "fnd/forwardSensitivity.hh"
+#include "fnd/expansionProfiler.hh"
+
+namespace fnd
+{
+    forwardSensitivity::forwardSensitivity( const expansionProfiler* pExpansionProfiler ) :
+        pProfiler( pExpansionProfiler ),
+        time( 0.0 ),
+        relTolerance( 1e-8 ),
+        absTolerance( 1e-20 ),
+        nextStep( 0.0 ),
+        stepCount( 0 ),
+        rejectedStepCount( 0 )
+    {
+        reactantBegin.push_back( 0 );
+        deltaBegin.push_back( 0 );
+    }
+    
+    int
+    forwardSensitivity::addSpecies( const std::string& rName,
+                                    double concentration )
+    {
+        speciesNames.push_back( rName );
+        initialConcentrations.push_back( concentration );
+        
+        // The state no longer fits; run will restart.
+        state.clear();
+        
+        return speciesNames.size() - 1;
+    }
+    
+    int
+    forwardSensitivity::addParameter( const std::string& rLabel )
+    {
+        parameterLabels.push_back( rLabel );
+        state.clear();
+        
+        return parameterLabels.size() - 1;
+    }
+    
+    int
+    forwardSensitivity::getRxnGenParameter( const coreRxnGen* pRxnGen )
+    {
+        std::map<const coreRxnGen*, int>::const_iterator iEntry
+            = parametersByRxnGen.find( pRxnGen );
+        if ( iEntry != parametersByRxnGen.end() ) return iEntry->second;
+        
+        std::string label;
+        if ( pProfiler ) label = pProfiler->getRxnGenLabel( pRxnGen );
+        if ( label.empty() )
+        {
+            std::ostringstream labelStream;
+            labelStream << "rxn-gen "
+                        << parametersByRxnGen.size();
+            label = labelStream.str();
+        }
+        
+        int parameter = addParameter( label );
+        parametersByRxnGen.insert( std::make_pair( pRxnGen,
+                                                   parameter ) );
+        return parameter;
+    }
+    
+    int
+    forwardSensitivity::addReaction( double rate,
+                                     const speciesCounts& rReactants,
+                                     const speciesCounts& rDeltas,
+                                     int parameter )
+    {
+        rates.push_back( rate );
+        reactionParameters.push_back( parameter );
+        
+        for ( speciesCounts::const_iterator iReactant = rReactants.begin();
+              iReactant != rReactants.end();
+              ++iReactant )
+        {
+            reactantSpecies.push_back( iReactant->first );
+            reactantMultiplicities.push_back( iReactant->second );
+        }
+        reactantBegin.push_back( reactantSpecies.size() );
+        
+        for ( speciesCounts::const_iterator iDelta = rDeltas.begin();
+              iDelta != rDeltas.end();
+              ++iDelta )
+        {
+            deltaSpecies.push_back( iDelta->first );
+            deltaValues.push_back( iDelta->second );
+        }
+        deltaBegin.push_back( deltaSpecies.size() );
+        
+        return rates.size() - 1;
+    }
+    
+    void
+    forwardSensitivity::setConcentration( int species,
+                                          double concentration )
+    {
+        initialConcentrations[species] = concentration;
+        
+        // Nothing has happened yet, so there's no need to wait for restart.
+        if ( 0.0 == time && ! state.empty() ) state[species] = concentration;
+    }
+    
+    void
+    forwardSensitivity::restart( void )
+    {
+        int speciesCount = getSpeciesCount();
+        
+        time = 0.0;
+        nextStep = 0.0;
+        stepCount = 0;
+        rejectedStepCount = 0;
+        state.assign( speciesCount * ( 1 + getParameterCount() ),
+                      0.0 );
+        std::copy( initialConcentrations.begin(),
+                   initialConcentrations.end(),
+                   state.begin() );
+    }
+    
+    void
+    forwardSensitivity::computeDerivative( const std::vector<double>& rState,
+                                           std::vector<double>& rDerivative ) const
+    {
+        const int speciesCount = getSpeciesCount();
+        const int parameterCount = getParameterCount();
+        const int reactionCount = getReactionCount();
+        
+        rDerivative.assign( rState.size(),
+                            0.0 );
+        
+        // Derivatives of a reaction's velocity with respect to each of its
+        // reactants' concentrations.
+        std::vector<double> partials;
+        
+        for ( int reaction = 0; reaction < reactionCount; ++reaction )
+        {
+            const int firstReactant = reactantBegin[reaction];
+            const int endReactant = reactantBegin[reaction + 1];
+            
+            double velocity = rates[reaction];
+            partials.assign( endReactant - firstReactant,
+                             rates[reaction] );
+            
+            for ( int entry = firstReactant; entry < endReactant; ++entry )
+            {
+                double concentration = rState[reactantSpecies[entry]];
+                int multiplicity = reactantMultiplicities[entry];
+                
+                double power = 1.0;
+                for ( int factor = 1; factor < multiplicity; ++factor ) power *= concentration;
+                
+                velocity *= power * concentration;
+                
+                for ( int other = firstReactant; other < endReactant; ++other )
+                {
+                    double& rPartial = partials[other - firstReactant];
+                    if ( other == entry ) rPartial *= multiplicity * power;
+                    else rPartial *= power * concentration;
+                }
+            }
+            
+            const int firstDelta = deltaBegin[reaction];
+            const int endDelta = deltaBegin[reaction + 1];
+            
+            for ( int entry = firstDelta; entry < endDelta; ++entry )
+            {
+                rDerivative[deltaSpecies[entry]] += deltaValues[entry] * velocity;
+            }
+            
+            for ( int parameter = 0; parameter < parameterCount; ++parameter )
+            {
+                const int block = ( 1 + parameter ) * speciesCount;
+                
+                // The velocity's derivative along the sensitivity vector,
+                // plus its explicit dependence on the parameter.
+                double change = ( parameter == reactionParameters[reaction] ) ? velocity : 0.0;
+                for ( int entry = firstReactant; entry < endReactant; ++entry )
+                {
+                    change += partials[entry - firstReactant]
+                        * rState[block + reactantSpecies[entry]];
+                }
+                
+                if ( 0.0 == change ) continue;
+                
+                for ( int entry = firstDelta; entry < endDelta; ++entry )
+                {
+                    rDerivative[block + deltaSpecies[entry]] += deltaValues[entry] * change;
+                }
+            }
+        }
+    }
+    
+    namespace
+    {
+        // The Dormand-Prince pair.  The fifth-order weights are the last
+        // row of the stage coefficients, so the last stage is evaluated at
+        // the trial state.
+        const double stageCoefficients[6][6] = {
+            { 1.0 / 5.0 },
+            { 3.0 / 40.0, 9.0 / 40.0 },
+            { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 },
+            { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 },
+            { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0 },
+            { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 }
+        };
+        
+        // Fifth-order weights less fourth-order weights.
+        const double errorWeights[7] = {
+            71.0 / 57600.0,
+            0.0,
+            -71.0 / 16695.0,
+            71.0 / 1920.0,
+            -17253.0 / 339200.0,
+            22.0 / 525.0,
+            -1.0 / 40.0
+        };
+        
+        // Bounds on how much the step changes at once.
+        const double stepSafety = 0.9;
+        const double maxStepGrowth = 5.0;
+        const double maxStepShrinkage = 0.1;
+        
+        bool
+        isFinite( double value )
+        {
+            // False for NaN as well as for infinities.
+            return std::fabs( value ) <= DBL_MAX;
+        }
+    }
+    
+    int
+    forwardSensitivity::findNonFinite( const std::vector<double>& rState ) const
+    {
+        for ( size_t ndx = 0; ndx < rState.size(); ++ndx )
+        {
+            if ( ! isFinite( rState[ndx] ) ) return ndx % getSpeciesCount();
+        }
+        return -1;
+    }
+    
+    double
+    forwardSensitivity::tryStep( double step )
+    {
+        const int stateSize = state.size();
+        stageState.resize( stateSize );
+        
+        for ( int stage = 1; stage < 7; ++stage )
+        {
+            const double* pCoefficients = stageCoefficients[stage - 1];
+            
+            for ( int ndx = 0; ndx < stateSize; ++ndx )
+            {
+                double increment = 0.0;
+                for ( int previous = 0; previous < stage; ++previous )
+                {
+                    increment += pCoefficients[previous] * stages[previous][ndx];
+                }
+                stageState[ndx] = state[ndx] + step * increment;
+            }
+            
+            computeDerivative( stageState,
+                               stages[stage] );
+        }
+        
+        trialState.swap( stageState );
+        
+        double maxError = 0.0;
+        for ( int ndx = 0; ndx < stateSize; ++ndx )
+        {
+            double trialValue = trialState[ndx];
+            if ( ! isFinite( trialValue ) ) return HUGE_VAL;
+            
+            double error = 0.0;
+            for ( int stage = 0; stage < 7; ++stage )
+            {
+                error += errorWeights[stage] * stages[stage][ndx];
+            }
+            
+            double scale = absTolerance
+                + relTolerance * std::max( std::fabs( state[ndx] ),
+                                           std::fabs( trialValue ) );
+            double relativeError = std::fabs( step * error ) / scale;
+            
+            // Written so that a NaN error rejects the step.
+            if ( ! ( relativeError <= maxError ) ) maxError = relativeError;
+        }
+        
+        return isFinite( maxError ) ? maxError : HUGE_VAL;
+    }
+    
+    void
+    forwardSensitivity::run( double duration,
+                             double maxStep )
+        throw( utl::xcpt )
+    {
+        if ( ! ( 0.0 < maxStep ) ) throw badSolverStepXcpt( maxStep );
+        
+        if ( state.size() != ( size_t ) ( getSpeciesCount() * ( 1 + getParameterCount() ) ) )
+        {
+            restart();
+        }
+        
+        if ( ! ( 0.0 < duration ) ) return;
+        
+        int badSpecies = findNonFinite( state );
+        if ( 0 <= badSpecies ) throw nonFiniteStateXcpt( time,
+                                                         speciesNames[badSpecies] );
+        
+        computeDerivative( state,
+                           stages[0] );
+        
+        const double endTime = time + duration;
+        const double minStep = 16.0 * DBL_EPSILON * std::fabs( endTime );
+        
+        double step = ( 0.0 < nextStep ) ? nextStep : duration;
+        
+        while ( time < endTime )
+        {
+            step = std::min( step,
+                             maxStep );
+            
+            bool lastStep = ( endTime <= time + step );
+            if ( lastStep ) step = endTime - time;
+            
+            double error = tryStep( step );
+            
+            if ( error <= 1.0 )
+            {
+                state.swap( trialState );
+                stages[0].swap( stages[6] );
+                time = lastStep ? endTime : time + step;
+                ++stepCount;
+                
+                double growth = ( 0.0 < error )
+                    ? stepSafety * std::pow( error, -0.2 )
+                    : maxStepGrowth;
+                step *= std::min( growth,
+                                  maxStepGrowth );
+                
+                // A step cut short to land on the end doesn't say how long
+                // the next one can be.
+                if ( ! lastStep || nextStep < step ) nextStep = step;
+            }
+            else
+            {
+                ++rejectedStepCount;
+                
+                double shrinkage = isFinite( error )
+                    ? stepSafety * std::pow( error, -0.2 )
+                    : maxStepShrinkage;
+                step *= std::max( shrinkage,
+                                  maxStepShrinkage );
+                
+                if ( step < minStep )
+                {
+                    badSpecies = findNonFinite( trialState );
+                    if ( 0 <= badSpecies ) throw nonFiniteStateXcpt( time,
+                                                                     speciesNames[badSpecies] );
+                    throw solverStepUnderflowXcpt( time,
+                                                   step );
+                }
+            }
+        }
+    }
+    
+    void
+    forwardSensitivity::write( std::ostream& rOs ) const
+    {
+        rOs << "species\tconcentration";
+        for ( int parameter = 0; parameter < getParameterCount(); ++parameter )
+        {
+            rOs << '\t'
+                << parameterLabels[parameter];
+        }
+        rOs << std::endl;
+        
+        for ( int species = 0; species < getSpeciesCount(); ++species )
+        {
+            rOs << speciesNames[species]
+                << '\t'
+                << getConcentration( species );
+            
+            for ( int parameter = 0; parameter < getParameterCount(); ++parameter )
+            {
+                rOs << '\t'
+                    << getSensitivity( species,
+                                       parameter );
+            }
+            rOs << std::endl;
+        }
+    }
+}
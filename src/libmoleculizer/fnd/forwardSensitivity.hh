@@ -0,0 +1,309 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_FORWARDSENSITIVITY_H
+#define FND_FORWARDSENSITIVITY_H
+
+/*! \file forwardSensitivity.hh
+  \ingroup chemGroup
+  \brief Deterministic solution of a network, with its sensitivities to
+  the rules' rates.
+  
+  The network is integrated as mass-action ODEs in molar concentrations,
+  and alongside it the forward sensitivity equations
+  
+  dS/dt = J S + df/dp,
+  
+  where J is the Jacobian of the ODEs.  There is one parameter for each
+  reaction generator, scaling the rates of all the reactions it made,
+  so S[species, parameter] is the derivative of the species'
+  concentration with respect to the log of the rule's rate.  (The rate
+  extrapolators are linear in the rule's rate, so this is what changing
+  the rate in the model does.)  Reactions that no generator made take
+  part in the dynamics only.
+  
+  Integration is by the Dormand-Prince embedded Runge-Kutta pair, fifth
+  order with a fourth-order error estimate, taking steps as long as the
+  tolerances allow, up to the longest step given to run.  The error of
+  each component is held below the absolute tolerance plus the relative
+  tolerance times the component's magnitude.  A solution that becomes
+  infinite or NaN, or that needs ever shorter steps, as when it blows up
+  in finite time, stops the run with an exception. */
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "fnd/basicReaction.hh"
+#include "fnd/coreRxnGen.hh"
+#include "fnd/fndXcpt.hh"
+
+namespace fnd
+{
+    class expansionProfiler;
+    
+    class forwardSensitivity
+    {
+    public:
+        // (species index, multiplicity or change) for each species in a
+        // reaction.
+        typedef std::vector<std::pair<int, int> > speciesCounts;
+        
+        // Generator parameters are labeled as in the profiler, if one is
+        // given.
+        forwardSensitivity( const expansionProfiler* pExpansionProfiler = 0 );
+        
+        // Returns the species' index.
+        int
+        addSpecies( const std::string& rName,
+                    double concentration = 0.0 );
+        
+        // Returns the parameter's index.
+        int
+        addParameter( const std::string& rLabel );
+        
+        // The parameter for a reaction generator, added the first time it
+        // is asked for, and labeled as in the expansion profiler if the
+        // generator was named there.
+        int
+        getRxnGenParameter( const coreRxnGen* pRxnGen );
+        
+        // The parameter is -1 for a reaction that belongs to none.
+        int
+        addReaction( double rate,
+                     const speciesCounts& rReactants,
+                     const speciesCounts& rDeltas,
+                     int parameter );
+        
+        // Sets an initial concentration, in molar.  Call restart
+        // afterward to begin again from the initial conditions.
+        void
+        setConcentration( int species,
+                          double concentration );
+        
+        // Back to time zero, with the initial concentrations and zero
+        // sensitivities.
+        void
+        restart( void );
+        
+        // Integrates forward by the duration, in steps of at most
+        // maxStep.  Throws nonFiniteStateXcpt or solverStepUnderflowXcpt,
+        // leaving the state at the last step taken, if the solution can't
+        // be continued.
+        void
+        run( double duration,
+             double maxStep )
+            throw( utl::xcpt );
+        
+        // Relative and absolute error tolerances for each step.
+        void
+        setTolerances( double relativeTolerance,
+                       double absoluteTolerance )
+        {
+            relTolerance = relativeTolerance;
+            absTolerance = absoluteTolerance;
+        }
+        
+        // Steps taken and steps rejected for too much error since the last
+        // restart.
+        int
+        getStepCount( void ) const
+        {
+            return stepCount;
+        }
+        
+        int
+        getRejectedStepCount( void ) const
+        {
+            return rejectedStepCount;
+        }
+        
+        int
+        getSpeciesCount( void ) const
+        {
+            return speciesNames.size();
+        }
+        
+        int
+        getParameterCount( void ) const
+        {
+            return parameterLabels.size();
+        }
+        
+        int
+        getReactionCount( void ) const
+        {
+            return rates.size();
+        }
+        
+        const std::string&
+        getSpeciesName( int species ) const
+        {
+            return speciesNames[species];
+        }
+        
+        const std::string&
+        getParameterLabel( int parameter ) const
+        {
+            return parameterLabels[parameter];
+        }
+        
+        // The time, concentrations and sensitivities are those reached by
+        // the last run, or set by the last restart.
+        double
+        getTime( void ) const
+        {
+            return time;
+        }
+        
+        double
+        getConcentration( int species ) const
+        {
+            return state[species];
+        }
+        
+        double
+        getSensitivity( int species,
+                        int parameter ) const
+        {
+            return state[sensitivityOffset( species, parameter )];
+        }
+        
+        // One line per species, giving its concentration and then its
+        // sensitivity to each parameter, separated by tabs, after a header
+        // line naming the columns.
+        void
+        write( std::ostream& rOs ) const;
+        
+    private:
+        std::vector<std::string> speciesNames;
+        std::vector<double> initialConcentrations;
+        
+        std::vector<std::string> parameterLabels;
+        std::map<const coreRxnGen*, int> parametersByRxnGen;
+        const expansionProfiler* pProfiler;
+        
+        // By reaction.  Reactants of reaction r are at reactantBegin[r] up
+        // to reactantBegin[r + 1], and likewise the deltas.
+        std::vector<double> rates;
+        std::vector<int> reactionParameters;
+        std::vector<int> reactantBegin;
+        std::vector<int> reactantSpecies;
+        std::vector<int> reactantMultiplicities;
+        std::vector<int> deltaBegin;
+        std::vector<int> deltaSpecies;
+        std::vector<int> deltaValues;
+        
+        double time;
+        
+        double relTolerance;
+        double absTolerance;
+        
+        // The step the error estimate last asked for, or zero after
+        // restart.
+        double nextStep;
+        
+        int stepCount;
+        int rejectedStepCount;
+        
+        // The concentrations, followed by the sensitivities, a block of one
+        // per species for each parameter.
+        std::vector<double> state;
+        
+        // Scratch space for the Runge-Kutta stages and the trial state at
+        // the end of a step.  The last stage is the derivative at the trial
+        // state, so it becomes the first stage of the next step.
+        std::vector<double> stages[7];
+        std::vector<double> stageState;
+        std::vector<double> trialState;
+        
+        int
+        sensitivityOffset( int species,
+                           int parameter ) const
+        {
+            return ( 1 + parameter ) * getSpeciesCount() + species;
+        }
+        
+        void
+        computeDerivative( const std::vector<double>& rState,
+                           std::vector<double>& rDerivative ) const;
+        
+        // Computes the trial state for a step from the current state,
+        // returning the largest estimated error relative to the tolerances,
+        // or infinity if the trial state isn't finite.
+        double
+        tryStep( double step );
+        
+        // The first species with a non-finite component in the state,
+        // or -1.
+        int
+        findNonFinite( const std::vector<double>& rState ) const;
+    };
+    
+    // Adds a reaction, with the species numbered by speciesIndex, a
+    // function taking a species pointer and returning its index, and the
+    // reaction's parameter that of the generator that made it.
+    template<class speciesType,
+             class speciesIndexFunction>
+    int
+    addBasicReaction( forwardSensitivity& rSensitivity,
+                      const basicReaction<speciesType>& rReaction,
+                      speciesIndexFunction speciesIndex )
+    {
+        typedef typename basicReaction<speciesType>::multMap multMap;
+        
+        forwardSensitivity::speciesCounts reactants;
+        const multMap& rReactantMap = rReaction.getReactants();
+        for ( typename multMap::const_iterator iReactant = rReactantMap.begin();
+              iReactant != rReactantMap.end();
+              ++iReactant )
+        {
+            reactants.push_back( std::make_pair( speciesIndex( iReactant->first ),
+                                                 iReactant->second ) );
+        }
+        
+        forwardSensitivity::speciesCounts deltas;
+        const multMap& rDeltaMap = rReaction.getDeltas();
+        for ( typename multMap::const_iterator iDelta = rDeltaMap.begin();
+              iDelta != rDeltaMap.end();
+              ++iDelta )
+        {
+            deltas.push_back( std::make_pair( speciesIndex( iDelta->first ),
+                                              iDelta->second ) );
+        }
+        
+        const coreRxnGen* pRxnGen = rReaction.getOriginatingRxnGen();
+        int parameter = pRxnGen ? rSensitivity.getRxnGenParameter( pRxnGen ) : -1;
+        
+        return rSensitivity.addReaction( rReaction.getRate(),
+                                         reactants,
+                                         deltas,
+                                         parameter );
+    }
+}
+
+#endif // FND_FORWARDSENSITIVITY_H
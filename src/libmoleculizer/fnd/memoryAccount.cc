@@ -0,0 +1,87 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "fnd/fndXcpt.hh"
+#include "fnd/memoryAccount.hh"
+
+namespace fnd
+{
+    namespace
+    {
+        const char* subsystemNames[memoryAccount::SUBSYSTEM_COUNT] =
+            {
+                "species-catalog",
+                "reaction-maps",
+                "recognizer-cache",
+                "plex-families",
+                "sensitivity-lists",
+                "rate-memos",
+                "network-snapshots"
+            };
+    }
+    
+    memoryAccount::
+    memoryAccount( void ) :
+        budget( 0 )
+    {
+        for ( int subsystemNdx = 0;
+              subsystemNdx < SUBSYSTEM_COUNT;
+              ++subsystemNdx )
+        {
+            usage[subsystemNdx] = 0;
+        }
+    }
+    
+    std::size_t
+    memoryAccount::
+    getTotalUsage( void ) const
+    {
+        std::size_t total = 0;
+        for ( int subsystemNdx = 0;
+              subsystemNdx < SUBSYSTEM_COUNT;
+              ++subsystemNdx )
+        {
+            total += usage[subsystemNdx];
+        }
+        return total;
+    }
+    
+    const char*
+    memoryAccount::
+    getSubsystemName( subsystem theSubsystem )
+    {
+        return subsystemNames[theSubsystem];
+    }
+    
+    void
+    memoryAccount::
+    checkBudget( void ) const
+        throw( utl::xcpt )
+    {
+        if ( isOverBudget() ) throw memoryBudgetXcpt( getTotalUsage(),
+                                                      budget );
+    }
+}
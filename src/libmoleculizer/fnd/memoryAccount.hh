@@ -0,0 +1,152 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_MEMORYACCOUNT_H
+#define FND_MEMORYACCOUNT_H
+
+/*! \file memoryAccount.hh
+  \ingroup rxnGenGroup
+  \brief Accounts for the memory taken by network expansion. */
+
+#include <cstddef>
+#include "utl/xcpt.hh"
+
+namespace fnd
+{
+    /*! \ingroup rxnGenGroup
+      \brief Estimated memory use of one network's expansion, and a budget
+      for it.
+      
+      Each ReactionNetworkDescription, and so each moleculizer, has one
+      of these.  The structures that grow as its network is expanded
+      charge what they add to the subsystem they belong to: the species
+      catalog and its name charts, the reaction lists and the maps of
+      reactions by substrate, the recognizer's cache of recognized
+      complexes, the plex families, the sensitivity lists that connect
+      features to their reaction generators, the memoized reaction rates,
+      and the indices of the published snapshots.  The charges are
+      estimates, from the sizes of the objects and of the tree or list
+      nodes holding them, not measurements of the heap; they are meant
+      for comparing subsystems and for stopping an expansion that would
+      exhaust memory.
+      
+      The budget, if one is set, is checked between the expansions of
+      species, never during one, so that a stopped expansion leaves a
+      consistent network.  The usage can thus exceed the budget by what
+      one species' expansion adds.
+      
+      Like the network it accounts for, this belongs to the expanding
+      thread.  Charging costs one addition, so it is always on. */
+    class memoryAccount
+    {
+    public:
+        enum subsystem
+        {
+            SPECIES_CATALOG = 0,
+            REACTION_MAPS,
+            RECOGNIZER_CACHE,
+            PLEX_FAMILIES,
+            SENSITIVITY_LISTS,
+            RATE_MEMOS,
+            NETWORK_SNAPSHOTS,
+            SUBSYSTEM_COUNT
+        };
+        
+        memoryAccount( void );
+        
+        void
+        charge( subsystem theSubsystem,
+                std::size_t bytes )
+        {
+            usage[theSubsystem] += bytes;
+        }
+        
+        // For structures that are emptied while their owner lives on.
+        void
+        refund( subsystem theSubsystem,
+                std::size_t bytes )
+        {
+            usage[theSubsystem] -= bytes;
+        }
+        
+        std::size_t
+        getUsage( subsystem theSubsystem ) const
+        {
+            return usage[theSubsystem];
+        }
+        
+        std::size_t
+        getTotalUsage( void ) const;
+        
+        static const char*
+        getSubsystemName( subsystem theSubsystem );
+        
+        // Zero, the default, means no budget.
+        void
+        setBudget( std::size_t bytes )
+        {
+            budget = bytes;
+        }
+        
+        std::size_t
+        getBudget( void ) const
+        {
+            return budget;
+        }
+        
+        bool
+        isOverBudget( void ) const
+        {
+            return budget && budget <= getTotalUsage();
+        }
+        
+        // Throws memoryBudgetXcpt if the budget has been reached.
+        void
+        checkBudget( void ) const
+            throw( utl::xcpt );
+        
+        // Estimated size of a node of a std::map, std::set or their multi
+        // versions holding a value of the given size, and of a std::list
+        // node.
+        static std::size_t
+        treeNodeBytes( std::size_t valueBytes )
+        {
+            return valueBytes + 4 * sizeof( void* );
+        }
+        
+        static std::size_t
+        listNodeBytes( std::size_t valueBytes )
+        {
+            return valueBytes + 2 * sizeof( void* );
+        }
+        
+    private:
+        std::size_t usage[SUBSYSTEM_COUNT];
+        std::size_t budget;
+    };
+}
+
+#endif // FND_MEMORYACCOUNT_H
@@ -32,17 +32,24 @@
 #ifndef FND_MULTISPECIESDUMPABLE_H
 #define FND_MULTISPECIESDUMPABLE_H
 
+#include "utl/linearHash.hh"
 #include "fnd/dumpable.hh"
 #include "fnd/sensitive.hh"
 #include "fnd/newSpeciesStimulus.hh"
 #include <vector>
+#include <algorithm>
 #include <iostream>
+#include <tr1/unordered_set>
 
 namespace fnd
 {
     // This doeesn't include any output (state dump) functionality.  Decided to
     // keep xml parsing and output out of template components like this.
-    
+    //
+    // The species are kept in the order they joined the stream, without
+    // repeats.  Membership is answered from a hashed set, and the sorted
+    // view handed out by getSpeciesInMultiSpeciesStream is rebuilt only
+    // after the stream has grown.
     template<class speciesT,
              class dumpArgT>
     class multiSpeciesDumpable :
@@ -52,9 +59,27 @@ namespace fnd
     protected:
         std::vector<const speciesT*> dumpedSpecies;
         
+        // Returns false if the species was already in the stream.
+        bool
+        addDumpedSpecies( const speciesT* pSpecies )
+        {
+            if ( ! dumpedSpeciesSet.insert( pSpecies ).second ) return false;
+            
+            dumpedSpecies.push_back( pSpecies );
+            sortedSpeciesValid = false;
+            return true;
+        }
+        
+    private:
+        std::tr1::unordered_set<const speciesT*, utl::linearHash> dumpedSpeciesSet;
+        
+        std::vector<const speciesT*> sortedSpecies;
+        bool sortedSpeciesValid;
+        
     public:
         multiSpeciesDumpable( const std::string& rName ) :
-            dumpable<dumpArgT> ( rName )
+            dumpable<dumpArgT> ( rName ),
+            sortedSpeciesValid( true )
         {}
         
         virtual
@@ -65,44 +90,37 @@ namespace fnd
         doDump( const dumpArgT& rDumpArg ) const
         {
         }
-
-      bool speciesInSpeciesStream( const speciesT* speciesPtr)
-      {
-	return std::find( dumpedSpecies.begin(),
-			  dumpedSpecies.end(),
-			  speciesPtr) != dumpedSpecies.end();
-      }
         
+        bool
+        speciesInSpeciesStream( const speciesT* speciesPtr ) const
+        {
+            return dumpedSpeciesSet.find( speciesPtr ) != dumpedSpeciesSet.end();
+        }
+        
+        int
+        getSpeciesCount( void ) const
+        {
+            return dumpedSpecies.size();
+        }
         
         const std::vector<const speciesT*>* 
         getSpeciesInMultiSpeciesStream()
         {
-            std::cout << "in getSpeciesInMultiSpeciesStream..." << std::endl;
-            sortAndUniqueSelf();
-            std::cout << "return getSpeciesInMultiSpeciesStream..." << std::endl;
-            return &dumpedSpecies;
+            if ( ! sortedSpeciesValid )
+            {
+                sortedSpecies = dumpedSpecies;
+                std::sort( sortedSpecies.begin(),
+                           sortedSpecies.end() );
+                sortedSpeciesValid = true;
+            }
+            return &sortedSpecies;
         }
         
-        
         virtual
         void
         respond( const fnd::newSpeciesStimulus<speciesT>& rStimulus )
         {
-            dumpedSpecies.push_back( rStimulus.getSpecies() );
-        }
-
-    private:
-        void
-        sortAndUniqueSelf()
-        {
-            std::sort( dumpedSpecies.begin(),
-                       dumpedSpecies.end());
-
-            std::cout << dumpedSpecies.end() - std::unique( dumpedSpecies.begin(), dumpedSpecies.end()) << std::endl;
-
-            dumpedSpecies.erase( std::unique( dumpedSpecies.begin(), dumpedSpecies.end()),
-                                 dumpedSpecies.end());
-                                 
+            addDumpedSpecies( rStimulus.getSpecies() );
         }
     };
 }
@@ -0,0 +1,584 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "fnd/networkReduction.hh"
+
+namespace fnd
+{
+    namespace
+    {
+        typedef networkReduction::speciesCounts speciesCounts;
+        
+        // Sorts by species, merging repeated species and dropping zeros.
+        speciesCounts
+        normalize( const std::map<int, int>& rCountMap )
+        {
+            speciesCounts result;
+            for ( std::map<int, int>::const_iterator iEntry = rCountMap.begin();
+                  iEntry != rCountMap.end();
+                  ++iEntry )
+            {
+                if ( 0 != iEntry->second ) result.push_back( *iEntry );
+            }
+            return result;
+        }
+        
+        void
+        accumulate( std::map<int, int>& rCountMap,
+                    const speciesCounts& rCounts,
+                    const std::vector<int>& rClassOf,
+                    int sign )
+        {
+            for ( speciesCounts::const_iterator iEntry = rCounts.begin();
+                  iEntry != rCounts.end();
+                  ++iEntry )
+            {
+                rCountMap[rClassOf.empty() ? iEntry->first : rClassOf[iEntry->first]]
+                    += sign * iEntry->second;
+            }
+        }
+        
+        speciesCounts
+        classCounts( const speciesCounts& rCounts,
+                     const std::vector<int>& rClassOf )
+        {
+            std::map<int, int> countMap;
+            accumulate( countMap, rCounts, rClassOf, 1 );
+            return normalize( countMap );
+        }
+        
+        speciesCounts
+        classDeltas( const networkReduction::reaction& rReaction,
+                     const std::vector<int>& rClassOf )
+        {
+            std::map<int, int> countMap;
+            accumulate( countMap, rReaction.products, rClassOf, 1 );
+            accumulate( countMap, rReaction.reactants, rClassOf, -1 );
+            return normalize( countMap );
+        }
+        
+        int
+        countOf( const speciesCounts& rCounts,
+                 int species )
+        {
+            for ( speciesCounts::const_iterator iEntry = rCounts.begin();
+                  iEntry != rCounts.end();
+                  ++iEntry )
+            {
+                if ( iEntry->first == species ) return iEntry->second;
+            }
+            return 0;
+        }
+        
+        double
+        factorial( int n )
+        {
+            double result = 1.0;
+            while ( 1 < n ) result *= n--;
+            return result;
+        }
+        
+        // The number of multisets of size m from n things.
+        double
+        multisetCount( int n,
+                       int m )
+        {
+            double result = 1.0;
+            for ( int ndx = 1; ndx <= m; ++ndx )
+            {
+                result = result * ( n + ndx - 1 ) / ndx;
+            }
+            return result;
+        }
+        
+        // The reaction pattern, as it would be after lumping, and the
+        // reaction's part in it, appended to a species' signature.
+        void
+        appendPattern( std::vector<double>& rEntry,
+                       double rate,
+                       const speciesCounts& rClassReactants,
+                       const speciesCounts& rClassDeltas )
+        {
+            rEntry.push_back( rate );
+            rEntry.push_back( rClassReactants.size() );
+            for ( speciesCounts::const_iterator iEntry = rClassReactants.begin();
+                  iEntry != rClassReactants.end();
+                  ++iEntry )
+            {
+                rEntry.push_back( iEntry->first );
+                rEntry.push_back( iEntry->second );
+            }
+            for ( speciesCounts::const_iterator iEntry = rClassDeltas.begin();
+                  iEntry != rClassDeltas.end();
+                  ++iEntry )
+            {
+                rEntry.push_back( iEntry->first );
+                rEntry.push_back( iEntry->second );
+            }
+        }
+        
+        // Rates are the same if they differ by less than this fraction;
+        // sums of rates taken in different orders can differ in the last
+        // bits.
+        const double rateTolerance = 1.0e-9;
+    }
+    
+    networkReduction::networkReduction( void )
+    {}
+    
+    int
+    networkReduction::addSpecies( const std::string& rName )
+    {
+        speciesNames.push_back( rName );
+        return speciesNames.size() - 1;
+    }
+    
+    int
+    networkReduction::addReaction( double rate,
+                                   const speciesCounts& rReactants,
+                                   const speciesCounts& rProducts )
+    {
+        static const std::vector<int> noClasses;
+        
+        reaction newReaction;
+        newReaction.rate = rate;
+        newReaction.reactants = classCounts( rReactants, noClasses );
+        newReaction.products = classCounts( rProducts, noClasses );
+        
+        reactions.push_back( newReaction );
+        return reactions.size() - 1;
+    }
+    
+    void
+    networkReduction::refine( std::vector<int>& rClassOf ) const
+    {
+        const int speciesCount = getSpeciesCount();
+        int classCount = speciesCount ? 1 + *std::max_element( rClassOf.begin(),
+                                                               rClassOf.end() ) : 0;
+        
+        for ( ;; )
+        {
+            typedef std::vector<std::vector<double> > signature;
+            std::vector<signature> signatures( speciesCount );
+            
+            for ( std::vector<reaction>::const_iterator iReaction = reactions.begin();
+                  iReaction != reactions.end();
+                  ++iReaction )
+            {
+                speciesCounts classReactants = classCounts( iReaction->reactants,
+                                                            rClassOf );
+                speciesCounts classDeltaCounts = classDeltas( *iReaction,
+                                                              rClassOf );
+                
+                // A species' part in a reaction is as a reactant (0) or as a
+                // product (1), with its multiplicity.
+                for ( int role = 0; role < 2; ++role )
+                {
+                    const speciesCounts& rCounts = role ? iReaction->products : iReaction->reactants;
+                    for ( speciesCounts::const_iterator iEntry = rCounts.begin();
+                          iEntry != rCounts.end();
+                          ++iEntry )
+                    {
+                        std::vector<double> entry;
+                        entry.push_back( role );
+                        entry.push_back( iEntry->second );
+                        appendPattern( entry,
+                                       iReaction->rate,
+                                       classReactants,
+                                       classDeltaCounts );
+                        signatures[iEntry->first].push_back( entry );
+                    }
+                }
+            }
+            
+            std::map<std::pair<int, signature>, int> newClasses;
+            std::vector<int> newClassOf( speciesCount );
+            for ( int species = 0; species < speciesCount; ++species )
+            {
+                signature& rSignature = signatures[species];
+                std::sort( rSignature.begin(),
+                           rSignature.end() );
+                
+                std::pair<std::map<std::pair<int, signature>, int>::iterator, bool> insertResult
+                    = newClasses.insert( std::make_pair( std::make_pair( rClassOf[species],
+                                                                         rSignature ),
+                                                         ( int ) newClasses.size() ) );
+                newClassOf[species] = insertResult.first->second;
+            }
+            
+            // Classes only ever split, so the same number of classes means
+            // that nothing changed.
+            bool stable = ( ( int ) newClasses.size() == classCount );
+            rClassOf.swap( newClassOf );
+            classCount = newClasses.size();
+            if ( stable ) return;
+        }
+    }
+    
+    bool
+    networkReduction::lumpReactions( std::vector<int>& rClassOf )
+    {
+        const int speciesCount = getSpeciesCount();
+        int classCount = speciesCount ? 1 + *std::max_element( rClassOf.begin(),
+                                                               rClassOf.end() ) : 0;
+        
+        std::vector<int> classSizes( classCount, 0 );
+        for ( int species = 0; species < speciesCount; ++species )
+        {
+            ++classSizes[rClassOf[species]];
+        }
+        
+        // For each lumped pattern, the total rate for each combination of
+        // original reactants.
+        typedef std::pair<speciesCounts, speciesCounts> pattern;
+        typedef std::map<speciesCounts, double> ratesByReactants;
+        std::map<pattern, ratesByReactants> patterns;
+        
+        for ( std::vector<reaction>::const_iterator iReaction = reactions.begin();
+              iReaction != reactions.end();
+              ++iReaction )
+        {
+            pattern key( classCounts( iReaction->reactants, rClassOf ),
+                         classDeltas( *iReaction, rClassOf ) );
+            patterns[key][iReaction->reactants] += iReaction->rate;
+        }
+        
+        reducedReactions.clear();
+        std::vector<bool> breakUp( classCount, false );
+        bool exact = true;
+        
+        for ( std::map<pattern, ratesByReactants>::const_iterator iPattern = patterns.begin();
+              iPattern != patterns.end();
+              ++iPattern )
+        {
+            const speciesCounts& rClassReactants = iPattern->first.first;
+            const speciesCounts& rClassDeltas = iPattern->first.second;
+            const ratesByReactants& rRates = iPattern->second;
+            
+            // Every combination of members must react.
+            double combinationCount = 1.0;
+            for ( speciesCounts::const_iterator iEntry = rClassReactants.begin();
+                  iEntry != rClassReactants.end();
+                  ++iEntry )
+            {
+                combinationCount *= multisetCount( classSizes[iEntry->first],
+                                                   iEntry->second );
+            }
+            bool patternExact = ( ( double ) rRates.size() == combinationCount );
+            
+            // And at the same rate, counting each combination as many times
+            // as it turns up when the lumped reactants are multiplied out.
+            double lumpedRate = 0.0;
+            for ( ratesByReactants::const_iterator iRate = rRates.begin();
+                  patternExact && iRate != rRates.end();
+                  ++iRate )
+            {
+                double orderings = 1.0;
+                for ( speciesCounts::const_iterator iEntry = iRate->first.begin();
+                      iEntry != iRate->first.end();
+                      ++iEntry )
+                {
+                    orderings /= factorial( iEntry->second );
+                }
+                for ( speciesCounts::const_iterator iEntry = rClassReactants.begin();
+                      iEntry != rClassReactants.end();
+                      ++iEntry )
+                {
+                    orderings *= factorial( iEntry->second );
+                }
+                
+                double rate = iRate->second / orderings;
+                if ( iRate == rRates.begin() ) lumpedRate = rate;
+                else if ( rateTolerance * std::fabs( lumpedRate ) < std::fabs( rate - lumpedRate ) )
+                {
+                    patternExact = false;
+                }
+            }
+            
+            if ( ! patternExact )
+            {
+                exact = false;
+                for ( speciesCounts::const_iterator iEntry = rClassReactants.begin();
+                      iEntry != rClassReactants.end();
+                      ++iEntry )
+                {
+                    breakUp[iEntry->first] = true;
+                }
+                continue;
+            }
+            
+            // Reactions within a lumped species vanish.
+            if ( rClassDeltas.empty() ) continue;
+            
+            std::map<int, int> productMap;
+            std::vector<int> sameClasses;
+            accumulate( productMap, rClassReactants, sameClasses, 1 );
+            accumulate( productMap, rClassDeltas, sameClasses, 1 );
+            
+            reaction lumpedReaction;
+            lumpedReaction.rate = lumpedRate;
+            lumpedReaction.reactants = rClassReactants;
+            lumpedReaction.products = normalize( productMap );
+            reducedReactions.push_back( lumpedReaction );
+        }
+        
+        if ( exact ) return true;
+        
+        // Every member but the first of a broken-up class gets a class of
+        // its own.
+        std::vector<bool> firstSeen( classCount, false );
+        for ( int species = 0; species < speciesCount; ++species )
+        {
+            int speciesClass = rClassOf[species];
+            if ( ! breakUp[speciesClass] ) continue;
+            
+            if ( firstSeen[speciesClass] ) rClassOf[species] = classCount++;
+            else firstSeen[speciesClass] = true;
+        }
+        
+        reducedReactions.clear();
+        return false;
+    }
+    
+    bool
+    networkReduction::isFastIntermediate( int species,
+                                          double qssaLifetime ) const
+    {
+        double outflowRate = 0.0;
+        
+        for ( std::vector<reaction>::const_iterator iReaction = reducedReactions.begin();
+              iReaction != reducedReactions.end();
+              ++iReaction )
+        {
+            int reactantCount = countOf( iReaction->reactants, species );
+            int productCount = countOf( iReaction->products, species );
+            
+            if ( 0 < reactantCount )
+            {
+                // Consumed, alone, by a first-order reaction.
+                if ( 1 != ( int ) iReaction->reactants.size()
+                     || 1 != reactantCount
+                     || 0 != productCount ) return false;
+                
+                outflowRate += iReaction->rate;
+            }
+            else if ( 1 < productCount ) return false;
+        }
+        
+        return 0.0 < outflowRate && 1.0 < qssaLifetime * outflowRate;
+    }
+    
+    void
+    networkReduction::eliminate( int species )
+    {
+        std::vector<reaction> makers;
+        std::vector<reaction> consumers;
+        std::vector<reaction> others;
+        double outflowRate = 0.0;
+        
+        for ( std::vector<reaction>::const_iterator iReaction = reducedReactions.begin();
+              iReaction != reducedReactions.end();
+              ++iReaction )
+        {
+            if ( countOf( iReaction->reactants, species ) )
+            {
+                consumers.push_back( *iReaction );
+                outflowRate += iReaction->rate;
+            }
+            else if ( countOf( iReaction->products, species ) ) makers.push_back( *iReaction );
+            else others.push_back( *iReaction );
+        }
+        
+        const std::vector<int> sameClasses;
+        for ( std::vector<reaction>::const_iterator iMaker = makers.begin();
+              iMaker != makers.end();
+              ++iMaker )
+        {
+            for ( std::vector<reaction>::const_iterator iConsumer = consumers.begin();
+                  iConsumer != consumers.end();
+                  ++iConsumer )
+            {
+                std::map<int, int> productMap;
+                accumulate( productMap, iMaker->products, sameClasses, 1 );
+                accumulate( productMap, iConsumer->products, sameClasses, 1 );
+                productMap[species] = 0;
+                
+                reaction combined;
+                combined.rate = iMaker->rate * iConsumer->rate / outflowRate;
+                combined.reactants = iMaker->reactants;
+                combined.products = normalize( productMap );
+                
+                if ( combined.products != combined.reactants ) others.push_back( combined );
+            }
+        }
+        
+        reducedReactions.swap( others );
+    }
+    
+    void
+    networkReduction::reduce( bool lumpSpecies,
+                              double qssaLifetime )
+    {
+        const int speciesCount = getSpeciesCount();
+        
+        std::vector<int> classOf( speciesCount, 0 );
+        if ( lumpSpecies )
+        {
+            do
+            {
+                refine( classOf );
+            }
+            while ( ! lumpReactions( classOf ) );
+        }
+        else
+        {
+            for ( int species = 0; species < speciesCount; ++species )
+            {
+                classOf[species] = species;
+            }
+            lumpReactions( classOf );
+        }
+        
+        int classCount = speciesCount ? 1 + *std::max_element( classOf.begin(),
+                                                               classOf.end() ) : 0;
+        
+        std::vector<bool> eliminated( classCount, false );
+        if ( 0.0 < qssaLifetime )
+        {
+            // Eliminating one intermediate can make or unmake others, so
+            // look again after each.
+            bool found = true;
+            while ( found )
+            {
+                found = false;
+                for ( int lumped = 0; lumped < classCount && ! found; ++lumped )
+                {
+                    if ( eliminated[lumped]
+                         || ! isFastIntermediate( lumped, qssaLifetime ) ) continue;
+                    
+                    eliminate( lumped );
+                    eliminated[lumped] = true;
+                    found = true;
+                }
+            }
+        }
+        
+        // Number the surviving classes in order of their first members.
+        std::vector<int> reducedOfClass( classCount, -1 );
+        reducedSpeciesOf.assign( speciesCount, -1 );
+        reducedMembers.clear();
+        for ( int species = 0; species < speciesCount; ++species )
+        {
+            int speciesClass = classOf[species];
+            if ( eliminated[speciesClass] ) continue;
+            
+            if ( reducedOfClass[speciesClass] < 0 )
+            {
+                reducedOfClass[speciesClass] = reducedMembers.size();
+                reducedMembers.push_back( std::vector<int>() );
+            }
+            reducedSpeciesOf[species] = reducedOfClass[speciesClass];
+            reducedMembers[reducedOfClass[speciesClass]].push_back( species );
+        }
+        
+        // Renumber the reactions' species, merging reactions that have
+        // become the same.
+        std::map<std::pair<speciesCounts, speciesCounts>, int> reactionsByPattern;
+        std::vector<reaction> merged;
+        for ( std::vector<reaction>::const_iterator iReaction = reducedReactions.begin();
+              iReaction != reducedReactions.end();
+              ++iReaction )
+        {
+            reaction renumbered;
+            renumbered.rate = iReaction->rate;
+            renumbered.reactants = classCounts( iReaction->reactants, reducedOfClass );
+            renumbered.products = classCounts( iReaction->products, reducedOfClass );
+            
+            std::pair<std::map<std::pair<speciesCounts, speciesCounts>, int>::iterator, bool> insertResult
+                = reactionsByPattern.insert( std::make_pair( std::make_pair( renumbered.reactants,
+                                                                             renumbered.products ),
+                                                             ( int ) merged.size() ) );
+            if ( insertResult.second ) merged.push_back( renumbered );
+            else merged[insertResult.first->second].rate += renumbered.rate;
+        }
+        reducedReactions.swap( merged );
+    }
+    
+    std::string
+    networkReduction::getReducedName( int reducedSpecies ) const
+    {
+        const std::vector<int>& rMembers = reducedMembers[reducedSpecies];
+        
+        std::string name;
+        for ( std::vector<int>::const_iterator iMember = rMembers.begin();
+              iMember != rMembers.end();
+              ++iMember )
+        {
+            if ( iMember != rMembers.begin() ) name += '|';
+            name += speciesNames[*iMember];
+        }
+        return name;
+    }
+    
+    void
+    networkReduction::write( std::ostream& rOs ) const
+    {
+        for ( std::vector<reaction>::const_iterator iReaction = reducedReactions.begin();
+              iReaction != reducedReactions.end();
+              ++iReaction )
+        {
+            for ( int side = 0; side < 2; ++side )
+            {
+                const speciesCounts& rCounts = side ? iReaction->products : iReaction->reactants;
+                for ( speciesCounts::const_iterator iEntry = rCounts.begin();
+                      iEntry != rCounts.end();
+                      ++iEntry )
+                {
+                    if ( iEntry != rCounts.begin() ) rOs << " + ";
+                    if ( 1 < iEntry->second ) rOs << iEntry->second << ' ';
+                    rOs << getReducedName( iEntry->first );
+                }
+                if ( ! side ) rOs << " -> ";
+            }
+            rOs << '\t'
+                << iReaction->rate
+                << std::endl;
+        }
+        
+        for ( int species = 0; species < getSpeciesCount(); ++species )
+        {
+            if ( reducedSpeciesOf[species] < 0 )
+            {
+                rOs << "eliminated\t"
+                    << speciesNames[species]
+                    << std::endl;
+            }
+        }
+    }
+}
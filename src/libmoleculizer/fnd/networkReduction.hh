@@ -0,0 +1,255 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_NETWORKREDUCTION_H
+#define FND_NETWORKREDUCTION_H
+
+/*! \file networkReduction.hh
+  \ingroup chemGroup
+  \brief Smaller networks, by lumping species and eliminating fast
+  intermediates.
+  
+  The network is taken as mass-action ODEs in concentrations, with a
+  reaction's velocity its rate times the product of its reactants'
+  concentrations, each raised to its multiplicity, as in
+  forwardSensitivity.
+  
+  Lumping replaces a set of species by their total, when the total's
+  dynamics are exact: the species must take part in reactions of the
+  same pattern at the same rates, where patterns are taken up to
+  lumping.  For example, if A1 and A2 are lumped into A, and B1 and B2
+  into B, then A1 + B1, A1 + B2, A2 + B1 and A2 + B2 must all react at
+  the same rate to lumped products of the same pattern, giving one
+  reaction A + B in the reduced network.
+  
+  Elimination is the quasi-steady-state approximation for intermediates
+  that are made and consumed by first-order reactions only, and whose
+  lifetime, the inverse of the total rate at which they're consumed, is
+  below a tolerance.  Each reaction making the intermediate is combined
+  with each reaction consuming it, at the making reaction's rate times
+  the consuming reaction's share of the intermediate's outflow.  Any
+  initial amount of an eliminated species is lost.
+  
+  Reduced species remember the original species they stand for, for
+  reporting. */
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "fnd/reactionNetworkDescription.hh"
+
+namespace fnd
+{
+    class networkReduction
+    {
+    public:
+        // (species index, multiplicity) for each species in a reaction, in
+        // order of species index.
+        typedef std::vector<std::pair<int, int> > speciesCounts;
+        
+        class reaction
+        {
+        public:
+            double rate;
+            speciesCounts reactants;
+            speciesCounts products;
+        };
+        
+        networkReduction( void );
+        
+        // Returns the species' index.
+        int
+        addSpecies( const std::string& rName );
+        
+        int
+        addReaction( double rate,
+                     const speciesCounts& rReactants,
+                     const speciesCounts& rProducts );
+        
+        // Lumps species if lumpSpecies is set, and then eliminates
+        // intermediates whose lifetime is less than qssaLifetime, if it is
+        // positive.  Reducing again starts over from the original network.
+        void
+        reduce( bool lumpSpecies,
+                double qssaLifetime = 0.0 );
+        
+        int
+        getSpeciesCount( void ) const
+        {
+            return speciesNames.size();
+        }
+        
+        const std::string&
+        getSpeciesName( int species ) const
+        {
+            return speciesNames[species];
+        }
+        
+        int
+        getReactionCount( void ) const
+        {
+            return reactions.size();
+        }
+        
+        // As added, with the species of each side in order.
+        const reaction&
+        getReaction( int reaction ) const
+        {
+            return reactions[reaction];
+        }
+        
+        // The reduced network.
+        
+        int
+        getReducedSpeciesCount( void ) const
+        {
+            return reducedMembers.size();
+        }
+        
+        // The original species' reduced species, or -1 if it was
+        // eliminated.
+        int
+        getReducedSpecies( int species ) const
+        {
+            return reducedSpeciesOf[species];
+        }
+        
+        // The original species that the reduced species stands for.
+        const std::vector<int>&
+        getMembers( int reducedSpecies ) const
+        {
+            return reducedMembers[reducedSpecies];
+        }
+        
+        // The members' names, separated by '|'.
+        std::string
+        getReducedName( int reducedSpecies ) const;
+        
+        int
+        getReducedReactionCount( void ) const
+        {
+            return reducedReactions.size();
+        }
+        
+        const reaction&
+        getReducedReaction( int reducedReaction ) const
+        {
+            return reducedReactions[reducedReaction];
+        }
+        
+        // The reduced reactions, one per line, and then each eliminated
+        // species.
+        void
+        write( std::ostream& rOs ) const;
+        
+    private:
+        std::vector<std::string> speciesNames;
+        std::vector<reaction> reactions;
+        
+        std::vector<int> reducedSpeciesOf;
+        std::vector<std::vector<int> > reducedMembers;
+        std::vector<reaction> reducedReactions;
+        
+        // Sets classOf so that species in the same class have the same
+        // reaction patterns, given the classes.
+        void
+        refine( std::vector<int>& rClassOf ) const;
+        
+        // Makes the reduced reactions from the classes, if every reaction
+        // pattern is exact.  Otherwise, breaks up the classes involved in
+        // patterns that aren't exact, and returns false.
+        bool
+        lumpReactions( std::vector<int>& rClassOf );
+        
+        bool
+        isFastIntermediate( int species,
+                            double qssaLifetime ) const;
+        
+        void
+        eliminate( int species );
+    };
+    
+    // Adds all the network's species and reactions.  The species are
+    // numbered in catalog order, and rSpeciesByIndex is filled to
+    // match.
+    template<class speciesType,
+             class reactionType>
+    void
+    addReactionNetwork( networkReduction& rReduction,
+                        const ReactionNetworkDescription<speciesType, reactionType>& rNetwork,
+                        std::vector<const speciesType*>& rSpeciesByIndex )
+    {
+        typedef ReactionNetworkDescription<speciesType, reactionType> networkType;
+        typedef typename basicReaction<speciesType>::multMap multMap;
+        
+        std::map<const speciesType*, int> indicesBySpecies;
+        
+        const typename networkType::SpeciesCatalog& rCatalog = rNetwork.getSpeciesCatalog();
+        for ( typename networkType::SpeciesCatalog::const_iterator iEntry = rCatalog.begin();
+              iEntry != rCatalog.end();
+              ++iEntry )
+        {
+            const speciesType* pSpecies = iEntry->second;
+            
+            indicesBySpecies.insert( std::make_pair( pSpecies,
+                                                     rReduction.addSpecies( pSpecies->getName() ) ) );
+            rSpeciesByIndex.push_back( pSpecies );
+        }
+        
+        const typename networkType::ReactionList& rReactions = rNetwork.getReactionList();
+        for ( typename networkType::ReactionList::const_iterator iReaction = rReactions.begin();
+              iReaction != rReactions.end();
+              ++iReaction )
+        {
+            networkReduction::speciesCounts reactants;
+            const multMap& rReactantMap = ( *iReaction )->getReactants();
+            for ( typename multMap::const_iterator iReactant = rReactantMap.begin();
+                  iReactant != rReactantMap.end();
+                  ++iReactant )
+            {
+                reactants.push_back( std::make_pair( indicesBySpecies[iReactant->first],
+                                                     iReactant->second ) );
+            }
+            
+            networkReduction::speciesCounts products;
+            const multMap& rProductMap = ( *iReaction )->getProducts();
+            for ( typename multMap::const_iterator iProduct = rProductMap.begin();
+                  iProduct != rProductMap.end();
+                  ++iProduct )
+            {
+                products.push_back( std::make_pair( indicesBySpecies[iProduct->first],
+                                                    iProduct->second ) );
+            }
+            
+            rReduction.addReaction( ( *iReaction )->getRate(),
+                                    reactants,
+                                    products );
+        }
+    }
+}
+
+#endif // FND_NETWORKREDUCTION_H
@@ -0,0 +1,644 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_NETWORKSNAPSHOT_H
+#define FND_NETWORKSNAPSHOT_H
+
+/*! \file networkSnapshot.hh
+  \brief Immutable, versioned views of a reaction network.
+  
+  The catalogs in ReactionNetworkDescription are changed in place while
+  the network is expanded, so nothing can read them while expansion is
+  going on in another thread.  A snapshot is a copy of the species,
+  reactions and reaction-by-substrate indices as of one publication,
+  which never changes afterward.  Readers in any thread take the current
+  snapshot without locking; the expanding thread publishes a new one
+  after it has added to the network.
+  
+  Publication doesn't copy the network.  Each index in a snapshot is a
+  list of sorted runs that are shared with the snapshots before it;
+  publishing adds a run holding just the new entries, and then merges
+  the smallest runs, as a binary counter carries, so that an entry is
+  merged O(log n) times and a lookup searches O(log n) runs.
+  
+  Snapshots and runs are only created and destroyed by the publishing
+  thread.  A snapshot that has been superseded is destroyed at a later
+  publication, once no reader holds it. */
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace fnd
+{
+    // A sorted, immutable array of (key, value) entries, shared by all the
+    // snapshot indices that contain it.
+    template<class keyT,
+             class valueT>
+    class snapshotRun
+    {
+    public:
+        typedef std::pair<keyT, valueT> entry;
+        
+        class entryKeyLess
+        {
+        public:
+            bool
+            operator()( const entry& rLeft,
+                        const entry& rRight ) const
+            {
+                return rLeft.first < rRight.first;
+            }
+        };
+        
+        std::vector<entry> entries;
+        
+        // How many indices hold this run.
+        int holderCount;
+        
+        snapshotRun( void ) :
+            holderCount( 0 )
+        {}
+    };
+    
+    // An immutable multimap made of shared runs, oldest first.  Entries
+    // with the same key come out in the order they were added.
+    template<class keyT,
+             class valueT>
+    class snapshotIndex
+    {
+    public:
+        typedef snapshotRun<keyT, valueT> runType;
+        typedef typename runType::entry entry;
+        typedef typename runType::entryKeyLess entryKeyLess;
+        
+    private:
+        std::vector<runType*> runs;
+        size_t entryCount;
+        
+        void
+        holdRun( runType* pRun )
+        {
+            ++pRun->holderCount;
+            runs.push_back( pRun );
+        }
+        
+    public:
+        snapshotIndex( void ) :
+            entryCount( 0 )
+        {}
+        
+        size_t
+        size( void ) const
+        {
+            return entryCount;
+        }
+        
+        // Makes this empty index hold the entries of rOlder followed by
+        // rNewEntries, which are sorted (stably) in the process.
+        void
+        extend( const snapshotIndex& rOlder,
+                std::vector<entry>& rNewEntries )
+        {
+            for ( typename std::vector<runType*>::const_iterator iRun = rOlder.runs.begin();
+                  iRun != rOlder.runs.end();
+                  ++iRun )
+            {
+                holdRun( *iRun );
+            }
+            entryCount = rOlder.entryCount + rNewEntries.size();
+            
+            if ( rNewEntries.empty() ) return;
+            
+            runType* pNewRun = new runType();
+            pNewRun->entries.swap( rNewEntries );
+            std::stable_sort( pNewRun->entries.begin(),
+                              pNewRun->entries.end(),
+                              entryKeyLess() );
+            holdRun( pNewRun );
+            
+            // Merge the last two runs while the older is no bigger.
+            while ( 2 <= runs.size()
+                    && runs[runs.size() - 2]->entries.size() <= runs.back()->entries.size() )
+            {
+                runType* pNewer = runs.back();
+                runs.pop_back();
+                runType* pOlder = runs.back();
+                runs.pop_back();
+                
+                runType* pMerged = new runType();
+                pMerged->entries.reserve( pOlder->entries.size() + pNewer->entries.size() );
+                std::merge( pOlder->entries.begin(),
+                            pOlder->entries.end(),
+                            pNewer->entries.begin(),
+                            pNewer->entries.end(),
+                            std::back_inserter( pMerged->entries ),
+                            entryKeyLess() );
+                
+                dropRun( pOlder );
+                dropRun( pNewer );
+                holdRun( pMerged );
+            }
+        }
+        
+        static void
+        dropRun( runType* pRun )
+        {
+            if ( 0 == --pRun->holderCount ) delete pRun;
+        }
+        
+        // Lets go of the runs; for the publishing thread only.
+        void
+        release( void )
+        {
+            std::for_each( runs.begin(),
+                           runs.end(),
+                           dropRun );
+            runs.clear();
+            entryCount = 0;
+        }
+        
+        template<class outputIterT>
+        void
+        findAll( const keyT& rKey,
+                 outputIterT output ) const
+        {
+            entry probe( rKey, valueT() );
+            
+            for ( typename std::vector<runType*>::const_iterator iRun = runs.begin();
+                  iRun != runs.end();
+                  ++iRun )
+            {
+                const std::vector<entry>& rEntries = ( *iRun )->entries;
+                typename std::vector<entry>::const_iterator iEntry
+                    = std::lower_bound( rEntries.begin(),
+                                        rEntries.end(),
+                                        probe,
+                                        entryKeyLess() );
+                
+                while ( iEntry != rEntries.end() && ! ( rKey < iEntry->first ) )
+                {
+                    *output++ = iEntry->second;
+                    ++iEntry;
+                }
+            }
+        }
+        
+        bool
+        findFirst( const keyT& rKey,
+                   valueT& rValue ) const
+        {
+            entry probe( rKey, valueT() );
+            
+            for ( typename std::vector<runType*>::const_iterator iRun = runs.begin();
+                  iRun != runs.end();
+                  ++iRun )
+            {
+                const std::vector<entry>& rEntries = ( *iRun )->entries;
+                typename std::vector<entry>::const_iterator iEntry
+                    = std::lower_bound( rEntries.begin(),
+                                        rEntries.end(),
+                                        probe,
+                                        entryKeyLess() );
+                
+                if ( iEntry != rEntries.end() && ! ( rKey < iEntry->first ) )
+                {
+                    rValue = iEntry->second;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+    
+    template<class speciesT,
+             class reactionT>
+    class snapshotPublisher;
+    
+    // One published version of the network.
+    template<class speciesT,
+             class reactionT>
+    class networkSnapshot
+    {
+        friend class snapshotPublisher<speciesT, reactionT>;
+        
+        long version;
+        
+        snapshotIndex<long, speciesT*> speciesByOrdinal;
+        snapshotIndex<std::string, speciesT*> speciesByTag;
+        snapshotIndex<std::string, speciesT*> speciesByID;
+        snapshotIndex<long, std::string> speciesIDsByOrdinal;
+        
+        snapshotIndex<long, reactionT*> reactionsByOrdinal;
+        snapshotIndex<const speciesT*, reactionT*> singleSubstrateRxns;
+        snapshotIndex<const speciesT*, reactionT*> doubleSubstrateRxns;
+        snapshotIndex<const speciesT*, reactionT*> autoDimerizationRxns;
+        
+        // Handles to this snapshot that readers hold.  Changed atomically.
+        mutable int readerCount;
+        
+        networkSnapshot( long versionNumber ) :
+            version( versionNumber ),
+            readerCount( 0 )
+        {}
+        
+        void
+        release( void )
+        {
+            speciesByOrdinal.release();
+            speciesByTag.release();
+            speciesByID.release();
+            speciesIDsByOrdinal.release();
+            reactionsByOrdinal.release();
+            singleSubstrateRxns.release();
+            doubleSubstrateRxns.release();
+            autoDimerizationRxns.release();
+        }
+        
+    public:
+        // Counts publications, starting from 0 for the empty network.
+        long
+        getVersion( void ) const
+        {
+            return version;
+        }
+        
+        size_t
+        getSpeciesCount( void ) const
+        {
+            return speciesByOrdinal.size();
+        }
+        
+        size_t
+        getReactionCount( void ) const
+        {
+            return reactionsByOrdinal.size();
+        }
+        
+        // Species and reactions are numbered in the order they were
+        // recorded.
+        speciesT*
+        getSpecies( long ordinal ) const
+        {
+            speciesT* pSpecies = 0;
+            speciesByOrdinal.findFirst( ordinal,
+                                        pSpecies );
+            return pSpecies;
+        }
+        
+        // The ID the species was recorded under, so that readers needn't
+        // ask the species itself, which may still be changing.
+        std::string
+        getSpeciesID( long ordinal ) const
+        {
+            std::string speciesID;
+            speciesIDsByOrdinal.findFirst( ordinal,
+                                           speciesID );
+            return speciesID;
+        }
+        
+        reactionT*
+        getReaction( long ordinal ) const
+        {
+            reactionT* pReaction = 0;
+            reactionsByOrdinal.findFirst( ordinal,
+                                          pReaction );
+            return pReaction;
+        }
+        
+        // These return null for an unknown species.
+        speciesT*
+        findSpecies( const std::string& rTag ) const
+        {
+            speciesT* pSpecies = 0;
+            speciesByTag.findFirst( rTag,
+                                    pSpecies );
+            return pSpecies;
+        }
+        
+        speciesT*
+        findSpeciesByID( const std::string& rID ) const
+        {
+            speciesT* pSpecies = 0;
+            speciesByID.findFirst( rID,
+                                   pSpecies );
+            return pSpecies;
+        }
+        
+        // Like ReactionNetworkDescription::findReactionWithSubstrates,
+        // but these never expand the network: a species that hadn't been
+        // expanded at publication just has no reactions yet.
+        bool
+        findReactionWithSubstrates( const speciesT* A,
+                                    std::vector<const reactionT*>& reactionVector ) const
+        {
+            size_t originalSize = reactionVector.size();
+            singleSubstrateRxns.findAll( A,
+                                         std::back_inserter( reactionVector ) );
+            return reactionVector.size() != originalSize;
+        }
+        
+        bool
+        findReactionWithSubstrates( const speciesT* A,
+                                    const speciesT* B,
+                                    std::vector<const reactionT*>& reactionVector ) const
+        {
+            size_t originalSize = reactionVector.size();
+            
+            if ( A != B )
+            {
+                std::vector<const reactionT*> rxnsWithASubstrate;
+                std::vector<const reactionT*> rxnsWithBSubstrate;
+                doubleSubstrateRxns.findAll( A,
+                                             std::back_inserter( rxnsWithASubstrate ) );
+                doubleSubstrateRxns.findAll( B,
+                                             std::back_inserter( rxnsWithBSubstrate ) );
+                
+                std::sort( rxnsWithASubstrate.begin(),
+                           rxnsWithASubstrate.end() );
+                std::sort( rxnsWithBSubstrate.begin(),
+                           rxnsWithBSubstrate.end() );
+                std::set_intersection( rxnsWithASubstrate.begin(), rxnsWithASubstrate.end(),
+                                       rxnsWithBSubstrate.begin(), rxnsWithBSubstrate.end(),
+                                       std::back_inserter( reactionVector ) );
+            }
+            else
+            {
+                autoDimerizationRxns.findAll( A,
+                                              std::back_inserter( reactionVector ) );
+            }
+            
+            return reactionVector.size() != originalSize;
+        }
+    };
+    
+    // Owns the published snapshots.  Recording and publishing are for the
+    // expanding thread only; acquire may be called from any thread.
+    template<class speciesT,
+             class reactionT>
+    class snapshotPublisher
+    {
+    public:
+        typedef networkSnapshot<speciesT, reactionT> snapshotType;
+        
+        // Keeps a snapshot from being destroyed.  Handles must be let go
+        // before the publisher is destroyed.
+        class handle
+        {
+            const snapshotType* pSnapshot;
+            
+            void
+            hold( void )
+            {
+                if ( pSnapshot ) __sync_fetch_and_add( &pSnapshot->readerCount, 1 );
+            }
+            
+            void
+            letGo( void )
+            {
+                if ( pSnapshot ) __sync_fetch_and_sub( &pSnapshot->readerCount, 1 );
+            }
+            
+        public:
+            // Takes over a hold that has already been counted.
+            explicit
+            handle( const snapshotType* pHeldSnapshot = 0 ) :
+                pSnapshot( pHeldSnapshot )
+            {}
+            
+            handle( const handle& rOther ) :
+                pSnapshot( rOther.pSnapshot )
+            {
+                hold();
+            }
+            
+            handle&
+            operator=( const handle& rOther )
+            {
+                if ( pSnapshot != rOther.pSnapshot )
+                {
+                    letGo();
+                    pSnapshot = rOther.pSnapshot;
+                    hold();
+                }
+                return *this;
+            }
+            
+            ~handle( void )
+            {
+                letGo();
+            }
+            
+            const snapshotType*
+            get( void ) const
+            {
+                return pSnapshot;
+            }
+            
+            const snapshotType*
+            operator->( void ) const
+            {
+                return pSnapshot;
+            }
+            
+            const snapshotType&
+            operator*( void ) const
+            {
+                return *pSnapshot;
+            }
+        };
+        
+    private:
+        snapshotType* volatile pCurrent;
+        
+        // Readers between reading pCurrent and counting themselves on it.
+        // Superseded snapshots are only destroyed when this is zero.
+        mutable int acquiringCount;
+        
+        std::vector<snapshotType*> superseded;
+        
+        // Recorded since the last publication.
+        std::vector<typename snapshotIndex<long, speciesT*>::entry> newSpeciesByOrdinal;
+        std::vector<typename snapshotIndex<std::string, speciesT*>::entry> newSpeciesByTag;
+        std::vector<typename snapshotIndex<std::string, speciesT*>::entry> newSpeciesByID;
+        std::vector<typename snapshotIndex<long, std::string>::entry> newSpeciesIDsByOrdinal;
+        std::vector<typename snapshotIndex<long, reactionT*>::entry> newReactionsByOrdinal;
+        std::vector<typename snapshotIndex<const speciesT*, reactionT*>::entry> newSingleSubstrateRxns;
+        std::vector<typename snapshotIndex<const speciesT*, reactionT*>::entry> newDoubleSubstrateRxns;
+        std::vector<typename snapshotIndex<const speciesT*, reactionT*>::entry> newAutoDimerizationRxns;
+        
+        long speciesRecorded;
+        long reactionsRecorded;
+        
+        static void
+        destroySnapshot( snapshotType* pSnapshot )
+        {
+            pSnapshot->release();
+            delete pSnapshot;
+        }
+        
+        void
+        destroyUnheldSnapshots( void )
+        {
+            if ( 0 != __sync_fetch_and_add( &acquiringCount, 0 ) ) return;
+            
+            typename std::vector<snapshotType*>::iterator iKept = superseded.begin();
+            for ( typename std::vector<snapshotType*>::iterator iSnapshot = superseded.begin();
+                  iSnapshot != superseded.end();
+                  ++iSnapshot )
+            {
+                if ( 0 == __sync_fetch_and_add( &( *iSnapshot )->readerCount, 0 ) )
+                {
+                    destroySnapshot( *iSnapshot );
+                }
+                else
+                {
+                    *iKept++ = *iSnapshot;
+                }
+            }
+            superseded.erase( iKept,
+                              superseded.end() );
+        }
+        
+        snapshotPublisher( const snapshotPublisher& );
+        snapshotPublisher& operator=( const snapshotPublisher& );
+        
+    public:
+        snapshotPublisher( void ) :
+            pCurrent( new snapshotType( 0 ) ),
+            acquiringCount( 0 ),
+            speciesRecorded( 0 ),
+            reactionsRecorded( 0 )
+        {}
+        
+        ~snapshotPublisher( void )
+        {
+            std::for_each( superseded.begin(),
+                           superseded.end(),
+                           destroySnapshot );
+            destroySnapshot( pCurrent );
+        }
+        
+        void
+        recordSpecies( speciesT* pSpecies,
+                       const std::string& rTag,
+                       const std::string& rID )
+        {
+            newSpeciesIDsByOrdinal.push_back( std::make_pair( speciesRecorded, rID ) );
+            newSpeciesByOrdinal.push_back( std::make_pair( speciesRecorded++, pSpecies ) );
+            newSpeciesByTag.push_back( std::make_pair( rTag, pSpecies ) );
+            newSpeciesByID.push_back( std::make_pair( rID, pSpecies ) );
+        }
+        
+        // The reaction also has to be recorded under its substrates, with
+        // one of the functions below, as ReactionNetworkDescription
+        // classifies it.
+        void
+        recordReaction( reactionT* pRxn )
+        {
+            newReactionsByOrdinal.push_back( std::make_pair( reactionsRecorded++, pRxn ) );
+        }
+        
+        void
+        recordSingleSubstrateRxn( const speciesT* pSubstrate,
+                                  reactionT* pRxn )
+        {
+            newSingleSubstrateRxns.push_back( std::make_pair( pSubstrate, pRxn ) );
+        }
+        
+        void
+        recordDoubleSubstrateRxn( const speciesT* pSubstrate,
+                                  reactionT* pRxn )
+        {
+            newDoubleSubstrateRxns.push_back( std::make_pair( pSubstrate, pRxn ) );
+        }
+        
+        void
+        recordAutoDimerizationRxn( const speciesT* pSubstrate,
+                                   reactionT* pRxn )
+        {
+            newAutoDimerizationRxns.push_back( std::make_pair( pSubstrate, pRxn ) );
+        }
+        
+        bool
+        hasUnpublished( void ) const
+        {
+            return ! ( newSpeciesByOrdinal.empty() && newReactionsByOrdinal.empty() );
+        }
+        
+        // Makes everything recorded so far visible to readers, as one
+        // new version, if anything has been recorded since the last time.
+        void
+        publish( void )
+        {
+            if ( ! hasUnpublished() ) return;
+            
+            snapshotType* pOld = pCurrent;
+            snapshotType* pNew = new snapshotType( pOld->version + 1 );
+            
+            pNew->speciesByOrdinal.extend( pOld->speciesByOrdinal, newSpeciesByOrdinal );
+            pNew->speciesByTag.extend( pOld->speciesByTag, newSpeciesByTag );
+            pNew->speciesByID.extend( pOld->speciesByID, newSpeciesByID );
+            pNew->speciesIDsByOrdinal.extend( pOld->speciesIDsByOrdinal, newSpeciesIDsByOrdinal );
+            pNew->reactionsByOrdinal.extend( pOld->reactionsByOrdinal, newReactionsByOrdinal );
+            pNew->singleSubstrateRxns.extend( pOld->singleSubstrateRxns, newSingleSubstrateRxns );
+            pNew->doubleSubstrateRxns.extend( pOld->doubleSubstrateRxns, newDoubleSubstrateRxns );
+            pNew->autoDimerizationRxns.extend( pOld->autoDimerizationRxns, newAutoDimerizationRxns );
+            
+            newSpeciesByOrdinal.clear();
+            newSpeciesByTag.clear();
+            newSpeciesByID.clear();
+            newSpeciesIDsByOrdinal.clear();
+            newReactionsByOrdinal.clear();
+            newSingleSubstrateRxns.clear();
+            newDoubleSubstrateRxns.clear();
+            newAutoDimerizationRxns.clear();
+            
+            // The new snapshot is complete before any reader can see it.
+            __sync_synchronize();
+            pCurrent = pNew;
+            __sync_synchronize();
+            
+            superseded.push_back( pOld );
+            destroyUnheldSnapshots();
+        }
+        
+        handle
+        acquire( void ) const
+        {
+            __sync_fetch_and_add( &acquiringCount, 1 );
+            const snapshotType* pSnapshot = pCurrent;
+            __sync_fetch_and_add( &pSnapshot->readerCount, 1 );
+            __sync_fetch_and_sub( &acquiringCount, 1 );
+            
+            return handle( pSnapshot );
+        }
+    };
+}
+
+#endif // FND_NETWORKSNAPSHOT_H
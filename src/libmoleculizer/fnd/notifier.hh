@@ -115,6 +115,31 @@ namespace fnd
                 notify( notifyDepth );
             }
         }
+
+        // Marks this notifier as having already notified, without sending
+        // the notification.  This is for restoring a saved reaction network,
+        // where everything the notification would generate is read back in
+        // along with the network.
+        void
+        markNotified( int notifyDepth )
+        {
+            if (( ! notified ) && ( 0 <= notifyDepth ) )
+            {
+                notified = true;
+                
+                recordNotification( notifyDepth );
+            }
+        }
+        
+    protected:
+        // Notifiers whose notification leaves state behind in its responders
+        // (plexSpecies, whose contexts are remembered by features, for
+        // example) override this to put that state back without generating
+        // anything.
+        virtual
+        void
+        recordNotification( int /* notifyDepth */ )
+        {}
     };
 
     class onceInformer :
@@ -0,0 +1,309 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include "fnd/propensityKernel.hh"
+#include "fnd/physConst.hh"
+
+namespace fnd
+{
+    propensityKernel::propensityKernel( void )
+    {
+        for ( int form = 0; form <= formCount; ++form )
+        {
+            formBegin[form] = 0;
+        }
+    }
+    
+    int
+    propensityKernel::addReaction( double rate,
+                                   const reactantList& rReactants )
+    {
+        reactionRates.push_back( rate );
+        reactionReactants.push_back( rReactants );
+        
+        return reactionRates.size() - 1;
+    }
+    
+    propensityKernel::reactionForm
+    propensityKernel::classify( const reactantList& rReactants )
+    {
+        switch ( rReactants.size() )
+        {
+        case 0:
+            return noSubstrate;
+            
+        case 1:
+            if ( rReactants[0].second == 1 ) return firstOrder;
+            if ( rReactants[0].second == 2 ) return homodimerization;
+            return otherForm;
+            
+        case 2:
+            if ( rReactants[0].second == 1
+                 && rReactants[1].second == 1 ) return heterodimerization;
+            return otherForm;
+            
+        default:
+            return otherForm;
+        }
+    }
+    
+    void
+    propensityKernel::finish( void )
+    {
+        int reactionCount = reactionRates.size();
+        
+        std::vector<int> formOfReaction( reactionCount );
+        int formSize[formCount] = { 0 };
+        for ( int reaction = 0; reaction < reactionCount; ++reaction )
+        {
+            formOfReaction[reaction] = classify( reactionReactants[reaction] );
+            ++formSize[formOfReaction[reaction]];
+        }
+        
+        formBegin[0] = 0;
+        for ( int form = 0; form < formCount; ++form )
+        {
+            formBegin[form + 1] = formBegin[form] + formSize[form];
+        }
+        
+        slotOfReaction.resize( reactionCount );
+        reactionOfSlot.resize( reactionCount );
+        rates.resize( reactionCount );
+        firstSpecies.assign( reactionCount, -1 );
+        secondSpecies.assign( reactionCount, -1 );
+        
+        otherBegin.clear();
+        otherSpecies.clear();
+        otherMultiplicities.clear();
+        otherArities.clear();
+        slotsBySpecies.clear();
+        
+        int nextSlot[formCount];
+        std::copy( formBegin,
+                   formBegin + formCount,
+                   nextSlot );
+        
+        for ( int reaction = 0; reaction < reactionCount; ++reaction )
+        {
+            const reactantList& rReactants = reactionReactants[reaction];
+            int slot = nextSlot[formOfReaction[reaction]]++;
+            
+            slotOfReaction[reaction] = slot;
+            reactionOfSlot[slot] = reaction;
+            rates[slot] = reactionRates[reaction];
+            
+            if ( formOfReaction[reaction] == otherForm )
+            {
+                // The other slots come last, in reaction order.
+                otherBegin.push_back( otherSpecies.size() );
+                
+                int arity = 0;
+                for ( reactantList::const_iterator iReactant = rReactants.begin();
+                      iReactant != rReactants.end();
+                      ++iReactant )
+                {
+                    otherSpecies.push_back( iReactant->first );
+                    otherMultiplicities.push_back( iReactant->second );
+                    arity += iReactant->second;
+                }
+                otherArities.push_back( arity );
+            }
+            else
+            {
+                if ( 0 < rReactants.size() ) firstSpecies[slot] = rReactants[0].first;
+                if ( 1 < rReactants.size() ) secondSpecies[slot] = rReactants[1].first;
+            }
+            
+            for ( reactantList::const_iterator iReactant = rReactants.begin();
+                  iReactant != rReactants.end();
+                  ++iReactant )
+            {
+                if ( ( int ) slotsBySpecies.size() <= iReactant->first )
+                {
+                    slotsBySpecies.resize( iReactant->first + 1 );
+                }
+                slotsBySpecies[iReactant->first].push_back( slot );
+            }
+        }
+        otherBegin.push_back( otherSpecies.size() );
+    }
+    
+    void
+    propensityKernel::setRate( int reaction,
+                               double rate )
+    {
+        reactionRates[reaction] = rate;
+        if ( reaction < ( int ) slotOfReaction.size() ) rates[slotOfReaction[reaction]] = rate;
+    }
+    
+    double
+    propensityKernel::molarDivisor( double volume,
+                                    int arity )
+    {
+        return std::pow( avogadrosNumber * volume,
+                         arity - 1 );
+    }
+    
+    double
+    propensityKernel::computeOtherSlot( int slot,
+                                        const double* pPopulations,
+                                        double volume ) const
+    {
+        int other = slot - formBegin[otherForm];
+        
+        double combinations = 1.0;
+        for ( int entry = otherBegin[other]; entry < otherBegin[other + 1]; ++entry )
+        {
+            int population = ( int ) pPopulations[otherSpecies[entry]];
+            int multiplicity = otherMultiplicities[entry];
+            
+            while ( 0 < multiplicity-- ) combinations *= population--;
+        }
+        
+        return combinations * rates[slot] / molarDivisor( volume, otherArities[other] );
+    }
+    
+    double
+    propensityKernel::computeSlot( int slot,
+                                   const double* pPopulations,
+                                   double volume ) const
+    {
+        if ( slot < formBegin[firstOrder] )
+        {
+            return rates[slot] / molarDivisor( volume, 0 );
+        }
+        if ( slot < formBegin[heterodimerization] )
+        {
+            return pPopulations[firstSpecies[slot]] * rates[slot];
+        }
+        if ( slot < formBegin[homodimerization] )
+        {
+            return pPopulations[firstSpecies[slot]] * pPopulations[secondSpecies[slot]] * rates[slot]
+                / molarDivisor( volume, 2 );
+        }
+        if ( slot < formBegin[otherForm] )
+        {
+            double population = pPopulations[firstSpecies[slot]];
+            return population * ( population - 1.0 ) * rates[slot]
+                / molarDivisor( volume, 2 );
+        }
+        
+        return computeOtherSlot( slot,
+                                 pPopulations,
+                                 volume );
+    }
+    
+    void
+    propensityKernel::computeAll( const double* pPopulations,
+                                  double volume,
+                                  double* pPropensities ) const
+    {
+        // Populations are gathered into the propensity array first, and
+        // the arithmetic then done over contiguous arrays, which the
+        // compiler can vectorize; __restrict__ tells it that the arrays
+        // don't overlap.
+        const double* __restrict__ pRates = rates.empty() ? 0 : &rates[0];
+        const int* __restrict__ pFirst = firstSpecies.empty() ? 0 : &firstSpecies[0];
+        const int* __restrict__ pSecond = secondSpecies.empty() ? 0 : &secondSpecies[0];
+        const double* __restrict__ pPops = pPopulations;
+        double* __restrict__ pOut = pPropensities;
+        
+        const double noSubstrateDivisor = molarDivisor( volume, 0 );
+        const double dimerDivisor = molarDivisor( volume, 2 );
+        
+        const int firstOrderBegin = formBegin[firstOrder];
+        const int heterodimerizationBegin = formBegin[heterodimerization];
+        const int homodimerizationBegin = formBegin[homodimerization];
+        const int otherFormBegin = formBegin[otherForm];
+        
+        for ( int slot = firstOrderBegin; slot < heterodimerizationBegin; ++slot )
+        {
+            pOut[slot] = pPops[pFirst[slot]];
+        }
+        for ( int slot = heterodimerizationBegin; slot < homodimerizationBegin; ++slot )
+        {
+            pOut[slot] = pPops[pFirst[slot]] * pPops[pSecond[slot]];
+        }
+        for ( int slot = homodimerizationBegin; slot < otherFormBegin; ++slot )
+        {
+            pOut[slot] = pPops[pFirst[slot]];
+        }
+        
+        for ( int slot = 0; slot < firstOrderBegin; ++slot )
+        {
+            pOut[slot] = pRates[slot] / noSubstrateDivisor;
+        }
+        
+        for ( int slot = firstOrderBegin; slot < heterodimerizationBegin; ++slot )
+        {
+            pOut[slot] = pOut[slot] * pRates[slot];
+        }
+        
+        for ( int slot = heterodimerizationBegin; slot < homodimerizationBegin; ++slot )
+        {
+            pOut[slot] = pOut[slot] * pRates[slot] / dimerDivisor;
+        }
+        
+        for ( int slot = homodimerizationBegin; slot < otherFormBegin; ++slot )
+        {
+            double population = pOut[slot];
+            pOut[slot] = population * ( population - 1.0 ) * pRates[slot] / dimerDivisor;
+        }
+        
+        for ( int slot = otherFormBegin; slot < formBegin[formCount]; ++slot )
+        {
+            pOut[slot] = computeOtherSlot( slot,
+                                           pPopulations,
+                                           volume );
+        }
+    }
+    
+    void
+    propensityKernel::updateForSpecies( const std::vector<int>& rChangedSpecies,
+                                        const double* pPopulations,
+                                        double volume,
+                                        double* pPropensities ) const
+    {
+        for ( std::vector<int>::const_iterator iSpecies = rChangedSpecies.begin();
+              iSpecies != rChangedSpecies.end();
+              ++iSpecies )
+        {
+            if ( ( int ) slotsBySpecies.size() <= *iSpecies ) continue;
+            
+            const std::vector<int>& rSlots = slotsBySpecies[*iSpecies];
+            for ( std::vector<int>::const_iterator iSlot = rSlots.begin();
+                  iSlot != rSlots.end();
+                  ++iSlot )
+            {
+                pPropensities[*iSlot] = computeSlot( *iSlot,
+                                                     pPopulations,
+                                                     volume );
+            }
+        }
+    }
+}
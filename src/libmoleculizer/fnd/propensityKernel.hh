@@ -0,0 +1,192 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_PROPENSITYKERNEL_H
+#define FND_PROPENSITYKERNEL_H
+
+/*! \file propensityKernel.hh
+  \ingroup chemGroup
+  \brief Propensities of many reactions at once, from flat arrays.
+  
+  gillspReaction::propensity walks its reactant map for each reaction.
+  The kernel keeps rates and reactant indices in arrays instead, with
+  the reactions grouped by form (no substrate, A, A + B, A + A, and
+  anything else), so that each group is one simple loop the compiler
+  can vectorize.  Populations are given as an array indexed by species.
+  
+  The results are the same, to the bit, as gillspReaction::propensity,
+  since the same products are formed in the same order.
+  
+  A reaction's propensity lives at its slot in the propensity array.
+  Slots are assigned when finish() is called, after all the reactions
+  have been added; getSlot maps reactions, numbered in the order they
+  were added, to slots. */
+
+#include <vector>
+#include <utility>
+#include "fnd/gillspReaction.hh"
+
+namespace fnd
+{
+    class propensityKernel
+    {
+    public:
+        // (species index, multiplicity) for each reactant.
+        typedef std::vector<std::pair<int, int> > reactantList;
+        
+        propensityKernel( void );
+        
+        // Returns the reaction's number.
+        int
+        addReaction( double rate,
+                     const reactantList& rReactants );
+        
+        // Groups the reactions and assigns their slots.  More reactions can
+        // be added afterward, but finish must be called again, and the
+        // slots change.
+        void
+        finish( void );
+        
+        int
+        getReactionCount( void ) const
+        {
+            return reactionRates.size();
+        }
+        
+        int
+        getSlot( int reaction ) const
+        {
+            return slotOfReaction[reaction];
+        }
+        
+        int
+        getReaction( int slot ) const
+        {
+            return reactionOfSlot[slot];
+        }
+        
+        void
+        setRate( int reaction,
+                 double rate );
+        
+        // Fills the propensity array, with one entry per slot.
+        void
+        computeAll( const double* pPopulations,
+                    double volume,
+                    double* pPropensities ) const;
+        
+        // Recomputes only the propensities of reactions with one of the
+        // given species as a reactant.
+        void
+        updateForSpecies( const std::vector<int>& rChangedSpecies,
+                          const double* pPopulations,
+                          double volume,
+                          double* pPropensities ) const;
+        
+        double
+        computeSlot( int slot,
+                     const double* pPopulations,
+                     double volume ) const;
+        
+    private:
+        // As the reactions were added.
+        std::vector<double> reactionRates;
+        std::vector<reactantList> reactionReactants;
+        
+        std::vector<int> slotOfReaction;
+        std::vector<int> reactionOfSlot;
+        
+        // Slots of each group are contiguous, in this order.
+        enum reactionForm
+        {
+            noSubstrate,
+            firstOrder,
+            heterodimerization,
+            homodimerization,
+            otherForm,
+            formCount
+        };
+        
+        // The first slot of each form, and one past the last slot.
+        int formBegin[formCount + 1];
+        
+        // By slot.  firstSpecies and secondSpecies are -1 where unused.
+        std::vector<double> rates;
+        std::vector<int> firstSpecies;
+        std::vector<int> secondSpecies;
+        
+        // Reactants of otherForm slots, starting from otherBegin[slot -
+        // formBegin[otherForm]].
+        std::vector<int> otherBegin;
+        std::vector<int> otherSpecies;
+        std::vector<int> otherMultiplicities;
+        std::vector<int> otherArities;
+        
+        // Slots in which each species is a reactant.
+        std::vector<std::vector<int> > slotsBySpecies;
+        
+        static reactionForm
+        classify( const reactantList& rReactants );
+        
+        // pow( avogadrosNumber * volume, arity - 1 ), as in
+        // gillspReaction::propensity.
+        static double
+        molarDivisor( double volume,
+                      int arity );
+        
+        double
+        computeOtherSlot( int slot,
+                          const double* pPopulations,
+                          double volume ) const;
+    };
+    
+    // Adds a reaction, with the species numbered by speciesIndex, a
+    // function taking a species pointer and returning its index.
+    template<class speciesType,
+             class speciesIndexFunction>
+    int
+    addGillspReaction( propensityKernel& rKernel,
+                       const gillspReaction<speciesType>& rReaction,
+                       speciesIndexFunction speciesIndex )
+    {
+        propensityKernel::reactantList reactants;
+        
+        const typename gillspReaction<speciesType>::multMap& rReactantMap
+            = rReaction.getReactants();
+        for ( typename gillspReaction<speciesType>::multMap::const_iterator iReactant = rReactantMap.begin();
+              iReactant != rReactantMap.end();
+              ++iReactant )
+        {
+            reactants.push_back( std::make_pair( speciesIndex( iReactant->first ),
+                                                 iReactant->second ) );
+        }
+        
+        return rKernel.addReaction( rReaction.getRate(),
+                                    reactants );
+    }
+}
+
+#endif // FND_PROPENSITYKERNEL_H
@@ -81,6 +81,12 @@ namespace fnd
             queries.push_back( pQuery );
         }
         
+        const std::vector<const queryT*>&
+        getQueries( void ) const
+        {
+            return queries;
+        }
+        
         bool
         operator()( const typename queryT::argType& rArg ) const;
     };
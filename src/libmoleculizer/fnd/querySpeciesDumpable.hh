@@ -62,16 +62,18 @@ namespace fnd
         {}
         
         // Overrides multiSpeciesDumpable::respond so that only species
-        // that pass the test get onto the dump list.
+        // that pass the test get onto the dump list.  Species already on
+        // the list aren't queried again.
         void
         respond( const newSpeciesStimulus<speciesT>& rStimulus )
         {
             const speciesT* pNewSpecies
                 = rStimulus.getSpecies();
             
-            if ( rQuery( *pNewSpecies ) )
+            if ( ( ! this->speciesInSpeciesStream( pNewSpecies ) )
+                 && rQuery( *pNewSpecies ) )
             {
-                this->dumpedSpecies.push_back( pNewSpecies );
+                this->addDumpedSpecies( pNewSpecies );
             }
         }
     };
@@ -0,0 +1,216 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef FND_RATEMEMO_H
+#define FND_RATEMEMO_H
+
+/*! \file rateMemo.hh
+  \ingroup rxnGenGroup
+  \brief Memoizes extrapolated reaction rates. */
+
+#include <map>
+#include "fnd/memoryAccount.hh"
+
+namespace fnd
+{
+    class expansionProfiler;
+    
+    /*! \ingroup rxnGenGroup
+      \brief Switch and process-wide counters for rate memos.
+      
+      The counters total the hits and misses of all the rate memos, so
+      that the hit rate of memoization over an expansion can be
+      reported.  This is process-wide state that is not thread-safe.  Memoization is on by default; turning it off
+      makes every extrapolator compute every rate, which is useful for
+      checking that memoized rates are the same. */
+    class rateMemoStats
+    {
+        static bool enabled;
+        static unsigned long hits;
+        static unsigned long misses;
+        
+    public:
+        static void
+        setEnabled( bool enable )
+        {
+            enabled = enable;
+        }
+        
+        static bool
+        isEnabled( void )
+        {
+            return enabled;
+        }
+        
+        static unsigned long
+        getHits( void )
+        {
+            return hits;
+        }
+        
+        static unsigned long
+        getMisses( void )
+        {
+            return misses;
+        }
+        
+        static void
+        reset( void )
+        {
+            hits = 0;
+            misses = 0;
+        }
+        
+        // Also counts the hit in the expansion profiler, if there is one
+        // and it is on.
+        static void
+        noteHit( expansionProfiler* pProfiler );
+        
+        static void
+        noteMiss( void )
+        {
+            ++misses;
+        }
+    };
+    
+    /*! \ingroup rxnGenGroup
+      \brief Memo of the rates extrapolated for one reaction rule.
+      
+      An extrapolator's rate depends only on a few quantities that it
+      reads from the reaction context, such as the weights of the
+      reactants or the shapes of the reacting binding sites, and many of
+      the reactions generated by a rule share them.  An extrapolator keeps
+      one of these keyed on exactly those quantities, so a remembered rate
+      is the very double that the extrapolator would compute.  Where the
+      rate also depends on something that seldom repeats, such as the
+      weights of dimerizing complexes, the extrapolator remembers only the
+      part that the key determines and finishes the calculation each time.
+      
+      Remembered rates are charged to the memoryAccount given at
+      construction, if any, and refunded when they are forgotten.  Hits
+      are counted in the expansionProfiler given at construction, if any. */
+    template<class keyT>
+    class rateMemo
+    {
+        typedef std::map<keyT, double> memoType;
+        memoType memo;
+        
+        unsigned long hits;
+        unsigned long misses;
+        
+        memoryAccount* pAccount;
+        
+        expansionProfiler* pProfiler;
+        
+        static std::size_t
+        entryBytes( void )
+        {
+            return memoryAccount::treeNodeBytes( sizeof( typename memoType::value_type ) );
+        }
+        
+    public:
+        rateMemo( memoryAccount* pMemoryAccount = 0,
+                  expansionProfiler* pExpansionProfiler = 0 ) :
+            hits( 0 ),
+            misses( 0 ),
+            pAccount( pMemoryAccount ),
+            pProfiler( pExpansionProfiler )
+        {}
+        
+        // Returns the remembered rate for the key, or null if there is none
+        // or memoization is off.  Counts the lookup as a hit or a miss.
+        const double*
+        find( const keyT& rKey )
+        {
+            if ( ! rateMemoStats::isEnabled() ) return 0;
+            
+            typename memoType::const_iterator iEntry = memo.find( rKey );
+            if ( memo.end() == iEntry )
+            {
+                ++misses;
+                rateMemoStats::noteMiss();
+                return 0;
+            }
+            
+            ++hits;
+            rateMemoStats::noteHit( pProfiler );
+            return & ( iEntry->second );
+        }
+        
+        double
+        remember( const keyT& rKey,
+                  double rate )
+        {
+            if ( ! rateMemoStats::isEnabled() ) return rate;
+            
+            std::pair<typename memoType::iterator, bool> insertResult
+                = memo.insert( std::make_pair( rKey,
+                                               rate ) );
+            if ( ! insertResult.second )
+            {
+                insertResult.first->second = rate;
+            }
+            else if ( pAccount )
+            {
+                pAccount->charge( memoryAccount::RATE_MEMOS,
+                                  entryBytes() );
+            }
+            return rate;
+        }
+        
+        // For when the parameters the rates were computed from change.
+        void
+        forget( void )
+        {
+            if ( pAccount )
+            {
+                pAccount->refund( memoryAccount::RATE_MEMOS,
+                                  memo.size() * entryBytes() );
+            }
+            memo.clear();
+        }
+        
+        typename memoType::size_type
+        size( void ) const
+        {
+            return memo.size();
+        }
+        
+        unsigned long
+        getHits( void ) const
+        {
+            return hits;
+        }
+        
+        unsigned long
+        getMisses( void ) const
+        {
+            return misses;
+        }
+    };
+}
+
+#endif // FND_RATEMEMO_H
@@ -36,13 +36,18 @@
 #include "fnd/fndXcpt.hh"
 #include "fnd/basicReaction.hh"
 #include "fnd/basicSpecies.hh"
+#include "fnd/networkSnapshot.hh"
+#include "fnd/memoryAccount.hh"
+#include "fnd/expansionProfiler.hh"
 
 namespace fnd
 {
     
     // Both speciesType and reactionType must have a public function
     // void expandReactionNetwork() - that is, derived from
-    // fnd::reactionNetworkComponent.
+    // fnd::reactionNetworkComponent.  speciesType must also have a public
+    // function size_t getObjectBytes() const, giving the size of the
+    // species for the memoryAccount.
 
     template <typename speciesT,
               typename reactionT>
@@ -96,6 +101,17 @@ namespace fnd
         ParticipatingSpeciesRxnMap doubleSubstrateRxns;
         ParticipatingSpeciesRxnMap autoDimerizationRxns;
 
+    private:
+        snapshotPublisher<speciesT, reactionT> theSnapshotPublisher;
+
+        memoryAccount theMemoryAccount;
+
+        expansionProfiler theExpansionProfiler;
+
+        // Charges a new species, and its catalog, chart and snapshot
+        // entries, to the memoryAccount.
+        void chargeSpecies( SpeciesTypeCptr pSpecies, const SpeciesTag& rTag, const SpeciesID& rID );
+
     public:
 
         ReactionNetworkDescription();
@@ -166,18 +182,51 @@ namespace fnd
         // whether it succeeds or fails, the name under which the species is/has been 
         // registered is placed in the refName parameter.
         virtual bool recordSpecies( SpeciesTypePtr pSpecies, SpeciesTag& refName );
-        bool recordReaction( ReactionTypePtr pRxn );
+        virtual bool recordReaction( ReactionTypePtr pRxn );
 
         void mustRecordSpecies( SpeciesTypePtr pSpecies ) throw( utl::xcpt );
         void mustRecordSpecies( SpeciesTypePtr pSpecies, SpeciesTag& refName ) throw( utl::xcpt );
         void mustRecordReaction( ReactionTypePtr pRxn ) throw( utl::xcpt );
 
 
+        // Throws memoryBudgetXcpt, without expanding, if the species is
+        // unexpanded and the memoryAccount's budget has been reached.  So
+        // do the findReactionWithSubstrates functions.
         void incrementNetworkBySpeciesTag( const SpeciesTag& rName ) throw( utl::xcpt );
         
         SpeciesID convertSpeciesTagToSpeciesID( const SpeciesTag& rTag ) const throw( utl::xcpt );
         SpeciesTag convertSpeciesIDToSpeciesTag( const SpeciesID& rID) const throw( utl::xcpt );
 
+        // The estimated memory use of this network, and its budget.
+        memoryAccount& getMemoryAccount();
+        const memoryAccount& getMemoryAccount() const;
+
+        // Profiles the expansion of this network, by the generators of its
+        // model.
+        expansionProfiler& getExpansionProfiler();
+        const expansionProfiler& getExpansionProfiler() const;
+
+
+
+        ///////////////////////////////////////////////////////////////////////////
+        //  Snapshot API
+        //
+        //  A snapshot is a read-only view of the network as of its last 
+        //  publication, which other threads can use while this one goes on
+        //  expanding the network.  getSnapshot may be called from any thread;
+        //  everything else in this class belongs to the expanding thread.  
+        //  Handles must be let go before this description is destroyed.
+        ///////////////////////////////////////////////////////////////////////////
+
+        typedef networkSnapshot<speciesT, reactionT> NetworkSnapshot;
+        typedef typename snapshotPublisher<speciesT, reactionT>::handle SnapshotHandle;
+
+        SnapshotHandle getSnapshot() const;
+
+        // Makes the species and reactions recorded since the last publication
+        // visible in new snapshots.
+        void publishSnapshot();
+
     };
 
 }
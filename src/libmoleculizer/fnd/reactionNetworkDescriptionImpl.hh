@@ -77,23 +77,25 @@ namespace fnd
     {
         // Because we are not clearing the reaction vector (the goal for this is so that 
         // users can easily collect together many different reactions from different sources or whatever.
-        typename std::vector<ReactionTypeCptr>::const_iterator originalEnd = reactionVector.end();
+        typename std::vector<ReactionTypeCptr>::size_type originalSize = reactionVector.size();
 
         if (!A->hasNotified()) 
         {
+            theMemoryAccount.checkBudget();
+
             // Hurm.  This seems uncool to me, but I don't really know to get around it otherwise.  
             const_cast<SpeciesTypePtr>(A)->expandReactionNetwork();
         }
 
-        typename ParticipatingSpeciesRxnMap::const_iterator iter = singleSubstrateRxns.find( const_cast<SpeciesTypePtr>(A) );
+        std::pair< typename ParticipatingSpeciesRxnMap::const_iterator, typename ParticipatingSpeciesRxnMap::const_iterator> range
+            = singleSubstrateRxns.equal_range( const_cast<SpeciesTypePtr>(A) );
             
-        while ( iter->first == A )
+        for( typename ParticipatingSpeciesRxnMap::const_iterator iter = range.first; iter != range.second; ++iter)
         {
             reactionVector.push_back( iter->second );
-            ++iter;
         }
             
-        return ( reactionVector.end() != originalEnd );
+        return ( reactionVector.size() != originalSize );
     }
 
 
@@ -104,10 +106,15 @@ namespace fnd
                                                                                  std::vector<ReactionNetworkDescription<speciesT, reactionT>::ReactionTypeCptr>& reactionVector)
     {
         
-        typename std::vector<ReactionTypeCptr>::const_iterator originalEnd = reactionVector.end();
+        typename std::vector<ReactionTypeCptr>::size_type originalSize = reactionVector.size();
 
         // This feels wrong (although semantically, so right), and probably means things 
         // should be refactored.
+        if ( ! A->hasNotified() || ! B->hasNotified() )
+        {
+            theMemoryAccount.checkBudget();
+        }
+
         if( ! A->hasNotified() )
         {
             const_cast<SpeciesTypePtr>(A)->expandReactionNetwork();
@@ -156,7 +163,7 @@ namespace fnd
             }
         }
     
-        return ( reactionVector.end() != originalEnd );
+        return ( reactionVector.size() != originalSize );
     }
 
 
@@ -227,8 +234,10 @@ namespace fnd
             theSpeciesListCatalog.insert( std::make_pair( speciesHandle, pSpecies ) );
             speciesTagToSpeciesIDChart.insert( std::make_pair( speciesHandle, speciesIDPtr ) );
             speciesIDToSpeciesTagChart.insert( std::make_pair( speciesIDPtr, speciesHandle ) );
+            theSnapshotPublisher.recordSpecies( pSpecies, *speciesHandle, *speciesIDPtr );
 
             theDeltaSpeciesList.push_back( pSpecies );
+            chargeSpecies( pSpecies, *speciesHandle, *speciesIDPtr );
             return true;
         }
 
@@ -254,8 +263,10 @@ namespace fnd
             theSpeciesListCatalog.insert( std::make_pair( speciesHandle, pSpecies ) );
             speciesTagToSpeciesIDChart.insert( std::make_pair( speciesHandle, speciesIDPtr ) );
             speciesIDToSpeciesTagChart.insert( std::make_pair( speciesIDPtr, speciesHandle ) );
+            theSnapshotPublisher.recordSpecies( pSpecies, *speciesHandle, *speciesIDPtr );
 
             theDeltaSpeciesList.push_back( pSpecies );
+            chargeSpecies( pSpecies, *speciesHandle, *speciesIDPtr );
             return true;
         }
 
@@ -276,6 +287,7 @@ namespace fnd
             
         theCompleteReactionList.push_back( pRxn );
         theDeltaReactionList.push_back( pRxn );
+        theSnapshotPublisher.recordReaction( pRxn );
 
         switch ( rxnArity )
         {
@@ -289,6 +301,7 @@ namespace fnd
             SpeciesTypePtr pOnlySubstrate;
             pOnlySubstrate = pRxn->getReactants().begin()->first;
             singleSubstrateRxns.insert( std::make_pair( pOnlySubstrate, pRxn ) );
+            theSnapshotPublisher.recordSingleSubstrateRxn( pOnlySubstrate, pRxn );
             break;
 
         case 2:
@@ -304,12 +317,14 @@ namespace fnd
                 {
                     theSpeciesPtr = reactantIter->first;
                     doubleSubstrateRxns.insert( std::make_pair( theSpeciesPtr, pRxn ) );
+                    theSnapshotPublisher.recordDoubleSubstrateRxn( theSpeciesPtr, pRxn );
                 }
             }
             else
             {
                 // Rxn is of type A + A -> ?.
                 autoDimerizationRxns.insert( std::make_pair( pRxn->getReactants().begin()->first, pRxn) );
+                theSnapshotPublisher.recordAutoDimerizationRxn( pRxn->getReactants().begin()->first, pRxn );
             }
             break;
 
@@ -318,8 +333,47 @@ namespace fnd
             break;
         }
             
+        // Both lists and a map entry for each distinct reactant.
+        theMemoryAccount.charge( memoryAccount::REACTION_MAPS,
+                                 sizeof( reactionT )
+                                 + 2 * memoryAccount::listNodeBytes( sizeof( ReactionTypePtr ) )
+                                 + pRxn->getReactants().size()
+                                 * memoryAccount::treeNodeBytes( sizeof( typename ParticipatingSpeciesRxnMap::value_type ) ) );
+        
+        // The same entries in the snapshot indices.
+        theMemoryAccount.charge( memoryAccount::NETWORK_SNAPSHOTS,
+                                 sizeof( std::pair<long, ReactionTypePtr> )
+                                 + pRxn->getReactants().size()
+                                 * sizeof( std::pair<SpeciesTypeCptr, ReactionTypePtr> ) );
+            
         return true;
     }
+
+    template <typename speciesT, typename reactionT>
+    void
+    ReactionNetworkDescription<speciesT, reactionT>::chargeSpecies( typename ReactionNetworkDescription<speciesT, reactionT>::SpeciesTypeCptr pSpecies,
+                                                                    const typename ReactionNetworkDescription<speciesT, reactionT>::SpeciesTag& rTag,
+                                                                    const typename ReactionNetworkDescription<speciesT, reactionT>::SpeciesID& rID )
+    {
+        // The species itself, its two names, its entries in the catalog
+        // and both charts, and its entry in the delta list.
+        theMemoryAccount.charge( memoryAccount::SPECIES_CATALOG,
+                                 pSpecies->getObjectBytes()
+                                 + sizeof( SpeciesTag ) + rTag.size()
+                                 + sizeof( SpeciesID ) + rID.size()
+                                 + 3 * memoryAccount::treeNodeBytes( 2 * sizeof( void* ) )
+                                 + memoryAccount::listNodeBytes( sizeof( SpeciesTypePtr ) ) );
+        
+        // Its entries in the snapshot indices, by ordinal, tag and ID, and
+        // its ID by ordinal.  These are counted once, as they are held in
+        // the runs of the current snapshot; runs of superseded snapshots
+        // that readers still hold are not counted.
+        theMemoryAccount.charge( memoryAccount::NETWORK_SNAPSHOTS,
+                                 sizeof( std::pair<long, SpeciesTypePtr> )
+                                 + 2 * sizeof( std::pair<std::string, SpeciesTypePtr> )
+                                 + sizeof( std::pair<long, std::string> )
+                                 + rTag.size() + 2 * rID.size() );
+    }
         
     // These are not used by anyone at the moment.  It might be better to use them instead
     // of the plain old recordSpecies/recordReaction functions, but who knows.
@@ -415,7 +469,10 @@ namespace fnd
             
         if ( iter != theSpeciesListCatalog.end() )
         {
+            if ( ! iter->second->hasNotified() ) theMemoryAccount.checkBudget();
+
             iter->second->expandReactionNetwork();
+            publishSnapshot();
         }
         else
         {
@@ -424,6 +481,54 @@ namespace fnd
     }
 
 
+    template <typename speciesT, typename reactionT>
+    memoryAccount&
+    ReactionNetworkDescription<speciesT, reactionT>::getMemoryAccount()
+    {
+        return theMemoryAccount;
+    }
+
+
+    template <typename speciesT, typename reactionT>
+    const memoryAccount&
+    ReactionNetworkDescription<speciesT, reactionT>::getMemoryAccount() const
+    {
+        return theMemoryAccount;
+    }
+
+
+    template <typename speciesT, typename reactionT>
+    expansionProfiler&
+    ReactionNetworkDescription<speciesT, reactionT>::getExpansionProfiler()
+    {
+        return theExpansionProfiler;
+    }
+
+
+    template <typename speciesT, typename reactionT>
+    const expansionProfiler&
+    ReactionNetworkDescription<speciesT, reactionT>::getExpansionProfiler() const
+    {
+        return theExpansionProfiler;
+    }
+
+
+    template <typename speciesT, typename reactionT>
+    typename ReactionNetworkDescription<speciesT, reactionT>::SnapshotHandle
+    ReactionNetworkDescription<speciesT, reactionT>::getSnapshot() const
+    {
+        return theSnapshotPublisher.acquire();
+    }
+
+
+    template <typename speciesT, typename reactionT>
+    void
+    ReactionNetworkDescription<speciesT, reactionT>::publishSnapshot()
+    {
+        theSnapshotPublisher.publish();
+    }
+
+
     template <typename speciesT, typename reactionT>
     ReactionNetworkDescription<speciesT, reactionT>::ReactionNetworkDescription()
         :
@@ -75,10 +75,13 @@ namespace fnd
         // Here is the reason for using a set here: a reaction can add itself to a
         // reactant's sensitivity list more than once with no subsequent loss of
         // efficiency.
-        void
+        //
+        // Returns true if the item wasn't already in the list, so that the
+        // owner of the list can charge its memoryAccount for the new node.
+        bool
         addSensitive( sensitiveType* pSensitive )
         {
-            insert( pSensitive );
+            return this->insert( pSensitive ).second;
         }
         
         // This might be used to elicit immediate responses from the
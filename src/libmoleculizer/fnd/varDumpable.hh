@@ -66,6 +66,18 @@ namespace fnd
         {
             rDumpArg.getOstream() << getVar()->getValue();
         }
+        
+        virtual bool
+        hasDumpValue( void ) const
+        {
+            return true;
+        }
+        
+        virtual double
+        getDumpValue( const dumpArgT& rDumpArg ) const
+        {
+            return getVar()->getValue();
+        }
     };
 }
 
@@ -29,6 +29,7 @@
 //
 //
 
+#include "fnd/expansionProfiler.hh"
 #include "mzr/mzrUnit.hh"
 #include "mol/mzrModMol.hh"
 #include "plex/plexUnit.hh"
@@ -148,7 +149,8 @@ namespace ftr
                 = pModMol->externState( rProductMolParams[paradigmModMolSpec] );
             
             // Substitute in the modification.
-            exchangedMolState[rExchange.modSiteNdx] = rExchange.pReplacementMod;
+            exchangedMolState.setModification( rExchange.modSiteNdx,
+                                               rExchange.pReplacementMod );
             
             // Intern the new modMol state.
             const cpx::molParam nuMolParam
@@ -164,6 +166,11 @@ namespace ftr
     omniRxnGen::
     respond( const fnd::featureStimulus<cpx::cxOmni<bnd::mzrMol, plx::mzrPlexSpecies, plx::mzrPlexFamily, plx::mzrOmniPlex> >& rStimulus )
     {
+        fnd::expansionProfiler& rProfiler = rMzrUnit.rMolzer.getExpansionProfiler();
+        fnd::profileRxnGen profile( rProfiler,
+                                    this,
+                                    "omni-gen" );
+        
         const cpx::cxOmni<bnd::mzrMol, plx::mzrPlexSpecies, plx::mzrPlexFamily, plx::mzrOmniPlex>& rContext
             = rStimulus.getContext();
         
@@ -198,7 +205,11 @@ namespace ftr
         }
         
         // Set the rate of the reaction.
-        pReaction->setRate( pExtrapolator->getRate( rContext ) );
+        {
+            fnd::profilePhase extrapProfile( rProfiler,
+                                             fnd::expansionProfiler::RATE_EXTRAPOLATION );
+            pReaction->setRate( pExtrapolator->getRate( rContext ) );
+        }
         
         // Now construct the primary product species, the modified complex.
         // This occurs in two steps, making the structural complex and making
@@ -30,6 +30,8 @@
 //
 
 #include "fnd/fndXcpt.hh"
+#include "fnd/expansionProfiler.hh"
+#include "mzr/moleculizer.hh"
 #include "mol/mzrModMol.hh"
 #include "mol/badModMolXcpt.hh"
 #include "plex/parserPlex.hh"
@@ -304,5 +306,9 @@ namespace ftr
         // Connect the family's reaction generator to the triggering omniplex's
         // feature.
         pOmni->getSubPlexFeature()->insert( pFamily->getRxnGen() );
+        
+        rMzrUnit.rMolzer.getExpansionProfiler().nameRxnGen( pFamily->getRxnGen(),
+                                                            eltName::omniGen,
+                                                            pOmni->getFamily()->getPlexFamilyName() );
     }
 }
@@ -30,6 +30,8 @@
 //
 
 #include "fnd/fndXcpt.hh"
+#include "fnd/expansionProfiler.hh"
+#include "mzr/moleculizer.hh"
 #include "cpx/modMolStateQuery.hh"
 #include "mol/mzrModMol.hh"
 #include "ftr/ftrEltName.hh"
@@ -348,6 +350,14 @@ namespace ftr
         
         // Connect the family's reaction generator to the mol's feature.
         // Note that mol inherits from feature.
-        pEnablingModMol->addSensitive( pFamily->getRxnGen() );
+        if ( pEnablingModMol->addSensitive( pFamily->getRxnGen() ) )
+        {
+            rMzrUnit.rMolzer.getMemoryAccount().charge( fnd::memoryAccount::SENSITIVITY_LISTS,
+                                                        fnd::memoryAccount::treeNodeBytes( sizeof( void* ) ) );
+        }
+        
+        rMzrUnit.rMolzer.getExpansionProfiler().nameRxnGen( pFamily->getRxnGen(),
+                                                            eltName::uniMolGen,
+                                                            pEnablingModMol->getName() );
     }
 }
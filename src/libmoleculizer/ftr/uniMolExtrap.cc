@@ -32,7 +32,6 @@
 #include "fnd/pchem.hh"
 #include "mol/mzrModMol.hh"
 #include "ftr/uniMolExtrap.hh"
-#include "fnd/pchem.hh"
 
 namespace ftr
 {
@@ -29,6 +29,7 @@
 //
 //
 
+#include "fnd/expansionProfiler.hh"
 #include "mzr/mzrUnit.hh"
 #include "mol/mzrModMol.hh"
 #include "cpx/cxMol.hh"
@@ -50,7 +51,8 @@ namespace ftr
         void
         operator()( const molModExchange& rExchange ) const
         {
-            rState[rExchange.modSiteNdx] = rExchange.pReplacementMod;
+            rState.setModification( rExchange.modSiteNdx,
+                                    rExchange.pReplacementMod );
         }
     };
     
@@ -58,6 +60,11 @@ namespace ftr
     uniMolRxnGen::
     respond( const fnd::featureStimulus<cpx::cxMol<plx::mzrPlexSpecies, plx::mzrPlexFamily> >& rStimulus )
     {
+        fnd::expansionProfiler& rProfiler = rMzrUnit.rMolzer.getExpansionProfiler();
+        fnd::profileRxnGen profile( rProfiler,
+                                    this,
+                                    "uni-mol-gen" );
+        
         const cpx::cxMol<plx::mzrPlexSpecies, plx::mzrPlexFamily>& rContext
             = rStimulus.getContext();
         
@@ -98,7 +105,11 @@ namespace ftr
             }
             
             // Set the rate of the reaction.
-            pReaction->setRate( pExtrapolator->getRate( rContext ) );
+            {
+                fnd::profilePhase extrapProfile( rProfiler,
+                                                 fnd::expansionProfiler::RATE_EXTRAPOLATION );
+                pReaction->setRate( pExtrapolator->getRate( rContext ) );
+            }
             
             // Construct the primary product species.
             //
@@ -0,0 +1,329 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include "mzr/agentSimulator.hh"
+
+namespace mzr
+{
+    namespace
+    {
+        // Sets a reaction capture for as long as it is in scope.
+        class captureScope
+        {
+            moleculizer& rMolzer;
+            reactionCapture* pPreviousCapture;
+            
+        public:
+            captureScope( moleculizer& rMoleculizer,
+                          reactionCapture* pCapture ) :
+                rMolzer( rMoleculizer ),
+                pPreviousCapture( rMoleculizer.getReactionCapture() )
+            {
+                rMolzer.setReactionCapture( pCapture );
+            }
+            
+            ~captureScope( void )
+            {
+                rMolzer.setReactionCapture( pPreviousCapture );
+            }
+        };
+    }
+    
+    agentSimulator::agentSimulator( double theVolume,
+                                    unsigned long seed ) :
+        volume( theVolume ),
+        time( 0.0 ),
+        reactionEventCount( 0 ),
+        kernelStale( true ),
+        catalogReactionsTaken( 0 )
+    {
+        if ( ! ( 0.0 < volume ) )
+        {
+            throw utl::xcpt( "Error in agentSimulator::agentSimulator.  The volume must be positive." );
+        }
+        
+        randomState[0] = 0x330e;
+        randomState[1] = seed & 0xffff;
+        randomState[2] = ( seed >> 16 ) & 0xffff;
+    }
+    
+    double
+    agentSimulator::uniformRandom( void )
+    {
+        return erand48( randomState );
+    }
+    
+    int
+    agentSimulator::indexSpecies( mzrSpecies* pSpecies )
+    {
+        std::pair<std::map<const mzrSpecies*, int>::iterator, bool> insertResult
+            = indicesBySpecies.insert( std::make_pair( pSpecies,
+                                                       ( int ) speciesByIndex.size() ) );
+        if ( insertResult.second )
+        {
+            speciesByIndex.push_back( pSpecies );
+            agentsBySpecies.push_back( std::vector<int>() );
+            populations.push_back( 0.0 );
+        }
+        return insertResult.first->second;
+    }
+    
+    void
+    agentSimulator::takeCatalogReactions( void )
+    {
+        // Reactions of species that were expanded in the catalog won't be
+        // generated again.
+        const moleculizer::ReactionList& rCatalogReactions = theMolzer.getReactionList();
+        if ( rCatalogReactions.size() == catalogReactionsTaken ) return;
+        
+        moleculizer::ReactionList::const_iterator iReaction = rCatalogReactions.begin();
+        std::advance( iReaction,
+                      catalogReactionsTaken );
+        for ( ;
+              iReaction != rCatalogReactions.end();
+              ++iReaction )
+        {
+            captureReaction( *iReaction );
+        }
+        catalogReactionsTaken = rCatalogReactions.size();
+    }
+    
+    void
+    agentSimulator::captureSpecies( mzrSpecies* pSpecies )
+    {
+        indexSpecies( pSpecies );
+    }
+    
+    void
+    agentSimulator::captureReaction( mzrReaction* pReaction )
+    {
+        fnd::addGillspReaction( kernel,
+                                *pReaction,
+                                speciesIndexer( *this ) );
+        reactions.push_back( pReaction );
+        kernelStale = true;
+    }
+    
+    void
+    agentSimulator::meetSpecies( mzrSpecies* pSpecies )
+    {
+        if ( pSpecies->hasNotified() ) return;
+        
+        captureScope capture( theMolzer,
+                              this );
+        
+        // At depth 0, the generators make the species' reactions but
+        // don't go on to notify their products.
+        pSpecies->ensureNotified( 0 );
+    }
+    
+    void
+    agentSimulator::addAgent( mzrSpecies* pSpecies )
+    {
+        int speciesNdx = indexSpecies( pSpecies );
+        
+        std::vector<int>& rAgents = agentsBySpecies[speciesNdx];
+        agentSlots.push_back( rAgents.size() );
+        rAgents.push_back( agentSpecies.size() );
+        agentSpecies.push_back( pSpecies );
+        populations[speciesNdx] += 1.0;
+        
+        meetSpecies( pSpecies );
+    }
+    
+    void
+    agentSimulator::addAgents( mzrSpecies* pSpecies,
+                               int count )
+    {
+        if ( count < 0 )
+        {
+            throw utl::xcpt( "Error in agentSimulator::addAgents.  The count must not be negative." );
+        }
+        
+        takeCatalogReactions();
+        
+        for ( int agentNdx = 0; agentNdx < count; ++agentNdx )
+        {
+            addAgent( pSpecies );
+        }
+        
+        // Propensities of the species' reactions are out of date.
+        kernelStale = true;
+    }
+    
+    void
+    agentSimulator::removeAgent( int speciesNdx )
+    {
+        std::vector<int>& rAgents = agentsBySpecies[speciesNdx];
+        
+        int slot = ( int ) ( uniformRandom() * rAgents.size() );
+        int agent = rAgents[slot];
+        
+        // Fill the agent's slot with the last agent of the species.
+        rAgents[slot] = rAgents.back();
+        agentSlots[rAgents[slot]] = slot;
+        rAgents.pop_back();
+        
+        // Fill the agent's number with the last agent.
+        int lastAgent = agentSpecies.size() - 1;
+        if ( agent != lastAgent )
+        {
+            mzrSpecies* pLastSpecies = agentSpecies[lastAgent];
+            int lastSlot = agentSlots[lastAgent];
+            
+            agentSpecies[agent] = pLastSpecies;
+            agentSlots[agent] = lastSlot;
+            agentsBySpecies[indicesBySpecies[pLastSpecies]][lastSlot] = agent;
+        }
+        agentSpecies.pop_back();
+        agentSlots.pop_back();
+        
+        populations[speciesNdx] -= 1.0;
+    }
+    
+    void
+    agentSimulator::refreshPropensities( void )
+    {
+        kernel.finish();
+        propensities.resize( kernel.getReactionCount() );
+        
+        if ( ! propensities.empty() )
+        {
+            kernel.computeAll( &populations[0],
+                               volume,
+                               &propensities[0] );
+        }
+        kernelStale = false;
+    }
+    
+    void
+    agentSimulator::fireReaction( const mzrReaction* pReaction )
+    {
+        ++reactionEventCount;
+        
+        std::vector<int> changedSpecies;
+        
+        const mzrReaction::multMap& rReactants = pReaction->getReactants();
+        for ( mzrReaction::multMap::const_iterator iReactant = rReactants.begin();
+              iReactant != rReactants.end();
+              ++iReactant )
+        {
+            int speciesNdx = indicesBySpecies[iReactant->first];
+            for ( int count = 0; count < iReactant->second; ++count )
+            {
+                removeAgent( speciesNdx );
+            }
+            changedSpecies.push_back( speciesNdx );
+        }
+        
+        const mzrReaction::multMap& rProducts = pReaction->getProducts();
+        for ( mzrReaction::multMap::const_iterator iProduct = rProducts.begin();
+              iProduct != rProducts.end();
+              ++iProduct )
+        {
+            for ( int count = 0; count < iProduct->second; ++count )
+            {
+                addAgent( iProduct->first );
+            }
+            changedSpecies.push_back( indicesBySpecies[iProduct->first] );
+        }
+        
+        // Meeting a new species may have brought new reactions, in which
+        // case everything is recomputed at the next step.
+        if ( ! kernelStale )
+        {
+            kernel.updateForSpecies( changedSpecies,
+                                     &populations[0],
+                                     volume,
+                                     &propensities[0] );
+        }
+    }
+    
+    bool
+    agentSimulator::step( double timeLimit )
+    {
+        if ( kernelStale ) refreshPropensities();
+        
+        double totalPropensity = 0.0;
+        for ( std::vector<double>::const_iterator iPropensity = propensities.begin();
+              iPropensity != propensities.end();
+              ++iPropensity )
+        {
+            totalPropensity += *iPropensity;
+        }
+        
+        if ( ! ( 0.0 < totalPropensity ) )
+        {
+            time = timeLimit;
+            return false;
+        }
+        
+        // 1 - u keeps the logarithm finite.
+        double nextTime = time - std::log( 1.0 - uniformRandom() ) / totalPropensity;
+        if ( timeLimit < nextTime )
+        {
+            // The process is memoryless, so nothing is lost by starting
+            // afresh from the limit.
+            time = timeLimit;
+            return false;
+        }
+        time = nextTime;
+        
+        double target = uniformRandom() * totalPropensity;
+        int slot = 0;
+        int lastSlot = propensities.size() - 1;
+        while ( slot < lastSlot
+                && ( target -= propensities[slot] ) >= 0.0 ) ++slot;
+        
+        // Skip back over empty slots that the rounding may have left us
+        // at.
+        while ( 0 < slot && 0.0 == propensities[slot] ) --slot;
+        
+        fireReaction( reactions[kernel.getReaction( slot )] );
+        return true;
+    }
+    
+    void
+    agentSimulator::run( double duration )
+    {
+        double endTime = time + duration;
+        while ( step( endTime ) )
+        {}
+    }
+    
+    int
+    agentSimulator::getPopulation( const mzrSpecies* pSpecies ) const
+    {
+        std::map<const mzrSpecies*, int>::const_iterator iEntry
+            = indicesBySpecies.find( pSpecies );
+        if ( iEntry == indicesBySpecies.end() ) return 0;
+        
+        return agentsBySpecies[iEntry->second].size();
+    }
+}
@@ -0,0 +1,242 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_AGENTSIMULATOR_H
+#define MZR_AGENTSIMULATOR_H
+
+/*! \file agentSimulator.hh
+  \ingroup mzrGroup
+  \brief Stochastic simulation of explicit complexes, without expanding
+  the network.
+  
+  Each agent is one complex, of some species, and the simulator applies
+  the model's rules only to the species of the complexes it holds.  When
+  a species first turns up, its features are presented to the reaction
+  generators, as expansion would, but with the simulator set as the
+  moleculizer's reactionCapture, so the reactions that come back, and the
+  complexes they make, go to the simulator rather than into the catalog;
+  products aren't expanded until an agent of their kind appears.  The
+  recognizers, queries and rate extrapolators are the same as in
+  expansion.  So this is lazy expansion, limited to the species that
+  agents reach, rather than rule application to individual complexes:
+  agents carry no state beyond their species.
+  
+  This is not network-free simulation.  Every kind of complex an agent
+  reaches is interned in its plex family, and its reactions with every
+  partner species known to its contexts are generated, so the cost still
+  grows with the number of species reached; a combinatorially explosive
+  model is no cheaper here than under on-demand expansion.  Applying
+  rules to complex instances would need the rate extrapolators and the
+  site shapes they read to work from a bare plex and its molecule
+  states, where now they work from a species' feature contexts and the
+  allostery of its family, and would need the generators to build
+  products without recognizing them into families.  Neither exists yet.
+  
+  Presenting a species to the generators marks it as notified and leaves
+  its contexts with the features, for good.  So the simulator does this
+  in a moleculizer of its own, which nothing else expands; a network is
+  generated from the same model with another moleculizer.  Reactions
+  that are in the simulator's catalog, such as those of a restored
+  network, are taken as they are, and their species aren't presented
+  again.
+  
+  Reactions fire as in Gillespie's direct method, with propensities
+  computed by propensityKernel, which agrees to the bit with
+  gillspReaction::propensity.  So on a network small enough to expand,
+  the simulator samples the same process as SSA on the expanded network. */
+
+#include <map>
+#include <vector>
+#include "fnd/propensityKernel.hh"
+#include "mzr/moleculizer.hh"
+
+namespace mzr
+{
+    class agentSimulator :
+        public reactionCapture
+    {
+    public:
+        // The volume is in liters.
+        agentSimulator( double volume,
+                        unsigned long seed = 0 );
+        
+        // The simulator's own moleculizer, for loading the model and for
+        // finding species in it, as with getSpeciesWithUniqueID.  It must
+        // not be used to expand the network.
+        moleculizer&
+        getMoleculizer( void )
+        {
+            return theMolzer;
+        }
+        
+        // The species must be one of getMoleculizer's.
+        void
+        addAgents( mzrSpecies* pSpecies,
+                   int count );
+        
+        // Fires the next reaction, if it happens no later than timeLimit,
+        // and returns true.  Otherwise, advances to timeLimit and returns
+        // false.
+        bool
+        step( double timeLimit );
+        
+        void
+        run( double duration );
+        
+        double
+        getTime( void ) const
+        {
+            return time;
+        }
+        
+        int
+        getAgentCount( void ) const
+        {
+            return agentSpecies.size();
+        }
+        
+        // Agents are renumbered as others are consumed.
+        mzrSpecies*
+        getAgentSpecies( int agent ) const
+        {
+            return agentSpecies[agent];
+        }
+        
+        int
+        getPopulation( const mzrSpecies* pSpecies ) const;
+        
+        // The kinds of complex met so far, whether or not any agents of
+        // the kind remain.
+        int
+        getSpeciesCount( void ) const
+        {
+            return speciesByIndex.size();
+        }
+        
+        mzrSpecies*
+        getSpecies( int speciesNdx ) const
+        {
+            return speciesByIndex[speciesNdx];
+        }
+        
+        int
+        getReactionCount( void ) const
+        {
+            return reactions.size();
+        }
+        
+        long
+        getReactionEventCount( void ) const
+        {
+            return reactionEventCount;
+        }
+        
+        // For reactionCapture.
+        void
+        captureSpecies( mzrSpecies* pSpecies );
+        
+        void
+        captureReaction( mzrReaction* pReaction );
+        
+    private:
+        class speciesIndexer
+        {
+            agentSimulator& rSimulator;
+            
+        public:
+            speciesIndexer( agentSimulator& rAgentSimulator ) :
+                rSimulator( rAgentSimulator )
+            {}
+            
+            int
+            operator()( mzrSpecies* pSpecies ) const
+            {
+                return rSimulator.indexSpecies( pSpecies );
+            }
+        };
+        friend class speciesIndexer;
+        
+        moleculizer theMolzer;
+        double volume;
+        double time;
+        long reactionEventCount;
+        
+        // By agent: its species, and its place in the list of agents of
+        // its species.
+        std::vector<mzrSpecies*> agentSpecies;
+        std::vector<int> agentSlots;
+        
+        // By species index.
+        std::map<const mzrSpecies*, int> indicesBySpecies;
+        std::vector<mzrSpecies*> speciesByIndex;
+        std::vector<std::vector<int> > agentsBySpecies;
+        std::vector<double> populations;
+        
+        // By reaction number in the kernel.
+        std::vector<const mzrReaction*> reactions;
+        fnd::propensityKernel kernel;
+        bool kernelStale;
+        
+        // How many of the catalog's reactions have been taken.
+        size_t catalogReactionsTaken;
+        
+        // By kernel slot.
+        std::vector<double> propensities;
+        
+        unsigned short randomState[3];
+        
+        double
+        uniformRandom( void );
+        
+        int
+        indexSpecies( mzrSpecies* pSpecies );
+        
+        // Takes the reactions added to the catalog, as by loading a model,
+        // since the last time.
+        void
+        takeCatalogReactions( void );
+        
+        // Presents a species' features to the reaction generators, the
+        // first time an agent of the species appears.
+        void
+        meetSpecies( mzrSpecies* pSpecies );
+        
+        void
+        addAgent( mzrSpecies* pSpecies );
+        
+        // Removes a random agent of the species.
+        void
+        removeAgent( int speciesNdx );
+        
+        void
+        refreshPropensities( void );
+        
+        void
+        fireReaction( const mzrReaction* pReaction );
+    };
+}
+
+#endif // MZR_AGENTSIMULATOR_H
@@ -0,0 +1,188 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include "mzr/cellList.hh"
+
+namespace mzr
+{
+    namespace
+    {
+        // Half of the 26 neighboring cells, one of each opposite pair, so
+        // that each pair of cells is visited once.
+        const int halfShell[13][3] = {
+            { 1, 0, 0 }, { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+            { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+            { -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+            { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 }
+        };
+        
+        int
+        wrapCell( int cell,
+                  int cellsPerSide )
+        {
+            if ( cell < 0 ) return cell + cellsPerSide;
+            if ( cellsPerSide <= cell ) return cell - cellsPerSide;
+            return cell;
+        }
+    }
+    
+    cellList::cellList( double theBoxSide ) :
+        boxSide( theBoxSide ),
+        cutoff( 0.0 ),
+        cellsPerSide( 1 )
+    {}
+    
+    double
+    cellList::periodicDistanceSquared( const double* pFirst,
+                                       const double* pSecond,
+                                       double boxSide )
+    {
+        double halfSide = 0.5 * boxSide;
+        double distanceSquared = 0.0;
+        
+        for ( int axis = 0; axis < 3; ++axis )
+        {
+            double delta = std::fabs( pFirst[axis] - pSecond[axis] );
+            if ( halfSide < delta ) delta = boxSide - delta;
+            distanceSquared += delta * delta;
+        }
+        
+        return distanceSquared;
+    }
+    
+    int
+    cellList::cellIndex( int xCell,
+                         int yCell,
+                         int zCell ) const
+    {
+        return ( xCell * cellsPerSide + yCell ) * cellsPerSide + zCell;
+    }
+    
+    void
+    cellList::build( const std::vector<double>& rCoords,
+                     double theCutoff )
+    {
+        cutoff = theCutoff;
+        int pointCount = rCoords.size() / 3;
+        
+        // Cells may be wider than the cutoff; there is no use in having
+        // many more cells than points.
+        int widestCells = 0 < cutoff ? ( int ) std::floor( boxSide / cutoff ) : 1;
+        int roughlyOnePerCell = ( int ) std::ceil( std::pow( ( double ) pointCount, 1.0 / 3.0 ) );
+        cellsPerSide = std::max( 1, std::min( widestCells, roughlyOnePerCell ) );
+        
+        cellHead.assign( cellsPerSide * cellsPerSide * cellsPerSide, -1 );
+        nextInCell.assign( pointCount, -1 );
+        
+        double cellsPerUnit = cellsPerSide / boxSide;
+        for ( int point = 0; point < pointCount; ++point )
+        {
+            int cell[3];
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                cell[axis] = ( int )( rCoords[3 * point + axis] * cellsPerUnit );
+                if ( cellsPerSide <= cell[axis] ) cell[axis] = cellsPerSide - 1;
+                if ( cell[axis] < 0 ) cell[axis] = 0;
+            }
+            
+            int& rHead = cellHead[cellIndex( cell[0], cell[1], cell[2] )];
+            nextInCell[point] = rHead;
+            rHead = point;
+        }
+    }
+    
+    void
+    cellList::addPairIfClose( const std::vector<double>& rCoords,
+                              int first,
+                              int second,
+                              std::vector<std::pair<int, int> >& rPairs ) const
+    {
+        if ( periodicDistanceSquared( &rCoords[3 * first],
+                                      &rCoords[3 * second],
+                                      boxSide ) < cutoff * cutoff )
+        {
+            rPairs.push_back( std::make_pair( first, second ) );
+        }
+    }
+    
+    void
+    cellList::findPairs( const std::vector<double>& rCoords,
+                         std::vector<std::pair<int, int> >& rPairs ) const
+    {
+        int pointCount = nextInCell.size();
+        
+        // With fewer than three cells a side, the neighbors of a cell are
+        // not all different cells, so just try every pair.
+        if ( cellsPerSide < 3 )
+        {
+            for ( int first = 0; first < pointCount; ++first )
+            {
+                for ( int second = first + 1; second < pointCount; ++second )
+                {
+                    addPairIfClose( rCoords, first, second, rPairs );
+                }
+            }
+            return;
+        }
+        
+        for ( int xCell = 0; xCell < cellsPerSide; ++xCell )
+        {
+            for ( int yCell = 0; yCell < cellsPerSide; ++yCell )
+            {
+                for ( int zCell = 0; zCell < cellsPerSide; ++zCell )
+                {
+                    int head = cellHead[cellIndex( xCell, yCell, zCell )];
+                    
+                    for ( int first = head; first != -1; first = nextInCell[first] )
+                    {
+                        for ( int second = nextInCell[first]; second != -1; second = nextInCell[second] )
+                        {
+                            addPairIfClose( rCoords, first, second, rPairs );
+                        }
+                    }
+                    
+                    for ( int neighbor = 0; neighbor < 13; ++neighbor )
+                    {
+                        int neighborHead
+                            = cellHead[cellIndex( wrapCell( xCell + halfShell[neighbor][0], cellsPerSide ),
+                                                  wrapCell( yCell + halfShell[neighbor][1], cellsPerSide ),
+                                                  wrapCell( zCell + halfShell[neighbor][2], cellsPerSide ) )];
+                        
+                        for ( int first = head; first != -1; first = nextInCell[first] )
+                        {
+                            for ( int second = neighborHead; second != -1; second = nextInCell[second] )
+                            {
+                                addPairIfClose( rCoords, first, second, rPairs );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_CELLLIST_H
+#define MZR_CELLLIST_H
+
+/*! \file cellList.hh
+  \ingroup mzrGroup
+  \brief Finds close pairs of points in a periodic box.
+  
+  The box is divided into cells no narrower than the cutoff distance, so
+  every pair closer than the cutoff lies in one cell or in two adjacent
+  ones.  Finding the pairs then takes time proportional to the number of
+  points, when they are spread evenly, rather than to its square. */
+
+#include <utility>
+#include <vector>
+
+namespace mzr
+{
+    class cellList
+    {
+    public:
+        // Coordinates are given as x0, y0, z0, x1, y1, z1..., each in
+        // [0, boxSide).
+        cellList( double boxSide );
+        
+        // Bins the points for pairs closer than cutoff.
+        void
+        build( const std::vector<double>& rCoords,
+               double cutoff );
+        
+        // Appends each pair of points (by index) closer than the cutoff to
+        // one another, counting distance around the box, exactly once.
+        // rCoords must be the coordinates the list was built with.
+        void
+        findPairs( const std::vector<double>& rCoords,
+                   std::vector<std::pair<int, int> >& rPairs ) const;
+        
+        int
+        getCellsPerSide( void ) const
+        {
+            return cellsPerSide;
+        }
+        
+        static double
+        periodicDistanceSquared( const double* pFirst,
+                                 const double* pSecond,
+                                 double boxSide );
+        
+    private:
+        double boxSide;
+        double cutoff;
+        int cellsPerSide;
+        
+        // The first point in each cell, and the next point in the same cell
+        // as each point; -1 ends a list.
+        std::vector<int> cellHead;
+        std::vector<int> nextInCell;
+        
+        int
+        cellIndex( int xCell,
+                   int yCell,
+                   int zCell ) const;
+        
+        void
+        addPairIfClose( const std::vector<double>& rCoords,
+                        int first,
+                        int second,
+                        std::vector<std::pair<int, int> >& rPairs ) const;
+    };
+}
+
+#endif // MZR_CELLLIST_H
@@ -0,0 +1,236 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include "mzr/expansionHeuristic.hh"
+#include "mzr/mzrSpecies.hh"
+#include "mzr/mzrReaction.hh"
+#include "plex/mzrPlexSpecies.hh"
+#include "plex/mzrPlexFamily.hh"
+
+namespace mzr
+{
+    namespace
+    {
+        double
+        lookUp( const std::map<const mzrSpecies*, double>& rScores,
+                const mzrSpecies* pSpecies )
+        {
+            std::map<const mzrSpecies*, double>::const_iterator iEntry
+                = rScores.find( pSpecies );
+            
+            return iEntry == rScores.end() ? 0.0 : iEntry->second;
+        }
+        
+        void
+        raiseTo( std::map<const mzrSpecies*, double>& rScores,
+                 const mzrSpecies* pSpecies,
+                 double score )
+        {
+            std::map<const mzrSpecies*, double>::iterator iEntry
+                = rScores.find( pSpecies );
+            
+            if ( iEntry == rScores.end() )
+            {
+                rScores.insert( std::make_pair( pSpecies,
+                                                score ) );
+            }
+            else
+            {
+                iEntry->second = std::max( iEntry->second,
+                                           score );
+            }
+        }
+    }
+    
+    void
+    maxIncomingRateHeuristic::
+    noteReaction( const mzrReaction* pReaction )
+    {
+        const mzrReaction::multMap& rProducts = pReaction->getProducts();
+        
+        for ( mzrReaction::multMap::const_iterator iProduct = rProducts.begin();
+              iProduct != rProducts.end();
+              ++iProduct )
+        {
+            raiseTo( maxRate,
+                     iProduct->first,
+                     pReaction->getRate() );
+        }
+    }
+    
+    double
+    maxIncomingRateHeuristic::
+    getScore( const mzrSpecies* pSpecies ) const
+    {
+        return lookUp( maxRate,
+                       pSpecies );
+    }
+    
+    void
+    pathFluxHeuristic::
+    noteSeed( const mzrSpecies* pSpecies )
+    {
+        raiseTo( flux,
+                 pSpecies,
+                 1.0 );
+    }
+    
+    void
+    pathFluxHeuristic::
+    noteReaction( const mzrReaction* pReaction )
+    {
+        const mzrReaction::multMap& rReactants = pReaction->getReactants();
+        
+        // A reaction with no reactants is fed from outside the network.
+        double reactantFlux = rReactants.empty() ? 1.0 : lookUp( flux,
+                                                                 rReactants.begin()->first );
+        for ( mzrReaction::multMap::const_iterator iReactant = rReactants.begin();
+              iReactant != rReactants.end();
+              ++iReactant )
+        {
+            reactantFlux = std::min( reactantFlux,
+                                     lookUp( flux,
+                                             iReactant->first ) );
+        }
+        
+        const mzrReaction::multMap& rProducts = pReaction->getProducts();
+        
+        for ( mzrReaction::multMap::const_iterator iProduct = rProducts.begin();
+              iProduct != rProducts.end();
+              ++iProduct )
+        {
+            raiseTo( flux,
+                     iProduct->first,
+                     pReaction->getRate() * reactantFlux );
+        }
+    }
+    
+    double
+    pathFluxHeuristic::
+    getScore( const mzrSpecies* pSpecies ) const
+    {
+        return lookUp( flux,
+                       pSpecies );
+    }
+    
+    double
+    molCountHeuristic::
+    getScore( const mzrSpecies* pSpecies ) const
+    {
+        const plx::mzrPlexSpecies* pPlexSpecies
+            = dynamic_cast<const plx::mzrPlexSpecies*>( pSpecies );
+        
+        // Species that aren't complexes count as a single mol.
+        if ( ! pPlexSpecies ) return -1.0;
+        
+        return - static_cast<double>( pPlexSpecies->rFamily.getParadigm().mols.size() );
+    }
+    
+    std::string
+    unknownExpansionHeuristicXcpt::
+    mkMsg( const std::string& rHeuristicName )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Unknown expansion heuristic `"
+                  << rHeuristicName
+                  << "'; expected max-rate, path-flux or mol-count.";
+        return msgStream.str();
+    }
+    
+    expansionHeuristic*
+    makeExpansionHeuristic( const std::string& rHeuristicName )
+        throw( unknownExpansionHeuristicXcpt )
+    {
+        if ( rHeuristicName == "max-rate" ) return new maxIncomingRateHeuristic();
+        if ( rHeuristicName == "path-flux" ) return new pathFluxHeuristic();
+        if ( rHeuristicName == "mol-count" ) return new molCountHeuristic();
+        
+        throw unknownExpansionHeuristicXcpt( rHeuristicName );
+    }
+    
+    void
+    expansionQueue::
+    enqueue( mzrSpecies* pSpecies )
+    {
+        if ( pSpecies->hasNotified() ) return;
+        
+        entries.push( entry( 0 < seeds.count( pSpecies ),
+                             pHeuristic->getScore( pSpecies ),
+                             queuedCount++,
+                             pSpecies ) );
+    }
+    
+    void
+    expansionQueue::
+    addSeed( mzrSpecies* pSpecies )
+    {
+        if ( ! pHeuristic ) return;
+        
+        if ( seeds.insert( pSpecies ).second ) pHeuristic->noteSeed( pSpecies );
+    }
+    
+    void
+    expansionQueue::
+    addReaction( mzrReaction* pReaction )
+    {
+        if ( ! pHeuristic ) return;
+        
+        pHeuristic->noteReaction( pReaction );
+        
+        const mzrReaction::multMap& rProducts = pReaction->getProducts();
+        
+        for ( mzrReaction::multMap::const_iterator iProduct = rProducts.begin();
+              iProduct != rProducts.end();
+              ++iProduct )
+        {
+            enqueue( iProduct->first );
+        }
+    }
+    
+    void
+    expansionQueue::
+    addSpecies( mzrSpecies* pSpecies )
+    {
+        if ( ! pHeuristic ) return;
+        
+        enqueue( pSpecies );
+    }
+    
+    mzrSpecies*
+    expansionQueue::
+    popBest( void )
+    {
+        while ( ! entries.empty() )
+        {
+            mzrSpecies* pSpecies = entries.top().pSpecies;
+            entries.pop();
+            
+            if ( ! pSpecies->hasNotified() ) return pSpecies;
+        }
+        return 0;
+    }
+}
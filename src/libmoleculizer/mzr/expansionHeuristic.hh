@@ -0,0 +1,229 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_EXPANSIONHEURISTIC_H
+#define MZR_EXPANSIONHEURISTIC_H
+
+/*! \file expansionHeuristic.hh
+  \ingroup mzrGroup
+  \brief Orders species for bounded network expansion.
+  
+  A bounded expansion stops when it runs out of species or reactions,
+  so the order in which species are expanded decides which part of the
+  network it ends up with.  Without a heuristic, species are expanded
+  in catalog order.  With one, the explicit species of the model are
+  expanded first, and after that always the unexpanded species that
+  the heuristic scores highest. */
+
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+#include "utl/xcpt.hh"
+
+namespace mzr
+{
+    class mzrSpecies;
+    class mzrReaction;
+    
+    class expansionHeuristic
+    {
+    public:
+        virtual
+        ~expansionHeuristic( void )
+        {}
+        
+        virtual std::string
+        getName( void ) const = 0;
+        
+        // The explicit species of the model, noted before any reaction.
+        virtual void
+        noteSeed( const mzrSpecies* pSpecies )
+        {}
+        
+        // Every reaction in the network is noted, in the order it was
+        // added, before any of its products are scored.
+        virtual void
+        noteReaction( const mzrReaction* pReaction )
+        {}
+        
+        // Higher scores are expanded first.  A species' score may only
+        // go up as reactions are noted.
+        virtual double
+        getScore( const mzrSpecies* pSpecies ) const = 0;
+    };
+    
+    // Scores a species by the fastest reaction producing it.
+    class maxIncomingRateHeuristic :
+        public expansionHeuristic
+    {
+        std::map<const mzrSpecies*, double> maxRate;
+        
+    public:
+        std::string
+        getName( void ) const
+        {
+            return "max-rate";
+        }
+        
+        void
+        noteReaction( const mzrReaction* pReaction );
+        
+        double
+        getScore( const mzrSpecies* pSpecies ) const;
+    };
+    
+    // Scores a species by the best path to it from the seed species,
+    // where a seed has flux 1 and a reaction passes on its rate times
+    // the smallest flux among its reactants.  A species' flux is not
+    // revised when the flux into its reactants later improves.
+    class pathFluxHeuristic :
+        public expansionHeuristic
+    {
+        std::map<const mzrSpecies*, double> flux;
+        
+    public:
+        std::string
+        getName( void ) const
+        {
+            return "path-flux";
+        }
+        
+        void
+        noteSeed( const mzrSpecies* pSpecies );
+        
+        void
+        noteReaction( const mzrReaction* pReaction );
+        
+        double
+        getScore( const mzrSpecies* pSpecies ) const;
+    };
+    
+    // Prefers complexes with fewer mols, so the network grows outward
+    // from the monomers one binding at a time.
+    class molCountHeuristic :
+        public expansionHeuristic
+    {
+    public:
+        std::string
+        getName( void ) const
+        {
+            return "mol-count";
+        }
+        
+        double
+        getScore( const mzrSpecies* pSpecies ) const;
+    };
+    
+    class unknownExpansionHeuristicXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rHeuristicName );
+        
+    public:
+        unknownExpansionHeuristicXcpt( const std::string& rHeuristicName ) :
+            utl::xcpt( mkMsg( rHeuristicName ) )
+        {}
+    };
+    
+    // Makes a heuristic from one of the names above.  The caller owns it.
+    expansionHeuristic*
+    makeExpansionHeuristic( const std::string& rHeuristicName )
+        throw( unknownExpansionHeuristicXcpt );
+    
+    // The unexpanded species, best first, as scored by a heuristic.
+    // Seeds come before everything else.  Scores only go up, so a
+    // species whose score improves is simply queued again, and entries
+    // for species that have since been expanded are dropped as they
+    // come off the queue.  Without a heuristic, nothing is ever queued.
+    class expansionQueue
+    {
+        class entry
+        {
+        public:
+            bool isSeed;
+            double score;
+            long order;
+            mzrSpecies* pSpecies;
+            
+            entry( bool seed,
+                   double speciesScore,
+                   long queueOrder,
+                   mzrSpecies* pQueuedSpecies ) :
+                isSeed( seed ),
+                score( speciesScore ),
+                order( queueOrder ),
+                pSpecies( pQueuedSpecies )
+            {}
+            
+            // "Less" means expanded later: seeds first, then by score,
+            // then in the order the species were queued.
+            bool
+            operator<( const entry& rRight ) const
+            {
+                if ( isSeed != rRight.isSeed ) return rRight.isSeed;
+                if ( score != rRight.score ) return score < rRight.score;
+                return order > rRight.order;
+            }
+        };
+        
+        expansionHeuristic* pHeuristic;
+        std::priority_queue<entry> entries;
+        std::set<const mzrSpecies*> seeds;
+        long queuedCount;
+        
+        void
+        enqueue( mzrSpecies* pSpecies );
+        
+    public:
+        expansionQueue( expansionHeuristic* pExpansionHeuristic ) :
+            pHeuristic( pExpansionHeuristic ),
+            queuedCount( 0 )
+        {}
+        
+        // Notes an explicit species of the model with the heuristic.
+        // Seeds must all be added before the first reaction.
+        void
+        addSeed( mzrSpecies* pSpecies );
+        
+        // Notes the reaction with the heuristic and queues its
+        // unexpanded products at their new scores.
+        void
+        addReaction( mzrReaction* pReaction );
+        
+        // Queues the species, if it is unexpanded, at its current score.
+        void
+        addSpecies( mzrSpecies* pSpecies );
+        
+        // Returns null when no unexpanded species are queued.
+        mzrSpecies*
+        popBest( void );
+    };
+}
+
+#endif // MZR_EXPANSIONHEURISTIC_H
@@ -33,7 +33,11 @@
 
 #include "utl/xcpt.hh"
 #include "utl/writeOutputGraph.hh"
+#include "fnd/expansionProfiler.hh"
+#include "fnd/fndXcpt.hh"
+#include "fnd/memoryAccount.hh"
 #include "moleculizer.hh"
+#include "mzr/expansionHeuristic.hh"
 #include "mzr/spatialExtrapolationFunctions.hh"
 #include "unitsMgr.hh"
 #include "mol/molUnit.hh"
@@ -123,6 +127,39 @@ int setRateExtrapolation( moleculizer* handle, int extrapolation)
 }
 
 
+int setExpansionHeuristic( moleculizer* handle, char* heuristicName)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0,
+                            UNKNOWN_ERROR = 1,
+                            UNKNOWN_HEURISTIC = 2};
+
+    try
+    {
+        mzr::moleculizer* underlyingMoleculizerObject = convertCMzrPtrToMzrPtr( handle );
+
+        if ( heuristicName == 0 || std::string( heuristicName ) == "catalog-order" )
+        {
+            underlyingMoleculizerObject->setExpansionHeuristic( 0 );
+        }
+        else
+        {
+            underlyingMoleculizerObject->setExpansionHeuristic( mzr::makeExpansionHeuristic( heuristicName ) );
+        }
+    }
+    catch(mzr::unknownExpansionHeuristicXcpt e)
+    {
+        e.warn();
+        return UNKNOWN_HEURISTIC;
+    }
+    catch(...)
+    {
+        return UNKNOWN_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+
 int loadCommonRulesFile(moleculizer* handle, char* fileName)
 {
     // This function takes a string to a file containing an xml rules 
@@ -299,7 +336,8 @@ int expandNetwork( moleculizer* handle)
 {
     enum LOCAL_ERROR_TYPE { SUCCESS = 0,
                             UNKNOWN_ERROR = 1,
-                            NO_MODEL_LOADED_ERROR = 2};
+                            NO_MODEL_LOADED_ERROR = 2,
+                            MEMORY_BUDGET_REACHED = 3};
 
     try
     {
@@ -311,6 +349,78 @@ int expandNetwork( moleculizer* handle)
         x.what();
         return NO_MODEL_LOADED_ERROR;
     }
+    catch(fnd::memoryBudgetXcpt x)
+    {
+        return MEMORY_BUDGET_REACHED;
+    }
+    catch(...)
+    {
+        return UNKNOWN_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int setExpansionProfiling( moleculizer* handle, int enable)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0 };
+
+    convertCMzrPtrToMzrPtr( handle )->getExpansionProfiler().setEnabled( enable != 0 );
+    return SUCCESS;
+}
+
+int resetExpansionProfile( moleculizer* handle)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0 };
+
+    convertCMzrPtrToMzrPtr( handle )->getExpansionProfiler().reset();
+    return SUCCESS;
+}
+
+int getExpansionPhaseProfile( moleculizer* handle, int phase, long* numCalls, long* numCacheHits, double* seconds)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0,
+                            NO_SUCH_PHASE = 1};
+
+    if ( phase < 0 || phase >= fnd::expansionProfiler::PHASE_COUNT )
+    {
+        return NO_SUCH_PHASE;
+    }
+
+    const fnd::expansionProfiler& rProfiler = convertCMzrPtrToMzrPtr( handle )->getExpansionProfiler();
+    const fnd::expansionProfiler::phaseStats& rStats
+        = rProfiler.getPhaseStats( static_cast<fnd::expansionProfiler::phase>( phase ) );
+
+    *numCalls = rStats.calls;
+    *numCacheHits = rStats.cacheHits;
+    *seconds = rStats.nanoseconds * 1.0e-9;
+
+    return SUCCESS;
+}
+
+int writeExpansionProfile( moleculizer* handle, char* fileName, int format)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0,
+                            UNKNOWN_ERROR = 1,
+                            FILE_NOT_WRITABLE = 2,
+                            NO_SUCH_FORMAT = 3};
+
+    if ( format != fnd::expansionProfiler::JSON 
+         && format != fnd::expansionProfiler::FOLDED_STACKS )
+    {
+        return NO_SUCH_FORMAT;
+    }
+
+    try
+    {
+        convertCMzrPtrToMzrPtr( handle )->getExpansionProfiler().writeProfile( fileName,
+                                                                               static_cast<fnd::expansionProfiler::outputFormat>( format ) );
+    }
+    catch(fnd::badDumpFileXcpt x)
+    {
+        x.warn();
+        return FILE_NOT_WRITABLE;
+    }
     catch(...)
     {
         return UNKNOWN_ERROR;
@@ -319,10 +429,55 @@ int expandNetwork( moleculizer* handle)
     return SUCCESS;
 }
 
+int setMemoryBudget( moleculizer* handle, long numBytes)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0,
+                            NEGATIVE_BUDGET = 1};
+
+    if ( numBytes < 0 ) return NEGATIVE_BUDGET;
+
+    mzr::moleculizer* underlyingMoleculizerObject = convertCMzrPtrToMzrPtr( handle );
+    underlyingMoleculizerObject->getMemoryAccount().setBudget( numBytes );
+    return SUCCESS;
+}
+
+int getMemoryBudget( moleculizer* handle, long* numBytes, int* budgetReached)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0 };
+
+    const fnd::memoryAccount& rAccount = convertCMzrPtrToMzrPtr( handle )->getMemoryAccount();
+    *numBytes = rAccount.getBudget();
+    *budgetReached = rAccount.isOverBudget() ? 1 : 0;
+    return SUCCESS;
+}
+
+int getMemoryUsage( moleculizer* handle, int subsystem, long* numBytes)
+{
+    enum LOCAL_ERROR_TYPE { SUCCESS = 0,
+                            NO_SUCH_SUBSYSTEM = 1};
+
+    const fnd::memoryAccount& rAccount = convertCMzrPtrToMzrPtr( handle )->getMemoryAccount();
+
+    if ( subsystem == -1 )
+    {
+        *numBytes = rAccount.getTotalUsage();
+        return SUCCESS;
+    }
+
+    if ( subsystem < 0 || subsystem >= fnd::memoryAccount::SUBSYSTEM_COUNT )
+    {
+        return NO_SUCH_SUBSYSTEM;
+    }
+
+    *numBytes = rAccount.getUsage( static_cast<fnd::memoryAccount::subsystem>( subsystem ) );
+    return SUCCESS;
+}
+
 int getBoundedNetwork( moleculizer* handle, long maxNumSpecies, long maxNumReactions, species*** pSpeciesArray, int* pNumSpec, reaction*** pReactionArray, int* pNumRxns)
 {
     enum LOCAL_ERROR_TYPE { SUCCESS = 0,
-                            UNKNOWN_ERROR = 1};
+                            UNKNOWN_ERROR = 1,
+                            MEMORY_BUDGET_REACHED = 3};
 
     try
     {
@@ -364,6 +519,8 @@ int getBoundedNetwork( moleculizer* handle, long maxNumSpecies, long maxNumReact
         *pNumSpec = numSpecies;
         *pNumRxns = numRxns;
 
+        if ( underlyingMoleculizerObject->getStoppedByBudget() ) return MEMORY_BUDGET_REACHED;
+
         return SUCCESS;
     }
     catch(utl::xcpt x)
@@ -382,7 +539,8 @@ int incrementSpecies( moleculizer* handle, char* speciesTag)
 {
     enum LOCAL_ERROR_TYPE { SUCCESS = 0,
                             UNKNOWN_ERROR = 1,
-                            NON_EXISTANT_SPECIES_NAME = 2};
+                            NON_EXISTANT_SPECIES_NAME = 2,
+                            MEMORY_BUDGET_REACHED = 3};
     try
     {
         mzr::moleculizer* moleculizerPtr = convertCMzrPtrToMzrPtr( handle );
@@ -394,6 +552,10 @@ int incrementSpecies( moleculizer* handle, char* speciesTag)
         x.warn();
         return NON_EXISTANT_SPECIES_NAME;
     }
+    catch( fnd::memoryBudgetXcpt x )
+    {
+        return MEMORY_BUDGET_REACHED;
+    }
     catch(...)
     {
         return UNKNOWN_ERROR;
@@ -1251,7 +1413,11 @@ int checkSpeciesIDIsInSpeciesStream( moleculizer* handle, char* speciesID, char*
 int expandSpeciesByTag( moleculizer* handle, char* theTag) {
     try {
         mzr::moleculizer* underlyingMoleculizerObject = convertCMzrPtrToMzrPtr( handle );
-        underlyingMoleculizerObject->findSpecies(theTag)->expandReactionNetwork();
+        mzr::mzrSpecies* pSpecies = underlyingMoleculizerObject->findSpecies(theTag);
+        if ( ! pSpecies->hasNotified() && underlyingMoleculizerObject->getMemoryAccount().isOverBudget() ) return 3;
+
+        pSpecies->expandReactionNetwork();
+        underlyingMoleculizerObject->publishSnapshot();
         return 0;
     }
     catch(...) {
@@ -1263,7 +1429,11 @@ int expandSpeciesByTag( moleculizer* handle, char* theTag) {
 int expandSpeciesByID( moleculizer* handle, char* theID) {
     try {
         mzr::moleculizer* underlyingMoleculizerObject = convertCMzrPtrToMzrPtr( handle );
-        underlyingMoleculizerObject->getSpeciesWithUniqueID(theID)->expandReactionNetwork();
+        mzr::mzrSpecies* pSpecies = underlyingMoleculizerObject->getSpeciesWithUniqueID(theID);
+        if ( ! pSpecies->hasNotified() && underlyingMoleculizerObject->getMemoryAccount().isOverBudget() ) return 3;
+
+        pSpecies->expandReactionNetwork();
+        underlyingMoleculizerObject->publishSnapshot();
         return 0;
     }
     catch(...) {
@@ -90,6 +90,10 @@ extern "C" {
 
     int setRateExtrapolation( moleculizer* handle, int extrapolation);
 
+    /* Chooses which species getBoundedNetwork expands first: "max-rate",
+       "path-flux", "mol-count", or "catalog-order" (the default). */
+    int setExpansionHeuristic( moleculizer* handle, char* heuristicName);
+
 
 /*************************************************
 ** 
@@ -128,6 +132,41 @@ extern "C" {
 //     int expandSpecies( moleculizer* handle, species* mzrSpecies);
 //     int expandReaction(moleculizer* handle, reaction* mzrReaction);
 
+/*************************************************
+** 
+** Functions for profiling network expansion
+**
+*************************************************/
+
+    /* Each moleculizer has its own expansion profiler, off until enabled.  Phases are
+       numbered 0 recognition, 1 isomorphism search, 2 canonical naming,
+       3 omniplex connection, 4 rate extrapolation, 5 catalog insertion.
+       writeExpansionProfile writes JSON for format 0 and folded stacks, as read
+       by flamegraph.pl, for format 1. */
+    int setExpansionProfiling( moleculizer* handle, int enable);
+    int resetExpansionProfile( moleculizer* handle);
+    int getExpansionPhaseProfile( moleculizer* handle, int phase, long* numCalls, long* numCacheHits, double* seconds);
+    int writeExpansionProfile( moleculizer* handle, char* fileName, int format);
+
+/*************************************************
+** 
+** Functions for the memory budget of network expansion
+**
+*************************************************/
+
+    /* Memory use is estimated per subsystem, numbered 0 species catalog,
+       1 reaction maps, 2 recognizer cache, 3 plex families, 4 sensitivity
+       lists, 5 rate memos, 6 network snapshots; subsystem -1 gives the
+       total.  Each moleculizer has its own account and budget.  A budget of
+       0, the default, means none.  Once the budget is reached, expandNetwork
+       and getBoundedNetwork stop between species, leaving a consistent
+       partial network, and return 3 if species were left unexpanded;
+       getBoundedNetwork still hands back the partial network.  The
+       functions that expand one species return 3 without expanding it. */
+    int setMemoryBudget( moleculizer* handle, long numBytes);
+    int getMemoryBudget( moleculizer* handle, long* numBytes, int* budgetReached);
+    int getMemoryUsage( moleculizer* handle, int subsystem, long* numBytes);
+
 /*************************************************
 ** 
 ** Functions for viewing state
@@ -0,0 +1,219 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "mzr/modelStreamLoader.hh"
+#include "mzr/mzrEltName.hh"
+#include "utl/utility.hh"
+
+namespace mzr
+{
+    modelStreamLoader::modelStreamLoader( void )
+        :
+        xmlpp::SaxParser(),
+        pModelDocument( 0 ),
+        depth( 0 ),
+        section( RETAINED ),
+        sawGeneratedNetwork( false )
+    {}
+
+    modelStreamLoader::~modelStreamLoader( void )
+    {
+        delete pModelDocument;
+    }
+
+    xmlpp::Document*
+    modelStreamLoader::releaseModelDocument( void )
+    {
+        xmlpp::Document* pDoc = pModelDocument;
+        pModelDocument = 0;
+        return pDoc;
+    }
+
+    void
+    modelStreamLoader::on_start_document( void )
+    {
+        delete pModelDocument;
+        pModelDocument = new xmlpp::Document();
+
+        openElements.clear();
+        generatedNetworkDigest.clear();
+        generatedSpecies.clear();
+        generatedReactions.clear();
+        depth = 0;
+        section = RETAINED;
+        sawGeneratedNetwork = false;
+    }
+
+    void
+    modelStreamLoader::on_start_element( const Glib::ustring& name,
+                                         const AttributeList& attributes )
+    {
+        ++depth;
+
+        // Children of the root pick which kind of section we are in.
+        if ( depth == 2 )
+        {
+            if ( name == eltName::generatedNetwork )
+            {
+                sawGeneratedNetwork = true;
+                section = GENERATED_NETWORK;
+
+                for( AttributeList::const_iterator attrIter = attributes.begin();
+                     attrIter != attributes.end();
+                     ++attrIter )
+                {
+                    if ( attrIter->name == eltName::generatedNetwork_modelDigestAttr ) generatedNetworkDigest = attrIter->value;
+                }
+                return;
+            }
+            else if ( name == eltName::unitsStates )
+            {
+                section = SKIPPED;
+                return;
+            }
+            else
+            {
+                section = RETAINED;
+            }
+        }
+
+        if ( section == SKIPPED ) return;
+
+        if ( section != RETAINED )
+        {
+            startGeneratedNetworkElement( name, attributes );
+            return;
+        }
+
+        xmlpp::Element* pElt;
+        if ( openElements.empty() )
+        {
+            pElt = pModelDocument->create_root_node( name );
+        }
+        else
+        {
+            pElt = openElements.back()->add_child( name );
+        }
+
+        for( AttributeList::const_iterator attrIter = attributes.begin();
+             attrIter != attributes.end();
+             ++attrIter )
+        {
+            pElt->set_attribute( attrIter->name, attrIter->value );
+        }
+
+        openElements.push_back( pElt );
+    }
+
+    void
+    modelStreamLoader::startGeneratedNetworkElement( const Glib::ustring& name,
+                                                     const AttributeList& attributes )
+    {
+        // generated-network is at depth 2, its sections at depth 3 and
+        // their entries at depth 4.  The substrates, products and rate of a
+        // reaction are at depth 5, and the substrates and products
+        // themselves at depth 6.
+        if ( depth == 3 )
+        {
+            if ( name == eltName::generatedSpecies ) section = GENERATED_SPECIES;
+            else if ( name == eltName::generatedReactions ) section = GENERATED_REACTIONS;
+        }
+        else if ( section == GENERATED_SPECIES )
+        {
+            if ( depth != 4 || name != eltName::savedSpecies ) return;
+
+            std::string tag;
+            std::string uniqueID;
+            bool expanded = false;
+
+            for( AttributeList::const_iterator attrIter = attributes.begin();
+                 attrIter != attributes.end();
+                 ++attrIter )
+            {
+                if ( attrIter->name == eltName::savedSpecies_tagAttr ) tag = attrIter->value;
+                else if ( attrIter->name == eltName::savedSpecies_uniqueIdAttr ) uniqueID = attrIter->value;
+                else if ( attrIter->name == eltName::savedSpecies_expandedAttr ) expanded = ( attrIter->value == "true" );
+            }
+
+            generatedSpecies.push_back( generatedSpeciesRecord( tag, uniqueID, expanded ) );
+        }
+        else if ( section == GENERATED_REACTIONS )
+        {
+            if ( depth == 4 )
+            {
+                if ( name == eltName::reaction ) generatedReactions.push_back( generatedReactionRecord() );
+                return;
+            }
+
+            if ( generatedReactions.empty() ) return;
+            generatedReactionRecord& rRecord = generatedReactions.back();
+
+            if ( depth == 5 && name == eltName::rate )
+            {
+                for( AttributeList::const_iterator attrIter = attributes.begin();
+                     attrIter != attributes.end();
+                     ++attrIter )
+                {
+                    if ( attrIter->name == eltName::rate_valueAttr ) rRecord.rate = attrIter->value;
+                }
+            }
+            else if ( depth == 6 && ( name == eltName::savedSubstrate || name == eltName::savedProduct ) )
+            {
+                std::string tag;
+                int multiplicity = 1;
+
+                for( AttributeList::const_iterator attrIter = attributes.begin();
+                     attrIter != attributes.end();
+                     ++attrIter )
+                {
+                    // Substrates and products have the same attributes.
+                    if ( attrIter->name == eltName::savedSubstrate_tagAttr ) tag = attrIter->value;
+                    else if ( attrIter->name == eltName::savedSubstrate_multAttr ) utl::from_string( multiplicity, attrIter->value );
+                }
+
+                generatedReactionRecord::participantList& rParticipants
+                    = ( name == eltName::savedSubstrate ) ? rRecord.substrates : rRecord.products;
+                rParticipants.push_back( std::make_pair( tag, multiplicity ) );
+            }
+        }
+    }
+
+    void
+    modelStreamLoader::on_end_element( const Glib::ustring& name )
+    {
+        if ( section == RETAINED )
+        {
+            openElements.pop_back();
+        }
+        else if ( depth == 3 && ( section == GENERATED_SPECIES || section == GENERATED_REACTIONS ) )
+        {
+            section = GENERATED_NETWORK;
+        }
+
+        --depth;
+        if ( depth == 1 ) section = RETAINED;
+    }
+}
@@ -0,0 +1,166 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_MODELSTREAMLOADER_HH
+#define MZR_MODELSTREAMLOADER_HH
+
+#include <libxml++/libxml++.h>
+#include <string>
+#include <vector>
+
+namespace mzr
+{
+    // One <species> element out of a saved generated-network.  The tag is
+    // the one the species had in the run that saved the network; saved
+    // reactions refer to species by it.
+    class generatedSpeciesRecord
+    {
+    public:
+        std::string tag;
+        std::string uniqueID;
+        bool expanded;
+
+        generatedSpeciesRecord( const std::string& theTag,
+                                const std::string& theUniqueID,
+                                bool isExpanded )
+            :
+            tag( theTag ),
+            uniqueID( theUniqueID ),
+            expanded( isExpanded )
+        {}
+    };
+
+    typedef std::vector<generatedSpeciesRecord> generatedSpeciesRecords;
+
+    // One <reaction> element out of a saved generated-network.
+    class generatedReactionRecord
+    {
+    public:
+        // Saved species tag and multiplicity.
+        typedef std::vector<std::pair<std::string, int> > participantList;
+
+        participantList substrates;
+        participantList products;
+
+        // Kept as text, so that it is converted just the once, when the
+        // reaction is restored.
+        std::string rate;
+    };
+
+    typedef std::vector<generatedReactionRecord> generatedReactionRecords;
+
+    // Reads a moleculizer document with a SAX parser rather than building
+    // the whole thing as a DOM.
+    //
+    // Only the sections that the units parse, and that makeDomOutput copies
+    // back out (the root element, model and streams), are built into a
+    // document.  The generated-network section of a saved state file, which
+    // is by far the largest part, is turned into flat lists of species and
+    // reaction records as it is read, and unit-states are skipped entirely.
+    //
+    // Nothing is handed to the units from inside the parser callbacks, so
+    // that exceptions thrown while loading the model never have to cross
+    // libxml2.
+    class modelStreamLoader :
+        public xmlpp::SaxParser
+    {
+    public:
+        modelStreamLoader( void );
+        ~modelStreamLoader( void );
+
+        // The document holding the retained sections, or null if nothing
+        // was parsed.  Ownership passes to the caller.
+        xmlpp::Document*
+        releaseModelDocument( void );
+
+        const generatedSpeciesRecords&
+        getGeneratedSpecies( void ) const
+        {
+            return generatedSpecies;
+        }
+
+        const generatedReactionRecords&
+        getGeneratedReactions( void ) const
+        {
+            return generatedReactions;
+        }
+
+        // The model digest that the generated-network was saved with, or
+        // empty if it had none.
+        const std::string&
+        getGeneratedNetworkDigest( void ) const
+        {
+            return generatedNetworkDigest;
+        }
+
+        bool
+        hasGeneratedNetwork( void ) const
+        {
+            return sawGeneratedNetwork;
+        }
+
+    protected:
+        void
+        on_start_document( void );
+
+        void
+        on_start_element( const Glib::ustring& name,
+                          const AttributeList& attributes );
+
+        void
+        on_end_element( const Glib::ustring& name );
+
+    private:
+        enum sectionType
+        {
+            RETAINED,
+            GENERATED_NETWORK,
+            GENERATED_SPECIES,
+            GENERATED_REACTIONS,
+            SKIPPED
+        };
+
+        void
+        startGeneratedNetworkElement( const Glib::ustring& name,
+                                      const AttributeList& attributes );
+
+        xmlpp::Document* pModelDocument;
+
+        // Elements of the retained sections that are still open.
+        std::vector<xmlpp::Element*> openElements;
+
+        // Depth of the element being read; the root element is at depth 1.
+        int depth;
+        sectionType section;
+
+        bool sawGeneratedNetwork;
+        std::string generatedNetworkDigest;
+        generatedSpeciesRecords generatedSpecies;
+        generatedReactionRecords generatedReactions;
+    };
+}
+
+#endif // MZR_MODELSTREAMLOADER_HH
@@ -39,6 +39,8 @@
 #include "utl/utlXcpt.hh"
 #include "utl/dom.hh"
 #include "utl/linearHash.hh"
+#include "fnd/expansionProfiler.hh"
+#include "fnd/memoryAccount.hh"
 
 #include "mzr/moleculizer.hh"
 #include "mzr/mzrException.hh"
@@ -48,9 +50,11 @@
 
 #include "mzr/unitsMgr.hh"
 #include "mzr/mzrEltName.hh"
+#include "mzr/expansionHeuristic.hh"
 #include "mzr/inputCapTest.hh"
 #include "dimer/dimerUnit.hh"
 #include "ftr/ftrUnit.hh"
+#include "nmr/nameInterner.hh"
 
 #include "plex/mzrPlexFamily.hh"
 
@@ -162,10 +166,12 @@ namespace mzr
         :
         modelLoaded( false ),
         extrapolationEnabled( false ),
-        theParser( new xmlpp::DomParser )
+        pModelDocument( 0 ),
+        pExpansionHeuristic( 0 ),
+        stoppedByBudget( false ),
+        pReactionCapture( 0 ),
+        speciesBatchDepth( 0 )
     {
-        theParser->set_validate( false );
-
         pUserUnits = new unitsMgr( *this );
         
         // Now just does the "input capabilities" thing.
@@ -175,7 +181,8 @@ namespace mzr
     moleculizer::~moleculizer( void )
     {
         delete pUserUnits;
-	delete theParser;
+	delete pModelDocument;
+        delete pExpansionHeuristic;
     }
 
 
@@ -262,10 +269,9 @@ namespace mzr
 
   void moleculizer::loadXmlFileName( const std::string& filename )
   {
-
-    theParser->parse_file( filename );
-    if ( !(*theParser) ) throw utl::dom::noDocumentParsedXcpt();
-    this->loadParsedDocument( theParser->get_document() );
+    modelStreamLoader theLoader;
+    theLoader.parse_file( filename );
+    this->loadStreamedDocument( theLoader );
   }
 
   void moleculizer::loadCommonRulesFileName( const std::string& filename)
@@ -285,15 +291,54 @@ namespace mzr
     
   void moleculizer::loadXmlString( const std::string& documentAsString )
   {
-    theParser->parse_memory( documentAsString );
-    if ( !theParser ) throw utl::dom::noDocumentParsedXcpt();
-        
-    this->loadParsedDocument( theParser->get_document() );
+    modelStreamLoader theLoader;
+    theLoader.parse_memory( documentAsString );
+    this->loadStreamedDocument( theLoader );
   }
 
+    void
+    moleculizer::loadStreamedDocument( modelStreamLoader& rLoader )
+    {
+        if ( getModelHasBeenLoaded() )
+        {
+            throw utl::modelAlreadyLoadedXcpt();
+        }
+
+        xmlpp::Document* pDoc = rLoader.releaseModelDocument();
+        if ( !pDoc || !pDoc->get_root_node() )
+        {
+            delete pDoc;
+            throw utl::dom::noDocumentParsedXcpt();
+        }
+
+        // The streamed document never contains a generated-network, so this
+        // only builds the model.  The document only becomes the model
+        // document once it has loaded.
+        try
+        {
+            this->loadParsedDocument( pDoc );
+        }
+        catch( ... )
+        {
+            delete pDoc;
+            throw;
+        }
+
+        delete pModelDocument;
+        pModelDocument = pDoc;
+
+        if ( rLoader.hasGeneratedNetwork() )
+        {
+            this->loadGeneratedNetwork( rLoader.getGeneratedSpecies(),
+                                        rLoader.getGeneratedReactions(),
+                                        rLoader.getGeneratedNetworkDigest() );
+        }
+    }
+
     void moleculizer::writeInternalData(const std::string& fileName) 
     {
-	this->theParser->get_document()->write_to_file_formatted( fileName );
+        if ( !pModelDocument ) throw ModelNotLoadedXcpt("moleculizer::writeInternalData");
+	pModelDocument->write_to_file_formatted( fileName );
     }
 
   bool
@@ -332,6 +377,8 @@ namespace mzr
         xmlpp::Element* pStreamsElement = utl::dom::getOptionalChild( pRootElement,
                                                                       eltName::streams );
         
+        modelDigest = computeModelDigest( pModelElement );
+        
         // Extract model info.
         constructorCore( pRootElement,
                          pModelElement,
@@ -343,6 +390,10 @@ namespace mzr
                        prepareUnitToRun( pRootElement,
                                          pModelElement,
                                          pStreamsElement ) );
+        
+        // Every mol, site and modification name has been interned by now,
+        // so rank them once rather than as each one arrived.
+        nmr::NameInterner::rankNames();
 
         // Check to see if it has a "generated-network" tag, which would mean
         // it is an output mzr file being read in.
@@ -352,6 +403,9 @@ namespace mzr
         {
             this->loadGeneratedNetwork( pGeneratedNetworkElmt );
         }
+
+        // Readers in other threads can see the model from here on.
+        this->publishSnapshot();
     }
 
     void 
@@ -359,16 +413,308 @@ namespace mzr
     {
 
         xmlpp::Element* pGeneratedSpeciesElmt = \
-            utl::dom::mustGetUniqueChild( pGeneratedNetworkElmt, "generated-species" ); 
+            utl::dom::mustGetUniqueChild( pGeneratedNetworkElmt, eltName::generatedSpecies ); 
+
+        xmlpp::Node::NodeList genSpecNodes = pGeneratedSpeciesElmt->get_children( eltName::savedSpecies );
+
+        generatedSpeciesRecords generatedSpecies;
+        for( xmlpp::Node::NodeList::const_iterator nodeIter = genSpecNodes.begin();
+             nodeIter != genSpecNodes.end();
+             ++nodeIter )
+        {
+            const xmlpp::Element* pElement = dynamic_cast<const xmlpp::Element*>( *nodeIter );
+            if ( !pElement ) continue;
+
+            generatedSpecies.push_back
+                ( generatedSpeciesRecord( pElement->get_attribute_value( eltName::savedSpecies_tagAttr ),
+                                          utl::dom::mustGetAttrString( pElement, eltName::savedSpecies_uniqueIdAttr ),
+                                          utl::dom::mustGetAttrString( pElement, eltName::savedSpecies_expandedAttr ) == "true" ) );
+        }
+
+        // The reactions are only needed if the network can be restored as
+        // it was saved.
+        std::string savedModelDigest = pGeneratedNetworkElmt->get_attribute_value( eltName::generatedNetwork_modelDigestAttr );
+        generatedReactionRecords generatedReactions;
 
-        xmlpp::Node::NodeList genSpecNodes = pGeneratedSpeciesElmt->get_children("species");
+        xmlpp::Element* pGeneratedReactionsElmt
+            = utl::dom::getOptionalChild( pGeneratedNetworkElmt, eltName::generatedReactions );
+
+        if ( pGeneratedReactionsElmt && savedModelDigest == modelDigest )
+        {
+            xmlpp::Node::NodeList genRxnNodes = pGeneratedReactionsElmt->get_children( eltName::reaction );
+
+            for( xmlpp::Node::NodeList::const_iterator nodeIter = genRxnNodes.begin();
+                 nodeIter != genRxnNodes.end();
+                 ++nodeIter )
+            {
+                xmlpp::Element* pRxnElt = dynamic_cast<xmlpp::Element*>( *nodeIter );
+                if ( !pRxnElt ) continue;
 
-        std::for_each( genSpecNodes.begin(),
-                       genSpecNodes.end(),
-                       restoreGeneratedSpecies( *this ) );
+                generatedReactions.push_back( generatedReactionRecord() );
+                generatedReactionRecord& rRecord = generatedReactions.back();
 
-        return;
+                xmlpp::Element* pSubstratesElt = utl::dom::mustGetUniqueChild( pRxnElt, eltName::savedSubstrates );
+                xmlpp::Element* pProductsElt = utl::dom::mustGetUniqueChild( pRxnElt, eltName::savedProducts );
+                xmlpp::Element* pRateElt = utl::dom::mustGetUniqueChild( pRxnElt, eltName::rate );
 
+                xmlpp::Node::NodeList substrateNodes = pSubstratesElt->get_children( eltName::savedSubstrate );
+                for( xmlpp::Node::NodeList::const_iterator subIter = substrateNodes.begin();
+                     subIter != substrateNodes.end();
+                     ++subIter )
+                {
+                    const xmlpp::Element* pSubElt = dynamic_cast<const xmlpp::Element*>( *subIter );
+                    if ( !pSubElt ) continue;
+
+                    rRecord.substrates.push_back
+                        ( std::make_pair( utl::dom::mustGetAttrString( pSubElt, eltName::savedSubstrate_tagAttr ),
+                                          utl::dom::mustGetAttrInt( pSubElt, eltName::savedSubstrate_multAttr ) ) );
+                }
+
+                xmlpp::Node::NodeList productNodes = pProductsElt->get_children( eltName::savedProduct );
+                for( xmlpp::Node::NodeList::const_iterator prodIter = productNodes.begin();
+                     prodIter != productNodes.end();
+                     ++prodIter )
+                {
+                    const xmlpp::Element* pProdElt = dynamic_cast<const xmlpp::Element*>( *prodIter );
+                    if ( !pProdElt ) continue;
+
+                    rRecord.products.push_back
+                        ( std::make_pair( utl::dom::mustGetAttrString( pProdElt, eltName::savedProduct_tagAttr ),
+                                          utl::dom::mustGetAttrInt( pProdElt, eltName::savedProduct_multAttr ) ) );
+                }
+
+                rRecord.rate = utl::dom::mustGetAttrString( pRateElt, eltName::rate_valueAttr );
+            }
+        }
+
+        this->loadGeneratedNetwork( generatedSpecies,
+                                    generatedReactions,
+                                    savedModelDigest );
+    }
+
+    void
+    moleculizer::loadGeneratedNetwork( const generatedSpeciesRecords& generatedSpecies,
+                                       const generatedReactionRecords& generatedReactions,
+                                       const std::string& savedModelDigest )
+    {
+        // A network that was saved from this very model can be put back as
+        // it stands.  Otherwise, including for files saved without a digest,
+        // the expanded species are expanded again so that their reactions
+        // come from the rules as they are now.
+        if ( savedModelDigest.empty()
+             || savedModelDigest != modelDigest )
+        {
+            std::for_each( generatedSpecies.begin(),
+                           generatedSpecies.end(),
+                           restoreGeneratedSpecies( *this ) );
+            return;
+        }
+
+        std::map<std::string, mzrSpecies*> speciesBySavedTag;
+        for( generatedSpeciesRecords::const_iterator recordIter = generatedSpecies.begin();
+             recordIter != generatedSpecies.end();
+             ++recordIter )
+        {
+            if ( recordIter->uniqueID.empty() )
+            {
+                throw utl::xcpt( "Error: generated species element has no \"unique-id\" attribute." );
+            }
+
+            speciesBySavedTag[recordIter->tag] = getSpeciesWithUniqueID( recordIter->uniqueID );
+        }
+
+        if ( !restoreGeneratedReactions( generatedSpecies,
+                                         generatedReactions,
+                                         speciesBySavedTag ) )
+        {
+            std::for_each( generatedSpecies.begin(),
+                           generatedSpecies.end(),
+                           restoreGeneratedSpecies( *this ) );
+        }
+    }
+
+    namespace
+    {
+        // Rates are written out with enough digits to be read back exactly,
+        // so that a restored reaction has the very rate it was saved with.
+        std::string
+        stringifyRate( double rate )
+        {
+            std::ostringstream oss;
+            oss.precision( std::numeric_limits<double>::digits10 + 2 );
+            oss << rate;
+            return oss.str();
+        }
+
+        typedef std::pair<std::pair<mzrReaction::multMap, mzrReaction::multMap>,
+                          std::string> reactionSignature;
+        
+        reactionSignature
+        signatureOf( const mzrReaction* pRxn )
+        {
+            return reactionSignature( std::make_pair( pRxn->getReactants(),
+                                                      pRxn->getProducts() ),
+                                      stringifyRate( pRxn->getRate() ) );
+        }
+
+        bool
+        resolveParticipants( const generatedReactionRecord::participantList& rSaved,
+                             const std::map<std::string, mzrSpecies*>& speciesBySavedTag,
+                             mzrReaction::multMap& rResolved )
+        {
+            for( generatedReactionRecord::participantList::const_iterator savedIter = rSaved.begin();
+                 savedIter != rSaved.end();
+                 ++savedIter )
+            {
+                std::map<std::string, mzrSpecies*>::const_iterator found
+                    = speciesBySavedTag.find( savedIter->first );
+                if ( found == speciesBySavedTag.end() ) return false;
+
+                rResolved[found->second] += savedIter->second;
+            }
+            return true;
+        }
+    }
+
+    bool
+    moleculizer::restoreGeneratedReactions( const generatedSpeciesRecords& generatedSpecies,
+                                            const generatedReactionRecords& generatedReactions,
+                                            const std::map<std::string, mzrSpecies*>& speciesBySavedTag )
+    {
+        // Resolve all the saved reactions before touching the network, so
+        // that a bad file leaves it as it was.
+        std::vector<reactionSignature> savedSignatures;
+        savedSignatures.reserve( generatedReactions.size() );
+
+        for( generatedReactionRecords::const_iterator recordIter = generatedReactions.begin();
+             recordIter != generatedReactions.end();
+             ++recordIter )
+        {
+            mzrReaction::multMap substrates;
+            mzrReaction::multMap products;
+            double rate;
+
+            if ( ! ( resolveParticipants( recordIter->substrates, speciesBySavedTag, substrates )
+                     && resolveParticipants( recordIter->products, speciesBySavedTag, products )
+                     && utl::from_string( rate, recordIter->rate ) ) )
+            {
+                return false;
+            }
+
+            savedSignatures.push_back( reactionSignature( std::make_pair( substrates, products ),
+                                                          recordIter->rate ) );
+        }
+
+        // The saved network includes the reactions that loading the model
+        // has already made (the user's explicit reactions); count them so
+        // that they aren't made twice.
+        std::map<reactionSignature, int> existingReactions;
+        for( ReactionList::const_iterator rxnIter = getReactionList().begin();
+             rxnIter != getReactionList().end();
+             ++rxnIter )
+        {
+            ++existingReactions[signatureOf( *rxnIter )];
+        }
+
+        mzrUnit& rMzrUnit = * ( pUserUnits->pMzrUnit );
+        utl::autoVector<mzrReaction>* pRestoredReactions = new utl::autoVector<mzrReaction>();
+        rMzrUnit.addReactionFamily( pRestoredReactions );
+
+        for( std::vector<reactionSignature>::const_iterator sigIter = savedSignatures.begin();
+             sigIter != savedSignatures.end();
+             ++sigIter )
+        {
+            std::map<reactionSignature, int>::iterator existing
+                = existingReactions.find( *sigIter );
+            if ( existing != existingReactions.end() && 0 < existing->second )
+            {
+                --existing->second;
+                continue;
+            }
+
+            mzrReaction* pRxn = new mzrReaction( rMzrUnit.globalVars.begin(),
+                                                 rMzrUnit.globalVars.end() );
+
+            const mzrReaction::multMap& rSubstrates = sigIter->first.first;
+            for( mzrReaction::multMap::const_iterator subIter = rSubstrates.begin();
+                 subIter != rSubstrates.end();
+                 ++subIter )
+            {
+                pRxn->addReactant( subIter->first, subIter->second );
+            }
+
+            const mzrReaction::multMap& rProducts = sigIter->first.second;
+            for( mzrReaction::multMap::const_iterator prodIter = rProducts.begin();
+                 prodIter != rProducts.end();
+                 ++prodIter )
+            {
+                pRxn->addProduct( prodIter->first, prodIter->second );
+            }
+
+            double rate = 0.0;
+            utl::from_string( rate, sigIter->second );
+            pRxn->setRate( rate );
+
+            pRestoredReactions->addEntry( pRxn );
+            recordReaction( pRxn );
+        }
+
+        // Everything the expanded species generated is back in the network,
+        // so they only need to be known to their features again, for the
+        // sake of species that are expanded later.
+        for( generatedSpeciesRecords::const_iterator recordIter = generatedSpecies.begin();
+             recordIter != generatedSpecies.end();
+             ++recordIter )
+        {
+            if ( !recordIter->expanded ) continue;
+
+            mzrSpecies* pSpecies = speciesBySavedTag.find( recordIter->tag )->second;
+            pSpecies->markNotified( mzrSpecies::getGenerateDepth() );
+        }
+
+        return true;
+    }
+
+    std::string
+    moleculizer::computeModelDigest( xmlpp::Element* pModelElt )
+    {
+        // Only element names and attributes count, so that the digest
+        // doesn't depend on how the document was laid out or parsed.
+        std::ostringstream modelText;
+        std::vector<xmlpp::Element*> pendingElements( 1, pModelElt );
+
+        while ( !pendingElements.empty() )
+        {
+            xmlpp::Element* pElt = pendingElements.back();
+            pendingElements.pop_back();
+
+            modelText << '<' << pElt->get_name();
+
+            xmlpp::Element::AttributeList attributes = pElt->get_attributes();
+            for( xmlpp::Element::AttributeList::const_iterator attrIter = attributes.begin();
+                 attrIter != attributes.end();
+                 ++attrIter )
+            {
+                modelText << ' ' << ( *attrIter )->get_name() << "=\"" << ( *attrIter )->get_value() << '"';
+            }
+            modelText << '>';
+
+            // Children are pushed in reverse so that they come off in
+            // document order.
+            xmlpp::Node::NodeList children = pElt->get_children();
+            for( xmlpp::Node::NodeList::reverse_iterator childIter = children.rbegin();
+                 childIter != children.rend();
+                 ++childIter )
+            {
+                xmlpp::Element* pChildElt = dynamic_cast<xmlpp::Element*>( *childIter );
+                if ( pChildElt ) pendingElements.push_back( pChildElt );
+            }
+        }
+
+        std::string text = modelText.str();
+        utl::linearHash hashText;
+
+        return utl::stringify( text.size() ) + "-" + utl::stringify( hashText( text ) );
     }
     
     
@@ -410,8 +756,8 @@ namespace mzr
             = pDoc->create_root_node( eltName::moleculizerState );
 
         // Copy in the original model and streams stuff...
-        xmlpp::Document* originalDoc = theParser->get_document();
-        xmlpp::Element* originalRoot = originalDoc->get_root_node();
+        if ( !pModelDocument ) throw ModelNotLoadedXcpt("moleculizer::makeDomOutput");
+        xmlpp::Element* originalRoot = pModelDocument->get_root_node();
 
         xmlpp::Element* pInputModelElt = utl::dom::mustGetUniqueChild( originalRoot, eltName::model);
         xmlpp::Element* pInputStreamsElt = utl::dom::getOptionalChild( originalRoot, eltName::streams);
@@ -444,8 +790,8 @@ namespace mzr
             = pDoc->create_root_node( eltName::moleculizerState );
 
         // Copy in the original model and streams stuff...
-        xmlpp::Document* originalDoc = theParser->get_document();
-        xmlpp::Element* originalRoot = originalDoc->get_root_node();
+        if ( !pModelDocument ) throw ModelNotLoadedXcpt("moleculizer::makeDomOutput");
+        xmlpp::Element* originalRoot = pModelDocument->get_root_node();
 
         xmlpp::Element* pInputModelElt = utl::dom::mustGetUniqueChild( originalRoot, eltName::model);
         xmlpp::Element* pInputStreamsElt = utl::dom::getOptionalChild( originalRoot, eltName::streams);
@@ -489,8 +835,11 @@ namespace mzr
 
     void moleculizer::insertGeneratedNetwork( xmlpp::Element* generatedNetworkElt, bool verbose )
     {
-        xmlpp::Element* genSpecElt = generatedNetworkElt->add_child("generated-species");
-        xmlpp::Element* genRxnsElt = generatedNetworkElt->add_child("generated-reactions");
+        // Only a complete network can be restored without re-expansion.
+        generatedNetworkElt->set_attribute( eltName::generatedNetwork_modelDigestAttr, modelDigest );
+
+        xmlpp::Element* genSpecElt = generatedNetworkElt->add_child( eltName::generatedSpecies );
+        xmlpp::Element* genRxnsElt = generatedNetworkElt->add_child( eltName::generatedReactions );
 
 
         // Insert each of the generated species into the network.
@@ -498,17 +847,17 @@ namespace mzr
              specIter != this->getSpeciesCatalog().end();
              ++specIter)
         {
-            xmlpp::Element* newSpecElt = genSpecElt->add_child( "species");
-            newSpecElt->set_attribute("tag", *(specIter->first));
-            newSpecElt->set_attribute("unique-id", convertSpeciesTagToSpeciesID( *specIter->first));
+            xmlpp::Element* newSpecElt = genSpecElt->add_child( eltName::savedSpecies );
+            newSpecElt->set_attribute( eltName::savedSpecies_tagAttr, *(specIter->first));
+            newSpecElt->set_attribute( eltName::savedSpecies_uniqueIdAttr, convertSpeciesTagToSpeciesID( *specIter->first));
 
             if( specIter->second->hasNotified() ) 
             {
-                newSpecElt->set_attribute("expanded", "true" );
+                newSpecElt->set_attribute( eltName::savedSpecies_expandedAttr, "true" );
             }
             else
             {
-                newSpecElt->set_attribute("expanded", "false" );
+                newSpecElt->set_attribute( eltName::savedSpecies_expandedAttr, "false" );
             }
         }
 
@@ -519,10 +868,10 @@ namespace mzr
         {
             const mzr::mzrReaction* pRxn( *rxnIter );
 
-            xmlpp::Element* newRxnElt = genRxnsElt->add_child( "reaction");
-            xmlpp::Element* newSubstratesElt = newRxnElt->add_child("substrates");
-            xmlpp::Element* newProductsElt = newRxnElt->add_child("products");
-            xmlpp::Element* newRateElt = newRxnElt->add_child("rate");
+            xmlpp::Element* newRxnElt = genRxnsElt->add_child( eltName::reaction );
+            xmlpp::Element* newSubstratesElt = newRxnElt->add_child( eltName::savedSubstrates );
+            xmlpp::Element* newProductsElt = newRxnElt->add_child( eltName::savedProducts );
+            xmlpp::Element* newRateElt = newRxnElt->add_child( eltName::rate );
 
             // newRxnElt->set_attribute( "representation", pRxn->getName() );
 
@@ -535,12 +884,12 @@ namespace mzr
                 
                 const mzr::mzrReaction::multMap::value_type& vt( *reactantIter );
 
-                xmlpp::Element* newSubElt = newSubstratesElt->add_child("substrate");
-                newSubElt->set_attribute("multiplicity", utl::stringify(vt.second) );
-                newSubElt->set_attribute("tag", vt.first->getTag() );
+                xmlpp::Element* newSubElt = newSubstratesElt->add_child( eltName::savedSubstrate );
+                newSubElt->set_attribute( eltName::savedSubstrate_multAttr, utl::stringify(vt.second) );
+                newSubElt->set_attribute( eltName::savedSubstrate_tagAttr, vt.first->getTag() );
                 if(verbose)
                 {
-                    newSubElt->set_attribute("unique-id", vt.first->getName() );
+                    newSubElt->set_attribute( eltName::savedSubstrate_uniqueIdAttr, vt.first->getName() );
                 }
             }
 
@@ -551,16 +900,16 @@ namespace mzr
             {
                 const mzr::mzrReaction::multMap::value_type& vt( *productIter );
 
-                xmlpp::Element* newProdElt = newProductsElt->add_child("product");
-                newProdElt->set_attribute("multiplicity", utl::stringify(vt.second) );
-                newProdElt->set_attribute("tag", vt.first->getTag() );
+                xmlpp::Element* newProdElt = newProductsElt->add_child( eltName::savedProduct );
+                newProdElt->set_attribute( eltName::savedProduct_multAttr, utl::stringify(vt.second) );
+                newProdElt->set_attribute( eltName::savedProduct_tagAttr, vt.first->getTag() );
                 if(verbose)
                 {
-                    newProdElt->set_attribute("unique-id", vt.first->getName() );
+                    newProdElt->set_attribute( eltName::savedProduct_uniqueIdAttr, vt.first->getName() );
                 }
             }
 
-            newRateElt->set_attribute("value", utl::stringify(pRxn->getRate() ) );
+            newRateElt->set_attribute( eltName::rate_valueAttr, stringifyRate(pRxn->getRate() ) );
         }
         
     }
@@ -568,8 +917,8 @@ namespace mzr
 
     void moleculizer::insertGeneratedNetwork( xmlpp::Element* generatedNetworkElt, CachePosition pos, bool verbose )
     {
-        xmlpp::Element* genSpecElt = generatedNetworkElt->add_child("generated-species");
-        xmlpp::Element* genRxnsElt = generatedNetworkElt->add_child("generated-reactions");
+        xmlpp::Element* genSpecElt = generatedNetworkElt->add_child( eltName::generatedSpecies );
+        xmlpp::Element* genRxnsElt = generatedNetworkElt->add_child( eltName::generatedReactions );
 
 
         // Insert each of the generated species into the network.
@@ -578,18 +927,18 @@ namespace mzr
              specIter != pos.first;
              ++specIter )
         {
-            xmlpp::Element* newSpecElt = genSpecElt->add_child( "species");
+            xmlpp::Element* newSpecElt = genSpecElt->add_child( eltName::savedSpecies );
             
-            newSpecElt->set_attribute("tag", (*specIter)->getTag());
-            newSpecElt->set_attribute("unique-id", convertSpeciesTagToSpeciesID( (*specIter)->getTag()));
+            newSpecElt->set_attribute( eltName::savedSpecies_tagAttr, (*specIter)->getTag());
+            newSpecElt->set_attribute( eltName::savedSpecies_uniqueIdAttr, convertSpeciesTagToSpeciesID( (*specIter)->getTag()));
 
             if( (*specIter)->hasNotified() ) 
             {
-                newSpecElt->set_attribute("expanded", "true" );
+                newSpecElt->set_attribute( eltName::savedSpecies_expandedAttr, "true" );
             }
             else
             {
-                newSpecElt->set_attribute("expanded", "false" );
+                newSpecElt->set_attribute( eltName::savedSpecies_expandedAttr, "false" );
             }
         }
 
@@ -600,10 +949,10 @@ namespace mzr
         {
             const mzr::mzrReaction* pRxn( *rxnIter );
 
-            xmlpp::Element* newRxnElt = genRxnsElt->add_child( "reaction");
-            xmlpp::Element* newSubstratesElt = newRxnElt->add_child("substrates");
-            xmlpp::Element* newProductsElt = newRxnElt->add_child("products");
-            xmlpp::Element* newRateElt = newRxnElt->add_child("rate");
+            xmlpp::Element* newRxnElt = genRxnsElt->add_child( eltName::reaction );
+            xmlpp::Element* newSubstratesElt = newRxnElt->add_child( eltName::savedSubstrates );
+            xmlpp::Element* newProductsElt = newRxnElt->add_child( eltName::savedProducts );
+            xmlpp::Element* newRateElt = newRxnElt->add_child( eltName::rate );
 
             // newRxnElt->set_attribute( "representation", pRxn->getName() );
 
@@ -616,12 +965,12 @@ namespace mzr
                 
                 const mzr::mzrReaction::multMap::value_type& vt( *reactantIter );
 
-                xmlpp::Element* newSubElt = newSubstratesElt->add_child("substrate");
-                newSubElt->set_attribute("multiplicity", utl::stringify(vt.second) );
-                newSubElt->set_attribute("tag", vt.first->getTag() );
+                xmlpp::Element* newSubElt = newSubstratesElt->add_child( eltName::savedSubstrate );
+                newSubElt->set_attribute( eltName::savedSubstrate_multAttr, utl::stringify(vt.second) );
+                newSubElt->set_attribute( eltName::savedSubstrate_tagAttr, vt.first->getTag() );
                 if(verbose)
                 {
-                    newSubElt->set_attribute("unique-id", vt.first->getName() );
+                    newSubElt->set_attribute( eltName::savedSubstrate_uniqueIdAttr, vt.first->getName() );
                 }
             }
 
@@ -632,16 +981,16 @@ namespace mzr
             {
                 const mzr::mzrReaction::multMap::value_type& vt( *productIter );
 
-                xmlpp::Element* newProdElt = newProductsElt->add_child("product");
-                newProdElt->set_attribute("multiplicity", utl::stringify(vt.second) );
-                newProdElt->set_attribute("tag", vt.first->getTag() );
+                xmlpp::Element* newProdElt = newProductsElt->add_child( eltName::savedProduct );
+                newProdElt->set_attribute( eltName::savedProduct_multAttr, utl::stringify(vt.second) );
+                newProdElt->set_attribute( eltName::savedProduct_tagAttr, vt.first->getTag() );
                 if(verbose)
                 {
-                    newProdElt->set_attribute("unique-id", vt.first->getName() );
+                    newProdElt->set_attribute( eltName::savedProduct_uniqueIdAttr, vt.first->getName() );
                 }
             }
 
-            newRateElt->set_attribute("value", utl::stringify(pRxn->getRate() ) );
+            newRateElt->set_attribute( eltName::rate_valueAttr, stringifyRate(pRxn->getRate() ) );
         }
         
     }
@@ -719,8 +1068,10 @@ namespace mzr
 
         bool foundUnexpandedSpecies = false;
         mzrSpecies* ptrUnexpandedSpecies = NULL;
+        const fnd::memoryAccount& rAccount = this->getMemoryAccount();
+        stoppedByBudget = false;
 
-        while(true)
+        while( true )
         {
             foundUnexpandedSpecies = false;
 
@@ -738,6 +1089,16 @@ namespace mzr
 
             if (foundUnexpandedSpecies)
             {
+                // Stopping between expansions leaves every reaction's species
+                // in the network, though some of them go unexpanded.
+                if ( rAccount.isOverBudget() )
+                {
+                    stoppedByBudget = true;
+                    this->publishSnapshot();
+                    throw fnd::memoryBudgetXcpt( rAccount.getTotalUsage(),
+                                                 rAccount.getBudget() );
+                }
+
                 // Expand and continue...
                 ptrUnexpandedSpecies->expandReactionNetwork();
             }
@@ -748,6 +1109,7 @@ namespace mzr
             }
         }
 
+        this->publishSnapshot();
     }
 
     
@@ -790,6 +1152,38 @@ namespace mzr
         bool expandedOne = false;
         //      int numExpansions = 0;
 
+        stoppedByBudget = false;
+
+        // With an expansion heuristic, species come off a queue that starts
+        // with the explicit species of the model, then ranks the rest of
+        // the network as the reactions already in it score it, and is fed
+        // the reactions each expansion adds.  Without one, and for any
+        // species the queue never saw, the catalog is scanned in order.
+        expansionQueue theExpansionQueue( pExpansionHeuristic );
+        if ( pExpansionHeuristic )
+        {
+            for( std::map<std::string, std::string>::const_iterator userNameIter = userNameToSpeciesIDChart.begin();
+                 userNameIter != userNameToSpeciesIDChart.end();
+                 ++userNameIter)
+            {
+                theExpansionQueue.addSeed( this->findSpecies( convertSpeciesIDToSpeciesTag( userNameIter->second ) ) );
+            }
+            
+            for( ReactionListCIter rxnIter = this->getReactionList().begin();
+                 rxnIter != this->getReactionList().end();
+                 ++rxnIter)
+            {
+                theExpansionQueue.addReaction( *rxnIter );
+            }
+            
+            for( SpeciesCatalogCIter speciesIter = this->getSpeciesCatalog().begin();
+                 speciesIter != this->getSpeciesCatalog().end();
+                 ++speciesIter)
+            {
+                theExpansionQueue.addSpecies( speciesIter->second );
+            }
+        }
+
         // We start out good -- the reaction network is not too big, because we passed the precondition
         while( true )
         {
@@ -800,17 +1194,38 @@ namespace mzr
 //            if ( this->getReactionList().size() == 0)
             if ( true)
             {
+                mzrSpecies* pNextSpecies = theExpansionQueue.popBest();
+
                 for( SpeciesCatalogCIter speciesIter = this->getSpeciesCatalog().begin();
-                     speciesIter != this->getSpeciesCatalog().end();
+                     ( ! pNextSpecies ) && speciesIter != this->getSpeciesCatalog().end();
                      ++speciesIter)
                 {
                     if ( !speciesIter->second->hasNotified() )
                     {
-                        expandedOne = true;
-                        speciesIter->second->expandReactionNetwork();
-                        break;
+                        pNextSpecies = speciesIter->second;
                     }
                 }
+
+                // Stopping between expansions leaves every reaction's species
+                // in the network, though some of them go unexpanded.  The
+                // last expansion was within bounds, so the boundary is after
+                // it.
+                if ( pNextSpecies && this->getMemoryAccount().isOverBudget() )
+                {
+                    stoppedByBudget = true;
+
+                    ++specCacheMaxIter;
+                    ++rxnCacheMaxIter;
+
+                    this->publishSnapshot();
+                    return std::make_pair( specCacheMaxIter, rxnCacheMaxIter );
+                }
+
+                if ( pNextSpecies )
+                {
+                    expandedOne = true;
+                    pNextSpecies->expandReactionNetwork();
+                }
             }
             else
             {
@@ -842,9 +1257,18 @@ namespace mzr
 //                 std::cout << "(DEBUG) "<< getTotalNumberSpecies() << "\t" << getTotalNumberReactions() << "\tTOT" << std::endl;
 //                 std::cout << "(DEBUG) " << std::distance( theDeltaSpeciesList.begin(), specCacheMaxIter) << "\t" << std::distance( theDeltaReactionList.begin(), rxnCacheMaxIter) << "\tCALC" << std::endl;
 
+                this->publishSnapshot();
                 return std::make_pair( specCacheMaxIter, rxnCacheMaxIter);
             }
 
+            // Score whatever the expansion produced.
+            for( ReactionListIter newRxnIter = ++rxnCacheMaxIter;
+                 newRxnIter != theDeltaReactionList.end();
+                 ++newRxnIter)
+            {
+                theExpansionQueue.addReaction( *newRxnIter );
+            }
+
             specCacheMaxIter = theDeltaSpeciesList.end();
             rxnCacheMaxIter = theDeltaReactionList.end();
 
@@ -864,12 +1288,18 @@ namespace mzr
 //                 std::cout << "(DEBUG) NUMSPEC\tNUMRXNS\tExpansions - " << numExpansions << "\n";
 //                 std::cout << "(DEBUG) "<< getTotalNumberSpecies() << "\t" << getTotalNumberReactions() <<  "\tTOT" << std::endl;
 //                 std::cout << "(DEBUG) " << std::distance( theDeltaSpeciesList.begin(), theDeltaSpeciesList.end()) << "\t" << std::distance( theDeltaReactionList.begin(), theDeltaReactionList.end()) << "\tCALC" << std::endl;
+                this->publishSnapshot();
                 return std::make_pair( theDeltaSpeciesList.end(), theDeltaReactionList.end() );
             }
 
         }
     }
              
+    bool moleculizer::getStoppedByBudget( void ) const
+    {
+        return stoppedByBudget;
+    }
+    
     bool moleculizer::getRateExtrapolation( void ) const
     {
         return extrapolationEnabled;
@@ -886,11 +1316,35 @@ namespace mzr
         extrapolationEnabled = rateExtrapolation;
     }
     
+    void
+    moleculizer::setExpansionHeuristic( expansionHeuristic* pHeuristic )
+    {
+        if ( pHeuristic != pExpansionHeuristic ) delete pExpansionHeuristic;
+        pExpansionHeuristic = pHeuristic;
+    }
+
+    const expansionHeuristic*
+    moleculizer::getExpansionHeuristic( void ) const
+    {
+        return pExpansionHeuristic;
+    }
+
     int 
     moleculizer::getNumberOfSpeciesInSpeciesStream(const std::string& streamName) const 
     {
-        // TODO
-        return 0;
+        fnd::dumpable<fnd::basicDumpable::dumpArg>* ptrDumpable = 
+            pUserUnits->pMzrUnit->mustFindDumpable( streamName );
+        
+        mzr::multiSpeciesDumpable<plx::mzrPlexSpecies>* streamPtr
+            = dynamic_cast< mzr::multiSpeciesDumpable<plx::mzrPlexSpecies>* >( ptrDumpable );
+        
+        if (!streamPtr)
+        {
+            std::cerr << "Error finding dumpable " << streamName << std::endl;
+            exit(1);
+        }
+        
+        return streamPtr->getSpeciesCount();
     }
 
     void 
@@ -905,15 +1359,14 @@ namespace mzr
         
         streamPtr = dynamic_cast< mzr::multiSpeciesDumpable<plx::mzrPlexSpecies>* >( ptrDumpable);
         
-        const std::vector<const plx::mzrPlexSpecies*>* theSpecies = streamPtr->getSpeciesInMultiSpeciesStream();
-        
-        
         if (!streamPtr)
         {
             std::cerr << "Error finding dumpable " << streamName << std::endl;
             exit(1);
         }
         
+        const std::vector<const plx::mzrPlexSpecies*>* theSpecies = streamPtr->getSpeciesInMultiSpeciesStream();
+        
         for( std::vector<const plx::mzrPlexSpecies*>::const_iterator ssIter = theSpecies->begin();
              ssIter != theSpecies->end();
              ++ssIter)
@@ -1144,23 +1597,106 @@ namespace mzr
     bool
     moleculizer::recordSpecies( mzrSpecies* pSpec)
     {
+        if ( pReactionCapture )
+        {
+            pReactionCapture->captureSpecies( pSpec );
+            return false;
+        }
+        
+        if ( 0 < speciesBatchDepth )
+        {
+            batchedSpecies.push_back( pSpec );
+            return false;
+        }
+        
+        fnd::profilePhase profile( getExpansionProfiler(),
+                                   fnd::expansionProfiler::CATALOG_INSERTION );
+        
         bool doNotify;
         doNotify = fnd::ReactionNetworkDescription<mzrSpecies, mzrReaction>::recordSpecies(pSpec);
         if(doNotify) pSpec->inform();
 
+        if ( doNotify && getExpansionProfiler().isEnabled() ) getExpansionProfiler().noteSpeciesMade();
+
         return doNotify;
     }
 
     bool
     moleculizer::recordSpecies( mzrSpecies* pSpec, SpeciesID& theID)
     {
+        if ( pReactionCapture )
+        {
+            theID = pSpec->getTag();
+            pReactionCapture->captureSpecies( pSpec );
+            return false;
+        }
+        
+        if ( 0 < speciesBatchDepth )
+        {
+            theID = pSpec->getTag();
+            batchedSpecies.push_back( pSpec );
+            return false;
+        }
+        
+        fnd::profilePhase profile( getExpansionProfiler(),
+                                   fnd::expansionProfiler::CATALOG_INSERTION );
+        
         bool doNotify;
         doNotify = fnd::ReactionNetworkDescription<mzrSpecies, mzrReaction>::recordSpecies(pSpec, theID);
         if(doNotify) pSpec->inform();
 
+        if ( doNotify && getExpansionProfiler().isEnabled() ) getExpansionProfiler().noteSpeciesMade();
+
         return doNotify;
     }
 
+    void
+    moleculizer::endSpeciesBatch( void )
+    {
+        if ( 0 < --speciesBatchDepth ) return;
+        
+        // Swapped out first, so that recording can't add to the batch
+        // being recorded.
+        std::vector<mzrSpecies*> heldSpecies;
+        heldSpecies.swap( batchedSpecies );
+        
+        std::vector<plx::mzrPlexSpecies*> heldPlexSpecies;
+        for ( std::vector<mzrSpecies*>::const_iterator iSpec = heldSpecies.begin();
+              iSpec != heldSpecies.end();
+              ++iSpec )
+        {
+            plx::mzrPlexSpecies* pPlexSpec = dynamic_cast<plx::mzrPlexSpecies*>( *iSpec );
+            if ( pPlexSpec ) heldPlexSpecies.push_back( pPlexSpec );
+        }
+        plx::mzrPlexSpecies::generateNames( heldPlexSpecies );
+        
+        for ( std::vector<mzrSpecies*>::const_iterator iSpec = heldSpecies.begin();
+              iSpec != heldSpecies.end();
+              ++iSpec )
+        {
+            recordSpecies( *iSpec );
+        }
+    }
+
+    bool
+    moleculizer::recordReaction( mzrReaction* pRxn )
+    {
+        if ( pReactionCapture )
+        {
+            pReactionCapture->captureReaction( pRxn );
+            return false;
+        }
+        
+        fnd::profilePhase profile( getExpansionProfiler(),
+                                   fnd::expansionProfiler::CATALOG_INSERTION );
+        
+        bool recorded = fnd::ReactionNetworkDescription<mzrSpecies, mzrReaction>::recordReaction( pRxn );
+        
+        if ( recorded && getExpansionProfiler().isEnabled() ) getExpansionProfiler().noteReactionMade();
+        
+        return recorded;
+    }
+
 
     int moleculizer::getMolCountInSpecies(const std::string& molName, const mzr::mzrSpecies* pSpec) const 
     {
@@ -1201,11 +1737,23 @@ namespace mzr
 	std::string uniqueID = utl::dom::mustGetAttrString( pElement, "unique-id" );
 	std::string isExpanded = utl::dom::mustGetAttrString( pElement, "expanded");
 
-	const mzrSpecies* pSpecies = rMolzer.getSpeciesWithUniqueID( uniqueID );
+	(*this)( generatedSpeciesRecord( pElement->get_attribute_value( "tag" ),
+					 uniqueID,
+					 isExpanded == "true" ) );
+    }
+
+    void restoreGeneratedSpecies::operator()( const generatedSpeciesRecord& rRecord )
+    {
+	if ( rRecord.uniqueID.empty() )
+	{
+	    throw utl::xcpt( "Error: generated species element has no \"unique-id\" attribute." );
+	}
+
+	const mzrSpecies* pSpecies = rMolzer.getSpeciesWithUniqueID( rRecord.uniqueID );
 
 	std::string tag = pSpecies->getTag();
             
-	if ( isExpanded == "true" )
+	if ( rRecord.expanded )
 	{
 	    rMolzer.incrementNetworkBySpeciesTag( tag );
 	}
@@ -40,11 +40,30 @@
 #include "mzr/mzrSpecies.hh"
 #include "mzr/mzrReaction.hh"
 #include "mzr/pythonRulesManager.hh"
+#include "mzr/modelStreamLoader.hh"
 
 
 namespace mzr
 {
     class unitsMgr;
+    class expansionHeuristic;
+    
+    // Takes the species and reactions that reaction generation makes, in
+    // place of the catalog, while it is set with
+    // moleculizer::setReactionCapture.
+    class reactionCapture
+    {
+    public:
+        virtual
+        ~reactionCapture( void )
+        {}
+        
+        virtual void
+        captureSpecies( mzrSpecies* pSpecies ) = 0;
+        
+        virtual void
+        captureReaction( mzrReaction* pReaction ) = 0;
+    };
     
     // The main bulk of this class can be found in ReactionNetworkDescription.
     class moleculizer :
@@ -69,10 +88,20 @@ namespace mzr
         void loadXmlFileName( const std::string& aFileName );
         void loadXmlString( const std::string& documentAsString );
         void loadGeneratedNetwork( xmlpp::Element* pGeneratedNetworkElmt);
+        void loadGeneratedNetwork( const generatedSpeciesRecords& generatedSpecies,
+                                   const generatedReactionRecords& generatedReactions,
+                                   const std::string& savedModelDigest );
         void loadParsedDocument( xmlpp::Document* pDoc );
 	void writeInternalData(const std::string& data );
         bool getModelHasBeenLoaded() const;
 
+        // A digest of the element names and attributes of a model element.
+        // A complete generated-network is saved with the digest of the model
+        // that generated it, so that when it is loaded again it can be
+        // restored as it stands, rather than regenerated, when the model is
+        // unchanged.
+        static std::string computeModelDigest( xmlpp::Element* pModelElt );
+
         // These functions are used for reading in rules statements, one at a time.
         void addParameterStatement(const std::string& statement );
         void addModificationStatement( std::string& statement);
@@ -118,8 +147,26 @@ namespace mzr
         //
         //////////////////////////////////////////////////
 
+        // Both stop early, with the network consistent, when the budget of
+        // getMemoryAccount() is reached, which is checked before each
+        // species is expanded.  The complete expansion then throws
+        // fnd::memoryBudgetXcpt.  The bounded one returns the delta
+        // boundary, which at a budget stop falls after everything
+        // generated so far, since nothing was left half expanded, rather
+        // than before the last expansion, as when a bound is overshot.
         void generateCompleteNetwork();
         CachePosition generateCompleteNetwork(long maxNumSpecies, long maxNumRxns = -1);
+        
+        // Whether the last generateCompleteNetwork stopped at the memory
+        // budget, with species left unexpanded, rather than at a bound or
+        // at the end of the network.
+        bool getStoppedByBudget( void ) const;
+
+        // Decides which species a bounded expansion expands first (see
+        // expansionHeuristic.hh).  The moleculizer takes ownership; null,
+        // the default, expands species in catalog order.
+        void setExpansionHeuristic( expansionHeuristic* pHeuristic );
+        const expansionHeuristic* getExpansionHeuristic( void ) const;
 
 
         //////////////////////////////////////////////////
@@ -206,6 +253,44 @@ namespace mzr
         virtual bool
         recordSpecies( mzrSpecies*, SpeciesID&);
 
+        // Overrides the base version, to account reactions to the expansion
+        // profiler.  The base version is virtual, so that mustRecordReaction
+        // and calls through the base class come here too.
+        using fnd::ReactionNetworkDescription<mzrSpecies, mzrReaction>::recordReaction;
+        
+        virtual bool
+        recordReaction( mzrReaction* );
+
+        // While a capture is set, recordSpecies and recordReaction hand
+        // what they are given to it, and leave the catalog alone.  Null
+        // clears the capture.
+        void
+        setReactionCapture( reactionCapture* pCapture )
+        {
+            pReactionCapture = pCapture;
+        }
+        
+        reactionCapture*
+        getReactionCapture( void ) const
+        {
+            return pReactionCapture;
+        }
+        
+        // While a species batch is open, recordSpecies holds new species
+        // back and returns false.  Closing the outermost batch names all
+        // the held species in one canonicalization pass and then records
+        // them in the order they came.  Complex species open a batch around
+        // each respond, so the complexes one respond makes are named
+        // together.  Batches nest; a capture takes precedence.
+        void
+        beginSpeciesBatch( void )
+        {
+            ++speciesBatchDepth;
+        }
+        
+        void
+        endSpeciesBatch( void );
+
 
         //////////////////////////////////////////////////
         // 
@@ -218,9 +303,19 @@ namespace mzr
 
     protected:
         void setModelHasBeenLoaded( bool value );
+
+        void loadStreamedDocument( modelStreamLoader& rLoader );
         
         void insertGeneratedNetwork( xmlpp::Element* generatedNetworkElt, CachePosition pos, bool verbose );
         void insertGeneratedNetwork( xmlpp::Element* generatedNetworkElement, bool verbose );
+
+        // Puts the saved reactions straight back into the network, and marks
+        // the expanded species as such without expanding them again.
+        // Returns false, having changed nothing, if some saved reaction
+        // refers to a species that isn't in the saved network.
+        bool restoreGeneratedReactions( const generatedSpeciesRecords& generatedSpecies,
+                                        const generatedReactionRecords& generatedReactions,
+                                        const std::map<std::string, mzrSpecies*>& speciesBySavedTag );
         
         
 
@@ -279,8 +374,22 @@ namespace mzr
 
       PythonRulesManager rulesManager;
 
-        // Now we store a copy of the parser, so that people can get a copy of the rules, at any time.
-        xmlpp::DomParser* theParser;
+        // The root, model and streams sections of the loaded document, so that
+        // people can get a copy of the rules at any time.  The rest of the
+        // input (a saved generated-network, for example) is not retained.
+        xmlpp::Document* pModelDocument;
+
+        // Digest of the model section that was loaded.
+        std::string modelDigest;
+
+        expansionHeuristic* pExpansionHeuristic;
+        
+        bool stoppedByBudget;
+
+        reactionCapture* pReactionCapture;
+        
+        int speciesBatchDepth;
+        std::vector<mzrSpecies*> batchedSpecies;
 
     };
 
@@ -294,6 +403,7 @@ namespace mzr
         {}
         
         void operator()( const xmlpp::Node* pNode );
+        void operator()( const generatedSpeciesRecord& rRecord );
 
     private:
         moleculizer& rMolzer;
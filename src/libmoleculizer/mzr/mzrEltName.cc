@@ -56,6 +56,7 @@ namespace mzr
         const std::string streams ("streams");
         const std::string events ("events");
         const std::string generatedNetwork("generated-network");
+        const std::string generatedNetwork_modelDigestAttr("model-digest");
         
         const std::string explicitSpecies ("explicit-species");
         
@@ -154,5 +155,22 @@ namespace mzr
         const std::string taggedDumpStream_dumpPeriodAttr ("dump-period");
         const std::string taggedSpeciesStreamRef ("tagged-species-stream-ref");
         const std::string taggedSpeciesStreamRef_nameAttr ("name");
+        
+        const std::string generatedSpecies ("generated-species");
+        const std::string savedSpecies ("species");
+        const std::string savedSpecies_tagAttr ("tag");
+        const std::string savedSpecies_uniqueIdAttr ("unique-id");
+        const std::string savedSpecies_expandedAttr ("expanded");
+        const std::string generatedReactions ("generated-reactions");
+        const std::string savedSubstrates ("substrates");
+        const std::string savedSubstrate ("substrate");
+        const std::string savedSubstrate_multAttr ("multiplicity");
+        const std::string savedSubstrate_tagAttr ("tag");
+        const std::string savedSubstrate_uniqueIdAttr ("unique-id");
+        const std::string savedProducts ("products");
+        const std::string savedProduct ("product");
+        const std::string savedProduct_multAttr ("multiplicity");
+        const std::string savedProduct_tagAttr ("tag");
+        const std::string savedProduct_uniqueIdAttr ("unique-id");
     }
 }
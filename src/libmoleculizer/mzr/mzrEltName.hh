@@ -56,6 +56,7 @@ namespace mzr
         extern const std::string streams;
         extern const std::string events;
         extern const std::string generatedNetwork;
+        extern const std::string generatedNetwork_modelDigestAttr;
         
         extern const std::string explicitSpecies;
         
@@ -154,6 +155,25 @@ namespace mzr
         extern const std::string taggedDumpStream_dumpPeriodAttr;
         extern const std::string taggedSpeciesStreamRef;
         extern const std::string taggedSpeciesStreamRef_nameAttr;
+        
+        // The generated network in a state file.  Reactions are written
+        // as eltName::reaction, with an eltName::rate.
+        extern const std::string generatedSpecies;
+        extern const std::string savedSpecies;
+        extern const std::string savedSpecies_tagAttr;
+        extern const std::string savedSpecies_uniqueIdAttr;
+        extern const std::string savedSpecies_expandedAttr;
+        extern const std::string generatedReactions;
+        extern const std::string savedSubstrates;
+        extern const std::string savedSubstrate;
+        extern const std::string savedSubstrate_multAttr;
+        extern const std::string savedSubstrate_tagAttr;
+        extern const std::string savedSubstrate_uniqueIdAttr;
+        extern const std::string savedProducts;
+        extern const std::string savedProduct;
+        extern const std::string savedProduct_multAttr;
+        extern const std::string savedProduct_tagAttr;
+        extern const std::string savedProduct_uniqueIdAttr;
     }
 }
 
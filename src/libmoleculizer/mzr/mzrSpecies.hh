@@ -32,6 +32,7 @@
 #ifndef SPECIES_H
 #define SPECIES_H
 
+#include <cstddef>
 #include "fnd/basicSpecies.hh"
 #include "fnd/massive.hh"
 #include "mzr/mzrReaction.hh"
@@ -70,6 +71,11 @@ namespace mzr
 
         virtual void inform(){}
         
+        // The size of this species and of what it alone holds, as charged
+        // to the moleculizer's memoryAccount when the species is recorded.
+        virtual std::size_t
+        getObjectBytes( void ) const = 0;
+        
         static unsigned int generateDepth;
         
         
@@ -0,0 +1,643 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <libxml++/libxml++.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include "utl/dom.hh"
+#include "utl/utility.hh"
+#include "mzr/modelStreamLoader.hh"
+#include "mzr/moleculizer.hh"
+#include "mzr/mzrEltName.hh"
+#include "mzr/networkDiff.hh"
+
+namespace mzr
+{
+    std::string
+    badSavedNetworkXcpt::
+    mkMsg( const std::string& rFileName,
+           const std::string& rProblem )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Saved network `"
+                  << rFileName
+                  << "' "
+                  << rProblem
+                  << ".";
+        return msgStream.str();
+    }
+    
+    std::string
+    networkModelMismatchXcpt::
+    mkMsg( const std::string& rFirstFileName,
+           const std::string& rSecondFileName )
+    {
+        std::ostringstream msgStream;
+        msgStream << "Saved networks `"
+                  << rFirstFileName
+                  << "' and `"
+                  << rSecondFileName
+                  << "' were generated from different models.";
+        return msgStream.str();
+    }
+    
+    namespace
+    {
+        void
+        resolveParticipants( const generatedReactionRecord::participantList& rSaved,
+                             const std::map<std::string, std::string>& uniqueIdByTag,
+                             const std::string& rFileName,
+                             savedNetwork::participantList& rResolved )
+        {
+            std::map<std::string, int> multByUniqueId;
+            
+            for( generatedReactionRecord::participantList::const_iterator savedIter = rSaved.begin();
+                 savedIter != rSaved.end();
+                 ++savedIter )
+            {
+                std::map<std::string, std::string>::const_iterator found
+                    = uniqueIdByTag.find( savedIter->first );
+                if ( found == uniqueIdByTag.end() )
+                {
+                    throw badSavedNetworkXcpt( rFileName,
+                                               "has a reaction with unknown species tag `"
+                                               + savedIter->first
+                                               + "'" );
+                }
+                
+                multByUniqueId[found->second] += savedIter->second;
+            }
+            
+            rResolved.assign( multByUniqueId.begin(),
+                              multByUniqueId.end() );
+        }
+    }
+    
+    savedNetwork::
+    savedNetwork( const std::string& rFileName )
+        throw( utl::xcpt ) :
+        fileName( rFileName ),
+        reactionCount( 0 ),
+        pModelDocument( 0 )
+    {
+        modelStreamLoader theLoader;
+        try
+        {
+            theLoader.parse_file( rFileName );
+        }
+        catch( const xmlpp::exception& )
+        {
+            throw badSavedNetworkXcpt( rFileName, "could not be parsed" );
+        }
+        
+        if ( !theLoader.hasGeneratedNetwork() )
+        {
+            throw badSavedNetworkXcpt( rFileName, "has no generated-network" );
+        }
+        
+        // Only the model section is needed from the document, for its digest
+        // and for writing merged networks.
+        pModelDocument = theLoader.releaseModelDocument();
+        if ( !pModelDocument || !pModelDocument->get_root_node() )
+        {
+            delete pModelDocument;
+            throw badSavedNetworkXcpt( rFileName, "has no document element" );
+        }
+        
+        try
+        {
+            readRecords( theLoader );
+        }
+        catch( ... )
+        {
+            delete pModelDocument;
+            throw;
+        }
+    }
+    
+    void
+    savedNetwork::
+    readRecords( const modelStreamLoader& rLoader )
+    {
+        const generatedSpeciesRecords& rSavedSpecies = rLoader.getGeneratedSpecies();
+        std::map<std::string, std::string> uniqueIdByTag;
+        
+        for( generatedSpeciesRecords::const_iterator recordIter = rSavedSpecies.begin();
+             recordIter != rSavedSpecies.end();
+             ++recordIter )
+        {
+            if ( recordIter->uniqueID.empty() )
+            {
+                throw badSavedNetworkXcpt( fileName,
+                                           "has species `"
+                                           + recordIter->tag
+                                           + "' with no unique-id" );
+            }
+            
+            speciesEntry& rEntry = species[recordIter->uniqueID];
+            rEntry.tag = recordIter->tag;
+            rEntry.expanded = recordIter->expanded;
+            
+            uniqueIdByTag[recordIter->tag] = recordIter->uniqueID;
+        }
+        
+        const generatedReactionRecords& rSavedReactions = rLoader.getGeneratedReactions();
+        for( generatedReactionRecords::const_iterator recordIter = rSavedReactions.begin();
+             recordIter != rSavedReactions.end();
+             ++recordIter )
+        {
+            reactionKey key;
+            resolveParticipants( recordIter->substrates, uniqueIdByTag, fileName, key.first );
+            resolveParticipants( recordIter->products, uniqueIdByTag, fileName, key.second );
+            
+            double rate;
+            if ( !utl::from_string( rate, recordIter->rate ) )
+            {
+                throw badSavedNetworkXcpt( fileName,
+                                           "has a reaction with bad rate `"
+                                           + recordIter->rate
+                                           + "'" );
+            }
+            
+            reactions[key].push_back( recordIter->rate );
+            ++reactionCount;
+        }
+        
+        modelDigest = rLoader.getGeneratedNetworkDigest();
+        if ( modelDigest.empty() )
+        {
+            modelDigest = moleculizer::computeModelDigest
+                ( utl::dom::mustGetUniqueChild( pModelDocument->get_root_node(),
+                                                eltName::model ) );
+        }
+    }
+    
+    savedNetwork::
+    ~savedNetwork( void )
+    {
+        delete pModelDocument;
+    }
+    
+    bool
+    networkDiff::
+    empty( void ) const
+    {
+        return addedSpecies.empty()
+            && removedSpecies.empty()
+            && addedReactions.empty()
+            && removedReactions.empty()
+            && changedRates.empty();
+    }
+    
+    namespace
+    {
+        void
+        writeParticipants( std::ostream& rOs,
+                           const savedNetwork::participantList& rParticipants )
+        {
+            if ( rParticipants.empty() )
+            {
+                rOs << "nothing";
+                return;
+            }
+            
+            for( savedNetwork::participantList::const_iterator partIter = rParticipants.begin();
+                 partIter != rParticipants.end();
+                 ++partIter )
+            {
+                if ( partIter != rParticipants.begin() ) rOs << " + ";
+                if ( 1 < partIter->second ) rOs << partIter->second << ' ';
+                rOs << partIter->first;
+            }
+        }
+        
+        void
+        writeReaction( std::ostream& rOs,
+                       const savedNetwork::reactionKey& rKey )
+        {
+            writeParticipants( rOs, rKey.first );
+            rOs << " -> ";
+            writeParticipants( rOs, rKey.second );
+        }
+    }
+    
+    void
+    networkDiff::
+    write( std::ostream& rOs ) const
+    {
+        // Enough digits that rates that differ at all print differently.
+        std::streamsize oldPrecision
+            = rOs.precision( std::numeric_limits<double>::digits10 + 2 );
+        
+        for( std::vector<std::string>::const_iterator specIter = removedSpecies.begin();
+             specIter != removedSpecies.end();
+             ++specIter )
+        {
+            rOs << "- species " << *specIter << '\n';
+        }
+        
+        for( std::vector<std::string>::const_iterator specIter = addedSpecies.begin();
+             specIter != addedSpecies.end();
+             ++specIter )
+        {
+            rOs << "+ species " << *specIter << '\n';
+        }
+        
+        for( std::vector<savedReaction>::const_iterator rxnIter = removedReactions.begin();
+             rxnIter != removedReactions.end();
+             ++rxnIter )
+        {
+            rOs << "- reaction ";
+            writeReaction( rOs, rxnIter->key );
+            rOs << " rate " << rxnIter->rate << '\n';
+        }
+        
+        for( std::vector<savedReaction>::const_iterator rxnIter = addedReactions.begin();
+             rxnIter != addedReactions.end();
+             ++rxnIter )
+        {
+            rOs << "+ reaction ";
+            writeReaction( rOs, rxnIter->key );
+            rOs << " rate " << rxnIter->rate << '\n';
+        }
+        
+        for( std::vector<rateChange>::const_iterator changeIter = changedRates.begin();
+             changeIter != changedRates.end();
+             ++changeIter )
+        {
+            rOs << "~ reaction ";
+            writeReaction( rOs, changeIter->key );
+            rOs << " rate " << changeIter->oldRate
+                << " -> " << changeIter->newRate << '\n';
+        }
+        
+        rOs.precision( oldPrecision );
+    }
+    
+    namespace
+    {
+        // The rates were checked when the network was loaded.
+        std::vector<double>
+        sortedRates( const std::vector<std::string>& rRateTexts )
+        {
+            std::vector<double> rates( rRateTexts.size(), 0.0 );
+            for( size_t rateNdx = 0;
+                 rateNdx < rRateTexts.size();
+                 ++rateNdx )
+            {
+                utl::from_string( rates[rateNdx], rRateTexts[rateNdx] );
+            }
+            std::sort( rates.begin(), rates.end() );
+            return rates;
+        }
+        
+        bool
+        ratesMatch( double oldRate,
+                    double newRate,
+                    double rateTolerance )
+        {
+            return std::fabs( oldRate - newRate )
+                <= rateTolerance * std::max( std::fabs( oldRate ),
+                                             std::fabs( newRate ) );
+        }
+        
+        void
+        diffReaction( const savedNetwork::reactionKey& rKey,
+                      const std::vector<double>& rOldRates,
+                      const std::vector<double>& rNewRates,
+                      double rateTolerance,
+                      networkDiff& rDiff )
+        {
+            std::vector<double> unmatchedOld;
+            std::vector<double> unmatchedNew;
+            
+            std::vector<double>::const_iterator oldIter = rOldRates.begin();
+            std::vector<double>::const_iterator newIter = rNewRates.begin();
+            while ( oldIter != rOldRates.end()
+                    && newIter != rNewRates.end() )
+            {
+                if ( ratesMatch( *oldIter, *newIter, rateTolerance ) )
+                {
+                    ++oldIter;
+                    ++newIter;
+                }
+                else if ( *oldIter < *newIter )
+                {
+                    unmatchedOld.push_back( *oldIter++ );
+                }
+                else
+                {
+                    unmatchedNew.push_back( *newIter++ );
+                }
+            }
+            unmatchedOld.insert( unmatchedOld.end(), oldIter, rOldRates.end() );
+            unmatchedNew.insert( unmatchedNew.end(), newIter, rNewRates.end() );
+            
+            size_t changedCount = std::min( unmatchedOld.size(),
+                                            unmatchedNew.size() );
+            for( size_t rateNdx = 0;
+                 rateNdx < changedCount;
+                 ++rateNdx )
+            {
+                rDiff.changedRates.push_back( rateChange( rKey,
+                                                          unmatchedOld[rateNdx],
+                                                          unmatchedNew[rateNdx] ) );
+            }
+            for( size_t rateNdx = changedCount;
+                 rateNdx < unmatchedOld.size();
+                 ++rateNdx )
+            {
+                rDiff.removedReactions.push_back( savedReaction( rKey, unmatchedOld[rateNdx] ) );
+            }
+            for( size_t rateNdx = changedCount;
+                 rateNdx < unmatchedNew.size();
+                 ++rateNdx )
+            {
+                rDiff.addedReactions.push_back( savedReaction( rKey, unmatchedNew[rateNdx] ) );
+            }
+        }
+    }
+    
+    void
+    diffNetworks( const savedNetwork& rOld,
+                  const savedNetwork& rNew,
+                  networkDiff& rDiff,
+                  double rateTolerance )
+    {
+        const savedNetwork::speciesMap& rOldSpecies = rOld.getSpecies();
+        const savedNetwork::speciesMap& rNewSpecies = rNew.getSpecies();
+        
+        savedNetwork::speciesMap::const_iterator oldSpecIter = rOldSpecies.begin();
+        savedNetwork::speciesMap::const_iterator newSpecIter = rNewSpecies.begin();
+        while ( oldSpecIter != rOldSpecies.end()
+                || newSpecIter != rNewSpecies.end() )
+        {
+            if ( newSpecIter == rNewSpecies.end()
+                 || ( oldSpecIter != rOldSpecies.end()
+                      && oldSpecIter->first < newSpecIter->first ) )
+            {
+                rDiff.removedSpecies.push_back( oldSpecIter->first );
+                ++oldSpecIter;
+            }
+            else if ( oldSpecIter == rOldSpecies.end()
+                      || newSpecIter->first < oldSpecIter->first )
+            {
+                rDiff.addedSpecies.push_back( newSpecIter->first );
+                ++newSpecIter;
+            }
+            else
+            {
+                ++oldSpecIter;
+                ++newSpecIter;
+            }
+        }
+        
+        const savedNetwork::reactionMap& rOldReactions = rOld.getReactions();
+        const savedNetwork::reactionMap& rNewReactions = rNew.getReactions();
+        const std::vector<double> noRates;
+        
+        savedNetwork::reactionMap::const_iterator oldRxnIter = rOldReactions.begin();
+        savedNetwork::reactionMap::const_iterator newRxnIter = rNewReactions.begin();
+        while ( oldRxnIter != rOldReactions.end()
+                || newRxnIter != rNewReactions.end() )
+        {
+            if ( newRxnIter == rNewReactions.end()
+                 || ( oldRxnIter != rOldReactions.end()
+                      && oldRxnIter->first < newRxnIter->first ) )
+            {
+                diffReaction( oldRxnIter->first,
+                              sortedRates( oldRxnIter->second ),
+                              noRates,
+                              rateTolerance,
+                              rDiff );
+                ++oldRxnIter;
+            }
+            else if ( oldRxnIter == rOldReactions.end()
+                      || newRxnIter->first < oldRxnIter->first )
+            {
+                diffReaction( newRxnIter->first,
+                              noRates,
+                              sortedRates( newRxnIter->second ),
+                              rateTolerance,
+                              rDiff );
+                ++newRxnIter;
+            }
+            else
+            {
+                diffReaction( oldRxnIter->first,
+                              sortedRates( oldRxnIter->second ),
+                              sortedRates( newRxnIter->second ),
+                              rateTolerance,
+                              rDiff );
+                ++oldRxnIter;
+                ++newRxnIter;
+            }
+        }
+    }
+    
+    namespace
+    {
+        void
+        insertParticipants( xmlpp::Element* pParentElt,
+                            const std::string& rEltName,
+                            const std::string& rMultAttrName,
+                            const std::string& rTagAttrName,
+                            const std::string& rUniqueIdAttrName,
+                            const savedNetwork::participantList& rParticipants,
+                            const std::map<std::string, std::string>& tagByUniqueId )
+        {
+            for( savedNetwork::participantList::const_iterator partIter = rParticipants.begin();
+                 partIter != rParticipants.end();
+                 ++partIter )
+            {
+                xmlpp::Element* pPartElt = pParentElt->add_child( rEltName );
+                pPartElt->set_attribute( rMultAttrName, utl::stringify( partIter->second ) );
+                pPartElt->set_attribute( rTagAttrName, tagByUniqueId.find( partIter->first )->second );
+                pPartElt->set_attribute( rUniqueIdAttrName, partIter->first );
+            }
+        }
+        
+        void
+        countRates( const savedNetwork::reactionMap& rReactions,
+                    const savedNetwork::reactionKey& rKey,
+                    std::map<std::string, int>& rCounts )
+        {
+            savedNetwork::reactionMap::const_iterator found = rReactions.find( rKey );
+            if ( found == rReactions.end() ) return;
+            
+            for( std::vector<std::string>::const_iterator rateIter = found->second.begin();
+                 rateIter != found->second.end();
+                 ++rateIter )
+            {
+                ++rCounts[*rateIter];
+            }
+        }
+    }
+    
+    void
+    mergeNetworks( const savedNetwork& rFirst,
+                   const savedNetwork& rSecond,
+                   const std::string& rOutputFileName )
+        throw( utl::xcpt )
+    {
+        if ( rFirst.getModelDigest() != rSecond.getModelDigest() )
+        {
+            throw networkModelMismatchXcpt( rFirst.getFileName(),
+                                            rSecond.getFileName() );
+        }
+        
+        xmlpp::Document outputDocument;
+        xmlpp::Element* pRootElt
+            = outputDocument.create_root_node( eltName::moleculizerState );
+        
+        xmlpp::Element* pOriginalRoot = rFirst.getModelDocument()->get_root_node();
+        pRootElt->import_node( utl::dom::mustGetUniqueChild( pOriginalRoot, eltName::model ) );
+        
+        xmlpp::Element* pStreamsElt = utl::dom::getOptionalChild( pOriginalRoot, eltName::streams );
+        if ( pStreamsElt ) pRootElt->import_node( pStreamsElt );
+        
+        // The digest is written even when neither network was saved with
+        // one, so that the merged network is restored rather than
+        // regenerated.
+        xmlpp::Element* pNetworkElt = pRootElt->add_child( eltName::generatedNetwork );
+        pNetworkElt->set_attribute( eltName::generatedNetwork_modelDigestAttr, rFirst.getModelDigest() );
+        
+        xmlpp::Element* pSpeciesElt = pNetworkElt->add_child( eltName::generatedSpecies );
+        xmlpp::Element* pReactionsElt = pNetworkElt->add_child( eltName::generatedReactions );
+        
+        // Species keep their tags from the first network.  Species only in
+        // the second keep theirs too, unless the first already uses it.
+        savedNetwork::speciesMap mergedSpecies = rFirst.getSpecies();
+        std::set<std::string> usedTags;
+        for( savedNetwork::speciesMap::const_iterator specIter = mergedSpecies.begin();
+             specIter != mergedSpecies.end();
+             ++specIter )
+        {
+            usedTags.insert( specIter->second.tag );
+        }
+        
+        for( savedNetwork::speciesMap::const_iterator specIter = rSecond.getSpecies().begin();
+             specIter != rSecond.getSpecies().end();
+             ++specIter )
+        {
+            savedNetwork::speciesMap::iterator found = mergedSpecies.find( specIter->first );
+            if ( found != mergedSpecies.end() )
+            {
+                found->second.expanded = found->second.expanded || specIter->second.expanded;
+                continue;
+            }
+            
+            savedNetwork::speciesEntry entry = specIter->second;
+            for( int suffix = 2;
+                 usedTags.count( entry.tag );
+                 ++suffix )
+            {
+                entry.tag = specIter->second.tag + "-" + utl::stringify( suffix );
+            }
+            usedTags.insert( entry.tag );
+            mergedSpecies.insert( std::make_pair( specIter->first, entry ) );
+        }
+        
+        std::map<std::string, std::string> tagByUniqueId;
+        for( savedNetwork::speciesMap::const_iterator specIter = mergedSpecies.begin();
+             specIter != mergedSpecies.end();
+             ++specIter )
+        {
+            xmlpp::Element* pSpecElt = pSpeciesElt->add_child( eltName::savedSpecies );
+            pSpecElt->set_attribute( eltName::savedSpecies_tagAttr, specIter->second.tag );
+            pSpecElt->set_attribute( eltName::savedSpecies_uniqueIdAttr, specIter->first );
+            pSpecElt->set_attribute( eltName::savedSpecies_expandedAttr, specIter->second.expanded ? "true" : "false" );
+            
+            tagByUniqueId[specIter->first] = specIter->second.tag;
+        }
+        
+        std::set<savedNetwork::reactionKey> mergedKeys;
+        for( savedNetwork::reactionMap::const_iterator rxnIter = rFirst.getReactions().begin();
+             rxnIter != rFirst.getReactions().end();
+             ++rxnIter )
+        {
+            mergedKeys.insert( rxnIter->first );
+        }
+        for( savedNetwork::reactionMap::const_iterator rxnIter = rSecond.getReactions().begin();
+             rxnIter != rSecond.getReactions().end();
+             ++rxnIter )
+        {
+            mergedKeys.insert( rxnIter->first );
+        }
+        
+        for( std::set<savedNetwork::reactionKey>::const_iterator keyIter = mergedKeys.begin();
+             keyIter != mergedKeys.end();
+             ++keyIter )
+        {
+            std::map<std::string, int> firstCounts;
+            std::map<std::string, int> secondCounts;
+            countRates( rFirst.getReactions(), *keyIter, firstCounts );
+            countRates( rSecond.getReactions(), *keyIter, secondCounts );
+            
+            std::map<std::string, int> mergedCounts = firstCounts;
+            for( std::map<std::string, int>::const_iterator countIter = secondCounts.begin();
+                 countIter != secondCounts.end();
+                 ++countIter )
+            {
+                int& rCount = mergedCounts[countIter->first];
+                rCount = std::max( rCount, countIter->second );
+            }
+            
+            for( std::map<std::string, int>::const_iterator countIter = mergedCounts.begin();
+                 countIter != mergedCounts.end();
+                 ++countIter )
+            {
+                for( int copyNdx = 0;
+                     copyNdx < countIter->second;
+                     ++copyNdx )
+                {
+                    xmlpp::Element* pRxnElt = pReactionsElt->add_child( eltName::reaction );
+                    insertParticipants( pRxnElt->add_child( eltName::savedSubstrates ),
+                                        eltName::savedSubstrate,
+                                        eltName::savedSubstrate_multAttr,
+                                        eltName::savedSubstrate_tagAttr,
+                                        eltName::savedSubstrate_uniqueIdAttr,
+                                        keyIter->first,
+                                        tagByUniqueId );
+                    insertParticipants( pRxnElt->add_child( eltName::savedProducts ),
+                                        eltName::savedProduct,
+                                        eltName::savedProduct_multAttr,
+                                        eltName::savedProduct_tagAttr,
+                                        eltName::savedProduct_uniqueIdAttr,
+                                        keyIter->second,
+                                        tagByUniqueId );
+                    pRxnElt->add_child( eltName::rate )->set_attribute( eltName::rate_valueAttr, countIter->first );
+                }
+            }
+        }
+        
+        outputDocument.write_to_file_formatted( rOutputFileName );
+    }
+}
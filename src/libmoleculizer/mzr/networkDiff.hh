@@ -0,0 +1,251 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_NETWORKDIFF_H
+#define MZR_NETWORKDIFF_H
+
+/*! \file networkDiff.hh
+  \ingroup mzrGroup
+  \brief Compares and merges saved generated networks.
+  
+  Works on the state files that makeDomOutput writes, without loading
+  them into a moleculizer, so nothing is expanded.  Species are matched
+  by their unique ids, which are canonical names, so the tags that two
+  runs happened to give the same species don't matter.  A reaction is
+  identified by its substrates and products with their multiplicities;
+  the same reaction made twice, by different reaction families, is
+  kept twice. */
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include "utl/xcpt.hh"
+
+namespace xmlpp
+{
+    class Document;
+}
+
+namespace mzr
+{
+    class modelStreamLoader;
+    
+    class badSavedNetworkXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rFileName,
+               const std::string& rProblem );
+        
+    public:
+        badSavedNetworkXcpt( const std::string& rFileName,
+                             const std::string& rProblem ) :
+            utl::xcpt( mkMsg( rFileName, rProblem ) )
+        {}
+    };
+    
+    class networkModelMismatchXcpt :
+        public utl::xcpt
+    {
+        static std::string
+        mkMsg( const std::string& rFirstFileName,
+               const std::string& rSecondFileName );
+        
+    public:
+        networkModelMismatchXcpt( const std::string& rFirstFileName,
+                                  const std::string& rSecondFileName ) :
+            utl::xcpt( mkMsg( rFirstFileName, rSecondFileName ) )
+        {}
+    };
+    
+    // A generated network read back from a state file.
+    class savedNetwork
+    {
+    public:
+        // Unique id and multiplicity, sorted by unique id.
+        typedef std::vector<std::pair<std::string, int> > participantList;
+        
+        // Substrates, then products.
+        typedef std::pair<participantList, participantList> reactionKey;
+        
+        // The rates of all the reactions with a given key, as they were
+        // written, so that a merged file has exactly the saved rates.
+        typedef std::map<reactionKey, std::vector<std::string> > reactionMap;
+        
+        class speciesEntry
+        {
+        public:
+            std::string tag;
+            bool expanded;
+            
+            speciesEntry( void ) :
+                expanded( false )
+            {}
+        };
+        
+        // By unique id.
+        typedef std::map<std::string, speciesEntry> speciesMap;
+        
+        savedNetwork( const std::string& rFileName )
+            throw( utl::xcpt );
+        
+        ~savedNetwork( void );
+        
+        const std::string&
+        getFileName( void ) const
+        {
+            return fileName;
+        }
+        
+        const speciesMap&
+        getSpecies( void ) const
+        {
+            return species;
+        }
+        
+        const reactionMap&
+        getReactions( void ) const
+        {
+            return reactions;
+        }
+        
+        int
+        getReactionCount( void ) const
+        {
+            return reactionCount;
+        }
+        
+        // The digest the network was saved with or, for a network saved
+        // by a bounded expansion, which is saved without one, the digest
+        // of its model section.
+        const std::string&
+        getModelDigest( void ) const
+        {
+            return modelDigest;
+        }
+        
+        // The model and streams sections of the file.
+        xmlpp::Document*
+        getModelDocument( void ) const
+        {
+            return pModelDocument;
+        }
+        
+    private:
+        std::string fileName;
+        speciesMap species;
+        reactionMap reactions;
+        int reactionCount;
+        std::string modelDigest;
+        xmlpp::Document* pModelDocument;
+        
+        void
+        readRecords( const modelStreamLoader& rLoader );
+        
+        savedNetwork( const savedNetwork& );
+        savedNetwork& operator=( const savedNetwork& );
+    };
+    
+    class savedReaction
+    {
+    public:
+        savedNetwork::reactionKey key;
+        double rate;
+        
+        savedReaction( const savedNetwork::reactionKey& rKey,
+                       double theRate ) :
+            key( rKey ),
+            rate( theRate )
+        {}
+    };
+    
+    class rateChange
+    {
+    public:
+        savedNetwork::reactionKey key;
+        double oldRate;
+        double newRate;
+        
+        rateChange( const savedNetwork::reactionKey& rKey,
+                    double theOldRate,
+                    double theNewRate ) :
+            key( rKey ),
+            oldRate( theOldRate ),
+            newRate( theNewRate )
+        {}
+    };
+    
+    class networkDiff
+    {
+    public:
+        // Unique ids.
+        std::vector<std::string> addedSpecies;
+        std::vector<std::string> removedSpecies;
+        
+        std::vector<savedReaction> addedReactions;
+        std::vector<savedReaction> removedReactions;
+        std::vector<rateChange> changedRates;
+        
+        bool
+        empty( void ) const;
+        
+        // One line per difference: "+" for added, "-" for removed and
+        // "~" for a changed rate.
+        void
+        write( std::ostream& rOs ) const;
+    };
+    
+    // Rates that differ by no more than rateTolerance times the larger of
+    // them are taken to be the same.  Where there are several reactions
+    // with the same substrates and products, the rates that match are
+    // taken out first, and what is left is paired up, smallest with
+    // smallest, as changed rates.
+    void
+    diffNetworks( const savedNetwork& rOld,
+                  const savedNetwork& rNew,
+                  networkDiff& rDiff,
+                  double rateTolerance = 0.0 );
+    
+    // Writes a state file holding both networks, which must have been
+    // generated from the same model, and which loads as it stands.
+    // Species are expanded in the merge if they were expanded in either
+    // network, and each reaction is kept as many times as it was saved in
+    // the network that has more of it.  The model and streams sections
+    // are those of the first network.
+    //
+    // Each run expanded its species against the species it knew of at
+    // the time, so reactions between a species expanded only in the
+    // first network and one expanded only in the second may be in
+    // neither.
+    void
+    mergeNetworks( const savedNetwork& rFirst,
+                   const savedNetwork& rSecond,
+                   const std::string& rOutputFileName )
+        throw( utl::xcpt );
+}
+
+#endif // MZR_NETWORKDIFF_H
@@ -0,0 +1,86 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "mzr/networkSensitivity.hh"
+#include "mzr/moleculizer.hh"
+
+namespace mzr
+{
+    namespace
+    {
+        class speciesIndex
+        {
+            const networkSensitivity& rSensitivity;
+            
+        public:
+            speciesIndex( const networkSensitivity& rNetworkSensitivity ) :
+                rSensitivity( rNetworkSensitivity )
+            {}
+            
+            int
+            operator()( const mzrSpecies* pSpecies ) const
+            {
+                return rSensitivity.getSpeciesIndex( pSpecies );
+            }
+        };
+    }
+    
+    networkSensitivity::networkSensitivity( const moleculizer& rMoleculizer ) :
+        fnd::forwardSensitivity( &rMoleculizer.getExpansionProfiler() )
+    {
+        const moleculizer::SpeciesCatalog& rCatalog = rMoleculizer.getSpeciesCatalog();
+        for ( moleculizer::SpeciesCatalog::const_iterator iEntry = rCatalog.begin();
+              iEntry != rCatalog.end();
+              ++iEntry )
+        {
+            const mzrSpecies* pSpecies = iEntry->second;
+            indicesBySpecies.insert( std::make_pair( pSpecies,
+                                                     addSpecies( pSpecies->getName() ) ) );
+        }
+        
+        const moleculizer::ReactionList& rReactions = rMoleculizer.getReactionList();
+        for ( moleculizer::ReactionList::const_iterator iReaction = rReactions.begin();
+              iReaction != rReactions.end();
+              ++iReaction )
+        {
+            fnd::addBasicReaction( *this,
+                                   **iReaction,
+                                   speciesIndex( *this ) );
+        }
+        
+        restart();
+    }
+    
+    int
+    networkSensitivity::getSpeciesIndex( const mzrSpecies* pSpecies ) const
+    {
+        std::map<const mzrSpecies*, int>::const_iterator iEntry
+            = indicesBySpecies.find( pSpecies );
+        if ( iEntry == indicesBySpecies.end() ) return -1;
+        
+        return iEntry->second;
+    }
+}
@@ -0,0 +1,72 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_NETWORKSENSITIVITY_H
+#define MZR_NETWORKSENSITIVITY_H
+
+/*! \file networkSensitivity.hh
+  \ingroup mzrGroup
+  \brief Forward sensitivities of a generated network to its rules.
+  
+  Takes the network as it stands when constructed; species and
+  reactions generated afterward are not included.  There is one
+  parameter per reaction generator, labeled with the generator's kind
+  and rule, as in the expansion profile. */
+
+#include <map>
+#include "fnd/forwardSensitivity.hh"
+
+namespace mzr
+{
+    class moleculizer;
+    class mzrSpecies;
+    
+    class networkSensitivity :
+        public fnd::forwardSensitivity
+    {
+    public:
+        networkSensitivity( const moleculizer& rMoleculizer );
+        
+        using fnd::forwardSensitivity::setConcentration;
+        
+        void
+        setConcentration( const mzrSpecies* pSpecies,
+                          double concentration )
+        {
+            setConcentration( getSpeciesIndex( pSpecies ),
+                              concentration );
+        }
+        
+        // -1 for a species that wasn't in the network.
+        int
+        getSpeciesIndex( const mzrSpecies* pSpecies ) const;
+        
+    private:
+        std::map<const mzrSpecies*, int> indicesBySpecies;
+    };
+}
+
+#endif // MZR_NETWORKSENSITIVITY_H
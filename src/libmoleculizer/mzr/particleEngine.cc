@@ -0,0 +1,486 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "mzr/particleEngine.hh"
+#include "mzr/moleculizer.hh"
+#include "mzr/mzrSpecies.hh"
+#include "mzr/mzrReaction.hh"
+#include "mzr/spatialExtrapolationFunctions.hh"
+#include "fnd/physConst.hh"
+
+namespace mzr
+{
+    namespace
+    {
+        const double pi = 3.14159265358979323846;
+        
+        // extrapolateMolecularRadius works in meters.
+        const double micrometersPerMeter = 1.0e6;
+        
+        const double cubicMicrometersPerLiter = 1.0e15;
+        
+        // Diffusion-limited reactions fire at this rate in contact, which
+        // makes them all but certain to fire in the first step.
+        const double certainRateTimesStep = 50.0;
+    }
+    
+    particleEngine::particleEngine( moleculizer& rMoleculizer,
+                                    double theBoxSide,
+                                    double theTimeStep,
+                                    unsigned long seed ) :
+        rMolzer( rMoleculizer ),
+        boxSide( theBoxSide ),
+        timeStep( theTimeStep ),
+        time( 0.0 ),
+        reactionEventCount( 0 ),
+        theCellList( theBoxSide )
+    {
+        if ( ! ( 0.0 < boxSide && 0.0 < timeStep ) )
+        {
+            throw utl::xcpt( "Error in particleEngine::particleEngine.  The box side and time step must be positive." );
+        }
+        
+        randomState[0] = 0x330e;
+        randomState[1] = seed & 0xffff;
+        randomState[2] = ( seed >> 16 ) & 0xffff;
+    }
+    
+    double
+    particleEngine::uniformRandom( void )
+    {
+        return erand48( randomState );
+    }
+    
+    double
+    particleEngine::gaussianRandom( void )
+    {
+        // Box-Muller; 1 - u keeps the logarithm finite.
+        double radius = std::sqrt( -2.0 * std::log( 1.0 - uniformRandom() ) );
+        return radius * std::cos( 2.0 * pi * uniformRandom() );
+    }
+    
+    void
+    particleEngine::wrap( double* pPosition ) const
+    {
+        for ( int axis = 0; axis < 3; ++axis )
+        {
+            pPosition[axis] -= boxSide * std::floor( pPosition[axis] / boxSide );
+            
+            // Rounding can leave a tiny negative coordinate at boxSide.
+            if ( boxSide <= pPosition[axis] ) pPosition[axis] = 0.0;
+        }
+    }
+    
+    const particleEngine::speciesProperties&
+    particleEngine::getProperties( const mzrSpecies* pSpecies )
+    {
+        std::map<const mzrSpecies*, speciesProperties>::iterator iEntry
+            = propertiesBySpecies.find( pSpecies );
+        
+        if ( iEntry == propertiesBySpecies.end() )
+        {
+            speciesProperties properties;
+            properties.radius = micrometersPerMeter * extrapolateMolecularRadius( pSpecies );
+            properties.diffusionCoeff = getDiffusionCoeffForSpecies( pSpecies );
+            
+            iEntry = propertiesBySpecies.insert( std::make_pair( pSpecies,
+                                                                 properties ) ).first;
+        }
+        
+        return iEntry->second;
+    }
+    
+    const mzrReaction*
+    particleEngine::reactionChannels::choose( double uniform ) const
+    {
+        std::vector<double>::const_iterator iChosen
+            = std::upper_bound( cumulativeRates.begin(),
+                                cumulativeRates.end(),
+                                uniform * getTotalRate() );
+        
+        if ( iChosen == cumulativeRates.end() ) --iChosen;
+        return reactions[iChosen - cumulativeRates.begin()];
+    }
+    
+    const particleEngine::reactionChannels&
+    particleEngine::getUnaryChannels( mzrSpecies* pSpecies )
+    {
+        std::map<const mzrSpecies*, reactionChannels>::iterator iEntry
+            = unaryChannels.find( pSpecies );
+        if ( iEntry != unaryChannels.end() ) return iEntry->second;
+        
+        reactionChannels& rChannels = unaryChannels[pSpecies];
+        
+        rMolzer.findReactionWithSubstrates( pSpecies,
+                                            rChannels.reactions );
+        rMolzer.publishSnapshot();
+        
+        double totalRate = 0.0;
+        for ( std::vector<const mzrReaction*>::const_iterator iRxn = rChannels.reactions.begin();
+              iRxn != rChannels.reactions.end();
+              ++iRxn )
+        {
+            totalRate += std::max( 0.0, ( *iRxn )->getRate() );
+            rChannels.cumulativeRates.push_back( totalRate );
+        }
+        
+        return rChannels;
+    }
+    
+    const particleEngine::reactionChannels&
+    particleEngine::getBinaryChannels( mzrSpecies* pFirst,
+                                       mzrSpecies* pSecond )
+    {
+        if ( pSecond < pFirst ) std::swap( pFirst, pSecond );
+        speciesPair key( pFirst, pSecond );
+        
+        std::map<speciesPair, reactionChannels>::iterator iEntry
+            = binaryChannels.find( key );
+        if ( iEntry != binaryChannels.end() ) return iEntry->second;
+        
+        reactionChannels& rChannels = binaryChannels[key];
+        
+        rMolzer.findReactionWithSubstrates( pFirst,
+                                            pSecond,
+                                            rChannels.reactions );
+        rMolzer.publishSnapshot();
+        
+        const speciesProperties& rFirstProperties = getProperties( pFirst );
+        const speciesProperties& rSecondProperties = getProperties( pSecond );
+        
+        double contactDistance = rFirstProperties.radius + rSecondProperties.radius;
+        double contactVolume = 4.0 / 3.0 * pi * contactDistance * contactDistance * contactDistance;
+        double diffusionRate = 4.0 * pi * contactDistance
+            * ( rFirstProperties.diffusionCoeff + rSecondProperties.diffusionCoeff );
+        double certainRate = certainRateTimesStep / timeStep;
+        
+        double totalRate = 0.0;
+        for ( std::vector<const mzrReaction*>::const_iterator iRxn = rChannels.reactions.begin();
+              iRxn != rChannels.reactions.end();
+              ++iRxn )
+        {
+            // The rate for one pair of molecules, in micrometers^3/sec.  A
+            // dimerization counts each pair twice, as in
+            // gillspReaction::propensity.
+            double pairRate = std::max( 0.0, ( *iRxn )->getRate() )
+                * ( pFirst == pSecond ? 2.0 : 1.0 )
+                * cubicMicrometersPerLiter / fnd::avogadrosNumber;
+            
+            double contactRate = 0.0;
+            if ( 0.0 < contactVolume && 0.0 < pairRate )
+            {
+                if ( pairRate < diffusionRate )
+                {
+                    double intrinsicRate = pairRate * diffusionRate / ( diffusionRate - pairRate );
+                    contactRate = std::min( certainRate,
+                                            intrinsicRate / contactVolume );
+                }
+                else
+                {
+                    contactRate = certainRate;
+                }
+            }
+            
+            totalRate += contactRate;
+            rChannels.cumulativeRates.push_back( totalRate );
+        }
+        
+        return rChannels;
+    }
+    
+    void
+    particleEngine::addParticle( mzrSpecies* pSpecies,
+                                 const double position[3] )
+    {
+        // The network grows only as far as the simulation goes.
+        if ( ! pSpecies->hasNotified() )
+        {
+            pSpecies->expandReactionNetwork();
+            rMolzer.publishSnapshot();
+        }
+        
+        particleSpecies.push_back( pSpecies );
+        coords.insert( coords.end(),
+                       position,
+                       position + 3 );
+        wrap( &coords[coords.size() - 3] );
+    }
+    
+    void
+    particleEngine::addParticles( mzrSpecies* pSpecies,
+                                  int count )
+    {
+        for ( int particle = 0; particle < count; ++particle )
+        {
+            double position[3];
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                position[axis] = boxSide * uniformRandom();
+            }
+            
+            addParticle( pSpecies,
+                         position );
+        }
+    }
+    
+    int
+    particleEngine::getPopulation( const mzrSpecies* pSpecies ) const
+    {
+        return std::count( particleSpecies.begin(),
+                           particleSpecies.end(),
+                           pSpecies );
+    }
+    
+    void
+    particleEngine::fireReaction( const mzrReaction* pReaction,
+                                  const double position[3] )
+    {
+        ++reactionEventCount;
+        
+        // The first product takes the reactants' place, and any others
+        // are put in contact with it, in random directions.
+        const mzrSpecies* pFirstProduct = 0;
+        
+        const mzrReaction::multMap& rProducts = pReaction->getProducts();
+        for ( mzrReaction::multMap::const_iterator iProduct = rProducts.begin();
+              iProduct != rProducts.end();
+              ++iProduct )
+        {
+            for ( int copy = 0; copy < iProduct->second; ++copy )
+            {
+                double productPosition[3] = { position[0], position[1], position[2] };
+                
+                if ( pFirstProduct )
+                {
+                    double distance = getProperties( pFirstProduct ).radius
+                        + getProperties( iProduct->first ).radius;
+                    
+                    double direction[3];
+                    double norm = 0.0;
+                    while ( norm == 0.0 )
+                    {
+                        for ( int axis = 0; axis < 3; ++axis )
+                        {
+                            direction[axis] = gaussianRandom();
+                        }
+                        norm = std::sqrt( direction[0] * direction[0]
+                                          + direction[1] * direction[1]
+                                          + direction[2] * direction[2] );
+                    }
+                    
+                    for ( int axis = 0; axis < 3; ++axis )
+                    {
+                        productPosition[axis] += distance * direction[axis] / norm;
+                    }
+                }
+                else
+                {
+                    pFirstProduct = iProduct->first;
+                }
+                
+                addParticle( iProduct->first,
+                             productPosition );
+            }
+        }
+    }
+    
+    void
+    particleEngine::removeConsumedParticles( void )
+    {
+        int kept = 0;
+        for ( int particle = 0; particle < ( int ) particleSpecies.size(); ++particle )
+        {
+            if ( ! particleSpecies[particle] ) continue;
+            
+            particleSpecies[kept] = particleSpecies[particle];
+            std::copy( &coords[3 * particle],
+                       &coords[3 * particle] + 3,
+                       &coords[3 * kept] );
+            ++kept;
+        }
+        
+        particleSpecies.resize( kept );
+        coords.resize( 3 * kept );
+    }
+    
+    void
+    particleEngine::fireUnaryReactions( void )
+    {
+        // Products are appended, and don't react again in this step.
+        int particleCount = particleSpecies.size();
+        
+        for ( int particle = 0; particle < particleCount; ++particle )
+        {
+            const reactionChannels& rChannels = getUnaryChannels( particleSpecies[particle] );
+            double totalRate = rChannels.getTotalRate();
+            
+            if ( totalRate <= 0.0
+                 || 1.0 - std::exp( -totalRate * timeStep ) <= uniformRandom() ) continue;
+            
+            double position[3];
+            std::copy( &coords[3 * particle],
+                       &coords[3 * particle] + 3,
+                       position );
+            particleSpecies[particle] = 0;
+            
+            fireReaction( rChannels.choose( uniformRandom() ),
+                          position );
+        }
+        
+        removeConsumedParticles();
+    }
+    
+    void
+    particleEngine::diffuse( void )
+    {
+        for ( int particle = 0; particle < ( int ) particleSpecies.size(); ++particle )
+        {
+            double stepDeviation
+                = std::sqrt( 2.0 * getProperties( particleSpecies[particle] ).diffusionCoeff * timeStep );
+            
+            double* pPosition = &coords[3 * particle];
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                pPosition[axis] += stepDeviation * gaussianRandom();
+            }
+            wrap( pPosition );
+        }
+    }
+    
+    void
+    particleEngine::fireBinaryReactions( void )
+    {
+        int particleCount = particleSpecies.size();
+        if ( particleCount < 2 ) return;
+        
+        double maxRadius = 0.0;
+        for ( int particle = 0; particle < particleCount; ++particle )
+        {
+            maxRadius = std::max( maxRadius,
+                                  getProperties( particleSpecies[particle] ).radius );
+        }
+        if ( maxRadius <= 0.0 ) return;
+        
+        theCellList.build( coords,
+                           2.0 * maxRadius );
+        contactPairs.clear();
+        theCellList.findPairs( coords,
+                               contactPairs );
+        
+        // So that no pair is favored when particles compete for partners.
+        for ( int pairNdx = contactPairs.size() - 1; 0 < pairNdx; --pairNdx )
+        {
+            int otherNdx = ( int )( uniformRandom() * ( pairNdx + 1 ) );
+            std::swap( contactPairs[pairNdx],
+                       contactPairs[std::min( otherNdx, pairNdx )] );
+        }
+        
+        for ( std::vector<std::pair<int, int> >::const_iterator iPair = contactPairs.begin();
+              iPair != contactPairs.end();
+              ++iPair )
+        {
+            int first = iPair->first;
+            int second = iPair->second;
+            
+            mzrSpecies* pFirst = particleSpecies[first];
+            mzrSpecies* pSecond = particleSpecies[second];
+            if ( ! ( pFirst && pSecond ) ) continue;
+            
+            double contactDistance = getProperties( pFirst ).radius + getProperties( pSecond ).radius;
+            if ( contactDistance * contactDistance
+                 <= cellList::periodicDistanceSquared( &coords[3 * first],
+                                                       &coords[3 * second],
+                                                       boxSide ) ) continue;
+            
+            const reactionChannels& rChannels = getBinaryChannels( pFirst,
+                                                                   pSecond );
+            double totalRate = rChannels.getTotalRate();
+            
+            if ( totalRate <= 0.0
+                 || 1.0 - std::exp( -totalRate * timeStep ) <= uniformRandom() ) continue;
+            
+            // The products appear midway between the reactants.
+            double midpoint[3];
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                double delta = coords[3 * second + axis] - coords[3 * first + axis];
+                if ( 0.5 * boxSide < delta ) delta -= boxSide;
+                if ( delta < -0.5 * boxSide ) delta += boxSide;
+                
+                midpoint[axis] = coords[3 * first + axis] + 0.5 * delta;
+            }
+            
+            particleSpecies[first] = 0;
+            particleSpecies[second] = 0;
+            
+            fireReaction( rChannels.choose( uniformRandom() ),
+                          midpoint );
+        }
+        
+        removeConsumedParticles();
+    }
+    
+    void
+    particleEngine::forgetReactionChannels( void )
+    {
+        unaryChannels.clear();
+        binaryChannels.clear();
+    }
+    
+    fnd::eventResult
+    particleEngine::step( void )
+    {
+        // Events fire at the step boundary nearest their time, which keeps
+        // an event at a whole number of steps from slipping a step when the
+        // sum of the steps comes out a little short.
+        if ( fnd::stop == events.fireThrough( time + 0.5 * timeStep,
+                                              *this ) )
+            return fnd::stop;
+        
+        fireUnaryReactions();
+        diffuse();
+        fireBinaryReactions();
+        
+        time += timeStep;
+        
+        return fnd::go;
+    }
+    
+    fnd::eventResult
+    particleEngine::run( double duration )
+    {
+        long stepCount = ( long )( duration / timeStep + 0.5 );
+        
+        for ( long stepNdx = 0; stepNdx < stepCount; ++stepNdx )
+        {
+            if ( fnd::stop == step() ) return fnd::stop;
+        }
+        return fnd::go;
+    }
+}
@@ -0,0 +1,231 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_PARTICLEENGINE_H
+#define MZR_PARTICLEENGINE_H
+
+/*! \file particleEngine.hh
+  \ingroup mzrGroup
+  \brief Brownian dynamics of individual molecules on a generated network.
+  
+  Each particle is one molecule of some species, moving in a periodic
+  cube.  A time step fires unimolecular reactions, moves every particle
+  by a Gaussian step for its species' diffusion coefficient, and then
+  lets pairs in contact react.
+  
+  Two particles are in contact within the sum of their radii, from
+  extrapolateMolecularRadius.  While in contact, they react at a rate
+  chosen so that, together with diffusion, the reaction's
+  macroscopic rate is (approximately) recovered: the intrinsic rate kA
+  is found from 1/k = 1/kA + 1/kD, as in
+  extrapolateIntrinsicReactionRate, and spread over the contact volume.
+  
+  Reactions are looked up with findReactionWithSubstrates, and species
+  are expanded as they first appear in the box, so only the part of
+  the network the simulation reaches is generated.
+  
+  Lengths are in micrometers and times in seconds.  The time step should
+  be small enough that particles move a fraction of their contact
+  distance in one step.
+  
+  Scheduled events, such as those in particleEvents.hh, fire at the
+  start of the step whose start time is nearest their own. */
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "fnd/eventQueue.hh"
+#include "mzr/cellList.hh"
+
+namespace mzr
+{
+    class moleculizer;
+    class mzrSpecies;
+    class mzrReaction;
+    class particleEngine;
+    
+    typedef fnd::event<particleEngine> particleEvent;
+    
+    class particleEngine
+    {
+    public:
+        // The moleculizer must outlive the engine, and must have its model
+        // loaded.
+        particleEngine( moleculizer& rMoleculizer,
+                        double boxSide,
+                        double timeStep,
+                        unsigned long seed = 0 );
+        
+        // Places count particles of the species uniformly in the box.
+        void
+        addParticles( mzrSpecies* pSpecies,
+                      int count );
+        
+        void
+        addParticle( mzrSpecies* pSpecies,
+                     const double position[3] );
+        
+        // Returns stop, without taking the step, if a scheduled event
+        // returned stop.
+        fnd::eventResult
+        step( void );
+        
+        // Takes as many steps as fit in the duration, or fewer if a scheduled
+        // event returns stop.
+        fnd::eventResult
+        run( double duration );
+        
+        fnd::eventQueue<particleEngine>&
+        getEvents( void )
+        {
+            return events;
+        }
+        
+        // Drops the reaction channels, so that they are built again from the
+        // reactions' current rates.
+        void
+        forgetReactionChannels( void );
+        
+        double
+        getTime( void ) const
+        {
+            return time;
+        }
+        
+        int
+        getParticleCount( void ) const
+        {
+            return particleSpecies.size();
+        }
+        
+        mzrSpecies*
+        getParticleSpecies( int particle ) const
+        {
+            return particleSpecies[particle];
+        }
+        
+        const double*
+        getParticlePosition( int particle ) const
+        {
+            return &coords[3 * particle];
+        }
+        
+        int
+        getPopulation( const mzrSpecies* pSpecies ) const;
+        
+        long
+        getReactionEventCount( void ) const
+        {
+            return reactionEventCount;
+        }
+        
+    private:
+        struct speciesProperties
+        {
+            // In micrometers, and micrometers^2/sec.
+            double radius;
+            double diffusionCoeff;
+        };
+        
+        // The reactions a species or pair of species may undergo, with the
+        // rate at which each fires, as a running total.
+        struct reactionChannels
+        {
+            std::vector<const mzrReaction*> reactions;
+            std::vector<double> cumulativeRates;
+            
+            double
+            getTotalRate( void ) const
+            {
+                return cumulativeRates.empty() ? 0.0 : cumulativeRates.back();
+            }
+            
+            const mzrReaction*
+            choose( double uniform ) const;
+        };
+        
+        typedef std::pair<const mzrSpecies*, const mzrSpecies*> speciesPair;
+        
+        moleculizer& rMolzer;
+        double boxSide;
+        double timeStep;
+        double time;
+        long reactionEventCount;
+        
+        // Parallel arrays; a null species marks a particle consumed during
+        // the current step.
+        std::vector<mzrSpecies*> particleSpecies;
+        std::vector<double> coords;
+        
+        std::map<const mzrSpecies*, speciesProperties> propertiesBySpecies;
+        std::map<const mzrSpecies*, reactionChannels> unaryChannels;
+        std::map<speciesPair, reactionChannels> binaryChannels;
+        
+        fnd::eventQueue<particleEngine> events;
+        
+        cellList theCellList;
+        std::vector<std::pair<int, int> > contactPairs;
+        
+        unsigned short randomState[3];
+        
+        double
+        uniformRandom( void );
+        
+        double
+        gaussianRandom( void );
+        
+        const speciesProperties&
+        getProperties( const mzrSpecies* pSpecies );
+        
+        const reactionChannels&
+        getUnaryChannels( mzrSpecies* pSpecies );
+        
+        const reactionChannels&
+        getBinaryChannels( mzrSpecies* pFirst,
+                           mzrSpecies* pSecond );
+        
+        void
+        fireReaction( const mzrReaction* pReaction,
+                      const double position[3] );
+        
+        void
+        fireUnaryReactions( void );
+        
+        void
+        diffuse( void );
+        
+        void
+        fireBinaryReactions( void );
+        
+        void
+        removeConsumedParticles( void );
+        
+        void
+        wrap( double* pPosition ) const;
+    };
+}
+
+#endif // MZR_PARTICLEENGINE_H
@@ -0,0 +1,70 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "mzr/particleEvents.hh"
+#include "mzr/mzrReaction.hh"
+
+namespace mzr
+{
+    fnd::eventResult
+    injectParticlesEvent::happen( particleEngine& rEngine )
+        throw( std::exception )
+    {
+        rEngine.addParticles( pSpecies,
+                              count );
+        return fnd::go;
+    }
+    
+    fnd::eventResult
+    setReactionRateEvent::happen( particleEngine& rEngine )
+        throw( std::exception )
+    {
+        pReaction->setRate( rate );
+        
+        // The engine turns reaction rates into firing probabilities as it
+        // first meets each species or pair of species.
+        rEngine.forgetReactionChannels();
+        return fnd::go;
+    }
+    
+    fnd::eventResult
+    dumpPopulationsEvent::happen( particleEngine& rEngine )
+        throw( std::exception )
+    {
+        rOs << rEngine.getTime();
+        
+        for ( std::vector<const mzrSpecies*>::const_iterator iSpecies = speciesToDump.begin();
+              iSpecies != speciesToDump.end();
+              ++iSpecies )
+        {
+            rOs << '\t'
+                << rEngine.getPopulation( *iSpecies );
+        }
+        rOs << std::endl;
+        
+        return fnd::go;
+    }
+}
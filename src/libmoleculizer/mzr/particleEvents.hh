@@ -0,0 +1,125 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef MZR_PARTICLEEVENTS_H
+#define MZR_PARTICLEEVENTS_H
+
+/*! \file particleEvents.hh
+  \ingroup eventGroup
+  \brief Timed perturbations of a particleEngine simulation.
+  
+  Schedule these with particleEngine::getEvents(), which takes
+  ownership of them. */
+
+#include <ostream>
+#include <vector>
+#include "mzr/particleEngine.hh"
+
+namespace mzr
+{
+    /*! \ingroup eventGroup
+      \brief Adds particles of a species at random places in the box.
+      
+      The species' reactions are generated when it is injected, if they
+      haven't been already, as they are for any species entering the
+      box. */
+    class injectParticlesEvent :
+        public particleEvent
+    {
+        mzrSpecies* pSpecies;
+        int count;
+        
+    public:
+        injectParticlesEvent( mzrSpecies* pInjectedSpecies,
+                              int injectedCount ) :
+            pSpecies( pInjectedSpecies ),
+            count( injectedCount )
+        {}
+        
+        fnd::eventResult
+        happen( particleEngine& rEngine )
+            throw( std::exception );
+    };
+    
+    /*! \ingroup eventGroup
+      \brief Changes the rate of a reaction. */
+    class setReactionRateEvent :
+        public particleEvent
+    {
+        mzrReaction* pReaction;
+        double rate;
+        
+    public:
+        setReactionRateEvent( mzrReaction* pChangedReaction,
+                              double newRate ) :
+            pReaction( pChangedReaction ),
+            rate( newRate )
+        {}
+        
+        fnd::eventResult
+        happen( particleEngine& rEngine )
+            throw( std::exception );
+    };
+    
+    /*! \ingroup eventGroup
+      \brief Writes a line of the time and the populations of some species.
+      
+      Fields are separated by tabs.  Scheduled periodically, this gives a
+      time course like a species stream. */
+    class dumpPopulationsEvent :
+        public particleEvent
+    {
+        std::ostream& rOs;
+        std::vector<const mzrSpecies*> speciesToDump;
+        
+    public:
+        dumpPopulationsEvent( std::ostream& rOutputStream,
+                              const std::vector<const mzrSpecies*>& rSpeciesToDump ) :
+            rOs( rOutputStream ),
+            speciesToDump( rSpeciesToDump )
+        {}
+        
+        fnd::eventResult
+        happen( particleEngine& rEngine )
+            throw( std::exception );
+    };
+    
+    /*! \ingroup eventGroup
+      \brief Stops particleEngine::run. */
+    class stopParticlesEvent :
+        public particleEvent
+    {
+    public:
+        fnd::eventResult
+        happen( particleEngine& rEngine )
+            throw( std::exception )
+        {
+            return fnd::stop;
+        }
+    };
+}
+
+#endif // MZR_PARTICLEEVENTS_H
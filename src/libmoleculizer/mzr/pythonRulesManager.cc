@@ -31,32 +31,224 @@
 
 #include "pythonRulesManager.hh"
 #include "mzrException.hh"
+#include "utl/linearHash.hh"
+
+#include <pthread.h>
+#include <fstream>
+#include <sstream>
 
 namespace mzr
 {
 
+  const int PythonRulesService::DEFAULT_CONVERSION_CACHE_SIZE = 16;
+
+  PyObject* PythonRulesService::mzrFileConverterClass = NULL;
+  bool PythonRulesService::initializationFailed = false;
+  PythonRulesService::ConversionCache PythonRulesService::conversionCache;
+  PythonRulesService::RecencyList PythonRulesService::recencyList;
+  int PythonRulesService::maxCachedConversions = PythonRulesService::DEFAULT_CONVERSION_CACHE_SIZE;
+
+  namespace
+  {
+    pthread_once_t pythonInitOnce = PTHREAD_ONCE_INIT;
+    pthread_mutex_t conversionCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    class conversionCacheLock
+    {
+    public:
+      conversionCacheLock( void )
+      {
+        pthread_mutex_lock( &conversionCacheMutex );
+      }
+
+      ~conversionCacheLock( void )
+      {
+        pthread_mutex_unlock( &conversionCacheMutex );
+      }
+    };
+  }
+
+  void
+  PythonRulesService::initializeOnce()
+  {
+    // If we are embedded in a Python program (through the python
+    // wrapper, for example), the interpreter is already running and the
+    // calling thread holds the GIL.
+    bool weStartedPython = !Py_IsInitialized();
+
+    if ( weStartedPython )
+    {
+      Py_Initialize();
+      PyEval_InitThreads();
+    }
+
+    PyGILState_STATE gilState = PyGILState_Ensure();
+
+    PyObject* pName = PyString_FromString( "moleculizer" );
+    PyObject* pModule = PyImport_Import( pName );
+    Py_XDECREF( pName );
+
+    if ( !pModule )
+    {
+      initializationFailed = true;
+      PyErr_Print();
+    }
+    else
+    {
+      PyObject* pDict = PyModule_GetDict( pModule );
+      mzrFileConverterClass = PyDict_GetItemString( pDict, "MoleculizerRulesFile" );
+
+      if ( !mzrFileConverterClass )
+      {
+        initializationFailed = true;
+        PyErr_Print();
+      }
+      else
+      {
+        // Borrowed from the module dictionary; the module lives as long
+        // as the interpreter, but keep our own reference regardless.
+        Py_INCREF( mzrFileConverterClass );
+      }
+    }
+
+    PyGILState_Release( gilState );
+
+    // Hand the GIL back so that PyGILState_Ensure works from any thread.
+    if ( weStartedPython ) PyEval_SaveThread();
+  }
+
+  void
+  PythonRulesService::ensureInitialized()
+  {
+    pthread_once( &pythonInitOnce, &PythonRulesService::initializeOnce );
+
+    if ( initializationFailed )
+    {
+      throw mzrPythonXcpt("The moleculizer module could not be loaded.  Please check to make sure it is installed or contact your system administrator.");
+    }
+  }
+
+  PyObject*
+  PythonRulesService::newConverter()
+  {
+    return PyObject_CallObject( mzrFileConverterClass, NULL );
+  }
+
+  bool
+  PythonRulesService::lookupConversion( const std::string& rulesSource,
+                                        std::string& xmlOutput )
+  {
+    conversionCacheLock lock;
+
+    utl::linearHash hashFunction;
+    ConversionCache::iterator iter = conversionCache.find( hashFunction( rulesSource ) );
+
+    // The hash only picks the slot; the source itself decides the hit.
+    if ( iter == conversionCache.end() ||
+         iter->second.rulesSource != rulesSource ) return false;
+
+    recencyList.splice( recencyList.begin(), recencyList, iter->second.iRecency );
+    xmlOutput = iter->second.xml;
+    return true;
+  }
+
+  void
+  PythonRulesService::recordConversion( const std::string& rulesSource,
+                                        const std::string& xmlOutput )
+  {
+    conversionCacheLock lock;
+
+    utl::linearHash hashFunction;
+    size_t sourceHash = hashFunction( rulesSource );
+
+    std::pair<ConversionCache::iterator, bool> insertResult
+      = conversionCache.insert( std::make_pair( sourceHash, cachedConversion() ) );
+    cachedConversion& rEntry = insertResult.first->second;
+
+    if ( insertResult.second )
+    {
+      recencyList.push_front( sourceHash );
+    }
+    else
+    {
+      recencyList.splice( recencyList.begin(), recencyList, rEntry.iRecency );
+    }
+    rEntry.iRecency = recencyList.begin();
+    rEntry.rulesSource = rulesSource;
+    rEntry.xml = xmlOutput;
+
+    trimConversionCache();
+  }
+
+  void
+  PythonRulesService::trimConversionCache()
+  {
+    while ( (int) conversionCache.size() > maxCachedConversions )
+    {
+      conversionCache.erase( recencyList.back() );
+      recencyList.pop_back();
+    }
+  }
+
+  int
+  PythonRulesService::getNumberCachedConversions()
+  {
+    conversionCacheLock lock;
+    return conversionCache.size();
+  }
+
+  void
+  PythonRulesService::clearConversionCache()
+  {
+    conversionCacheLock lock;
+    conversionCache.clear();
+    recencyList.clear();
+  }
+
+  void
+  PythonRulesService::setConversionCacheSize( int maxConversions )
+  {
+    conversionCacheLock lock;
+    maxCachedConversions = maxConversions < 0 ? 0 : maxConversions;
+    trimConversionCache();
+  }
+
+  int
+  PythonRulesService::getConversionCacheSize()
+  {
+    conversionCacheLock lock;
+    return maxCachedConversions;
+  }
+
   PythonRulesManager::~PythonRulesManager()
   {
-    delete paramPythonFunctionName;
-    delete molPythonFunctionName;
-    delete alloPlexPythonFunctionName;
-    delete alloOmniPythonFunctionName;
-    delete dimerGenPythonFunctionName;
-    delete omniGenPythonFunctionName;
-    delete uniMolGenPythonFunctionName;
-    delete speciesStreamPythonFunctionName;
-    delete singleStringTuple;
-    delete getFileStringFunctionName;
-    delete addWholeRulesFileFunctionName;
-    delete addWholeRulesStringFunctionName;
+    delete[] paramPythonFunctionName;
+    delete[] modPythonFunctionName;
+    delete[] molPythonFunctionName;
+    delete[] alloPlexPythonFunctionName;
+    delete[] alloOmniPythonFunctionName;
+    delete[] dimerGenPythonFunctionName;
+    delete[] omniGenPythonFunctionName;
+    delete[] uniMolGenPythonFunctionName;
+    delete[] speciesStreamPythonFunctionName;
+    delete[] singleStringTuple;
+    delete[] getFileStringFunctionName;
+    delete[] addWholeRulesFileFunctionName;
+    delete[] addWholeRulesStringFunctionName;
+    delete[] explicitSpeciesPythonFunctionName;
     
-    // PyDecref( mzrFileConverterClassInst );
+    if ( mzrFileConverterClassInst )
+    {
+      pythonGilLock gil;
+      Py_DECREF( mzrFileConverterClassInst );
+    }
   }
 
 
   PythonRulesManager::PythonRulesManager()
     :
-    _isInitialized( true )
+    _isInitialized( true ),
+    mzrFileConverterClassInst( NULL )
   {
     paramPythonFunctionName = new char[256];
     modPythonFunctionName = new char[256];
@@ -88,49 +280,115 @@ namespace mzr
     strcpy( explicitSpeciesPythonFunctionName, "addExplicitSpeciesStatement" );
     strcpy (singleStringTuple, "s");
 
-    PyObject *pName, *pModule, *pDict, *pFunc, *pArgs, *pFileName;
-
-    Py_Initialize();
+    // Python is not touched until a conversion is actually needed.  See
+    // PythonRulesService.
+  }
 
-    pName = PyString_FromString( "moleculizer" );
+  void
+  PythonRulesManager::enqueueCall( char* functionName,
+                                   const std::string& argument,
+                                   const std::string& sourceText )
+  {
+    if (!isInitialized() ) throw std::exception();
 
-    pModule = PyImport_Import( pName );
+    size_t originalLength = rulesSource.size();
+    rulesSource.append( functionName );
+    rulesSource.push_back( '\n' );
+    rulesSource.append( sourceText );
+    rulesSource.push_back( '\0' );
+
+    PendingCall theCall;
+    theCall.functionName = functionName;
+    theCall.argument = argument;
+    theCall.sourceLength = rulesSource.size() - originalLength;
+    pendingCalls.push_back( theCall );
+  }
 
-    if (!pModule)
+  void
+  PythonRulesManager::flushPendingCalls() const
+  {
+    // The caller holds the GIL.
+    if ( !mzrFileConverterClassInst )
     {
-	_isInitialized = false;
-	PyErr_Print();
-	throw mzrPythonXcpt("The moleculizer module could not be loaded.  Please check to make sure it is installed or contact your system administrator.");
+      mzrFileConverterClassInst = PythonRulesService::newConverter();
+
+      if ( !mzrFileConverterClassInst )
+      {
+        _isInitialized = false;
+        PyErr_Print();
+        throw mzrPythonXcpt("The MoleculizerRulesFile could not be found in the moleculizer module. Please contact your system administrator");
+      }
     }
 
-    pDict = PyModule_GetDict( pModule );
-    pFunc = PyDict_GetItemString( pDict, "MoleculizerRulesFile" );
-
-    if (!pModule)
+    for( std::vector<PendingCall>::iterator callIter = pendingCalls.begin();
+         callIter != pendingCalls.end();
+         ++callIter)
     {
-	_isInitialized = false;
-	PyErr_Print();
-	throw mzrPythonXcpt("The MoleculizerRulesFile could not be found in the moleculizer module. Please contact your system administrator");
+      PyObject* result = PyObject_CallMethod( mzrFileConverterClassInst, 
+                                              callIter->functionName, 
+                                              singleStringTuple, 
+                                              callIter->argument.c_str() );
+      if ( !result )
+      {
+        // The converter has seen the calls before this one, which are done
+        // with.  The failed call is dropped altogether, text and all, so
+        // that the rules are converted, and cached, as if it had never
+        // been given; the calls after it stay pending.
+        PyErr_Print();
+        std::string failedStatement( callIter->argument );
+
+        size_t laterLength = 0;
+        for ( std::vector<PendingCall>::iterator laterIter = callIter + 1;
+              laterIter != pendingCalls.end();
+              ++laterIter )
+        {
+          laterLength += laterIter->sourceLength;
+        }
+        rulesSource.erase( rulesSource.size() - laterLength - callIter->sourceLength,
+                           callIter->sourceLength );
+
+        pendingCalls.erase( pendingCalls.begin(), callIter + 1 );
+        throw mzrPythonXcpt("The rules statement '" + failedStatement + "' could not be converted.");
+      }
+      Py_DECREF( result );
     }
 
-    mzrFileConverterClassInst = PyObject_CallObject(pFunc, NULL);
-
+    pendingCalls.clear();
   }
 
   std::string
   PythonRulesManager::getXmlString() const
   {
+    if (!isInitialized() ) throw std::exception();
 
-    PyErr_Print();
+    // A cached conversion needs no interpreter at all.
+    std::string xmlString;
+    if ( PythonRulesService::lookupConversion( rulesSource, xmlString ) )
+    {
+      return xmlString;
+    }
 
-    PyObject* fileAsString;
+    PythonRulesService::ensureInitialized();
 
-    if (!isInitialized() ) throw std::exception();
+    pythonGilLock gil;
+
+    flushPendingCalls();
+
+    PyObject* fileAsString;
     fileAsString = PyObject_CallMethod(mzrFileConverterClassInst, getFileStringFunctionName, NULL);
 
-    PyErr_Print();
+    if ( !fileAsString )
+    {
+      PyErr_Print();
+      throw mzrPythonXcpt("The rules could not be converted to xml.");
+    }
+
+    xmlString = std::string( PyString_AsString( fileAsString ) );
+    Py_DECREF( fileAsString );
 
-    return std::string(PyString_AsString(fileAsString));
+    PythonRulesService::recordConversion( rulesSource, xmlString );
+
+    return xmlString;
   }
 
 
@@ -138,10 +396,14 @@ namespace mzr
   std::string 
   PythonRulesManager::addRulesFile( const std::string& rulesFile)
   {
-    if( !isInitialized() ) throw std::exception();
-    PyErr_Print();
-    PyObject_CallMethod( mzrFileConverterClassInst, addWholeRulesFileFunctionName, singleStringTuple, rulesFile.c_str());
-    PyErr_Print();
+    // The cache is keyed on what the file says, not what it is called.
+    std::ifstream rulesStream( rulesFile.c_str() );
+    if ( !rulesStream ) throw utl::xcpt( "Could not open rules file '" + rulesFile + "'." );
+
+    std::ostringstream rulesContents;
+    rulesContents << rulesStream.rdbuf();
+
+    enqueueCall( addWholeRulesFileFunctionName, rulesFile, rulesContents.str() );
     return getXmlString();
   }
 
@@ -149,82 +411,54 @@ namespace mzr
   std::string
   PythonRulesManager::addRulesString( const std::string& rulesString)
   {
-    if( !isInitialized() ) throw std::exception();
-
-    PyErr_Print();
-    PyObject_CallMethod( mzrFileConverterClassInst, addWholeRulesStringFunctionName, singleStringTuple, rulesString.c_str());
-    PyErr_Print();
-
+    enqueueCall( addWholeRulesStringFunctionName, rulesString, rulesString );
     return getXmlString();
   }
 
 
   void PythonRulesManager::addParameterStatement(const std::string& paramLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, paramPythonFunctionName, singleStringTuple, paramLine.c_str());
+    enqueueCall( paramPythonFunctionName, paramLine, paramLine );
   }
 
   void PythonRulesManager::addModificationStatement(const std::string& modLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, modPythonFunctionName, singleStringTuple, modLine.c_str());
-
+    enqueueCall( modPythonFunctionName, modLine, modLine );
   }
 
   void PythonRulesManager::addMolsStatement(const std::string& molsLIne)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, molPythonFunctionName, singleStringTuple, molsLIne.c_str());
-
+    enqueueCall( molPythonFunctionName, molsLIne, molsLIne );
   }
 
   void PythonRulesManager::addAllostericPlexStatement(const std::string& alloPlexLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, alloPlexPythonFunctionName, singleStringTuple, alloPlexLine.c_str());
-
+    enqueueCall( alloPlexPythonFunctionName, alloPlexLine, alloPlexLine );
   }
 
   void PythonRulesManager::addAllostericOmniStatement(const std::string& alloOmniLine)
   {
-
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, alloOmniPythonFunctionName, singleStringTuple, alloOmniLine.c_str());
-
+    enqueueCall( alloOmniPythonFunctionName, alloOmniLine, alloOmniLine );
   }
 
   void PythonRulesManager::addDimerizationGenStatement(const std::string& dimerGenLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, dimerGenPythonFunctionName, singleStringTuple, dimerGenLine.c_str());
+    enqueueCall( dimerGenPythonFunctionName, dimerGenLine, dimerGenLine );
   }
 
   void PythonRulesManager::addOmniGenStatement(const std::string& omniGenLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, omniGenPythonFunctionName, singleStringTuple, omniGenLine.c_str());
+    enqueueCall( omniGenPythonFunctionName, omniGenLine, omniGenLine );
   }
 
   void PythonRulesManager::addUniMolGenStatement(const std::string& uniMolGenLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, uniMolGenPythonFunctionName, singleStringTuple, uniMolGenLine.c_str());
+    enqueueCall( uniMolGenPythonFunctionName, uniMolGenLine, uniMolGenLine );
   }
 
   void PythonRulesManager::addSpeciesStreamStatement(const std::string& speciesStreamLine)
   {
-    if (!isInitialized() ) throw std::exception();
-
-    PyObject_CallMethod(mzrFileConverterClassInst, speciesStreamPythonFunctionName, singleStringTuple, speciesStreamLine.c_str() );
+    enqueueCall( speciesStreamPythonFunctionName, speciesStreamLine, speciesStreamLine );
   }
 
 
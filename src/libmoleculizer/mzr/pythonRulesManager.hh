@@ -40,10 +40,113 @@
 
 #include <Python.h>
 #include <string>
+#include <vector>
+#include <list>
+#include <map>
 
 namespace mzr
 {
 
+  // The embedded interpreter and the "moleculizer" module are process
+  // wide resources, so they are owned here rather than by any
+  // individual PythonRulesManager.  Nothing is done until the first
+  // rules file actually needs converting, so moleculizer objects that
+  // only ever load xml never pay for Py_Initialize.
+  //
+  // Conversions are also memoized by the content of the rules that
+  // produced them, so loading the same rules into many short lived
+  // moleculizer objects only runs the Python converter once.  The cache
+  // keeps only the most recently used conversions, so that a long running
+  // program that converts many rule sets doesn't keep them all.
+  //
+  // All access to the interpreter happens with the GIL held, which is
+  // what serializes concurrent callers.  The conversion cache has a lock
+  // of its own, so that a hit needs neither the GIL nor the interpreter.
+  class PythonRulesService
+  {
+  public:
+    // Initializes the interpreter (if the host program has not already
+    // done so) and imports the moleculizer module.  Throws
+    // mzrPythonXcpt if the module cannot be loaded.
+    static void
+    ensureInitialized();
+
+    // Creates a new MoleculizerRulesFile converter object.  The caller
+    // must hold the GIL and owns the returned reference.
+    static PyObject*
+    newConverter();
+
+    static bool
+    lookupConversion( const std::string& rulesSource,
+                      std::string& xmlOutput );
+
+    static void
+    recordConversion( const std::string& rulesSource,
+                      const std::string& xmlOutput );
+
+    static int
+    getNumberCachedConversions();
+
+    static void
+    clearConversionCache();
+
+    // The number of conversions kept; the least recently used are
+    // dropped to make room.  The default is DEFAULT_CONVERSION_CACHE_SIZE.
+    static void
+    setConversionCacheSize( int maxConversions );
+
+    static int
+    getConversionCacheSize();
+
+    static const int DEFAULT_CONVERSION_CACHE_SIZE;
+
+  private:
+    static void
+    initializeOnce();
+
+    // Drops least recently used conversions until there are no more
+    // than maxCachedConversions.  The caller holds the cache lock.
+    static void
+    trimConversionCache();
+
+    static PyObject* mzrFileConverterClass;
+    static bool initializationFailed;
+
+    // Hashes of the cached rules, most recently used first.
+    typedef std::list<size_t> RecencyList;
+
+    class cachedConversion
+    {
+    public:
+      std::string rulesSource;
+      std::string xml;
+      RecencyList::iterator iRecency;
+    };
+
+    typedef std::map<size_t, cachedConversion> ConversionCache;
+    static ConversionCache conversionCache;
+    static RecencyList recencyList;
+    static int maxCachedConversions;
+  };
+
+  // Acquires the GIL for the lifetime of the object.
+  class pythonGilLock
+  {
+  public:
+    pythonGilLock( void )
+      :
+      gilState( PyGILState_Ensure() )
+    {}
+
+    ~pythonGilLock( void )
+    {
+      PyGILState_Release( gilState );
+    }
+
+  private:
+    PyGILState_STATE gilState;
+  };
+
   class PythonRulesManager
   {
   public:
@@ -74,9 +177,32 @@ namespace mzr
       return _isInitialized;
     }
 
+    // Everything this manager has been given, which is the key of its
+    // conversion in the PythonRulesService cache.
+    const std::string&
+    getRulesSource() const
+    {
+      return rulesSource;
+    }
+
   private:
 
-    bool _isInitialized;
+    // Statements are not sent to Python as they arrive.  They are
+    // queued here and only replayed into a converter object when the
+    // xml they produce is not already in the conversion cache.
+    void
+    enqueueCall( char* functionName,
+                 const std::string& argument,
+                 const std::string& sourceText );
+
+    // Throws mzrPythonXcpt, at the first statement Python rejects.  The
+    // rejected statement is dropped, both from the pending calls and from
+    // rulesSource, so that the statements given afterward can still be
+    // converted.
+    void
+    flushPendingCalls() const;
+
+    mutable bool _isInitialized;
 
     char* getFileStringFunctionName;
     char* addWholeRulesFileFunctionName;
@@ -94,9 +220,25 @@ namespace mzr
     char* explicitSpeciesPythonFunctionName;
     char* singleStringTuple;
 
-    PyObject* mzrFileConverterClassInst;
+    // Everything this manager has been given, in order, with files
+    // replaced by their contents.  This is the key for the conversion
+    // cache.  The pending calls' text is at its end, in order.
+    mutable std::string rulesSource;
+
+    class PendingCall
+    {
+    public:
+      char* functionName;
+      std::string argument;
+
+      // The length of this call's text in rulesSource.
+      size_t sourceLength;
+    };
+
+    mutable std::vector<PendingCall> pendingCalls;
 
-    void DEBUG_doInterestingStuff();
+    // NULL until a conversion actually has to be run.
+    mutable PyObject* mzrFileConverterClassInst;
 
   };
 
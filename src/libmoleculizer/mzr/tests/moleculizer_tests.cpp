@@ -32,6 +32,43 @@
 #include <boost/test/included/unit_test.hpp>
 #include <boost/foreach.hpp>
 #include "mzr/moleculizer.hh"
+#include "fnd/dumpStream.hh"
+#include "fnd/binaryDumpReader.hh"
+#include "mzr/cellList.hh"
+#include "fnd/propensityKernel.hh"
+#include "cpx/siteToShapeMap.hh"
+#include "cpx/queryAlloList.hh"
+#include "cpx/basicPlex.hh"
+#include "utl/hashCache.hh"
+#include "utl/autoVector.hh"
+#include "cpx/modStateMixin.hh"
+#include "cpx/cpxXcpt.hh"
+#include "fnd/rateMemo.hh"
+#include "dimer/dimerizeExtrap.hh"
+#include "fnd/eventQueue.hh"
+#include "fnd/forwardSensitivity.hh"
+#include "fnd/expansionProfiler.hh"
+#include "fnd/networkReduction.hh"
+#include "mzr/agentSimulator.hh"
+#include "fnd/memoryAccount.hh"
+#include "fnd/sensitivityList.hh"
+#include "fnd/networkSnapshot.hh"
+#include "fnd/basicDumpable.hh"
+#include "fnd/querySpeciesDumpable.hh"
+#include "mzr/networkDiff.hh"
+#include "mzr/unitsMgr.hh"
+#include "nmr/nmrUnit.hh"
+#include "nmr/mangledNameAssembler.hh"
+#include "nmr/namedMolecule.hh"
+#include "nmr/internedComplexSpecies.hh"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <set>
 using namespace boost::unit_test;
 using namespace mzr;
 
@@ -67,11 +104,2218 @@ void test_scaffold()
     // theMoleculizer.attachFileName( "/home/naddy/Sources/libmoleculizer/src/mzr/tests/scaffold.xml" );
 }
 
+void test_python_rules_cache()
+{
+    typedef PythonRulesService service;
+    service::clearConversionCache();
+    
+    // Rules whose conversion is cached are answered without starting the
+    // interpreter.
+    bool pythonWasRunning = Py_IsInitialized();
+    PythonRulesManager theManager;
+    theManager.addParameterStatement( "k = 1.0" );
+    BOOST_CHECK( Py_IsInitialized() == pythonWasRunning );
+    service::recordConversion( theManager.getRulesSource(), "<moleculizer-input/>" );
+    BOOST_CHECK( theManager.getXmlString() == "<moleculizer-input/>" );
+    BOOST_CHECK( Py_IsInitialized() == pythonWasRunning );
+    
+    // The cache is keyed on what the rules say.
+    std::string xml;
+    PythonRulesManager otherManager;
+    otherManager.addParameterStatement( "k = 2.0" );
+    BOOST_CHECK( ! service::lookupConversion( otherManager.getRulesSource(), xml ) );
+    PythonRulesManager sameManager;
+    sameManager.addParameterStatement( "k = 1.0" );
+    BOOST_CHECK( service::lookupConversion( sameManager.getRulesSource(), xml ) );
+    BOOST_CHECK( xml == "<moleculizer-input/>" );
+    
+    // Only the most recently used conversions are kept.
+    service::setConversionCacheSize( 2 );
+    BOOST_CHECK( service::getNumberCachedConversions() == 1 );
+    service::recordConversion( "a", "A" );
+    service::recordConversion( "b", "B" );
+    BOOST_CHECK( service::getNumberCachedConversions() == 2 );
+    BOOST_CHECK( ! service::lookupConversion( theManager.getRulesSource(), xml ) );
+    
+    BOOST_CHECK( service::lookupConversion( "a", xml ) );
+    service::recordConversion( "c", "C" );
+    BOOST_CHECK( service::lookupConversion( "a", xml ) && xml == "A" );
+    BOOST_CHECK( ! service::lookupConversion( "b", xml ) );
+    BOOST_CHECK( service::lookupConversion( "c", xml ) && xml == "C" );
+    
+    // Recording a conversion again replaces it.
+    service::recordConversion( "c", "D" );
+    BOOST_CHECK( service::lookupConversion( "c", xml ) && xml == "D" );
+    BOOST_CHECK( service::getNumberCachedConversions() == 2 );
+    
+    service::setConversionCacheSize( 0 );
+    BOOST_CHECK( service::getNumberCachedConversions() == 0 );
+    
+    service::setConversionCacheSize( service::DEFAULT_CONVERSION_CACHE_SIZE );
+    service::clearConversionCache();
+}
+
+// A dumpable whose value is whatever the test last set.
+class testValueDumpable :
+    public fnd::dumpable<fnd::basicDumpable::dumpArg>
+{
+    const double& rValue;
+    
+public:
+    testValueDumpable( const std::string& rName,
+                       const double& rDumpedValue ) :
+        fnd::dumpable<fnd::basicDumpable::dumpArg>( rName ),
+        rValue( rDumpedValue )
+    {}
+    
+    void
+    doDump( const fnd::basicDumpable::dumpArg& rDumpArg ) const
+    {
+        rDumpArg.getOstream() << rValue;
+    }
+    
+    bool
+    hasDumpValue( void ) const
+    {
+        return true;
+    }
+    
+    double
+    getDumpValue( const fnd::basicDumpable::dumpArg& rDumpArg ) const
+    {
+        return rValue;
+    }
+};
+
+// A dumpable that only writes text.
+class testTextDumpable :
+    public fnd::dumpable<fnd::basicDumpable::dumpArg>
+{
+public:
+    testTextDumpable( const std::string& rName ) :
+        fnd::dumpable<fnd::basicDumpable::dumpArg>( rName )
+    {}
+    
+    void
+    doDump( const fnd::basicDumpable::dumpArg& rDumpArg ) const
+    {
+        rDumpArg.getOstream() << "text";
+    }
+};
+
+void writeTestDump( const std::string& rFileName,
+                    int firstRow,
+                    int rowCount )
+{
+    double time, value;
+    testValueDumpable timeDumpable( "time", time );
+    testValueDumpable valueDumpable( "value", value );
+    
+    fnd::dumpStream stream( rFileName,
+                            fnd::dumpStream::textAndBinaryFormat,
+                            1000 );
+    fnd::basicDumpable::dumpArg dumpArg( stream.getOstream() );
+    stream.addColumn( new fnd::dmpColumn<fnd::basicDumpable::dumpArg>( &timeDumpable, dumpArg ) );
+    stream.addColumn( new fnd::dmpColumn<fnd::basicDumpable::dumpArg>( &valueDumpable, dumpArg ) );
+    
+    stream.init();
+    for ( int row = firstRow; row != firstRow + rowCount; ++row )
+    {
+        time = row * 0.1;
+        value = 1.0 / ( row + 1 );
+        stream.doDump();
+    }
+}
+
+void test_binary_dump_round_trip()
+{
+    const std::string fileName( "binary_dump_test.dmp" );
+    const std::string binaryFileName( fileName + fnd::dumpStream::binaryFileSuffix );
+    std::remove( fileName.c_str() );
+    std::remove( binaryFileName.c_str() );
+    
+    // The second stream continues the first, as a continued simulation would.
+    writeTestDump( fileName, 0, 2500 );
+    writeTestDump( fileName, 2500, 10 );
+    
+    fnd::binaryDumpReader reader( binaryFileName );
+    BOOST_REQUIRE( reader.getColumnNames().size() == 2 );
+    BOOST_CHECK( reader.findColumn( "value" ) == 1 );
+    
+    std::vector<std::vector<double> > columns;
+    reader.readAll( columns );
+    BOOST_REQUIRE( columns[0].size() == 2510 );
+    
+    for ( int row = 0; row != 2510; ++row )
+    {
+        BOOST_CHECK( columns[0][row] == row * 0.1 );
+        BOOST_CHECK( columns[1][row] == 1.0 / ( row + 1 ) );
+    }
+    
+    std::remove( fileName.c_str() );
+    std::remove( binaryFileName.c_str() );
+    
+    // Binary output needs a genuine file, and numeric columns.
+    BOOST_CHECK_THROW( fnd::dumpStream( "-", fnd::dumpStream::binaryFormat ),
+                       fnd::badDumpFileXcpt );
+    
+    {
+        fnd::dumpStream stream( binaryFileName,
+                                fnd::dumpStream::binaryFormat );
+        fnd::basicDumpable::dumpArg dumpArg( stream.getOstream() );
+        testTextDumpable textDumpable( "text" );
+        BOOST_CHECK_THROW( stream.addColumn( new fnd::dmpColumn<fnd::basicDumpable::dumpArg>( &textDumpable, dumpArg ) ),
+                           fnd::nonNumericDumpColumnXcpt );
+        BOOST_CHECK( stream.empty() );
+    }
+    std::remove( binaryFileName.c_str() );
+}
+
+void test_cell_list_pairs()
+{
+    const double boxSide = 10.0;
+    const double cutoff = 0.7;
+    
+    // Points on a jittered grid, some of them close across the box edges.
+    std::vector<double> coords;
+    for ( int point = 0; point != 3000; ++point )
+    {
+        for ( int axis = 0; axis != 3; ++axis )
+        {
+            coords.push_back( std::fmod( point * ( 0.37 + 0.21 * axis ) + 0.013 * point * point,
+                                         boxSide ) );
+        }
+    }
+    
+    mzr::cellList theCellList( boxSide );
+    theCellList.build( coords, cutoff );
+    BOOST_CHECK( 3 <= theCellList.getCellsPerSide() );
+    
+    std::vector<std::pair<int, int> > foundPairs;
+    theCellList.findPairs( coords, foundPairs );
+    
+    std::set<std::pair<int, int> > found;
+    for ( std::vector<std::pair<int, int> >::const_iterator iPair = foundPairs.begin();
+          iPair != foundPairs.end();
+          ++iPair )
+    {
+        found.insert( std::make_pair( std::min( iPair->first, iPair->second ),
+                                      std::max( iPair->first, iPair->second ) ) );
+    }
+    BOOST_CHECK( found.size() == foundPairs.size() );
+    
+    std::set<std::pair<int, int> > expected;
+    for ( int first = 0; first != 3000; ++first )
+    {
+        for ( int second = first + 1; second != 3000; ++second )
+        {
+            if ( mzr::cellList::periodicDistanceSquared( &coords[3 * first],
+                                                         &coords[3 * second],
+                                                         boxSide ) < cutoff * cutoff )
+            {
+                expected.insert( std::make_pair( first, second ) );
+            }
+        }
+    }
+    BOOST_CHECK( 0 < expected.size() );
+    BOOST_CHECK( found == expected );
+}
+
+class testPopSpecies
+{
+public:
+    int pop;
+    std::string name;
+    
+    int
+    getPop( void ) const
+    {
+        return pop;
+    }
+    
+    std::string
+    getName( void ) const
+    {
+        return name;
+    }
+    
+    std::string
+    getTaggedName( void ) const
+    {
+        return name;
+    }
+};
+
+class testPopReaction :
+    public fnd::gillspReaction<testPopSpecies>
+{
+public:
+    testPopReaction( double rate ) :
+        fnd::gillspReaction<testPopSpecies>( rate )
+    {}
+    
+    void
+    notify( int notifyDepth )
+    {}
+};
+
+class testPopSpeciesIndex
+{
+    const std::vector<testPopSpecies>& rSpecies;
+public:
+    testPopSpeciesIndex( const std::vector<testPopSpecies>& rAllSpecies ) :
+        rSpecies( rAllSpecies )
+    {}
+    
+    int
+    operator()( const testPopSpecies* pSpecies ) const
+    {
+        return pSpecies - &rSpecies[0];
+    }
+};
+
+void test_propensity_kernel()
+{
+    const double volume = 1.3e-15;
+    
+    std::vector<testPopSpecies> species( 40 );
+    for ( int ndx = 0; ndx != 40; ++ndx )
+    {
+        species[ndx].pop = ( ndx * 7919 ) % 251;
+    }
+    
+    // Every form of reaction, in a jumbled order.
+    std::vector<testPopReaction*> reactions;
+    for ( int ndx = 0; ndx != 300; ++ndx )
+    {
+        testPopReaction* pRxn = new testPopReaction( 0.5 + ( ndx * 37 ) % 101 * 1.0e5 );
+        
+        int first = ( ndx * 13 ) % 40;
+        int second = ( ndx * 29 + 1 ) % 40;
+        switch ( ndx % 6 )
+        {
+        case 0:
+            break;
+        case 1:
+            pRxn->addReactant( &species[first], 1 );
+            break;
+        case 2:
+            pRxn->addReactant( &species[first], 2 );
+            break;
+        case 3:
+            pRxn->addReactant( &species[first], 1 );
+            if ( second != first ) pRxn->addReactant( &species[second], 1 );
+            break;
+        case 4:
+            pRxn->addReactant( &species[first], 1 );
+            pRxn->addReactant( &species[second], 2 );
+            break;
+        default:
+            pRxn->addReactant( &species[first], 3 );
+            break;
+        }
+        reactions.push_back( pRxn );
+    }
+    
+    fnd::propensityKernel kernel;
+    for ( int ndx = 0; ndx != 300; ++ndx )
+    {
+        BOOST_CHECK( ndx == fnd::addGillspReaction( kernel,
+                                                    *reactions[ndx],
+                                                    testPopSpeciesIndex( species ) ) );
+    }
+    kernel.finish();
+    
+    std::vector<double> populations( 40 );
+    for ( int ndx = 0; ndx != 40; ++ndx ) populations[ndx] = species[ndx].pop;
+    
+    std::vector<double> propensities( 300 );
+    kernel.computeAll( &populations[0], volume, &propensities[0] );
+    for ( int ndx = 0; ndx != 300; ++ndx )
+    {
+        BOOST_CHECK( propensities[kernel.getSlot( ndx )] == reactions[ndx]->propensity( volume ) );
+    }
+    
+    // Change a few populations and update only what depends on them.
+    std::vector<int> changed;
+    changed.push_back( 3 );
+    changed.push_back( 17 );
+    species[3].pop += 11;
+    species[17].pop = 1;
+    populations[3] = species[3].pop;
+    populations[17] = species[17].pop;
+    
+    kernel.updateForSpecies( changed, &populations[0], volume, &propensities[0] );
+    for ( int ndx = 0; ndx != 300; ++ndx )
+    {
+        BOOST_CHECK( propensities[kernel.getSlot( ndx )] == reactions[ndx]->propensity( volume ) );
+        delete reactions[ndx];
+    }
+}
+
+// Stands in for a plexSpecies: records the site shape maps it is given.
+class testAlloSpecies
+{
+public:
+    std::vector<cpx::molParam> molParams;
+    
+    class
+    {
+    public:
+        std::vector<const cpx::siteToShapeMap*> applied;
+        
+        void
+        setSiteShapes( const cpx::siteToShapeMap& rSiteToShapeMap )
+        {
+            applied.push_back( &rSiteToShapeMap );
+        }
+    } siteParams;
+};
+
+class testAlloOmni
+{};
+
+class testWeightBelowQuery :
+    public cpx::molStateQuery
+{
+    double threshold;
+public:
+    testWeightBelowQuery( double theThreshold ) :
+        threshold( theThreshold )
+    {}
+    
+    bool
+    operator()( const cpx::molParam& rParam ) const
+    {
+        return rParam->getMolWeight() < threshold;
+    }
+};
+
+// A conjunct that isn't a mol state query.
+class testSameStateQuery :
+    public cpx::plexQuery<testAlloSpecies, testAlloOmni>
+{
+public:
+    bool
+    operator()( const testAlloSpecies& rSpecies ) const
+    {
+        return rSpecies.molParams[0] == rSpecies.molParams[1];
+    }
+    
+    bool
+    applyTracked( const testAlloSpecies& rSpecies,
+                  const specType& rSpec ) const
+    {
+        return false;
+    }
+};
+
+void test_allostery_index()
+{
+    typedef cpx::andPlexQueries<testAlloSpecies, testAlloOmni> andQueriesType;
+    typedef cpx::molStatePlexQuery<testAlloSpecies, testAlloOmni> molStatePlexQueryType;
+    
+    const int molCount = 4;
+    const int stateCount = 5;
+    
+    std::vector<cpx::molState*> states;
+    std::vector<testWeightBelowQuery*> stateQueries;
+    for ( int ndx = 0; ndx != stateCount; ++ndx )
+    {
+        states.push_back( new cpx::molState( ndx + 1.0 ) );
+        stateQueries.push_back( new testWeightBelowQuery( ndx + 1.5 ) );
+    }
+    testSameStateQuery sameStateQuery;
+    
+    std::vector<cpx::plexQuery<testAlloSpecies, testAlloOmni>*> plexQueries;
+    std::vector<andQueriesType*> andQueries;
+    cpx::queryAllosteryList<testAlloSpecies, testAlloOmni> alloList;
+    
+    for ( int round = 0; round != 2; ++round )
+    {
+        // More queries, including some with no mol state queries at all,
+        // and some that query the same mol twice.
+        for ( int ndx = 0; ndx != 70; ++ndx )
+        {
+            andQueriesType* pQuery = new andQueriesType();
+            for ( int conjunct = 0; conjunct != ndx % 4; ++conjunct )
+            {
+                int molNdx = ( ndx * 7 + conjunct * 3 + round ) % molCount;
+                int stateNdx = ( ndx * 11 + conjunct * 5 ) % stateCount;
+                plexQueries.push_back( new molStatePlexQueryType( molNdx,
+                                                                  *stateQueries[stateNdx] ) );
+                pQuery->addQuery( plexQueries.back() );
+            }
+            if ( ndx % 5 == 2 ) pQuery->addQuery( &sameStateQuery );
+            
+            andQueries.push_back( pQuery );
+            alloList.addQueryAndMap( pQuery, cpx::siteToShapeMap() );
+        }
+        
+        for ( int combo = 0; combo != 625; ++combo )
+        {
+            testAlloSpecies species;
+            for ( int molNdx = 0, rest = combo; molNdx != molCount; ++molNdx, rest /= stateCount )
+            {
+                species.molParams.push_back( states[rest % stateCount] );
+            }
+            
+            alloList.setSatisfiedQuerySiteShapes( species );
+            
+            // What running down the list, as it used to be done, gives.
+            std::vector<const cpx::siteToShapeMap*> expected;
+            for ( cpx::queryAllosteryList<testAlloSpecies, testAlloOmni>::const_iterator iEntry
+                      = alloList.begin();
+                  iEntry != alloList.end();
+                  ++iEntry )
+            {
+                if ( ( *iEntry->first )( species ) ) expected.push_back( &iEntry->second );
+            }
+            
+            BOOST_CHECK( species.siteParams.applied == expected );
+        }
+    }
+    
+    for ( size_t ndx = 0; ndx != andQueries.size(); ++ndx ) delete andQueries[ndx];
+    for ( size_t ndx = 0; ndx != plexQueries.size(); ++ndx ) delete plexQueries[ndx];
+    for ( int ndx = 0; ndx != stateCount; ++ndx )
+    {
+        delete states[ndx];
+        delete stateQueries[ndx];
+    }
+}
+
+class testSiteMol
+{
+    int siteCount;
+public:
+    testSiteMol( int theSiteCount ) :
+        siteCount( theSiteCount )
+    {}
+    
+    int
+    getSiteCount( void ) const
+    {
+        return siteCount;
+    }
+};
+
+void test_site_occupancy()
+{
+    std::vector<testSiteMol*> mols;
+    for ( int ndx = 0; ndx != 12; ++ndx )
+    {
+        mols.push_back( new testSiteMol( ndx % 4 ) );
+    }
+    
+    cpx::basicPlex<testSiteMol> plex;
+    plex.mols = mols;
+    
+    // Bind pairs of sites taken in a scrambled order, leaving some free.
+    std::vector<cpx::siteSpec> sites;
+    for ( int molNdx = 0; molNdx != 12; ++molNdx )
+    {
+        for ( int siteNdx = 0; siteNdx != mols[molNdx]->getSiteCount(); ++siteNdx )
+        {
+            sites.push_back( cpx::siteSpec( molNdx, siteNdx ) );
+        }
+    }
+    for ( size_t ndx = 0; ndx + 1 < sites.size(); ndx += 3 )
+    {
+        size_t other = ( ndx * 7 + 5 ) % sites.size();
+        if ( other == ndx ) continue;
+        plex.bindings.push_back( cpx::binding( sites[ndx], sites[other] ) );
+    }
+    
+    std::map<cpx::siteSpec, cpx::bindingSpec> siteToBindings;
+    plex.makeSiteToBindings( siteToBindings );
+    
+    cpx::siteOccupancy occupancy;
+    occupancy.build( plex );
+    BOOST_CHECK( occupancy.getSiteCount() == ( int ) sites.size() );
+    
+    std::vector<cpx::siteSpec> expectedFreeSites;
+    for ( int molNdx = 11; 0 <= molNdx; --molNdx )
+    {
+        for ( int siteNdx = mols[molNdx]->getSiteCount() - 1; 0 <= siteNdx; --siteNdx )
+        {
+            cpx::siteSpec spec( molNdx, siteNdx );
+            std::map<cpx::siteSpec, cpx::bindingSpec>::const_iterator found
+                = siteToBindings.find( spec );
+            
+            if ( found == siteToBindings.end() )
+            {
+                expectedFreeSites.push_back( spec );
+                BOOST_CHECK( occupancy.siteIsFree( spec ) );
+                BOOST_CHECK( occupancy.getBinding( spec ) == -1 );
+            }
+            else
+            {
+                BOOST_CHECK( ! occupancy.siteIsFree( spec ) );
+                BOOST_CHECK( occupancy.getBinding( spec ) == found->second );
+            }
+        }
+    }
+    
+    std::vector<cpx::siteSpec> freeSites;
+    plex.makeFreeSiteVector( freeSites );
+    BOOST_CHECK( freeSites == expectedFreeSites );
+    BOOST_CHECK( ! freeSites.empty() );
+    
+    for ( int ndx = 0; ndx != 12; ++ndx ) delete mols[ndx];
+}
+
+class testHashCache :
+    public utl::autoHashCache<const int*, int, 4>
+{
+public:
+    int madeCount;
+    
+    testHashCache( void ) :
+        madeCount( 0 )
+    {}
+    
+    int*
+    makeMember( const std::vector<const int*>& rKey )
+    {
+        return new int( madeCount++ );
+    }
+};
+
+void test_hash_cache()
+{
+    // Keys of up to 6 elements, so that some are too long to be held
+    // inline, drawn from 5 addresses.
+    int addresses[5];
+    std::vector<std::vector<const int*> > keys;
+    for ( int ndx = 0; ndx != 3000; ++ndx )
+    {
+        std::vector<const int*> key;
+        for ( int length = ndx % 7, rest = ndx / 7; 0 < length; --length, rest /= 5 )
+        {
+            key.push_back( &addresses[rest % 5] );
+        }
+        keys.push_back( key );
+    }
+    
+    testHashCache cache;
+    std::map<std::vector<const int*>, int> expected;
+    for ( int round = 0; round != 2; ++round )
+    {
+        for ( size_t ndx = 0; ndx != keys.size(); ++ndx )
+        {
+            std::map<std::vector<const int*>, int>::iterator found
+                = expected.find( keys[ndx] );
+            int member = *cache.getMember( keys[ndx] );
+            
+            if ( found == expected.end() )
+            {
+                BOOST_CHECK( member == ( int ) expected.size() );
+                expected[keys[ndx]] = member;
+            }
+            else
+            {
+                BOOST_CHECK( member == found->second );
+            }
+        }
+    }
+    BOOST_CHECK( cache.size() == expected.size() );
+    BOOST_CHECK( cache.madeCount == ( int ) expected.size() );
+    
+    // Members are kept in the order they were made.
+    int ordinal = 0;
+    for ( testHashCache::const_iterator iEntry = cache.begin();
+          iEntry != cache.end();
+          ++iEntry, ++ordinal )
+    {
+        BOOST_CHECK( *iEntry->second == ordinal );
+        BOOST_CHECK( expected[iEntry->first.toVector()] == ordinal );
+        BOOST_CHECK( cache.findMember( iEntry->first.toVector() ) == iEntry->second );
+    }
+    
+    std::vector<const int*> unknownKey( 9, &addresses[0] );
+    BOOST_CHECK( cache.findMember( unknownKey ) == 0 );
+}
+
+void test_mod_state_packing()
+{
+    cpx::modification none( "none", 0.0 );
+    cpx::modification phosphorylated( "phosphorylated", 79.97 );
+    cpx::modification acetylated( "acetylated", 42.01 );
+    const cpx::modification* mods[] = { 0, &none, &phosphorylated, &acetylated };
+    
+    // 3 sites fit in the head word; 19 sites spill into tail words.
+    for ( int siteCount = 3; siteCount <= 19; siteCount += 16 )
+    {
+        std::vector<std::vector<const cpx::modification*> > states;
+        for ( int ndx = 0; ndx != 200; ++ndx )
+        {
+            std::vector<const cpx::modification*> state;
+            for ( int site = 0, rest = ndx * 7919; site != siteCount; ++site, rest /= 3 )
+            {
+                state.push_back( mods[( rest + site ) % 4] );
+            }
+            states.push_back( state );
+        }
+        
+        for ( size_t ndx = 0; ndx != states.size(); ++ndx )
+        {
+            cpx::modStateMixin packed( states[ndx] );
+            
+            BOOST_REQUIRE( packed.size() == states[ndx].size() );
+            double weightDelta = 0.0;
+            for ( int site = 0; site != siteCount; ++site )
+            {
+                BOOST_CHECK( packed[site] == states[ndx][site] );
+                if ( states[ndx][site] ) weightDelta += states[ndx][site]->getWeightDelta();
+            }
+            BOOST_CHECK( packed.totalWeightDelta() == weightDelta );
+            
+            // Exchanging a modification is the same as packing the
+            // exchanged state.
+            std::vector<const cpx::modification*> exchanged( states[ndx] );
+            exchanged[ndx % siteCount] = &phosphorylated;
+            cpx::modStateMixin packedExchange( packed );
+            packedExchange.setModification( ndx % siteCount, &phosphorylated );
+            BOOST_CHECK( packedExchange == cpx::modStateMixin( exchanged ) );
+            BOOST_CHECK( packedExchange.totalWeightDelta()
+                         == cpx::modStateMixin( exchanged ).totalWeightDelta() );
+            
+            for ( size_t other = 0; other != states.size(); ++other )
+            {
+                cpx::modStateMixin otherPacked( states[other] );
+                bool same = ( states[ndx] == states[other] );
+                
+                BOOST_CHECK( ( packed == otherPacked ) == same );
+                BOOST_CHECK( ( packed < otherPacked ) != ( otherPacked < packed ) || same );
+                if ( same ) BOOST_CHECK( packed.hashValue() == otherPacked.hashValue() );
+                
+                // Null modifications in the other state are wildcards.
+                bool matches = true;
+                for ( int site = 0; site != siteCount; ++site )
+                {
+                    if ( states[other][site] && states[other][site] != states[ndx][site] )
+                        matches = false;
+                }
+                BOOST_CHECK( packed.matches( otherPacked ) == matches );
+            }
+        }
+    }
+    
+    // Codes run out after 255 live modifications, and come back as
+    // modifications are destroyed.
+    utl::autoVector<cpx::modification> extraMods;
+    bool ranOut = false;
+    while ( ! ranOut && extraMods.size() < ( size_t ) cpx::modification::codeCount )
+    {
+        try
+        {
+            extraMods.push_back( new cpx::modification( "extra", 0.0 ) );
+        }
+        catch ( const cpx::tooManyModificationsXcpt& )
+        {
+            ranOut = true;
+        }
+    }
+    BOOST_CHECK( ranOut );
+    BOOST_CHECK( extraMods.size() <= 252 );
+    
+    cpx::modCode freedCode = extraMods.back()->getCode();
+    delete extraMods.back();
+    extraMods.pop_back();
+    cpx::modification reused( "reused", 0.0 );
+    BOOST_CHECK( reused.getCode() == freedCode );
+    BOOST_CHECK( cpx::modification::fromCode( freedCode ) == &reused );
+}
+
+void test_rate_memo()
+{
+    cpx::siteShape shapes[] = { cpx::siteShape( "a" ),
+                                cpx::siteShape( "b" ),
+                                cpx::siteShape( "c" ) };
+    
+    fnd::memoryAccount account;
+    dimer::dimerizeMassExtrap dimerize( 5000.0, 7000.0, &account );
+    for ( int ndx = 0; ndx != 3; ++ndx )
+    {
+        dimerize.setRate( &shapes[ndx], &shapes[( ndx + 1 ) % 3], 1.0e8 / ( ndx + 1 ) );
+    }
+    
+    // Each pass asks for the same rates, with weights and shape pairs
+    // recurring as they do across a rule's reactions.  The first pass is
+    // uncached, the second fills the memo and the third should hit for
+    // every pair of shapes that has a rate, whatever the weights.
+    std::vector<double> rates[3];
+    int unknownPairs = 0;
+    for ( int pass = 0; pass != 3; ++pass )
+    {
+        fnd::rateMemoStats::setEnabled( 0 < pass );
+        fnd::rateMemoStats::reset();
+        unknownPairs = 0;
+        
+        for ( int ndx = 0; ndx != 600; ++ndx )
+        {
+            double leftWeight = 1000.0 + ( ndx % 37 ) * 241.3;
+            double rightWeight = 2000.0 + ( ndx % 11 ) * 97.1;
+            const cpx::siteShape* pLeft = &shapes[ndx % 3];
+            const cpx::siteShape* pRight = &shapes[( ndx / 3 ) % 3];
+            
+            double rate = -1.0;
+            if ( ! dimerize.findRate( pLeft, pRight, leftWeight, rightWeight, rate ) )
+            {
+                BOOST_CHECK( pLeft == pRight );
+                ++unknownPairs;
+            }
+            rates[pass].push_back( rate );
+        }
+        
+        if ( 0 == pass )
+        {
+            BOOST_CHECK( 0 == fnd::rateMemoStats::getHits() + fnd::rateMemoStats::getMisses() );
+        }
+        else
+        {
+            BOOST_CHECK( 600 == fnd::rateMemoStats::getHits() + fnd::rateMemoStats::getMisses() );
+        }
+    }
+    // Unknown pairs of site shapes aren't remembered.
+    BOOST_CHECK( 0 < unknownPairs );
+    BOOST_CHECK( ( unsigned long ) unknownPairs == fnd::rateMemoStats::getMisses() );
+    BOOST_CHECK( ( unsigned long ) ( 600 - unknownPairs ) == fnd::rateMemoStats::getHits() );
+    fnd::rateMemoStats::setEnabled( true );
+    
+    // One invariant is remembered for each ordered pair of shapes that
+    // has a rate: three pairs, each asked for in both orders.
+    const std::size_t invariantBytes
+        = fnd::memoryAccount::treeNodeBytes( sizeof( std::pair<const std::pair<cpx::siteParam, cpx::siteParam>, double> ) );
+    BOOST_CHECK( account.getUsage( fnd::memoryAccount::RATE_MEMOS ) == 6 * invariantBytes );
+    
+    // Cached rates are the same doubles, bit for bit.
+    for ( int pass = 1; pass != 3; ++pass )
+    {
+        BOOST_REQUIRE( rates[pass].size() == rates[0].size() );
+        BOOST_CHECK( 0 == std::memcmp( &rates[pass][0],
+                                       &rates[0][0],
+                                       rates[0].size() * sizeof( double ) ) );
+    }
+    
+    // Writing a rate over an old one forgets the memoized invariants.
+    dimerize.setRate( &shapes[0], &shapes[1], 1.0 );
+    BOOST_CHECK( account.getUsage( fnd::memoryAccount::RATE_MEMOS ) == 0 );
+    double rate = 0.0;
+    BOOST_CHECK( dimerize.findRate( &shapes[0], &shapes[1], 1000.0, 2000.0, rate ) );
+    BOOST_CHECK( rate == fnd::bindingRate( fnd::bindingInvariant( 1.0, 5000.0, 7000.0 ),
+                                           1000.0,
+                                           2000.0 ) );
+}
+
+class testTimeline
+{
+public:
+    // (time, label) for each event that happened.
+    std::vector<std::pair<double, int> > happenings;
+    fnd::eventQueue<testTimeline> events;
+};
+
+class testTimelineEvent :
+    public fnd::event<testTimeline>
+{
+    int label;
+    fnd::eventResult result;
+    
+public:
+    static int liveCount;
+    
+    testTimelineEvent( int theLabel,
+                       fnd::eventResult theResult = fnd::go ) :
+        label( theLabel ),
+        result( theResult )
+    {
+        ++liveCount;
+    }
+    
+    ~testTimelineEvent( void )
+    {
+        --liveCount;
+    }
+    
+    fnd::eventResult
+    happen( testTimeline& rTimeline )
+        throw( std::exception )
+    {
+        rTimeline.happenings.push_back( std::make_pair( rTimeline.events.getNow(),
+                                                        label ) );
+        
+        // Event 7 schedules a one-shot event for a little later.
+        if ( 7 == label )
+        {
+            rTimeline.events.schedule( rTimeline.events.getNow() + 0.25,
+                                       new testTimelineEvent( 8 ) );
+        }
+        
+        // Event 13 fails.
+        if ( 13 == label ) throw utl::xcpt( "Event 13 failed." );
+        return result;
+    }
+};
+
+int testTimelineEvent::liveCount = 0;
+
+void test_event_queue()
+{
+    {
+        testTimeline timeline;
+        fnd::eventQueue<testTimeline>& rEvents = timeline.events;
+        
+        BOOST_CHECK( rEvents.empty() );
+        BOOST_CHECK( rEvents.getNextTime() == std::numeric_limits<double>::infinity() );
+        
+        // Scheduled out of order, with ties at 2.0.
+        rEvents.schedule( 3.0, new testTimelineEvent( 3 ) );
+        rEvents.schedule( 2.0, new testTimelineEvent( 21 ) );
+        rEvents.schedulePeriodic( 0.5, 1.0, new testTimelineEvent( 5 ) );
+        rEvents.schedule( 2.0, new testTimelineEvent( 22 ) );
+        rEvents.schedule( 1.0, new testTimelineEvent( 7 ) );
+        rEvents.schedule( 2.75, new testTimelineEvent( 9, fnd::stop ) );
+        BOOST_CHECK( rEvents.size() == 6 );
+        BOOST_CHECK( rEvents.getNextTime() == 0.5 );
+        
+        // The stop at 2.75 leaves 3.0 and the periodic event queued.
+        BOOST_CHECK( fnd::stop == rEvents.fireThrough( 10.0, timeline ) );
+        BOOST_CHECK( rEvents.getNow() == 2.75 );
+        BOOST_CHECK( rEvents.getNextTime() == 3.0 );
+        
+        BOOST_CHECK( fnd::go == rEvents.fireThrough( 3.5, timeline ) );
+        
+        double times[] = { 0.5, 1.0, 1.25, 1.5, 2.0, 2.0, 2.5, 2.75, 3.0, 3.5 };
+        int labels[] = { 5, 7, 8, 5, 21, 22, 5, 9, 3, 5 };
+        BOOST_REQUIRE( timeline.happenings.size() == 10 );
+        for ( int ndx = 0; ndx != 10; ++ndx )
+        {
+            BOOST_CHECK( timeline.happenings[ndx].first == times[ndx] );
+            BOOST_CHECK( timeline.happenings[ndx].second == labels[ndx] );
+        }
+        
+        // Only the periodic event is left, and one-shots are gone.
+        BOOST_CHECK( rEvents.size() == 1 );
+        BOOST_CHECK( testTimelineEvent::liveCount == 1 );
+        BOOST_CHECK( rEvents.getNextTime() == 4.5 );
+        
+        bool threw = false;
+        try
+        {
+            rEvents.schedule( 1.0, new testTimelineEvent( 0 ) );
+        }
+        catch ( const utl::xcpt& rXcpt )
+        {
+            threw = true;
+        }
+        BOOST_CHECK( threw );
+        
+        // A periodic event's times are multiples of its period, not sums.
+        timeline.happenings.clear();
+        rEvents.fireThrough( 1000.5, timeline );
+        BOOST_CHECK( timeline.happenings.size() == 997 );
+        BOOST_CHECK( timeline.happenings.back().first == 1000.5 );
+    }
+    BOOST_CHECK( testTimelineEvent::liveCount == 0 );
+    
+    // Events that throw are deleted or rescheduled all the same.
+    {
+        testTimeline timeline;
+        fnd::eventQueue<testTimeline>& rEvents = timeline.events;
+        
+        rEvents.schedule( 1.0, new testTimelineEvent( 13 ) );
+        rEvents.schedulePeriodic( 2.0, 1.0, new testTimelineEvent( 13 ) );
+        
+        BOOST_CHECK_THROW( rEvents.fireNext( timeline ), utl::xcpt );
+        BOOST_CHECK( rEvents.size() == 1 );
+        BOOST_CHECK( testTimelineEvent::liveCount == 1 );
+        
+        BOOST_CHECK_THROW( rEvents.fireNext( timeline ), utl::xcpt );
+        BOOST_CHECK( rEvents.size() == 1 );
+        BOOST_CHECK( testTimelineEvent::liveCount == 1 );
+        BOOST_CHECK( rEvents.getNextTime() == 3.0 );
+    }
+    BOOST_CHECK( testTimelineEvent::liveCount == 0 );
+}
+
+// A -> B, then A + B -> C, with C -> A + B made by no generator.
+void
+buildSensitivityNetwork( fnd::forwardSensitivity& rSensitivity,
+                         std::vector<testPopSpecies>& rSpecies,
+                         const fnd::coreRxnGen* pFirstGen,
+                         const fnd::coreRxnGen* pSecondGen,
+                         const double rates[2] )
+{
+    testPopReaction conversion( rates[0] );
+    conversion.addReactant( &rSpecies[0], 1 );
+    conversion.addProduct( &rSpecies[1], 1 );
+    conversion.setOriginatingRxnGen( pFirstGen );
+    
+    testPopReaction binding( rates[1] );
+    binding.addReactant( &rSpecies[0], 1 );
+    binding.addReactant( &rSpecies[1], 1 );
+    binding.addProduct( &rSpecies[2], 1 );
+    binding.setOriginatingRxnGen( pSecondGen );
+    
+    testPopReaction release( 0.1 );
+    release.addReactant( &rSpecies[2], 1 );
+    release.addProduct( &rSpecies[0], 1 );
+    release.addProduct( &rSpecies[1], 1 );
+    
+    for ( int ndx = 0; ndx != 3; ++ndx )
+    {
+        rSensitivity.addSpecies( rSpecies[ndx].getName() );
+    }
+    fnd::addBasicReaction( rSensitivity, conversion, testPopSpeciesIndex( rSpecies ) );
+    fnd::addBasicReaction( rSensitivity, binding, testPopSpeciesIndex( rSpecies ) );
+    fnd::addBasicReaction( rSensitivity, release, testPopSpeciesIndex( rSpecies ) );
+    
+    rSensitivity.setConcentration( 0, 1.5 );
+    rSensitivity.setConcentration( 1, 0.2 );
+    rSensitivity.restart();
+}
+
+void test_forward_sensitivity()
+{
+    // A -> B alone: A = A0 exp( -k t ), so dA/dlog( k ) = -k t A.
+    {
+        const double rate = 0.7;
+        const double duration = 2.0;
+        
+        fnd::forwardSensitivity sensitivity;
+        sensitivity.addSpecies( "A", 1.5 );
+        sensitivity.addSpecies( "B" );
+        int parameter = sensitivity.addParameter( "conversion" );
+        
+        fnd::forwardSensitivity::speciesCounts reactants;
+        reactants.push_back( std::make_pair( 0, 1 ) );
+        fnd::forwardSensitivity::speciesCounts deltas;
+        deltas.push_back( std::make_pair( 0, -1 ) );
+        deltas.push_back( std::make_pair( 1, 1 ) );
+        sensitivity.addReaction( rate, reactants, deltas, parameter );
+        
+        sensitivity.run( duration, 0.001 );
+        
+        double expected = 1.5 * std::exp( -rate * duration );
+        BOOST_CHECK( std::fabs( sensitivity.getTime() - duration ) < 1e-12 );
+        BOOST_CHECK( std::fabs( sensitivity.getConcentration( 0 ) - expected ) < 1e-10 );
+        BOOST_CHECK( std::fabs( sensitivity.getSensitivity( 0, 0 )
+                                + rate * duration * expected ) < 1e-10 );
+        BOOST_CHECK( std::fabs( sensitivity.getSensitivity( 1, 0 )
+                                - rate * duration * expected ) < 1e-10 );
+        
+        // Left to choose its own steps, the solver takes few of them and
+        // stays within its tolerances.
+        sensitivity.restart();
+        sensitivity.setTolerances( 1e-10, 1e-14 );
+        sensitivity.run( duration, duration );
+        BOOST_CHECK( std::fabs( sensitivity.getTime() - duration ) < 1e-12 );
+        BOOST_CHECK( sensitivity.getStepCount() < 100 );
+        BOOST_CHECK( std::fabs( sensitivity.getConcentration( 0 ) - expected ) < 1e-8 );
+        BOOST_CHECK( std::fabs( sensitivity.getSensitivity( 0, 0 )
+                                + rate * duration * expected ) < 1e-8 );
+    }
+    
+    // 2A -> 3A: dA/dt = A^2, which blows up at t = 1 / A0.  The steps
+    // shrink as it nears, until every trial state overflows.
+    {
+        fnd::forwardSensitivity sensitivity;
+        sensitivity.addSpecies( "A", 1.0 );
+        int parameter = sensitivity.addParameter( "autocatalysis" );
+        
+        fnd::forwardSensitivity::speciesCounts reactants;
+        reactants.push_back( std::make_pair( 0, 2 ) );
+        fnd::forwardSensitivity::speciesCounts deltas;
+        deltas.push_back( std::make_pair( 0, 1 ) );
+        sensitivity.addReaction( 1.0, reactants, deltas, parameter );
+        
+        bool threw = false;
+        try
+        {
+            sensitivity.run( 2.0, 0.1 );
+        }
+        catch ( const fnd::nonFiniteStateXcpt& rXcpt )
+        {
+            threw = true;
+        }
+        BOOST_CHECK( threw );
+        BOOST_CHECK( sensitivity.getTime() < 1.0 );
+        BOOST_CHECK( 0.99 < sensitivity.getTime() );
+        BOOST_CHECK( 1e100 < sensitivity.getConcentration( 0 ) );
+        BOOST_CHECK( 0 < sensitivity.getRejectedStepCount() );
+        
+        // With a rate so fast that the first derivative overflows, no step
+        // gives a finite state.
+        fnd::forwardSensitivity overflowing;
+        overflowing.addSpecies( "A", 1e10 );
+        overflowing.addReaction( 1e300, reactants, deltas, -1 );
+        
+        threw = false;
+        try
+        {
+            overflowing.run( 1.0, 0.1 );
+        }
+        catch ( const fnd::nonFiniteStateXcpt& rXcpt )
+        {
+            threw = true;
+        }
+        BOOST_CHECK( threw );
+        BOOST_CHECK( overflowing.getConcentration( 0 ) == 1e10 );
+        
+        // A NaN initial concentration is caught before any step.
+        overflowing.setConcentration( 0, std::numeric_limits<double>::quiet_NaN() );
+        overflowing.restart();
+        
+        threw = false;
+        try
+        {
+            overflowing.run( 1.0, 0.1 );
+        }
+        catch ( const fnd::nonFiniteStateXcpt& rXcpt )
+        {
+            threw = true;
+        }
+        BOOST_CHECK( threw );
+        BOOST_CHECK( overflowing.getStepCount() == 0 );
+    }
+    
+    // The whole network, against central differences in the log of each
+    // rule's rate.
+    std::vector<testPopSpecies> species( 3 );
+    species[0].name = "A";
+    species[1].name = "B";
+    species[2].name = "C";
+    
+    fnd::coreRxnGen firstGen;
+    fnd::coreRxnGen secondGen;
+    fnd::expansionProfiler profiler;
+    profiler.nameRxnGen( &secondGen,
+                         "dimerization-gen",
+                         "A-B" );
+    
+    // Names are kept by each profiler apart, as for each moleculizer.
+    fnd::expansionProfiler otherProfiler;
+    BOOST_CHECK( otherProfiler.getRxnGenLabel( &secondGen ).empty() );
+    {
+        moleculizer firstMoleculizer;
+        moleculizer secondMoleculizer;
+        firstMoleculizer.getExpansionProfiler().setEnabled( true );
+        BOOST_CHECK( ! secondMoleculizer.getExpansionProfiler().isEnabled() );
+    }
+    
+    const double rates[2] = { 0.7, 2.0 };
+    const double duration = 3.0;
+    const double timeStep = 0.001;
+    const double logStep = 1e-4;
+    
+    fnd::forwardSensitivity sensitivity( &profiler );
+    buildSensitivityNetwork( sensitivity, species, &firstGen, &secondGen, rates );
+    BOOST_CHECK( sensitivity.getParameterCount() == 2 );
+    BOOST_CHECK( sensitivity.getParameterLabel( 0 ) == "rxn-gen 0" );
+    BOOST_CHECK( sensitivity.getParameterLabel( 1 ) == "dimerization-gen A-B" );
+    sensitivity.run( duration, timeStep );
+    
+    for ( int parameter = 0; parameter != 2; ++parameter )
+    {
+        double upRates[2] = { rates[0], rates[1] };
+        double downRates[2] = { rates[0], rates[1] };
+        upRates[parameter] *= std::exp( logStep );
+        downRates[parameter] *= std::exp( -logStep );
+        
+        fnd::forwardSensitivity up;
+        fnd::forwardSensitivity down;
+        buildSensitivityNetwork( up, species, &firstGen, &secondGen, upRates );
+        buildSensitivityNetwork( down, species, &firstGen, &secondGen, downRates );
+        up.run( duration, timeStep );
+        down.run( duration, timeStep );
+        
+        for ( int ndx = 0; ndx != 3; ++ndx )
+        {
+            double difference = ( up.getConcentration( ndx ) - down.getConcentration( ndx ) )
+                / ( 2.0 * logStep );
+            BOOST_CHECK( std::fabs( sensitivity.getSensitivity( ndx, parameter ) - difference ) < 1e-6 );
+        }
+    }
+    
+    // Mass is conserved, so the sensitivities of the total are zero.
+    for ( int parameter = 0; parameter != 2; ++parameter )
+    {
+        double total = sensitivity.getSensitivity( 0, parameter )
+            + sensitivity.getSensitivity( 1, parameter )
+            + 2.0 * sensitivity.getSensitivity( 2, parameter );
+        BOOST_CHECK( std::fabs( total ) < 1e-10 );
+    }
+    
+    // Starting over gives the same answer.
+    double concentration = sensitivity.getConcentration( 2 );
+    double firstSensitivity = sensitivity.getSensitivity( 2, 0 );
+    sensitivity.restart();
+    BOOST_CHECK( sensitivity.getTime() == 0.0 );
+    BOOST_CHECK( sensitivity.getSensitivity( 2, 0 ) == 0.0 );
+    sensitivity.run( duration, timeStep );
+    BOOST_CHECK( sensitivity.getConcentration( 2 ) == concentration );
+    BOOST_CHECK( sensitivity.getSensitivity( 2, 0 ) == firstSensitivity );
+    
+    bool threw = false;
+    try
+    {
+        sensitivity.run( 1.0, 0.0 );
+    }
+    catch ( const fnd::badSolverStepXcpt& rXcpt )
+    {
+        threw = true;
+    }
+    BOOST_CHECK( threw );
+}
+
+void
+addReductionReaction( fnd::networkReduction& rReduction,
+                      double rate,
+                      int firstReactant,
+                      int secondReactant,
+                      int firstProduct,
+                      int secondProduct )
+{
+    fnd::networkReduction::speciesCounts reactants;
+    if ( 0 <= firstReactant ) reactants.push_back( std::make_pair( firstReactant, 1 ) );
+    if ( 0 <= secondReactant ) reactants.push_back( std::make_pair( secondReactant, 1 ) );
+    
+    fnd::networkReduction::speciesCounts products;
+    if ( 0 <= firstProduct ) products.push_back( std::make_pair( firstProduct, 1 ) );
+    if ( 0 <= secondProduct ) products.push_back( std::make_pair( secondProduct, 1 ) );
+    
+    rReduction.addReaction( rate, reactants, products );
+}
+
+// The rate of the reduced reaction between the reduced species of the
+// given original species, or -1 if there isn't one.
+double
+findReducedRate( const fnd::networkReduction& rReduction,
+                 int firstReactant,
+                 int secondReactant,
+                 int firstProduct,
+                 int secondProduct )
+{
+    std::map<int, int> reactants;
+    if ( 0 <= firstReactant ) ++reactants[rReduction.getReducedSpecies( firstReactant )];
+    if ( 0 <= secondReactant ) ++reactants[rReduction.getReducedSpecies( secondReactant )];
+    
+    std::map<int, int> products;
+    if ( 0 <= firstProduct ) ++products[rReduction.getReducedSpecies( firstProduct )];
+    if ( 0 <= secondProduct ) ++products[rReduction.getReducedSpecies( secondProduct )];
+    
+    for ( int ndx = 0; ndx != rReduction.getReducedReactionCount(); ++ndx )
+    {
+        const fnd::networkReduction::reaction& rReaction = rReduction.getReducedReaction( ndx );
+        fnd::networkReduction::speciesCounts reactantCounts( reactants.begin(), reactants.end() );
+        fnd::networkReduction::speciesCounts productCounts( products.begin(), products.end() );
+        
+        if ( rReaction.reactants == reactantCounts
+             && rReaction.products == productCounts ) return rReaction.rate;
+    }
+    return -1.0;
+}
+
+// Integrates a network, or its reduction, from the same initial
+// concentrations of the original species.
+void
+integrateReduction( const fnd::networkReduction& rReduction,
+                    bool reduced,
+                    const std::vector<double>& rInitial,
+                    std::vector<double>& rFinal )
+{
+    fnd::forwardSensitivity solver;
+    
+    int speciesCount = reduced ? rReduction.getReducedSpeciesCount() : rReduction.getSpeciesCount();
+    std::vector<double> concentrations( speciesCount, 0.0 );
+    for ( int ndx = 0; ndx != rReduction.getSpeciesCount(); ++ndx )
+    {
+        int target = reduced ? rReduction.getReducedSpecies( ndx ) : ndx;
+        if ( 0 <= target ) concentrations[target] += rInitial[ndx];
+    }
+    for ( int ndx = 0; ndx != speciesCount; ++ndx ) solver.addSpecies( "", concentrations[ndx] );
+    
+    int reactionCount = reduced ? rReduction.getReducedReactionCount() : rReduction.getReactionCount();
+    for ( int ndx = 0; ndx != reactionCount; ++ndx )
+    {
+        const fnd::networkReduction::reaction& rReaction
+            = reduced ? rReduction.getReducedReaction( ndx ) : rReduction.getReaction( ndx );
+        
+        std::map<int, int> deltaMap;
+        for ( size_t entry = 0; entry != rReaction.products.size(); ++entry )
+        {
+            deltaMap[rReaction.products[entry].first] += rReaction.products[entry].second;
+        }
+        for ( size_t entry = 0; entry != rReaction.reactants.size(); ++entry )
+        {
+            deltaMap[rReaction.reactants[entry].first] -= rReaction.reactants[entry].second;
+        }
+        fnd::forwardSensitivity::speciesCounts deltas( deltaMap.begin(), deltaMap.end() );
+        
+        solver.addReaction( rReaction.rate, rReaction.reactants, deltas, -1 );
+    }
+    
+    solver.run( 2.0, 0.001 );
+    
+    rFinal.clear();
+    for ( int ndx = 0; ndx != speciesCount; ++ndx ) rFinal.push_back( solver.getConcentration( ndx ) );
+}
+
+void test_network_reduction()
+{
+    enum
+    {
+        A1, A2, B, D1, D2, E, C, P, F1, F2, G, H, J1, J2, K1, K2, L,
+        speciesCount
+    };
+    
+    fnd::networkReduction reduction;
+    for ( int ndx = 0; ndx != speciesCount; ++ndx )
+    {
+        std::ostringstream nameStream;
+        nameStream << "s" << ndx;
+        reduction.addSpecies( nameStream.str() );
+    }
+    
+    // A1 and A2 lump; D1 and D2 react at different rates, so don't.
+    addReductionReaction( reduction, 2.0, A1, -1, B, -1 );
+    addReductionReaction( reduction, 2.0, A2, -1, B, -1 );
+    addReductionReaction( reduction, 1.0, D1, -1, B, -1 );
+    addReductionReaction( reduction, 3.0, D2, -1, B, -1 );
+    
+    // C is a fast intermediate.
+    addReductionReaction( reduction, 5.0, B, E, C, -1 );
+    addReductionReaction( reduction, 1.0, C, -1, B, E );
+    addReductionReaction( reduction, 1000.0, C, -1, P, E );
+    
+    // F1 and F2 both bind G.
+    addReductionReaction( reduction, 4.0, F1, G, H, -1 );
+    addReductionReaction( reduction, 4.0, F2, G, H, -1 );
+    
+    // J1 and J2 look alike, and so do K1 and K2, but J1 only binds K1 and
+    // J2 only K2, so the total of the Js doesn't follow from the totals.
+    addReductionReaction( reduction, 6.0, J1, K1, L, -1 );
+    addReductionReaction( reduction, 6.0, J2, K2, L, -1 );
+    
+    reduction.reduce( true );
+    
+    BOOST_CHECK( reduction.getReducedSpecies( A1 ) == reduction.getReducedSpecies( A2 ) );
+    BOOST_CHECK( reduction.getReducedSpecies( F1 ) == reduction.getReducedSpecies( F2 ) );
+    BOOST_CHECK( reduction.getReducedSpecies( D1 ) != reduction.getReducedSpecies( D2 ) );
+    
+    std::set<int> unlumped;
+    unlumped.insert( reduction.getReducedSpecies( J1 ) );
+    unlumped.insert( reduction.getReducedSpecies( J2 ) );
+    unlumped.insert( reduction.getReducedSpecies( K1 ) );
+    unlumped.insert( reduction.getReducedSpecies( K2 ) );
+    BOOST_CHECK( unlumped.size() == 4 );
+    
+    BOOST_CHECK( reduction.getReducedSpeciesCount() == speciesCount - 2 );
+    BOOST_CHECK( reduction.getMembers( reduction.getReducedSpecies( A2 ) ).size() == 2 );
+    BOOST_CHECK( reduction.getReducedName( reduction.getReducedSpecies( A1 ) ) == "s0|s1" );
+    
+    BOOST_CHECK( findReducedRate( reduction, A1, -1, B, -1 ) == 2.0 );
+    BOOST_CHECK( findReducedRate( reduction, F1, G, H, -1 ) == 4.0 );
+    BOOST_CHECK( reduction.getReducedReactionCount() == reduction.getReactionCount() - 2 );
+    
+    // The lumped network gives the totals of the original.
+    std::vector<double> initial( speciesCount );
+    for ( int ndx = 0; ndx != speciesCount; ++ndx ) initial[ndx] = 0.1 * ( ndx % 7 + 1 );
+    
+    std::vector<double> original;
+    std::vector<double> lumped;
+    integrateReduction( reduction, false, initial, original );
+    integrateReduction( reduction, true, initial, lumped );
+    
+    std::vector<double> totals( reduction.getReducedSpeciesCount(), 0.0 );
+    for ( int ndx = 0; ndx != speciesCount; ++ndx )
+    {
+        totals[reduction.getReducedSpecies( ndx )] += original[ndx];
+    }
+    for ( int ndx = 0; ndx != reduction.getReducedSpeciesCount(); ++ndx )
+    {
+        BOOST_CHECK( std::fabs( totals[ndx] - lumped[ndx] ) < 1e-10 );
+    }
+    
+    // With the quasi-steady-state approximation, C goes, and B + E makes P
+    // directly.  B + E -> C -> B + E has no effect, and goes too.
+    reduction.reduce( true, 0.01 );
+    BOOST_CHECK( reduction.getReducedSpecies( C ) == -1 );
+    BOOST_CHECK( reduction.getReducedSpeciesCount() == speciesCount - 3 );
+    BOOST_CHECK( std::fabs( findReducedRate( reduction, B, E, P, E ) - 5.0 * 1000.0 / 1001.0 ) < 1e-12 );
+    BOOST_CHECK( findReducedRate( reduction, B, E, B, E ) == -1.0 );
+    
+    // C lives too long for a tighter tolerance.
+    reduction.reduce( true, 1.0e-4 );
+    BOOST_CHECK( reduction.getReducedSpecies( C ) != -1 );
+    
+    // Without lumping, only C goes.
+    reduction.reduce( false, 0.01 );
+    BOOST_CHECK( reduction.getReducedSpeciesCount() == speciesCount - 1 );
+    BOOST_CHECK( reduction.getReducedSpecies( A1 ) != reduction.getReducedSpecies( A2 ) );
+}
+
+// A species whose "rules" are a table of first-order conversions to
+// other test species, made into reactions when it is notified, as the
+// reaction generators would.
+class testAgentSpecies :
+    public mzrSpecies
+{
+public:
+    moleculizer& rMolzer;
+    std::vector<std::pair<testAgentSpecies*, double> > conversions;
+    std::vector<mzrReaction*>& rMadeReactions;
+    
+    testAgentSpecies( moleculizer& rMoleculizer,
+                      std::vector<mzrReaction*>& rReactions ) :
+        rMolzer( rMoleculizer ),
+        rMadeReactions( rReactions )
+    {}
+    
+    double
+    getWeight( void ) const
+    {
+        return 1.0;
+    }
+    
+    std::size_t
+    getObjectBytes( void ) const
+    {
+        return sizeof( testAgentSpecies )
+            + conversions.capacity() * sizeof( conversions[0] );
+    }
+    
+    void
+    notify( int depth )
+    {
+        std::vector<fnd::sensitivityList<mzrReaction>*> noGlobals;
+        
+        for ( size_t ndx = 0; ndx != conversions.size(); ++ndx )
+        {
+            mzrReaction* pReaction = new mzrReaction( noGlobals.begin(),
+                                                      noGlobals.end(),
+                                                      conversions[ndx].second );
+            pReaction->addReactant( this, 1 );
+            pReaction->addProduct( conversions[ndx].first, 1 );
+            rMadeReactions.push_back( pReaction );
+            
+            rMolzer.recordReaction( pReaction );
+            rMolzer.recordSpecies( conversions[ndx].first );
+            
+            if ( 0 < depth ) conversions[ndx].first->ensureNotified( depth - 1 );
+        }
+    }
+};
+
+void test_agent_simulator()
+{
+    agentSimulator simulator( 1.0e-15, 17 );
+    moleculizer& rSimulatorMolzer = simulator.getMoleculizer();
+    std::vector<mzrReaction*> madeReactions;
+    
+    // A <-> B, with A -> B at 1/s and B -> A at 3/s.
+    testAgentSpecies speciesA( rSimulatorMolzer, madeReactions );
+    testAgentSpecies speciesB( rSimulatorMolzer, madeReactions );
+    speciesA.conversions.push_back( std::make_pair( &speciesB, 1.0 ) );
+    speciesB.conversions.push_back( std::make_pair( &speciesA, 3.0 ) );
+    
+    const int agentCount = 400;
+    simulator.addAgents( &speciesA, agentCount );
+    
+    // B's reactions aren't made until there is some B.
+    BOOST_CHECK( simulator.getReactionCount() == 1 );
+    BOOST_CHECK( ! speciesB.hasNotified() );
+    
+    simulator.run( 5.0 );
+    BOOST_CHECK( simulator.getReactionCount() == 2 );
+    BOOST_CHECK( simulator.getSpeciesCount() == 2 );
+    BOOST_CHECK( simulator.getAgentCount() == agentCount );
+    
+    // Nothing went into the catalog.
+    BOOST_CHECK( rSimulatorMolzer.getTotalNumberSpecies() == 0 );
+    BOOST_CHECK( rSimulatorMolzer.getTotalNumberReactions() == 0 );
+    BOOST_CHECK( rSimulatorMolzer.getReactionCapture() == 0 );
+    
+    // At equilibrium, the population of B is binomial, with mean N/4
+    // and variance 3N/16; samples a second apart, four relaxation times,
+    // are nearly independent.
+    const int sampleCount = 400;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    for ( int sample = 0; sample != sampleCount; ++sample )
+    {
+        simulator.run( 1.0 );
+        
+        double population = simulator.getPopulation( &speciesB );
+        sum += population;
+        sumOfSquares += population * population;
+        
+        BOOST_CHECK( simulator.getPopulation( &speciesA ) + population == agentCount );
+    }
+    
+    double mean = sum / sampleCount;
+    double variance = sumOfSquares / sampleCount - mean * mean;
+    double expectedMean = agentCount / 4.0;
+    double expectedVariance = 3.0 * agentCount / 16.0;
+    
+    // Five standard errors.
+    BOOST_CHECK( std::fabs( mean - expectedMean ) < 5.0 * std::sqrt( expectedVariance / sampleCount ) );
+    BOOST_CHECK( 0.7 * expectedVariance < variance && variance < 1.3 * expectedVariance );
+    
+    int bAgents = 0;
+    for ( int agent = 0; agent != simulator.getAgentCount(); ++agent )
+    {
+        if ( simulator.getAgentSpecies( agent ) == &speciesB ) ++bAgents;
+    }
+    BOOST_CHECK( bAgents == simulator.getPopulation( &speciesB ) );
+    
+    // The same model still expands in full in a moleculizer of its own,
+    // after the simulation.
+    moleculizer networkMolzer;
+    testAgentSpecies networkA( networkMolzer, madeReactions );
+    testAgentSpecies networkB( networkMolzer, madeReactions );
+    networkA.conversions.push_back( std::make_pair( &networkB, 1.0 ) );
+    networkB.conversions.push_back( std::make_pair( &networkA, 3.0 ) );
+    
+    networkMolzer.recordSpecies( &networkA );
+    std::vector<const mzrReaction*> networkReactions;
+    BOOST_CHECK( networkMolzer.findReactionWithSubstrates( &networkA, networkReactions ) );
+    BOOST_CHECK( networkMolzer.findReactionWithSubstrates( &networkB, networkReactions ) );
+    BOOST_CHECK( networkReactions.size() == 2 );
+    BOOST_CHECK( networkMolzer.getTotalNumberSpecies() == 2 );
+    BOOST_CHECK( networkMolzer.getTotalNumberReactions() == 2 );
+    
+    // Which left the simulation alone.
+    simulator.run( 1.0 );
+    BOOST_CHECK( simulator.getReactionCount() == 2 );
+    BOOST_CHECK( simulator.getPopulation( &speciesA ) + simulator.getPopulation( &speciesB ) == agentCount );
+    BOOST_CHECK( rSimulatorMolzer.getTotalNumberReactions() == 0 );
+    
+    for ( size_t ndx = 0; ndx != madeReactions.size(); ++ndx ) delete madeReactions[ndx];
+}
+
+void test_memory_budget()
+{
+    typedef fnd::memoryAccount account;
+    
+    // A sensitive item is added, and so charged for by the list's owner,
+    // only once.
+    int sensitive = 0;
+    fnd::sensitivityList<int> theList;
+    BOOST_CHECK( theList.addSensitive( &sensitive ) );
+    BOOST_CHECK( ! theList.addSensitive( &sensitive ) );
+    BOOST_CHECK( std::string( account::getSubsystemName( account::SENSITIVITY_LISTS ) ) == "sensitivity-lists" );
+    BOOST_CHECK( std::string( account::getSubsystemName( account::NETWORK_SNAPSHOTS ) ) == "network-snapshots" );
+    
+    // Rate memos charge what they remember and refund what they forget.
+    {
+        account memoAccount;
+        fnd::rateMemoStats::setEnabled( true );
+        fnd::rateMemo<int> theMemo( &memoAccount );
+        theMemo.remember( 1, 2.0 );
+        std::size_t memoBytes = memoAccount.getUsage( account::RATE_MEMOS );
+        BOOST_CHECK( 0 < memoBytes );
+        theMemo.remember( 1, 3.0 );
+        BOOST_CHECK( memoAccount.getUsage( account::RATE_MEMOS ) == memoBytes );
+        theMemo.remember( 2, 3.0 );
+        BOOST_CHECK( memoAccount.getUsage( account::RATE_MEMOS ) == 2 * memoBytes );
+        theMemo.forget();
+        BOOST_CHECK( memoAccount.getTotalUsage() == 0 );
+    }
+    
+    std::vector<mzrReaction*> madeReactions;
+    std::vector<testAgentSpecies*> chain;
+    
+    // Another moleculizer, whose account the first doesn't touch.
+    moleculizer otherMoleculizer;
+    const account& rOtherAccount = otherMoleculizer.getMemoryAccount();
+    testAgentSpecies otherSpecies( otherMoleculizer, madeReactions );
+    otherMoleculizer.recordSpecies( &otherSpecies );
+    std::size_t otherBytes = rOtherAccount.getTotalUsage();
+    BOOST_CHECK( 0 < otherBytes );
+    
+    {
+        moleculizer theMoleculizer;
+        account& rAccount = theMoleculizer.getMemoryAccount();
+        BOOST_CHECK( rAccount.getTotalUsage() == 0 );
+        
+        // A chain of species, each converting to the next.
+        const int chainLength = 5;
+        for ( int ndx = 0; ndx != chainLength; ++ndx )
+        {
+            chain.push_back( new testAgentSpecies( theMoleculizer, madeReactions ) );
+            if ( ndx ) chain[ndx - 1]->conversions.push_back( std::make_pair( chain[ndx], 1.0 ) );
+        }
+        
+        // The species is charged at its own size.
+        theMoleculizer.recordSpecies( chain[0] );
+        std::size_t catalogBytes = rAccount.getUsage( account::SPECIES_CATALOG );
+        BOOST_CHECK( chain[0]->getObjectBytes() < catalogBytes );
+        BOOST_CHECK( sizeof( mzrSpecies ) < chain[0]->getObjectBytes() );
+        BOOST_CHECK( 0 < rAccount.getUsage( account::NETWORK_SNAPSHOTS ) );
+        BOOST_CHECK( rAccount.getUsage( account::REACTION_MAPS ) == 0 );
+        
+        std::vector<const mzrReaction*> reactions;
+        std::size_t snapshotBytes = rAccount.getUsage( account::NETWORK_SNAPSHOTS );
+        theMoleculizer.findReactionWithSubstrates( chain[0], reactions );
+        BOOST_CHECK( reactions.size() == 1 );
+        BOOST_CHECK( 0 < rAccount.getUsage( account::REACTION_MAPS ) );
+        BOOST_CHECK( catalogBytes < rAccount.getUsage( account::SPECIES_CATALOG ) );
+        BOOST_CHECK( snapshotBytes < rAccount.getUsage( account::NETWORK_SNAPSHOTS ) );
+        BOOST_CHECK( rOtherAccount.getTotalUsage() == otherBytes );
+        
+        std::size_t total = rAccount.getTotalUsage();
+        std::size_t sum = 0;
+        for ( int subsystemNdx = 0; subsystemNdx != account::SUBSYSTEM_COUNT; ++subsystemNdx )
+        {
+            sum += rAccount.getUsage( static_cast<account::subsystem>( subsystemNdx ) );
+        }
+        BOOST_CHECK( sum == total );
+        
+        // Once the budget is reached, unexpanded species are refused
+        // without any change to the network, but what is already there
+        // can still be looked up.  The other moleculizer has no budget.
+        rAccount.setBudget( total );
+        BOOST_CHECK( rAccount.isOverBudget() );
+        BOOST_CHECK( ! rOtherAccount.isOverBudget() );
+        
+        reactions.clear();
+        BOOST_CHECK_THROW( theMoleculizer.findReactionWithSubstrates( chain[1], reactions ),
+                           fnd::memoryBudgetXcpt );
+        BOOST_CHECK_THROW( theMoleculizer.incrementNetworkBySpeciesTag( chain[1]->getTag() ),
+                           fnd::memoryBudgetXcpt );
+        BOOST_CHECK( ! chain[1]->hasNotified() );
+        BOOST_CHECK( theMoleculizer.getTotalNumberSpecies() == 2 );
+        BOOST_CHECK( theMoleculizer.getTotalNumberReactions() == 1 );
+        BOOST_CHECK( rAccount.getTotalUsage() == total );
+        
+        BOOST_CHECK( theMoleculizer.findReactionWithSubstrates( chain[0], reactions ) );
+        
+        // Raising the budget lets expansion go on.
+        rAccount.setBudget( 2 * total );
+        BOOST_CHECK( ! rAccount.isOverBudget() );
+        theMoleculizer.incrementNetworkBySpeciesTag( chain[1]->getTag() );
+        BOOST_CHECK( theMoleculizer.getTotalNumberSpecies() == 3 );
+    }
+    
+    // The first moleculizer's account went with it, leaving the other's.
+    BOOST_CHECK( rOtherAccount.getTotalUsage() == otherBytes );
+    
+    for ( size_t ndx = 0; ndx != chain.size(); ++ndx ) delete chain[ndx];
+    for ( size_t ndx = 0; ndx != madeReactions.size(); ++ndx ) delete madeReactions[ndx];
+}
+
+void test_network_snapshot()
+{
+    typedef fnd::snapshotPublisher<int, int> publisherType;
+    publisherType thePublisher;
+    
+    int species[3] = { 0, 1, 2 };
+    int reactions[3] = { 0, 1, 2 };
+    
+    // Nothing is visible before the first publication.
+    publisherType::handle emptySnapshot = thePublisher.acquire();
+    BOOST_CHECK( emptySnapshot->getVersion() == 0 );
+    BOOST_CHECK( emptySnapshot->getSpeciesCount() == 0 );
+    
+    // 0 -> 1 and 0 + 1 -> 2.
+    thePublisher.recordSpecies( &species[0], "tag-0", "id-0" );
+    thePublisher.recordSpecies( &species[1], "tag-1", "id-1" );
+    thePublisher.recordReaction( &reactions[0] );
+    thePublisher.recordSingleSubstrateRxn( &species[0], &reactions[0] );
+    thePublisher.recordReaction( &reactions[1] );
+    thePublisher.recordDoubleSubstrateRxn( &species[0], &reactions[1] );
+    thePublisher.recordDoubleSubstrateRxn( &species[1], &reactions[1] );
+    BOOST_CHECK( thePublisher.hasUnpublished() );
+    BOOST_CHECK( thePublisher.acquire()->getSpeciesCount() == 0 );
+    
+    thePublisher.publish();
+    BOOST_CHECK( ! thePublisher.hasUnpublished() );
+    
+    publisherType::handle firstSnapshot = thePublisher.acquire();
+    BOOST_CHECK( firstSnapshot->getVersion() == 1 );
+    BOOST_CHECK( firstSnapshot->getSpeciesCount() == 2 );
+    BOOST_CHECK( firstSnapshot->getReactionCount() == 2 );
+    BOOST_CHECK( firstSnapshot->getSpecies( 1 ) == &species[1] );
+    BOOST_CHECK( firstSnapshot->getReaction( 0 ) == &reactions[0] );
+    BOOST_CHECK( firstSnapshot->findSpecies( "tag-0" ) == &species[0] );
+    BOOST_CHECK( firstSnapshot->findSpeciesByID( "id-1" ) == &species[1] );
+    BOOST_CHECK( firstSnapshot->getSpeciesID( 1 ) == "id-1" );
+    BOOST_CHECK( firstSnapshot->findSpecies( "tag-2" ) == 0 );
+    
+    std::vector<const int*> found;
+    BOOST_CHECK( firstSnapshot->findReactionWithSubstrates( &species[0], found ) );
+    BOOST_CHECK( found.size() == 1 && found[0] == &reactions[0] );
+    found.clear();
+    BOOST_CHECK( firstSnapshot->findReactionWithSubstrates( &species[1], &species[0], found ) );
+    BOOST_CHECK( found.size() == 1 && found[0] == &reactions[1] );
+    found.clear();
+    BOOST_CHECK( ! firstSnapshot->findReactionWithSubstrates( &species[1], found ) );
+    
+    // Publishing with nothing new makes no new version.
+    thePublisher.publish();
+    BOOST_CHECK( thePublisher.acquire()->getVersion() == 1 );
+    
+    // 2 + 2 -> 0, published while readers hold the older snapshots.
+    thePublisher.recordSpecies( &species[2], "tag-2", "id-2" );
+    thePublisher.recordReaction( &reactions[2] );
+    thePublisher.recordAutoDimerizationRxn( &species[2], &reactions[2] );
+    thePublisher.publish();
+    
+    publisherType::handle secondSnapshot = thePublisher.acquire();
+    BOOST_CHECK( secondSnapshot->getVersion() == 2 );
+    BOOST_CHECK( secondSnapshot->getSpeciesCount() == 3 );
+    BOOST_CHECK( secondSnapshot->getReactionCount() == 3 );
+    BOOST_CHECK( secondSnapshot->findSpecies( "tag-0" ) == &species[0] );
+    BOOST_CHECK( secondSnapshot->findSpecies( "tag-2" ) == &species[2] );
+    BOOST_CHECK( secondSnapshot->getSpeciesID( 2 ) == "id-2" );
+    BOOST_CHECK( secondSnapshot->findReactionWithSubstrates( &species[2], &species[2], found ) );
+    BOOST_CHECK( found.size() == 1 && found[0] == &reactions[2] );
+    
+    // The held snapshots are unchanged.
+    BOOST_CHECK( emptySnapshot->getVersion() == 0 );
+    BOOST_CHECK( emptySnapshot->getSpeciesCount() == 0 );
+    BOOST_CHECK( firstSnapshot->getVersion() == 1 );
+    BOOST_CHECK( firstSnapshot->getSpeciesCount() == 2 );
+    BOOST_CHECK( firstSnapshot->getReactionCount() == 2 );
+    BOOST_CHECK( firstSnapshot->findSpecies( "tag-2" ) == 0 );
+    BOOST_CHECK( firstSnapshot->findSpeciesByID( "id-1" ) == &species[1] );
+    found.clear();
+    BOOST_CHECK( ! firstSnapshot->findReactionWithSubstrates( &species[2], &species[2], found ) );
+    
+    // A copied handle keeps the snapshot after the original lets go.
+    publisherType::handle copiedSnapshot( firstSnapshot );
+    firstSnapshot = secondSnapshot;
+    BOOST_CHECK( firstSnapshot->getVersion() == 2 );
+    BOOST_CHECK( copiedSnapshot->getVersion() == 1 );
+    BOOST_CHECK( copiedSnapshot->getSpecies( 0 ) == &species[0] );
+}
+
+// A state file with an empty model, saved under the given digest.
+void writeSavedNetwork( const std::string& rFileName,
+                        const std::string& rDigest,
+                        const std::string& rSpecies,
+                        const std::string& rReactions )
+{
+    std::ofstream file( rFileName.c_str() );
+    file << "<moleculizer-state><model/>"
+         << "<generated-network model-digest=\"" << rDigest << "\">"
+         << "<generated-species>" << rSpecies << "</generated-species>"
+         << "<generated-reactions>" << rReactions << "</generated-reactions>"
+         << "</generated-network></moleculizer-state>";
+}
+
+std::string savedSpeciesXml( const std::string& rTag,
+                             const std::string& rUniqueId,
+                             bool expanded )
+{
+    return "<species tag=\"" + rTag
+        + "\" unique-id=\"" + rUniqueId
+        + "\" expanded=\"" + ( expanded ? "true" : "false" ) + "\"/>";
+}
+
+// A reaction converting one species to another.
+std::string savedReactionXml( const std::string& rSubstrateTag,
+                              const std::string& rProductTag,
+                              const std::string& rRate )
+{
+    return "<reaction><substrates><substrate multiplicity=\"1\" tag=\"" + rSubstrateTag
+        + "\"/></substrates><products><product multiplicity=\"1\" tag=\"" + rProductTag
+        + "\"/></products><rate value=\"" + rRate + "\"/></reaction>";
+}
+
+void test_network_diff_and_merge()
+{
+    const std::string firstFileName( "network_diff_first.xml" );
+    const std::string secondFileName( "network_diff_second.xml" );
+    const std::string otherModelFileName( "network_diff_other.xml" );
+    const std::string mergedFileName( "network_diff_merged.xml" );
+    
+    // The second run tagged the same species differently, found species
+    // C, which it tagged as the first run tagged A, and got another rate
+    // for A -> B.
+    writeSavedNetwork( firstFileName,
+                       "digest",
+                       savedSpeciesXml( "t1", "A", true )
+                       + savedSpeciesXml( "t2", "B", false ),
+                       savedReactionXml( "t1", "t2", "1" ) );
+    writeSavedNetwork( secondFileName,
+                       "digest",
+                       savedSpeciesXml( "t2", "A", false )
+                       + savedSpeciesXml( "t3", "B", true )
+                       + savedSpeciesXml( "t1", "C", false ),
+                       savedReactionXml( "t2", "t3", "2" )
+                       + savedReactionXml( "t3", "t1", "3" ) );
+    writeSavedNetwork( otherModelFileName,
+                       "other-digest",
+                       savedSpeciesXml( "t1", "A", false ),
+                       "" );
+    
+    {
+        mzr::savedNetwork first( firstFileName );
+        mzr::savedNetwork second( secondFileName );
+        BOOST_CHECK( first.getModelDigest() == "digest" );
+        BOOST_CHECK( first.getSpecies().size() == 2 );
+        BOOST_CHECK( second.getReactionCount() == 2 );
+        
+        mzr::networkDiff sameDiff;
+        mzr::diffNetworks( first, first, sameDiff );
+        BOOST_CHECK( sameDiff.empty() );
+        
+        mzr::savedNetwork::participantList speciesA( 1, std::make_pair( std::string( "A" ), 1 ) );
+        mzr::savedNetwork::participantList speciesB( 1, std::make_pair( std::string( "B" ), 1 ) );
+        
+        mzr::networkDiff diff;
+        mzr::diffNetworks( first, second, diff );
+        BOOST_CHECK( diff.removedSpecies.empty() );
+        BOOST_REQUIRE( diff.addedSpecies.size() == 1 );
+        BOOST_CHECK( diff.addedSpecies[0] == "C" );
+        BOOST_CHECK( diff.removedReactions.empty() );
+        BOOST_REQUIRE( diff.addedReactions.size() == 1 );
+        BOOST_CHECK( diff.addedReactions[0].key.first == speciesB );
+        BOOST_CHECK( diff.addedReactions[0].rate == 3.0 );
+        BOOST_REQUIRE( diff.changedRates.size() == 1 );
+        BOOST_CHECK( diff.changedRates[0].key == std::make_pair( speciesA, speciesB ) );
+        BOOST_CHECK( diff.changedRates[0].oldRate == 1.0 );
+        BOOST_CHECK( diff.changedRates[0].newRate == 2.0 );
+        
+        std::ostringstream diffText;
+        diff.write( diffText );
+        BOOST_CHECK( diffText.str() == "+ species C\n"
+                     "+ reaction B -> C rate 3\n"
+                     "~ reaction A -> B rate 1 -> 2\n" );
+        
+        // Within the tolerance, the rates are the same.
+        mzr::networkDiff tolerantDiff;
+        mzr::diffNetworks( first, second, tolerantDiff, 0.5 );
+        BOOST_CHECK( tolerantDiff.changedRates.empty() );
+        BOOST_CHECK( tolerantDiff.addedReactions.size() == 1 );
+        
+        mzr::mergeNetworks( first, second, mergedFileName );
+        
+        mzr::savedNetwork other( otherModelFileName );
+        BOOST_CHECK_THROW( mzr::mergeNetworks( first, other, mergedFileName + ".unused" ),
+                           mzr::networkModelMismatchXcpt );
+    }
+    
+    {
+        mzr::savedNetwork merged( mergedFileName );
+        BOOST_CHECK( merged.getModelDigest() == "digest" );
+        
+        // Tags come from the first network, where it has them.
+        const mzr::savedNetwork::speciesMap& rSpecies = merged.getSpecies();
+        BOOST_REQUIRE( rSpecies.size() == 3 );
+        BOOST_CHECK( rSpecies.find( "A" )->second.tag == "t1" );
+        BOOST_CHECK( rSpecies.find( "A" )->second.expanded );
+        BOOST_CHECK( rSpecies.find( "B" )->second.tag == "t2" );
+        BOOST_CHECK( rSpecies.find( "B" )->second.expanded );
+        BOOST_CHECK( rSpecies.find( "C" )->second.tag == "t1-2" );
+        BOOST_CHECK( ! rSpecies.find( "C" )->second.expanded );
+        
+        // Both rates of A -> B are kept.
+        BOOST_CHECK( merged.getReactionCount() == 3 );
+        
+        mzr::networkDiff diff;
+        mzr::diffNetworks( merged, merged, diff );
+        BOOST_CHECK( diff.empty() );
+    }
+    
+    std::remove( firstFileName.c_str() );
+    std::remove( secondFileName.c_str() );
+    std::remove( otherModelFileName.c_str() );
+    std::remove( mergedFileName.c_str() );
+}
+
+// X and Y bind one another at a single pair of sites, so the complete
+// network is X, Y and X-Y, with binding and unbinding between them.
+const char* bindingModelXml =
+    "<moleculizer-input><model>"
+    "<modifications/>"
+    "<mols>"
+    "<mod-mol name=\"X\"><weight daltons=\"100.0\"/>"
+    "<binding-site name=\"L\"><default-shape-ref name=\"default\"/><site-shape name=\"default\"/></binding-site>"
+    "</mod-mol>"
+    "<mod-mol name=\"Y\"><weight daltons=\"100.0\"/>"
+    "<binding-site name=\"R\"><default-shape-ref name=\"default\"/><site-shape name=\"default\"/></binding-site>"
+    "</mod-mol>"
+    "</mols>"
+    "<allosteric-plexes/><allosteric-omnis/>"
+    "<reaction-gens><dimerization-gen>"
+    "<mol-ref name=\"X\"><site-ref name=\"L\"/></mol-ref>"
+    "<mol-ref name=\"Y\"><site-ref name=\"R\"/></mol-ref>"
+    "<default-on-rate value=\"10378367.8945\"/><default-off-rate value=\"0.25\"/>"
+    "</dimerization-gen></reaction-gens>"
+    "<explicit-species>"
+    "<plex-species name=\"X-singleton\"><plex><mol-instance name=\"the-X\"><mol-ref name=\"X\"/></mol-instance></plex>"
+    "<instance-states/><population count=\"2\"/></plex-species>"
+    "<plex-species name=\"Y-singleton\"><plex><mol-instance name=\"the-Y\"><mol-ref name=\"Y\"/></mol-instance></plex>"
+    "<instance-states/><population count=\"2\"/></plex-species>"
+    "</explicit-species>"
+    "<explicit-reactions/>"
+    "<volume liters=\"4e-14\"/>"
+    "</model></moleculizer-input>";
+
+std::string participantsText( const mzrReaction::multMap& rParticipants )
+{
+    std::multiset<std::string> names;
+    for ( mzrReaction::multMap::const_iterator iter = rParticipants.begin();
+          iter != rParticipants.end();
+          ++iter )
+    {
+        std::ostringstream participant;
+        participant << iter->second << ' ' << iter->first->getName();
+        names.insert( participant.str() );
+    }
+    
+    std::string text;
+    BOOST_FOREACH( const std::string& rName, names ) text += rName + "; ";
+    return text;
+}
+
+// The species of a network by unique id, with whether each was
+// expanded, and its reactions, with their rates, counted by what they do.
+void describeNetwork( const moleculizer& rMoleculizer,
+                      std::map<std::string, bool>& rSpecies,
+                      std::map<std::string, int>& rReactions )
+{
+    for ( moleculizer::SpeciesCatalog::const_iterator iter = rMoleculizer.getSpeciesCatalog().begin();
+          iter != rMoleculizer.getSpeciesCatalog().end();
+          ++iter )
+    {
+        rSpecies[iter->second->getName()] = iter->second->hasNotified();
+    }
+    
+    for ( moleculizer::ReactionList::const_iterator iter = rMoleculizer.getReactionList().begin();
+          iter != rMoleculizer.getReactionList().end();
+          ++iter )
+    {
+        std::ostringstream reaction;
+        reaction.precision( 17 );
+        reaction << participantsText( ( *iter )->getReactants() )
+                 << "-> " << participantsText( ( *iter )->getProducts() )
+                 << "rate " << ( *iter )->getRate();
+        ++rReactions[reaction.str()];
+    }
+}
+
+void test_generated_network_restore()
+{
+    const std::string savedFileName( "network_restore_saved.xml" );
+    
+    // Only X is expanded before the network is saved, so the restored
+    // network still has Y to expand.
+    moleculizer original;
+    original.loadXmlString( bindingModelXml );
+    original.incrementNetworkBySpeciesTag( original.getSpeciesWithSomeName( "X-singleton" )->getTag() );
+    original.writeOutputFile( savedFileName );
+    
+    std::map<std::string, bool> savedSpecies;
+    std::map<std::string, int> savedReactions;
+    describeNetwork( original, savedSpecies, savedReactions );
+    BOOST_CHECK( 0 < savedReactions.size() );
+    
+    moleculizer restored;
+    restored.loadXmlFileName( savedFileName );
+    
+    // The same species, expanded or not as they were, and the same
+    // reactions at the same rates.
+    std::map<std::string, bool> restoredSpecies;
+    std::map<std::string, int> restoredReactions;
+    describeNetwork( restored, restoredSpecies, restoredReactions );
+    BOOST_CHECK( restoredSpecies == savedSpecies );
+    BOOST_CHECK( restoredReactions == savedReactions );
+    BOOST_CHECK( restored.getTotalNumberReactions() == original.getTotalNumberReactions() );
+    
+    // Expanding a restored species that was expanded makes nothing new.
+    restored.incrementNetworkBySpeciesTag( restored.getSpeciesWithSomeName( "X-singleton" )->getTag() );
+    BOOST_CHECK( restored.getTotalNumberReactions() == original.getTotalNumberReactions() );
+    
+    // Expanding the rest gives the network that expanding the original
+    // gives, with no reaction made twice.
+    original.generateCompleteNetwork();
+    restored.generateCompleteNetwork();
+    
+    std::map<std::string, bool> completeSpecies;
+    std::map<std::string, int> completeReactions;
+    describeNetwork( original, completeSpecies, completeReactions );
+    BOOST_CHECK( completeSpecies.size() == 3 );
+    
+    restoredSpecies.clear();
+    restoredReactions.clear();
+    describeNetwork( restored, restoredSpecies, restoredReactions );
+    BOOST_CHECK( restoredSpecies == completeSpecies );
+    BOOST_CHECK( restoredReactions == completeReactions );
+    BOOST_CHECK( restored.getTotalNumberReactions() == original.getTotalNumberReactions() );
+    
+    typedef std::map<std::string, int>::value_type reactionCount;
+    BOOST_FOREACH( const reactionCount& rCount, restoredReactions )
+    {
+        BOOST_CHECK( rCount.second == 1 );
+    }
+    
+    std::remove( savedFileName.c_str() );
+}
+
+void test_bounded_expansion_budget_stop()
+{
+    moleculizer theMoleculizer;
+    theMoleculizer.loadXmlString( bindingModelXml );
+    
+    // The budget is reached by the first expansion, which makes X-Y and
+    // the binding reaction, so the bounded expansion stops before the
+    // second.
+    fnd::memoryAccount& rAccount = theMoleculizer.getMemoryAccount();
+    rAccount.setBudget( rAccount.getTotalUsage() + 1 );
+    
+    moleculizer::CachePosition position = theMoleculizer.generateCompleteNetwork( 100, 100 );
+    BOOST_CHECK( theMoleculizer.getStoppedByBudget() );
+    BOOST_CHECK( theMoleculizer.getTotalNumberSpecies() == 3 );
+    BOOST_CHECK( theMoleculizer.getTotalNumberReactions() == 1 );
+    
+    // The boundary takes in the whole first expansion.
+    BOOST_CHECK( std::distance( theMoleculizer.theDeltaSpeciesList.begin(), position.first ) == 3 );
+    BOOST_CHECK( std::distance( theMoleculizer.theDeltaReactionList.begin(), position.second ) == 1 );
+    
+    std::map<std::string, bool> species;
+    std::map<std::string, int> reactions;
+    describeNetwork( theMoleculizer, species, reactions );
+    int unexpandedCount = 0;
+    typedef std::map<std::string, bool>::value_type speciesEntry;
+    BOOST_FOREACH( const speciesEntry& rEntry, species )
+    {
+        if ( ! rEntry.second ) ++unexpandedCount;
+    }
+    BOOST_CHECK( 0 < unexpandedCount );
+    
+    // Without a budget the rest is expanded, and the expansion isn't
+    // taken for a budget stop.
+    rAccount.setBudget( 0 );
+    position = theMoleculizer.generateCompleteNetwork( 100, 100 );
+    BOOST_CHECK( ! theMoleculizer.getStoppedByBudget() );
+    BOOST_CHECK( theMoleculizer.getTotalNumberSpecies() == 3 );
+    BOOST_CHECK( theMoleculizer.getTotalNumberReactions() == 2 );
+    BOOST_CHECK( position.first == theMoleculizer.theDeltaSpeciesList.end() );
+    BOOST_CHECK( position.second == theMoleculizer.theDeltaReactionList.end() );
+}
+
+nmr::MinimalMol*
+makeNamingMol( const std::string& molType,
+               int bindingSiteCount,
+               const std::string& modificationValue )
+{
+    static const char* siteNames[] = { "One", "Two", "Three" };
+    
+    nmr::MinimalMol* pMol = new nmr::MinimalMol( molType );
+    for ( int siteNdx = 0; siteNdx != bindingSiteCount; ++siteNdx )
+    {
+        pMol->addNewBindingSite( siteNames[siteNdx] );
+    }
+    pMol->addNewModificationSite( "Site-One", "NULL" );
+    pMol->updateModificationState( "Site-One", modificationValue );
+    return pMol;
+}
+
+nmr::InternedMol
+makeInternedNamingMol( const std::string& molType,
+                       const std::string& modificationValue )
+{
+    nmr::InternedMol aMol( nmr::NameInterner::intern( molType ) );
+    aMol.theModifications.push_back( std::make_pair( nmr::NameInterner::intern( "Site-One" ),
+                                                     nmr::NameInterner::intern( modificationValue ) ) );
+    return aMol;
+}
+
+void test_interned_canonical_name()
+{
+    typedef nmr::NameInterner::NameId NameId;
+    
+    // Interning is idempotent, and IDs handed out against name order
+    // still compare in name order.
+    NameId zebra = nmr::NameInterner::intern( "zebra-site" );
+    NameId aardvark = nmr::NameInterner::intern( "aardvark-site" );
+    BOOST_CHECK( nmr::NameInterner::intern( "zebra-site" ) == zebra );
+    BOOST_CHECK( zebra != aardvark );
+    {
+        nmr::NameInterner::readGuard nameTableGuard;
+        BOOST_CHECK( nmr::NameInterner::getName( zebra ) == "zebra-site" );
+        BOOST_CHECK( nmr::NameInterner::getName( aardvark ) == "aardvark-site" );
+        BOOST_CHECK( nmr::NameInterner::nameLess( aardvark, zebra ) );
+        BOOST_CHECK( ! nmr::NameInterner::nameLess( zebra, aardvark ) );
+    }
+    
+    // The same complex, built from strings and from interned IDs, must
+    // get the same canonical name.
+    nmr::ComplexSpecies aComplex;
+    aComplex.addMolToComplex( makeNamingMol( "A-Type", 3, "NULL" ), "Mol_1" );
+    aComplex.addMolToComplex( makeNamingMol( "A-Type", 3, "NULL" ), "Mol_2" );
+    aComplex.addMolToComplex( makeNamingMol( "B-Type", 1, "NONNULL" ), "Mol_3" );
+    aComplex.addBindingToComplex( "Mol_2", "One", "Mol_3", "One" );
+    aComplex.addBindingToComplex( "Mol_1", "One", "Mol_2", "Two" );
+    
+    nmr::InternedComplexSpecies anInternedComplex;
+    anInternedComplex.addMolToComplex( makeInternedNamingMol( "A-Type", "NULL" ) );
+    anInternedComplex.addMolToComplex( makeInternedNamingMol( "A-Type", "NULL" ) );
+    anInternedComplex.addMolToComplex( makeInternedNamingMol( "B-Type", "NONNULL" ) );
+    
+    // Binding sites by index: One is 0, Two is 1.
+    anInternedComplex.addBindingToComplex( 1, 0, 2, 0 );
+    anInternedComplex.addBindingToComplex( 0, 0, 1, 1 );
+    
+    moleculizer theMolzer;
+    nmr::MangledNameAssembler theAssembler( *theMolzer.pUserUnits->pNmrUnit );
+    
+    std::string stringName = theAssembler.createCanonicalName( aComplex );
+    BOOST_CHECK( ! stringName.empty() );
+    BOOST_CHECK_EQUAL( theAssembler.createCanonicalName( anInternedComplex ), stringName );
+}
+
+struct streamSpecies
+{
+    int ordinal;
+};
+
+// Passes the even species, and counts how often it is asked.
+class countingEvenQuery :
+    public fnd::query<streamSpecies>
+{
+public:
+    countingEvenQuery( void ) :
+        calls( 0 )
+    {}
+    
+    bool
+    operator()( const streamSpecies& rSpecies ) const
+    {
+        ++calls;
+        return 0 == rSpecies.ordinal % 2;
+    }
+    
+    mutable int calls;
+};
+
+// X binds X through L, so the dimer holds two embeddings of an X omniplex.
+const char* homodimerModelXml =
+    "<moleculizer-input><model>"
+    "<modifications/>"
+    "<mols>"
+    "<mod-mol name=\"X\"><weight daltons=\"100.0\"/>"
+    "<binding-site name=\"L\"><default-shape-ref name=\"default\"/><site-shape name=\"default\"/></binding-site>"
+    "</mod-mol>"
+    "</mols>"
+    "<allosteric-plexes/><allosteric-omnis/>"
+    "<reaction-gens><dimerization-gen>"
+    "<mol-ref name=\"X\"><site-ref name=\"L\"/></mol-ref>"
+    "<mol-ref name=\"X\"><site-ref name=\"L\"/></mol-ref>"
+    "<default-on-rate value=\"10378367.8945\"/><default-off-rate value=\"0.25\"/>"
+    "</dimerization-gen></reaction-gens>"
+    "<explicit-species>"
+    "<plex-species name=\"X-singleton\"><plex><mol-instance name=\"the-X\"><mol-ref name=\"X\"/></mol-instance></plex>"
+    "<instance-states/><population count=\"2\"/></plex-species>"
+    "</explicit-species>"
+    "<explicit-reactions/>"
+    "<volume liters=\"4e-14\"/>"
+    "</model>"
+    "<streams><species-streams>"
+    "<omni-species-stream name=\"X-total\"><plex><mol-instance name=\"an-X\"><mol-ref name=\"X\"/></mol-instance></plex>"
+    "<instance-states/></omni-species-stream>"
+    "<omni-species-stream name=\"X-dimer\"><plex>"
+    "<mol-instance name=\"left-X\"><mol-ref name=\"X\"/></mol-instance>"
+    "<mol-instance name=\"right-X\"><mol-ref name=\"X\"/></mol-instance>"
+    "<binding><mol-instance-ref name=\"left-X\"><binding-site-ref name=\"L\"/></mol-instance-ref>"
+    "<mol-instance-ref name=\"right-X\"><binding-site-ref name=\"L\"/></mol-instance-ref></binding>"
+    "</plex><instance-states/></omni-species-stream>"
+    "</species-streams></streams>"
+    "</moleculizer-input>";
+
+void test_species_stream_membership()
+{
+    typedef fnd::multiSpeciesDumpable<streamSpecies, fnd::basicDumpable::dumpArg> multiStream;
+    typedef fnd::querySpeciesDumpable<streamSpecies, fnd::basicDumpable::dumpArg> queryStream;
+    typedef fnd::newSpeciesStimulus<streamSpecies> stimulus;
+    
+    streamSpecies species[4];
+    for ( int ndx = 0; ndx != 4; ++ndx ) species[ndx].ordinal = ndx;
+    
+    // A species notified twice is in the stream once.
+    multiStream everything( "everything" );
+    everything.respond( stimulus( &species[2], 0 ) );
+    everything.respond( stimulus( &species[0], 0 ) );
+    everything.respond( stimulus( &species[2], 0 ) );
+    BOOST_CHECK( everything.getSpeciesCount() == 2 );
+    BOOST_CHECK( everything.speciesInSpeciesStream( &species[0] ) );
+    BOOST_CHECK( ! everything.speciesInSpeciesStream( &species[1] ) );
+    
+    const std::vector<const streamSpecies*>* pSorted
+        = everything.getSpeciesInMultiSpeciesStream();
+    BOOST_CHECK( pSorted->size() == 2 );
+    BOOST_CHECK( std::count( pSorted->begin(), pSorted->end(), &species[2] ) == 1 );
+    
+    // The sorted view catches up once the stream has grown.
+    everything.respond( stimulus( &species[3], 0 ) );
+    everything.respond( stimulus( &species[1], 0 ) );
+    pSorted = everything.getSpeciesInMultiSpeciesStream();
+    BOOST_CHECK( pSorted->size() == 4 );
+    BOOST_CHECK( std::count( pSorted->begin(), pSorted->end(), &species[1] ) == 1 );
+    for ( unsigned int ndx = 1; ndx < pSorted->size(); ++ndx )
+    {
+        BOOST_CHECK( ( *pSorted )[ndx - 1] < ( *pSorted )[ndx] );
+    }
+    
+    // A species already in a query stream isn't queried again.
+    countingEvenQuery evenQuery;
+    queryStream evens( "evens", evenQuery );
+    for ( int pass = 0; pass != 2; ++pass )
+    {
+        for ( int ndx = 0; ndx != 4; ++ndx )
+        {
+            evens.respond( stimulus( &species[ndx], 0 ) );
+        }
+    }
+    BOOST_CHECK( evens.getSpeciesCount() == 2 );
+    BOOST_CHECK( evenQuery.calls == 6 );
+    
+    // The dimer reaches the X omniplex through both of its Xs, but is
+    // counted once.
+    moleculizer theMolzer;
+    theMolzer.loadXmlString( homodimerModelXml );
+    theMolzer.generateCompleteNetwork();
+    BOOST_CHECK( theMolzer.getTotalNumberSpecies() == 2 );
+    
+    std::vector<const mzrSpecies*> totalSpecies;
+    theMolzer.getSpeciesInSpeciesStream( "X-total", totalSpecies );
+    BOOST_CHECK( theMolzer.getNumberOfSpeciesInSpeciesStream( "X-total" ) == 2 );
+    BOOST_CHECK( totalSpecies.size() == 2 );
+    BOOST_CHECK( std::set<const mzrSpecies*>( totalSpecies.begin(), totalSpecies.end() ).size() == 2 );
+    BOOST_CHECK( theMolzer.getNumberOfSpeciesInSpeciesStream( "X-dimer" ) == 1 );
+}
+
 test_suite*
 init_unit_test_suite( int, char* [] )
 {
     declare_test_suite( "Moleculizer Test Suite" );
     add_test( test_scaffold );
+    add_test( test_python_rules_cache );
+    add_test( test_binary_dump_round_trip );
+    add_test( test_cell_list_pairs );
+    add_test( test_propensity_kernel );
+    add_test( test_allostery_index );
+    add_test( test_site_occupancy );
+    add_test( test_hash_cache );
+    add_test( test_mod_state_packing );
+    add_test( test_rate_memo );
+    add_test( test_event_queue );
+    add_test( test_forward_sensitivity );
+    add_test( test_network_reduction );
+    add_test( test_agent_simulator );
+    add_test( test_memory_budget );
+    add_test( test_network_snapshot );
+    add_test( test_network_diff_and_merge );
+    add_test( test_generated_network_restore );
+    add_test( test_interned_canonical_name );
+    add_test( test_species_stream_membership );
+    add_test( test_bounded_expansion_budget_stop );
 
     return 0;
 }
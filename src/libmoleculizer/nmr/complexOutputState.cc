@@ -31,6 +31,7 @@
 
 
 #include "complexOutputState.hh"
+#include "utl/utility.hh"
 #include <sstream>
 
 namespace nmr
@@ -108,6 +109,58 @@ namespace nmr
         return oss.str();
         
     }
+    
+    bool
+    InternedOutputState::operator== ( InternedOutputStateCref other ) const
+    {
+        return ( theMolTokens == other.theMolTokens &&
+                 theBindingTokens == other.theBindingTokens &&
+                 theModificationTokens == other.theModificationTokens );
+    }
+    
+    void
+    InternedOutputState::clear()
+    {
+        theMolTokens.clear();
+        theBindingTokens.clear();
+        theModificationTokens.clear();
+    }
+    
+    void
+    InternedOutputState::stringify( ComplexOutputState& rOutputState ) const
+    {
+        rOutputState.clear();
+        
+        for ( unsigned int ndx = 0; ndx != theMolTokens.size(); ++ndx )
+        {
+            rOutputState.addMolTokenToOutputState( NameInterner::getName( theMolTokens[ndx] ) );
+        }
+        
+        for ( unsigned int ndx = 0; ndx != theBindingTokens.size(); ++ndx )
+        {
+            const BindingToken& rToken = theBindingTokens[ndx];
+            
+            ComplexOutputState::BindingTokenStr aBindingToken;
+            aBindingToken.first.first = utl::stringify( rToken.first.first );
+            aBindingToken.first.second = utl::stringify( rToken.first.second );
+            aBindingToken.second.first = utl::stringify( rToken.second.first );
+            aBindingToken.second.second = utl::stringify( rToken.second.second );
+            
+            rOutputState.addBindingTokenToOutputState( aBindingToken );
+        }
+        
+        for ( unsigned int ndx = 0; ndx != theModificationTokens.size(); ++ndx )
+        {
+            const ModificationToken& rToken = theModificationTokens[ndx];
+            
+            ComplexOutputState::ModificationTokenStr aModificationToken;
+            aModificationToken.first = utl::stringify( rToken.first );
+            aModificationToken.second.first = NameInterner::getName( rToken.second.first );
+            aModificationToken.second.second = NameInterner::getName( rToken.second.second );
+            
+            rOutputState.addModificationTokenToOutputState( aModificationToken );
+        }
+    }
 }
 
 std::ostream& operator<< ( std::ostream& os, const nmr::ComplexOutputState& cos )
@@ -33,6 +33,7 @@
 #define __COMPLEXOUTPUTSTATE_HH
 
 #include "utl/defs.hh"
+#include "nmr/nameInterner.hh"
 
 namespace nmr
 {
@@ -64,6 +65,34 @@ namespace nmr
         void clear();
         std::string repr() const;
     };
+    
+    // The same tokens as a ComplexOutputState, with mol types, modification
+    // sites and modification values as NameInterner IDs and indices as
+    // integers.  Name assemblers that can work from this directly avoid
+    // building the string tokens at all.
+    
+    DECLARE_CLASS( InternedOutputState );
+    struct InternedOutputState
+    {
+        typedef std::pair<std::pair<int, int>, std::pair<int, int> > __BindingToken;
+        typedef std::pair<int, std::pair<NameInterner::NameId, NameInterner::NameId> > __ModificationToken;
+        
+        DECLARE_TYPE( NameInterner::NameId, MolToken );
+        DECLARE_TYPE( __BindingToken, BindingToken );
+        DECLARE_TYPE( __ModificationToken, ModificationToken );
+        
+        std::vector<MolToken> theMolTokens;
+        std::vector<BindingToken> theBindingTokens;
+        std::vector<ModificationToken> theModificationTokens;
+        
+        bool operator== ( const InternedOutputState& other ) const;
+        
+        void clear();
+        
+        // Produces the equivalent ComplexOutputState.  The caller must hold
+        // a NameInterner::readGuard.
+        void stringify( ComplexOutputState& rOutputState ) const;
+    };
 }
 
 std::ostream& operator<< ( std::ostream& os, const nmr::ComplexOutputState& cos );
@@ -32,11 +32,111 @@
 
 #include "nauty/nauty.h"
 #include "complexSpeciesOutputMinimizer.hh"
+#include <pthread.h>
 #include <iostream>
 
 namespace nmr
 {
 
+namespace
+{
+// The minimizer only needs to sort mols and tell mol types apart, which
+// MinimalMols do by string and InternedMols by interned ID.
+
+bool
+sameMolType( const MinimalMol* pFirstMol, const MinimalMol* pSecondMol )
+{
+    return pFirstMol->getMolType() == pSecondMol->getMolType();
+}
+
+bool
+sameMolType( const InternedMol& rFirstMol, const InternedMol& rSecondMol )
+{
+    return rFirstMol.getMolType() == rSecondMol.getMolType();
+}
+
+bool
+molLess( const MinimalMol* pFirstMol, const MinimalMol* pSecondMol )
+{
+    return *pFirstMol < *pSecondMol;
+}
+
+bool
+molLess( const InternedMol& rFirstMol, const InternedMol& rSecondMol )
+{
+    return rFirstMol < rSecondMol;
+}
+
+template<class molListT>
+class molIndexLessThanCmp : public std::binary_function<int, int, bool>
+{
+public:
+    molIndexLessThanCmp( const molListT& rMolList )
+            :
+            theComparisonMolList( rMolList )
+    {}
+
+    bool operator()( int ndx1, int ndx2 ) const
+    {
+        return molLess( theComparisonMolList[ndx1], theComparisonMolList[ndx2] );
+    }
+
+private:
+    const molListT& theComparisonMolList;
+};
+
+// nauty keeps its working state in file-static variables.
+pthread_mutex_t nautyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+pthread_once_t workspaceKeyOnce = PTHREAD_ONCE_INIT;
+pthread_key_t workspaceKey;
+
+void
+deleteWorkspace( void* pWorkspace )
+{
+    delete static_cast<ComplexSpeciesOutputMinimizer*>( pWorkspace );
+}
+
+void
+createWorkspaceKey()
+{
+    pthread_key_create( &workspaceKey, &deleteWorkspace );
+}
+}
+
+class ComplexSpeciesOutputMinimizer::nautyBuffers
+{
+public:
+    std::vector<setword> graph;
+    std::vector<setword> canonicalGraph;
+    std::vector<setword> workspace;
+    std::vector<int> lab;
+    std::vector<int> ptn;
+    std::vector<int> orbits;
+};
+
+ComplexSpeciesOutputMinimizer::~ComplexSpeciesOutputMinimizer()
+{
+    delete pNautyBuffers;
+}
+
+ComplexSpeciesOutputMinimizer&
+ComplexSpeciesOutputMinimizer::getThreadWorkspace()
+{
+    pthread_once( &workspaceKeyOnce, &createWorkspaceKey );
+
+    ComplexSpeciesOutputMinimizer* pWorkspace
+        = static_cast<ComplexSpeciesOutputMinimizer*>( pthread_getspecific( workspaceKey ) );
+
+    if ( !pWorkspace )
+    {
+        pWorkspace = new ComplexSpeciesOutputMinimizer();
+        pthread_setspecific( workspaceKey, pWorkspace );
+    }
+
+    return *pWorkspace;
+}
+
 ComplexOutputState
 ComplexSpeciesOutputMinimizer::getMinimalOutputState( ComplexSpeciesCref theComplexSpecies )
 {
@@ -46,8 +146,7 @@ ComplexSpeciesOutputMinimizer::getMinimalOutputState( ComplexSpeciesCref theComp
     setupDataStructuresForCalculation( aComplexSpecies );
 
     Permutation theMinimizingPermutation =
-        calculateCanonicalPermutationForColoredGraph( complexGraphEdgeMap,
-                partitionSpecification );
+        calculateCanonicalPermutationForColoredGraph( partitionSpecification );
 
     aComplexSpecies.applyPermutationToComplex( theMinimizingPermutation );
 
@@ -58,7 +157,39 @@ ComplexSpeciesOutputMinimizer::getMinimalOutputState( ComplexSpeciesCref theComp
 }
 
 void
-ComplexSpeciesOutputMinimizer::setupDataStructuresForCalculation( ComplexSpeciesRef aComplexSpecies )
+ComplexSpeciesOutputMinimizer::getMinimalOutputState( InternedComplexSpeciesCref theComplexSpecies,
+        InternedOutputState& rOutputState )
+{
+    // Assignment reuses the working copy's storage.
+    workingComplex = theComplexSpecies;
+
+    setupDataStructuresForCalculation( workingComplex );
+
+    Permutation theMinimizingPermutation =
+        calculateCanonicalPermutationForColoredGraph( partitionSpecification );
+
+    workingComplex.applyPermutationToComplex( theMinimizingPermutation );
+
+    // As in the ComplexSpecies version, the tokens are those of the
+    // complex as given, so that both paths produce the same names.
+    theComplexSpecies.constructOutputState( rOutputState );
+}
+
+void
+ComplexSpeciesOutputMinimizer::getMinimalOutputStates( const std::vector<const InternedComplexSpecies*>& rComplexes,
+        std::vector<InternedOutputState>& rOutputStates )
+{
+    rOutputStates.resize( rComplexes.size() );
+
+    for ( unsigned int ndx = 0; ndx != rComplexes.size(); ++ndx )
+    {
+        getMinimalOutputState( *rComplexes[ndx], rOutputStates[ndx] );
+    }
+}
+
+template<class complexT>
+void
+ComplexSpeciesOutputMinimizer::setupDataStructuresForCalculation( complexT& aComplexSpecies )
 {
 
 // Ensure graph is standard, with at most one binding between any two mols in the complex.
@@ -72,34 +203,27 @@ ComplexSpeciesOutputMinimizer::setupDataStructuresForCalculation( ComplexSpecies
     return;
 }
 
-void ComplexSpeciesOutputMinimizer::setupComplexEdgeMap( ComplexSpeciesCref aComplexSpecies )
+template<class complexT>
+void ComplexSpeciesOutputMinimizer::setupComplexEdgeMap( const complexT& aComplexSpecies )
 {
-
-    for(GraphEdgeList::iterator i = complexGraphEdgeMap.begin();
-	i != complexGraphEdgeMap.end();
-	++i)
+    // The inner vectors are cleared rather than freed, so they keep their
+    // capacity from one complex to the next.
+    unsigned int complexSize = aComplexSpecies.getNumberOfMolsInComplex();
+    if ( complexGraphEdgeMap.size() < complexSize )
     {
-	delete (*i);
+        complexGraphEdgeMap.resize( complexSize );
     }
 
-
-//     BOOST_FOREACH( std::set<int>* ptrSet, complexGraphEdgeMap )
-//     {
-//         delete ptrSet;
-//     }
-
-    for ( unsigned int ii = 0; ii != aComplexSpecies.getNumberOfMolsInComplex(); ++ii )
+    for ( unsigned int ii = 0; ii != complexSize; ++ii )
     {
-        complexGraphEdgeMap.push_back( new std::set<int>() );
+        complexGraphEdgeMap[ii].clear();
     }
 
-    typedef std::pair<int, int> KeyType;
+    typename complexT::BindingListCref theBindingList = aComplexSpecies.getBindingList();
 
-
-    ComplexSpecies::BindingListCref theBindingList = aComplexSpecies.getBindingList();
-
-// Create the edge-map for the complex.
-    for ( ComplexSpecies::BindingList::const_iterator bndIter = theBindingList.begin();
+// Create the edge-map for the complex.  The graph has been checked to be
+// simple, so no edge is added twice.
+    for ( typename complexT::BindingList::const_iterator bndIter = theBindingList.begin();
             bndIter != theBindingList.end();
             ++bndIter )
     {
@@ -107,25 +231,23 @@ void ComplexSpeciesOutputMinimizer::setupComplexEdgeMap( ComplexSpeciesCref aCom
         int molNdx1 = ( *bndIter ).second.first;
         int molNdx2 = ( *bndIter ).first.first;
 
-        complexGraphEdgeMap[molNdx1]->insert( molNdx2 );
-        complexGraphEdgeMap[molNdx2]->insert( molNdx1 );
+        complexGraphEdgeMap[molNdx1].push_back( molNdx2 );
+        complexGraphEdgeMap[molNdx2].push_back( molNdx1 );
     }
 }
 
-void ComplexSpeciesOutputMinimizer::setupComplexColorPartition( ComplexSpeciesCref aComplexSpecies )
+template<class complexT>
+void ComplexSpeciesOutputMinimizer::setupComplexColorPartition( const complexT& aComplexSpecies )
 {
     int complexSize = aComplexSpecies.getNumberOfMolsInComplex();
 
-    partitionSpecification.clear();
-    partitionSpecification.reserve( complexSize );
     partitionSpecification.resize( complexSize );
 
-    ComplexSpecies::MolListCref theMolList = aComplexSpecies.getMolList();
+    typename complexT::MolListCref theMolList = aComplexSpecies.getMolList();
 
-    std::string current_name( "This cannot possibly be a mol-name" );
     for ( int molNdx = 0; molNdx != ( complexSize - 1 ); ++molNdx )
     {
-        if ( theMolList[molNdx]->getMolType() != theMolList[molNdx + 1] ->getMolType() )
+        if ( !sameMolType( theMolList[molNdx], theMolList[molNdx + 1] ) )
         {
             partitionSpecification[molNdx] = 0;
         }
@@ -142,27 +264,17 @@ void ComplexSpeciesOutputMinimizer::setupComplexColorPartition( ComplexSpeciesCr
 }
 
 
+template<class complexT>
 bool
-ComplexSpeciesOutputMinimizer::checkComplexSpeciesIsSimpleGraph( ComplexSpeciesCref aComplexSpecies )
+ComplexSpeciesOutputMinimizer::checkComplexSpeciesIsSimpleGraph( const complexT& aComplexSpecies )
 {
-    typedef std::pair<int, int> IntPair;
-
-    std::map<IntPair, int> bindingsBetweenMap;
-    for ( int firstNdx = 0; firstNdx != aComplexSpecies.getNumberOfMolsInComplex(); ++firstNdx )
-    {
-        for ( int secondNdx = 0; secondNdx != aComplexSpecies.getNumberOfMolsInComplex(); ++secondNdx )
-        {
-            IntPair theKey = std::make_pair( firstNdx, secondNdx );
-            int theValue = 0;
-
-            bindingsBetweenMap.insert( std::make_pair( theKey, theValue ) );
-        }
-    }
+    unsigned int complexSize = aComplexSpecies.getNumberOfMolsInComplex();
 
+    bindingsBetween.assign( complexSize * complexSize, 0 );
 
 // Now iterate through each of the bindings and count up the number of connections
-    ComplexSpecies::BindingListCref theBindingList = aComplexSpecies.getBindingList();
-    for ( ComplexSpecies::BindingList::const_iterator bndIter = theBindingList.begin();
+    typename complexT::BindingListCref theBindingList = aComplexSpecies.getBindingList();
+    for ( typename complexT::BindingList::const_iterator bndIter = theBindingList.begin();
             bndIter != theBindingList.end();
             ++bndIter )
     {
@@ -172,49 +284,40 @@ ComplexSpeciesOutputMinimizer::checkComplexSpeciesIsSimpleGraph( ComplexSpeciesC
 // This means that there is a binding from a mol to itself within a complex species.
         if ( bindingIndex1 == bindingIndex2 ) return false;
 
-        IntPair theKey;
-
-        if ( bindingIndex2 < bindingIndex1 ) theKey = std::make_pair( bindingIndex2, bindingIndex2 );
-        else theKey = std::make_pair( bindingIndex1, bindingIndex2 );
+        if ( bindingIndex2 < bindingIndex1 ) std::swap( bindingIndex1, bindingIndex2 );
 
-        if ( bindingsBetweenMap[theKey] == 1 ) return false;
-        else bindingsBetweenMap[theKey] = 1;
+        char& rBound = bindingsBetween[bindingIndex1 * complexSize + bindingIndex2];
+        if ( rBound ) return false;
+        else rBound = 1;
     }
 
     return true;
 }
 
-Permutation
-ComplexSpeciesOutputMinimizer::calculateCanonicalPermutationForColoredGraph( const GraphEdgeList& graphEdgeList,
-        const ColoringPartition& theColoring )
+void
+ComplexSpeciesOutputMinimizer::runNauty( int n )
 {
-    static DEFAULTOPTIONS_GRAPH( options );
+    DEFAULTOPTIONS_GRAPH( options );
     options.getcanon = TRUE;
     options.defaultptn = FALSE;
 
-    DYNALLSTAT( graph,g,g_sz );
-    DYNALLSTAT( int,lab,lab_sz );
-    DYNALLSTAT( int,ptn,ptn_sz );
-    DYNALLSTAT( int,orbits,orbits_sz );
-    DYNALLSTAT( setword,workspace,workspace_sz );
-    DYNALLSTAT( graph, canong, canong_sz );
-
     statsblk stats;
 
-    int n = theColoring.size();
     int m = ( n + WORDSIZE - 1 ) / WORDSIZE;
 
-    set *gv;
+    if ( !pNautyBuffers ) pNautyBuffers = new nautyBuffers();
+    nautyBuffers& rBuffers = *pNautyBuffers;
 
-// This dynamically allocates g, the workspace, lab, ptn, and orbits
+// resize only reallocates when a complex is larger than any before it.
+    rBuffers.graph.resize( m * n );
+    rBuffers.canonicalGraph.resize( m * n );
+    rBuffers.workspace.resize( 50 * m );
+    rBuffers.lab.resize( n );
+    rBuffers.ptn.resize( n );
+    rBuffers.orbits.resize( n );
 
-    char error[] = "malloc";
-    DYNALLOC2( graph,g,g_sz,m,n,error );
-    DYNALLOC1( setword, workspace, workspace_sz, 50*m, error );
-    DYNALLOC1( int, lab, lab_sz, n, error );
-    DYNALLOC1( int, ptn, ptn_sz, n, error );
-    DYNALLOC1( int, orbits, orbits_sz, n, error );
-    DYNALLOC2( graph, canong, canong_sz, m, n, error );
+    graph* g = &rBuffers.graph[0];
+    set *gv;
 
 // Create the graph here.
     for ( int vertexNumber = 0; vertexNumber != n; ++vertexNumber )
@@ -222,47 +325,46 @@ ComplexSpeciesOutputMinimizer::calculateCanonicalPermutationForColoredGraph( con
         gv = GRAPHROW( g,vertexNumber,m );
         EMPTYSET( gv, m );
 
-        for ( std::set<int>::const_iterator iter = complexGraphEdgeMap[vertexNumber]->begin();
-                    iter != complexGraphEdgeMap[vertexNumber]->end();
-                    ++iter )
-            {
-                ADDELEMENT( gv, *iter );
-            }
+        const std::vector<int>& rNeighbors = complexGraphEdgeMap[vertexNumber];
+        for ( std::vector<int>::const_iterator iter = rNeighbors.begin();
+                iter != rNeighbors.end();
+                ++iter )
+        {
+            ADDELEMENT( gv, *iter );
+        }
     }
 
 // Create the coloring partition here.
-    for ( unsigned int ii = 0; ii != n; ++ii )
+    for ( int ii = 0; ii != n; ++ii )
     {
-        lab[ii] = ii;
-        ptn[ii] = partitionSpecification[ii];
+        rBuffers.lab[ii] = ii;
+        rBuffers.ptn[ii] = partitionSpecification[ii];
     }
 
-    nauty( g, lab, ptn, NULL, orbits, &options, &stats, workspace, 50*m, m, n, canong );
-
-    std::vector<int> basicPerm( n, 0 );
+    pthread_mutex_lock( &nautyMutex );
+    nauty( g, &rBuffers.lab[0], &rBuffers.ptn[0], NULL, &rBuffers.orbits[0],
+           &options, &stats, &rBuffers.workspace[0], 50*m, m, n, &rBuffers.canonicalGraph[0] );
+    pthread_mutex_unlock( &nautyMutex );
+}
 
-    for ( unsigned int ndx = 0;
-            ndx != n;
-            ++ndx )
-    {
-        basicPerm[ndx] = lab[ndx];
-    }
+Permutation
+ComplexSpeciesOutputMinimizer::calculateCanonicalPermutationForColoredGraph( const ColoringPartition& theColoring )
+{
+    int n = theColoring.size();
 
-    DYNFREE( g, g_sz );
-    DYNFREE( lab, lab_sz );
-    DYNFREE( ptn, ptn_sz );
-    DYNFREE( orbits, orbits_sz );
-    DYNFREE( workspace, workspace_sz );
-    DYNFREE( canong, canong_sz );
+    runNauty( n );
 
-    return Permutation( basicPerm );
+    return Permutation( std::vector<int>( pNautyBuffers->lab.begin(),
+                                          pNautyBuffers->lab.begin() + n ) );
 }
 
+template<class complexT>
 Permutation
-ComplexSpeciesOutputMinimizer::calculateMolSortingPermutationForComplex( ComplexSpeciesCref aComplexSpecies )
+ComplexSpeciesOutputMinimizer::calculateMolSortingPermutationForComplex( const complexT& aComplexSpecies )
 {
 //initialize a vector with entries 0...size-1
     std::vector<int> permutationVect;
+    permutationVect.reserve( aComplexSpecies.getNumberOfMolsInComplex() );
     for ( unsigned int i=0;
             i != aComplexSpecies.getNumberOfMolsInComplex();
             ++i )
@@ -273,26 +375,11 @@ ComplexSpeciesOutputMinimizer::calculateMolSortingPermutationForComplex( Complex
 //Sort permutation using a function which compares the theMols belonging at that index.
     std::sort( permutationVect.begin(),
                permutationVect.end(),
-               MolIndexLessThanCmp( aComplexSpecies ) );
+               molIndexLessThanCmp<typename complexT::MolList>( aComplexSpecies.getMolList() ) );
 
     Permutation inversePerm = Permutation( permutationVect );
     Permutation forwardPerm = inversePerm.invertPermutation();
     return forwardPerm;
 }
 
-
-ComplexSpeciesOutputMinimizer::MolIndexLessThanCmp::MolIndexLessThanCmp( ComplexSpeciesCref aComplexSpeciesForCmp )
-        :
-        theComparisonMolList( aComplexSpeciesForCmp.getMolList() )
-{}
-
-bool
-ComplexSpeciesOutputMinimizer::MolIndexLessThanCmp::operator()( int ndx1, int ndx2 )
-{
-    return *theComparisonMolList[ndx1] < *theComparisonMolList[ndx2];
-}
-
-
-
-
 }
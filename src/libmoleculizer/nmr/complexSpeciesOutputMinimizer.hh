@@ -34,6 +34,7 @@
 
 
 #include "complexSpecies.hh"
+#include "internedComplexSpecies.hh"
 #include "permutation.hh"
 #include <vector>
 #include <set>
@@ -41,19 +42,47 @@
 
 namespace nmr
 {
+// A minimizer is also the workspace for canonicalization: the edge lists,
+// the coloring, the nauty graph and work buffers and the working copy of
+// the complex are kept between calls and only grow.  Naming uses one
+// workspace per thread, from getThreadWorkspace().  nauty itself keeps
+// file-static state, so the nauty calls of all workspaces are made one at
+// a time, under one lock.
 class ComplexSpeciesOutputMinimizer
 {
 public:
 
     typedef std::vector<int> ColoringPartition;
-    typedef std::vector< std::set<int>* > GraphEdgeList;
+    typedef std::vector< std::vector<int> > GraphEdgeList;
 
     ComplexSpeciesOutputMinimizer()
+            :
+            pNautyBuffers( 0 )
 {}
 
+    ~ComplexSpeciesOutputMinimizer();
+
+    // The calling thread's workspace, created on first use and deleted
+    // when the thread exits.
+    static ComplexSpeciesOutputMinimizer&
+    getThreadWorkspace();
+
     ComplexOutputState
     getMinimalOutputState( ComplexSpeciesCref aComplexSpecies );
 
+    // The same calculation on the integer records.  Gives the tokens of
+    // getMinimalOutputState on the corresponding ComplexSpecies.
+    void
+    getMinimalOutputState( InternedComplexSpeciesCref aComplexSpecies,
+                           InternedOutputState& rOutputState );
+
+    // Canonicalizes a batch of complexes, such as the new species of one
+    // respond, in one pass through the workspace.
+    // rOutputStates is resized to match and its elements reused.
+    void
+    getMinimalOutputStates( const std::vector<const InternedComplexSpecies*>& rComplexes,
+                            std::vector<InternedOutputState>& rOutputStates );
+
 class NonSimpleGraphXcpt : public GeneralNmrXcpt
     {
     public:
@@ -69,40 +98,71 @@ class NonSimpleGraphXcpt : public GeneralNmrXcpt
             return oss.str();
         }
 
+        static
+        std::string
+        mkMsg( InternedComplexSpeciesCref aComplexSpecies )
+        {
+            std::ostringstream oss;
+            oss << "Error: the complex species '";
+            for ( unsigned int ndx = 0; ndx != aComplexSpecies.getNumberOfMolsInComplex(); ++ndx )
+            {
+                oss << NameInterner::getName( aComplexSpecies.getMolList()[ndx].getMolType() ) << " - ";
+            }
+            oss << "' does not represent a simple graph.  Please contact "
+            << "the developer <addy@molsci.org>.";
+            return oss.str();
+        }
+
         NonSimpleGraphXcpt( ComplexSpeciesCref aComplexSpecies )
                 :
                 GeneralNmrXcpt( mkMsg( aComplexSpecies ) )
         {}
+
+        NonSimpleGraphXcpt( InternedComplexSpeciesCref aComplexSpecies )
+                :
+                GeneralNmrXcpt( mkMsg( aComplexSpecies ) )
+        {}
     };
 
 private:
+    // These are templates over the complex representation, ComplexSpecies
+    // or InternedComplexSpecies, and are only instantiated in the .cc.
+    template<class complexT>
     Permutation
-    calculateMolSortingPermutationForComplex( ComplexSpeciesCref aComplexSpecies );
+    calculateMolSortingPermutationForComplex( const complexT& aComplexSpecies );
 
     Permutation
-    calculateCanonicalPermutationForColoredGraph( const GraphEdgeList& refGraphEdgeList,
-            const ColoringPartition& refColPart );
-
-    bool checkComplexSpeciesIsSimpleGraph( ComplexSpeciesCref aComplexSpecies );
-    void setupDataStructuresForCalculation( ComplexSpeciesRef aComplexSpecies );
-    void setupComplexEdgeMap( ComplexSpeciesCref aComplexSpecies );
-    void setupComplexColorPartition( ComplexSpeciesCref aComplexSpecies );
-
-struct MolIndexLessThanCmp : public std::binary_function<int, int, bool>
-    {
-        DECLARE_TYPE( ComplexSpecies::MolList, MolList );
+    calculateCanonicalPermutationForColoredGraph( const ColoringPartition& refColPart );
 
-        MolIndexLessThanCmp( ComplexSpeciesCref aComplexSpeciesForCmp );
-        bool operator()( int ndx1, int ndx2 );
+    void
+    runNauty( int vertexCount );
 
-private:
-        MolListCref theComparisonMolList;
-    };
+    template<class complexT>
+    bool checkComplexSpeciesIsSimpleGraph( const complexT& aComplexSpecies );
+    template<class complexT>
+    void setupDataStructuresForCalculation( complexT& aComplexSpecies );
+    template<class complexT>
+    void setupComplexEdgeMap( const complexT& aComplexSpecies );
+    template<class complexT>
+    void setupComplexColorPartition( const complexT& aComplexSpecies );
 
 private:
     ColoringPartition partitionSpecification;
     GraphEdgeList complexGraphEdgeMap;
-// std::vector<std::set<int>* > complexGraphEdgeMap;
+
+    // n x n flags, set for each pair of mols found bound to each other.
+    std::vector<char> bindingsBetween;
+
+    // nauty's graph, work and labelling buffers, defined in the .cc so
+    // that nauty.h stays out of this header.
+    class nautyBuffers;
+    nautyBuffers* pNautyBuffers;
+
+    InternedComplexSpecies workingComplex;
+
+    // The buffers belong to one workspace.
+    ComplexSpeciesOutputMinimizer( const ComplexSpeciesOutputMinimizer& );
+    ComplexSpeciesOutputMinimizer& operator=( const ComplexSpeciesOutputMinimizer& );
 };
 }
 
@@ -0,0 +1,144 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "nmr/internedComplexSpecies.hh"
+#include "nmr/nmrExceptions.hh"
+#include <algorithm>
+
+namespace nmr
+{
+    
+    void
+    InternedComplexSpecies::addBindingToComplex( MolNdx firstMolNdx,
+                                                 BndNdx firstMolBindingNdx,
+                                                 MolNdx secondMolNdx,
+                                                 BndNdx secondMolBindingNdx )
+    {
+        if ( firstMolNdx >= theMols.size() || secondMolNdx >= theMols.size() )
+        {
+            throw GeneralNmrXcpt( "Binding to a mol that is not in the complex in InternedComplexSpecies::addBindingToComplex." );
+        }
+        
+        // Ordered and inserted as ComplexSpecies::addBindingToComplex does,
+        // so that the two give the same output states.
+        Binding aBinding;
+        
+        if ( firstMolNdx < secondMolNdx )
+        {
+            aBinding.first = HalfBinding( firstMolNdx, firstMolBindingNdx );
+            aBinding.second = HalfBinding( secondMolNdx, secondMolBindingNdx );
+        }
+        else
+        {
+            aBinding.first = HalfBinding( secondMolNdx, secondMolBindingNdx );
+            aBinding.second = HalfBinding( firstMolNdx, firstMolBindingNdx );
+        }
+        
+        theBindings.insert( std::lower_bound( theBindings.begin(),
+                                              theBindings.end(),
+                                              aBinding ), aBinding );
+    }
+    
+    void
+    InternedComplexSpecies::applyPermutationToComplex( const Permutation& aPermutation )
+    {
+        if ( !aPermutation.getIsComplete() )
+        {
+            throw GeneralNmrXcpt( "Permutation is not complete" );
+        }
+        if ( aPermutation.getDimension() != this->getNumberOfMolsInComplex() )
+        {
+            throw GeneralNmrXcpt( "Permutation in not the same size as our mol" );
+        }
+        
+        Permutation theInversePerm = aPermutation.invertPermutation();
+        
+        MolList updatedMolList;
+        updatedMolList.reserve( theMols.size() );
+        for ( unsigned int molNdx = 0; molNdx != theMols.size(); ++molNdx )
+        {
+            updatedMolList.push_back( theMols[theInversePerm[molNdx]] );
+        }
+        
+        for ( BindingList::iterator bndIter = theBindings.begin();
+              bndIter != theBindings.end();
+              ++bndIter )
+        {
+            bndIter->first.first = aPermutation[bndIter->first.first];
+            bndIter->second.first = aPermutation[bndIter->second.first];
+            
+            if ( bndIter->first > bndIter->second )
+            {
+                std::swap( bndIter->first, bndIter->second );
+            }
+        }
+        
+        std::sort( theBindings.begin(),
+                   theBindings.end() );
+        
+        theMols.swap( updatedMolList );
+    }
+    
+    void
+    InternedComplexSpecies::constructOutputState( InternedOutputState& rOutputState ) const
+    {
+        rOutputState.clear();
+        
+        rOutputState.theMolTokens.reserve( theMols.size() );
+        for ( MolList::const_iterator iMol = theMols.begin();
+              iMol != theMols.end();
+              ++iMol )
+        {
+            rOutputState.theMolTokens.push_back( iMol->theMolType );
+        }
+        
+        rOutputState.theBindingTokens.reserve( theBindings.size() );
+        for ( BindingList::const_iterator iBinding = theBindings.begin();
+              iBinding != theBindings.end();
+              ++iBinding )
+        {
+            rOutputState.theBindingTokens.push_back( InternedOutputState::BindingToken( std::make_pair( iBinding->first.first,
+                                                                                                        iBinding->first.second ),
+                                                                                        std::make_pair( iBinding->second.first,
+                                                                                                        iBinding->second.second ) ) );
+        }
+        
+        for ( unsigned int molNdx = 0;
+              molNdx != theMols.size();
+              ++molNdx )
+        {
+            const InternedMol::ModificationList& rMods = theMols[molNdx].theModifications;
+            
+            for ( InternedMol::ModificationList::const_iterator iMod = rMods.begin();
+                  iMod != rMods.end();
+                  ++iMod )
+            {
+                rOutputState.theModificationTokens.push_back( std::make_pair( static_cast<int>( molNdx ),
+                                                                              *iMod ) );
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef __INTERNEDCOMPLEXSPECIES_HH
+#define __INTERNEDCOMPLEXSPECIES_HH
+
+#include "utl/defs.hh"
+#include "nmr/nameInterner.hh"
+#include "nmr/complexOutputState.hh"
+#include "nmr/permutation.hh"
+
+#include <vector>
+
+namespace nmr
+{
+    
+    // A mol as the naming pipeline sees it: its type, and the value at each
+    // of its modification sites, all as NameInterner IDs.  The
+    // modifications are kept in order of site name, as MinimalMol keeps
+    // them.
+    
+    DECLARE_CLASS( InternedMol );
+    struct InternedMol
+    {
+        typedef std::pair<NameInterner::NameId, NameInterner::NameId> __ModificationToken;
+        DECLARE_TYPE( __ModificationToken, ModificationToken );
+        DECLARE_TYPE( std::vector<ModificationToken>, ModificationList );
+        
+        InternedMol( NameInterner::NameId molType )
+            :
+            theMolType( molType )
+        {}
+        
+        NameInterner::NameId
+        getMolType() const
+        {
+            return theMolType;
+        }
+        
+        bool
+        operator< ( InternedMolCref rhsMol ) const
+        {
+            return NameInterner::nameLess( theMolType, rhsMol.theMolType );
+        }
+        
+        NameInterner::NameId theMolType;
+        ModificationList theModifications;
+    };
+    
+    // The integer counterpart of ComplexSpecies.  Mols are held by value and
+    // addressed by index rather than by alias, and bindings name binding
+    // sites by their index in the mol, which is what the output state
+    // records anyway.
+    
+    DECLARE_CLASS( InternedComplexSpecies );
+    class InternedComplexSpecies
+    {
+    public:
+        DECLARE_TYPE( unsigned int, MolNdx );
+        DECLARE_TYPE( unsigned int, BndNdx );
+        DECLARE_TYPE( std::vector<InternedMol>, MolList );
+        typedef std::pair<MolNdx, BndNdx> __HalfBinding;
+        DECLARE_TYPE( __HalfBinding, HalfBinding );
+        typedef std::pair<HalfBinding, HalfBinding> __Binding;
+        DECLARE_TYPE( __Binding, Binding );
+        DECLARE_TYPE( std::vector<Binding>, BindingList );
+        
+        void
+        addMolToComplex( InternedMolCref aMol )
+        {
+            theMols.push_back( aMol );
+        }
+        
+        void
+        addBindingToComplex( MolNdx firstMolNdx,
+                             BndNdx firstMolBindingNdx,
+                             MolNdx secondMolNdx,
+                             BndNdx secondMolBindingNdx );
+        
+        unsigned int
+        getNumberOfMolsInComplex() const
+        {
+            return theMols.size();
+        }
+        
+        unsigned int
+        getNumberOfBindingsInComplex() const
+        {
+            return theBindings.size();
+        }
+        
+        MolListCref
+        getMolList() const
+        {
+            return theMols;
+        }
+        
+        BindingListCref
+        getBindingList() const
+        {
+            return theBindings;
+        }
+        
+        void
+        applyPermutationToComplex( const Permutation& aPermutation );
+        
+        void
+        constructOutputState( InternedOutputState& rOutputState ) const;
+        
+        void
+        clear()
+        {
+            theMols.clear();
+            theBindings.clear();
+        }
+        
+    protected:
+        MolList theMols;
+        BindingList theBindings;
+    };
+}
+
+#endif
@@ -104,6 +104,46 @@ namespace nmr
     }
     
     
+    std::string
+    MangledNameAssembler::createNameFromInternedOutputState( InternedOutputStateCref anInternedOutputState ) const
+    {
+        // Must produce exactly what createNameFromOutputState produces from
+        // anInternedOutputState.stringify().
+        std::string aComplexSpeciesName;
+        aComplexSpeciesName.reserve( 64 );
+        
+        aComplexSpeciesName += "___";
+        for ( std::vector<InternedOutputState::MolToken>::const_iterator iMol = anInternedOutputState.theMolTokens.begin();
+              iMol != anInternedOutputState.theMolTokens.end();
+              ++iMol )
+        {
+            appendMolToken( aComplexSpeciesName, NameInterner::getName( *iMol ) );
+        }
+        
+        aComplexSpeciesName += "___";
+        for ( std::vector<InternedOutputState::BindingToken>::const_iterator iBinding = anInternedOutputState.theBindingTokens.begin();
+              iBinding != anInternedOutputState.theBindingTokens.end();
+              ++iBinding )
+        {
+            appendBindingIndex( aComplexSpeciesName, iBinding->first.first );
+            appendBindingIndex( aComplexSpeciesName, iBinding->first.second );
+            appendBindingIndex( aComplexSpeciesName, iBinding->second.first );
+            appendBindingIndex( aComplexSpeciesName, iBinding->second.second );
+        }
+        
+        aComplexSpeciesName += "___";
+        for ( std::vector<InternedOutputState::ModificationToken>::const_iterator iMod = anInternedOutputState.theModificationTokens.begin();
+              iMod != anInternedOutputState.theModificationTokens.end();
+              ++iMod )
+        {
+            appendModificationToken( aComplexSpeciesName, utl::stringify( iMod->first ) );
+            appendModificationToken( aComplexSpeciesName, NameInterner::getName( iMod->second.first ) );
+            appendModificationToken( aComplexSpeciesName, NameInterner::getName( iMod->second.second ) );
+        }
+        
+        return aComplexSpeciesName;
+    }
+    
     std::string
     MangledNameAssembler::constructMangledMolList( ComplexOutputStateCref aComplexOutputState ) const
     {
@@ -192,6 +232,54 @@ namespace nmr
     }
     
     
+    void
+    MangledNameAssembler::appendMolToken( std::string& rName, const std::string& aMolName ) const
+    {
+        std::string::size_type len = aMolName.size();
+        if ( len < 10 )
+        {
+            rName += static_cast<char>( '0' + len );
+        }
+        else
+        {
+            rName += '_';
+            rName += utl::stringify( len );
+            rName += '_';
+        }
+        rName += aMolName;
+    }
+    
+    void
+    MangledNameAssembler::appendBindingIndex( std::string& rName, int anIndex ) const
+    {
+        if ( 0 <= anIndex && anIndex < 10 )
+        {
+            rName += static_cast<char>( '0' + anIndex );
+        }
+        else
+        {
+            rName += processBindingString( utl::stringify( anIndex ) );
+        }
+    }
+    
+    void
+    MangledNameAssembler::appendModificationToken( std::string& rName, const std::string& aModString ) const
+    {
+        std::string::size_type len = aModString.size();
+        if ( len < 10 )
+        {
+            rName += '_';
+            rName += static_cast<char>( '0' + len );
+        }
+        else
+        {
+            rName += "__";
+            rName += utl::stringify( len );
+            rName += '_';
+        }
+        rName += aModString;
+    }
+    
     void
     MangledNameAssembler::parseMangledMolString( const std::string& molString, std::vector<ComplexOutputState::MolTokenStr>& molTokenVector ) const
     {
@@ -73,6 +73,9 @@ namespace nmr
         std::string
         createNameFromOutputState( const ComplexOutputState& aCOS ) const;
         
+        std::string
+        createNameFromInternedOutputState( const InternedOutputState& anInternedOutputState ) const;
+        
         ComplexOutputState
         createOutputStateFromName( const std::string& name ) const throw( nmr::UnparsableNameXcpt );
         
@@ -88,6 +91,11 @@ namespace nmr
         
         std::string getEncodedLength( const std::string& stringInQuestion ) const;
         
+        // Append-in-place versions of the above, for the interned path.
+        void appendMolToken( std::string& rName, const std::string& aMolName ) const;
+        void appendBindingIndex( std::string& rName, int anIndex ) const;
+        void appendModificationToken( std::string& rName, const std::string& aModString ) const;
+        
         
     protected:
         // These functions are used to decode the encoded names.
@@ -36,6 +36,7 @@
 #include "nmr/nmrExceptions.hh"
 
 #include "nmr/complexSpecies.hh"
+#include "nmr/internedComplexSpecies.hh"
 #include "nmr/complexOutputState.hh"
 #include "nmr/complexSpeciesOutputMinimizer.hh"
 
@@ -108,7 +109,7 @@ namespace nmr
         std::string
         createCanonicalName( ComplexSpeciesCref aComplexSpecies ) const
         {
-            ComplexSpeciesOutputMinimizer canonicalNameGenerator;
+            ComplexSpeciesOutputMinimizer& canonicalNameGenerator = ComplexSpeciesOutputMinimizer::getThreadWorkspace();
             ComplexOutputState minimalOutputState = canonicalNameGenerator.getMinimalOutputState( aComplexSpecies );
             
             
@@ -143,6 +144,40 @@ namespace nmr
             return answer;
         }
         
+        // The integer path: canonicalization runs on interned records, and
+        // strings are produced only by createNameFromInternedOutputState.
+        // Both read the name tables, so the whole call holds a readGuard.
+        std::string
+        createCanonicalName( InternedComplexSpeciesCref aComplexSpecies ) const
+        {
+            NameInterner::readGuard nameTableGuard;
+            
+            ComplexSpeciesOutputMinimizer& canonicalNameGenerator = ComplexSpeciesOutputMinimizer::getThreadWorkspace();
+            InternedOutputState minimalOutputState;
+            canonicalNameGenerator.getMinimalOutputState( aComplexSpecies, minimalOutputState );
+            
+            return createNameFromInternedOutputState( minimalOutputState );
+        }
+        
+        // Names a batch of complexes; rNames[i] is the canonical name of
+        // *rComplexes[i].  The readGuard is held for the whole batch.
+        void
+        createCanonicalNames( const std::vector<const InternedComplexSpecies*>& rComplexes,
+                              std::vector<std::string>& rNames ) const
+        {
+            NameInterner::readGuard nameTableGuard;
+            
+            ComplexSpeciesOutputMinimizer& canonicalNameGenerator = ComplexSpeciesOutputMinimizer::getThreadWorkspace();
+            std::vector<InternedOutputState> minimalOutputStates;
+            canonicalNameGenerator.getMinimalOutputStates( rComplexes, minimalOutputStates );
+            
+            rNames.resize( rComplexes.size() );
+            for ( unsigned int ndx = 0; ndx != rComplexes.size(); ++ndx )
+            {
+                rNames[ndx] = createNameFromInternedOutputState( minimalOutputStates[ndx] );
+            }
+        }
+        
         std::string
         generateNameFromComplexSpecies( ComplexSpeciesCref aComplexSpecies ) const
         {
@@ -156,7 +191,7 @@ namespace nmr
         std::string
         generateCanonicalNameFromComplexSpecies( ComplexSpeciesCref aComplexSpecies ) const
         {
-            ComplexSpeciesOutputMinimizer canonicalNameGenerator;
+            ComplexSpeciesOutputMinimizer& canonicalNameGenerator = ComplexSpeciesOutputMinimizer::getThreadWorkspace();
             ComplexOutputState minimalOutputState = canonicalNameGenerator.getMinimalOutputState( aComplexSpecies );
             
             // I'm surprised this works
@@ -164,6 +199,18 @@ namespace nmr
         }
         
         virtual std::string createNameFromOutputState( ComplexOutputStateCref aComplexOutputState ) const = 0;
+        
+        // Assemblers that can write a name straight from the integer tokens
+        // should override this; by default the tokens are stringified.
+        virtual std::string
+        createNameFromInternedOutputState( InternedOutputStateCref anInternedOutputState ) const
+        {
+            ComplexOutputState anOutputState;
+            anInternedOutputState.stringify( anOutputState );
+            
+            return createNameFromOutputState( anOutputState );
+        }
+
         virtual ComplexOutputState createOutputStateFromName( const std::string& aMangledName ) const
             throw( nmr::UnparsableNameXcpt, utl::NotImplementedXcpt )
         {
@@ -0,0 +1,114 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#include "nmr/nameInterner.hh"
+#include <pthread.h>
+
+namespace nmr
+{
+    namespace
+    {
+        pthread_rwlock_t nameTableLock = PTHREAD_RWLOCK_INITIALIZER;
+        
+        class nameTableWriteLock
+        {
+        public:
+            nameTableWriteLock( void )
+            {
+                pthread_rwlock_wrlock( &nameTableLock );
+            }
+            
+            ~nameTableWriteLock( void )
+            {
+                pthread_rwlock_unlock( &nameTableLock );
+            }
+        };
+    }
+    
+    std::deque<std::string> NameInterner::names;
+    std::map<std::string, NameInterner::NameId> NameInterner::nameToId;
+    std::vector<int> NameInterner::ranks;
+    bool NameInterner::ranksStale = false;
+    
+    NameInterner::NameId
+    NameInterner::intern( const std::string& rName )
+    {
+        nameTableWriteLock lock;
+        
+        std::map<std::string, NameId>::iterator iEntry
+            = nameToId.lower_bound( rName );
+        
+        if ( iEntry != nameToId.end() && iEntry->first == rName )
+        {
+            return iEntry->second;
+        }
+        
+        NameId newId = names.size();
+        names.push_back( rName );
+        nameToId.insert( iEntry, std::make_pair( rName, newId ) );
+        ranksStale = true;
+        
+        return newId;
+    }
+    
+    void
+    NameInterner::rankNames( void )
+    {
+        nameTableWriteLock lock;
+        
+        if ( ! ranksStale ) return;
+        
+        ranks.resize( names.size() );
+        int rank = 0;
+        for ( std::map<std::string, NameId>::const_iterator iName = nameToId.begin();
+              iName != nameToId.end();
+              ++iName )
+        {
+            ranks[iName->second] = rank++;
+        }
+        
+        ranksStale = false;
+    }
+    
+    NameInterner::readGuard::readGuard( void )
+    {
+        pthread_rwlock_rdlock( &nameTableLock );
+        
+        // Names were interned since the last ranking; rank them before
+        // letting the caller compare IDs.
+        while ( ranksStale )
+        {
+            pthread_rwlock_unlock( &nameTableLock );
+            rankNames();
+            pthread_rwlock_rdlock( &nameTableLock );
+        }
+    }
+    
+    NameInterner::readGuard::~readGuard( void )
+    {
+        pthread_rwlock_unlock( &nameTableLock );
+    }
+}
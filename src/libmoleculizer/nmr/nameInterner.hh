@@ -0,0 +1,114 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef __NAMEINTERNER_HH
+#define __NAMEINTERNER_HH
+
+#include "utl/defs.hh"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace nmr
+{
+    
+    // Assigns each distinct mol, site or modification name a dense integer
+    // ID, so that the naming pipeline can compare and copy integers and only
+    // produce strings when a name is finally written out.
+    //
+    // Names are interned by the cpx classes as the rules are loaded.  IDs
+    // are process-wide and are never retired, so an ID stays valid for as
+    // long as anything could hold it.
+    //
+    // The tables are shared by every moleculizer in the process, so they
+    // are guarded by a read/write lock.  intern takes the write lock; any
+    // code that calls getName or nameLess must hold a readGuard for as long
+    // as it uses the results.  Ranks are rebuilt once, by rankNames, after
+    // a batch of names has been interned rather than on every new name.
+    
+    DECLARE_CLASS( NameInterner );
+    class NameInterner
+    {
+    public:
+        DECLARE_TYPE( int, NameId );
+        
+        static NameId
+        intern( const std::string& rName );
+        
+        // Brings the ranks up to date with the names interned since the
+        // last call.  moleculizer calls this once a model has been loaded;
+        // readGuard also calls it if it finds the ranks out of date.
+        static void
+        rankNames( void );
+        
+        // Holds the read lock for its lifetime.  Must not be held by a
+        // thread that goes on to intern a name.
+        class readGuard
+        {
+        public:
+            readGuard( void );
+            ~readGuard( void );
+            
+        private:
+            readGuard( const readGuard& );
+            readGuard& operator=( const readGuard& );
+        };
+        
+        static const std::string&
+        getName( NameId nameId )
+        {
+            return names[nameId];
+        }
+        
+        // Orders IDs as their names would be ordered.  IDs are handed out in
+        // order of first appearance, so each name also keeps its rank among
+        // all the names, and the ranks are compared instead of the strings.
+        static bool
+        nameLess( NameId lhs, NameId rhs )
+        {
+            return ranks[lhs] < ranks[rhs];
+        }
+        
+        static int
+        getNameCount( void )
+        {
+            return names.size();
+        }
+        
+    private:
+        // A deque, so that references returned by getName survive interning.
+        static std::deque<std::string> names;
+        static std::map<std::string, NameId> nameToId;
+        
+        // By ID, the position of the name in nameToId.  Only valid while
+        // ranksStale is false.
+        static std::vector<int> ranks;
+        static bool ranksStale;
+    };
+}
+
+#endif
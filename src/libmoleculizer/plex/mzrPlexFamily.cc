@@ -43,7 +43,8 @@ namespace plx
     mzrPlexFamily( const mzrPlex& rParadigm,
                    cpx::knownBindings<bnd::mzrMol, fnd::feature<cpx::cxBinding<mzrPlexSpecies, mzrPlexFamily> > >& refKnownBindings,
                    std::set<mzrPlexFamily*>& refOmniplexFamilies,
-                   nmr::nmrUnit& refNmrUnit ) :
+                   nmr::nmrUnit& refNmrUnit,
+                   fnd::expansionProfiler& rExpansionProfiler ) :
         cpx::plexFamily<bnd::mzrMol,
                         mzrPlex,
                         mzrPlexSpecies,
@@ -51,7 +52,8 @@ namespace plx
                         mzrOmniPlex> ( rParadigm,
                                        refKnownBindings,
                                        refOmniplexFamilies ),
-        rNmrUnit( refNmrUnit )
+        rNmrUnit( refNmrUnit ),
+        rProfiler( rExpansionProfiler )
     {}
     
     mzrPlexSpecies*
@@ -104,4 +106,10 @@ namespace plx
         return rNmrUnit.getNameEncoder();
     }
     
+    mzr::moleculizer&
+    mzrPlexFamily::getMolzer( void ) const
+    {
+        return rNmrUnit.rMolzer;
+    }
+    
 }
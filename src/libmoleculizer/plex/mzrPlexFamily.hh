@@ -44,6 +44,7 @@
 #include "cpx/plexFamily.hh"
 #include "plex/mzrPlex.hh"
 #include "plex/mzrPlexSpecies.hh"
+#include "fnd/expansionProfiler.hh"
 
 namespace nmr
 {
@@ -51,6 +52,11 @@ namespace nmr
     DECLARE_CLASS( nameAssembler );
 }
 
+namespace mzr
+{
+    class moleculizer;
+}
+
 namespace bnd
 {
     DECLARE_CLASS( mzrMol );
@@ -80,6 +86,8 @@ namespace plx
     {
         nmr::nmrUnit& rNmrUnit;
         
+        fnd::expansionProfiler& rProfiler;
+        
     public:
         // The arguments other than the paradigm plex are passed on to the base
         // class constructor.  The knownBindings and the set of all omniPlexes
@@ -87,7 +95,8 @@ namespace plx
         mzrPlexFamily( const mzrPlex& rParadigm,
                        cpx::knownBindings<bnd::mzrMol, fnd::feature<cpx::cxBinding<mzrPlexSpecies, mzrPlexFamily> > >& refKnownBindings,
                        std::set<mzrPlexFamily*>& refOmniplexFamilies,
-                       nmr::nmrUnit& refNmrUnit );
+                       nmr::nmrUnit& refNmrUnit,
+                       fnd::expansionProfiler& rExpansionProfiler );
         
         // Fulfills plexFamily::constructSpecies pure virtual function.
         // This exists so that mzrPlexSpecies can have a reference to
@@ -99,6 +108,18 @@ namespace plx
         const nmr::NameAssembler*
         getNamingStrategy() const;
         
+        // The moleculizer whose network this family's species belong to.
+        mzr::moleculizer&
+        getMolzer( void ) const;
+        
+        // The profiler of the recognizer that made this family, which
+        // times the naming of its species.
+        fnd::expansionProfiler&
+        getExpansionProfiler( void ) const
+        {
+            return rProfiler;
+        }
+        
         
         // Output routine.
         void
@@ -31,10 +31,16 @@
 
 #include "utl/dom.hh"
 #include "utl/utility.hh"
+#include "fnd/expansionProfiler.hh"
+#include "fnd/memoryAccount.hh"
 #include "plex/mzrPlexSpecies.hh"
 #include "plex/mzrPlexFamily.hh"
 #include "plex/plexEltName.hh"
+#include "nmr/nameAssembler.hh"
 #include "mzr/mzrSpeciesDumpable.hh"
+#include "mzr/moleculizer.hh"
+#include <map>
+#include <set>
 #include <libxml++/libxml++.h>
 
 namespace plx
@@ -46,12 +52,46 @@ namespace plx
         return cpx::plexSpeciesMixin<mzrPlexFamily>::getWeight();
     }
     
+    std::size_t
+    mzrPlexSpecies::
+    getObjectBytes( void ) const
+    {
+        // The shapes of the binding sites, the states of the mols, and the
+        // name, once it has been generated.
+        return sizeof( mzrPlexSpecies )
+            + siteParams.size()
+            * fnd::memoryAccount::treeNodeBytes( sizeof( cpx::siteToShapeMap::value_type ) )
+            + molParams.capacity() * sizeof( cpx::molParam )
+            + name.capacity();
+    }
+    
     void
     mzrPlexSpecies::
     notify( int generateDepth )
     {
-        rFamily.respond( fnd::newSpeciesStimulus<mzrPlexSpecies> ( this,
-                                                                   generateDepth ) );
+        // Hold back the species this respond makes, so that they are named
+        // in one batch when it is done.
+        mzr::moleculizer& rMolzer = rFamily.getMolzer();
+        rMolzer.beginSpeciesBatch();
+        try
+        {
+            rFamily.respond( fnd::newSpeciesStimulus<mzrPlexSpecies> ( this,
+                                                                       generateDepth ) );
+        }
+        catch ( ... )
+        {
+            rMolzer.endSpeciesBatch();
+            throw;
+        }
+        rMolzer.endSpeciesBatch();
+    }
+
+    void
+    mzrPlexSpecies::
+    recordNotification( int generateDepth )
+    {
+        rFamily.recordContexts( fnd::newSpeciesStimulus<mzrPlexSpecies> ( this,
+                                                                          generateDepth ) );
     }
 
     void 
@@ -69,6 +109,11 @@ namespace plx
 
         if ( nameGenerated )
         {
+            fnd::expansionProfiler& rProfiler = rFamily.getExpansionProfiler();
+            if ( rProfiler.isEnabled() )
+            {
+                rProfiler.noteCacheHit( fnd::expansionProfiler::CANONICAL_NAMING );
+            }
             return name;
         }
         else
@@ -77,10 +122,11 @@ namespace plx
 #ifdef TMP_DEBUGGING
 	std::cout << "Generating name for " << getInformativeName() << std::endl;
 #endif
-        if ( nameGenerated )
-            nameGenerated = true;
+            fnd::profilePhase profile( rFamily.getExpansionProfiler(),
+                                       fnd::expansionProfiler::CANONICAL_NAMING );
             const nmr::NameAssembler* pNameAssembler = rFamily.getNamingStrategy();
             name = getCanonicalName( pNameAssembler );
+            nameGenerated = true;
 
 #ifdef TMP_DEBUGGING
 	    std::cout << "Done!" << std::endl;
@@ -89,6 +135,59 @@ namespace plx
         }
     }
     
+    void
+    mzrPlexSpecies::
+    generateNames( const std::vector<mzrPlexSpecies*>& rSpecies )
+    {
+        // Group the unnamed species by the naming strategy of their family.
+        typedef std::map<const nmr::NameAssembler*, std::vector<mzrPlexSpecies*> > strategyMap;
+        strategyMap unnamedByStrategy;
+        std::set<const mzrPlexSpecies*> grouped;
+        
+        for ( std::vector<mzrPlexSpecies*>::const_iterator iSpecies = rSpecies.begin();
+              iSpecies != rSpecies.end();
+              ++iSpecies )
+        {
+            if ( ! ( *iSpecies )->nameGenerated
+                 && grouped.insert( *iSpecies ).second )
+            {
+                unnamedByStrategy[( *iSpecies )->rFamily.getNamingStrategy()].push_back( *iSpecies );
+            }
+        }
+        
+        std::vector<nmr::InternedComplexSpecies> complexes;
+        std::vector<const nmr::InternedComplexSpecies*> complexPtrs;
+        std::vector<std::string> names;
+        
+        for ( strategyMap::const_iterator iGroup = unnamedByStrategy.begin();
+              iGroup != unnamedByStrategy.end();
+              ++iGroup )
+        {
+            const std::vector<mzrPlexSpecies*>& rGroup = iGroup->second;
+            
+            fnd::profilePhase profile( rGroup.front()->rFamily.getExpansionProfiler(),
+                                       fnd::expansionProfiler::CANONICAL_NAMING );
+            
+            // Sized before the pointers are taken, so they stay valid.
+            complexes.resize( rGroup.size() );
+            complexPtrs.clear();
+            for ( unsigned int ndx = 0; ndx != rGroup.size(); ++ndx )
+            {
+                rGroup[ndx]->createInternedRepresentation( complexes[ndx] );
+                complexPtrs.push_back( &complexes[ndx] );
+            }
+            
+            iGroup->first->createCanonicalNames( complexPtrs,
+                                                 names );
+            
+            for ( unsigned int ndx = 0; ndx != rGroup.size(); ++ndx )
+            {
+                rGroup[ndx]->name = names[ndx];
+                rGroup[ndx]->nameGenerated = true;
+            }
+        }
+    }
+    
     xmlpp::Element*
     mzrPlexSpecies::
     insertElt( xmlpp::Element* pExplicitSpeciesElt,
@@ -103,10 +103,24 @@ namespace plx
         virtual std::string
         getName( void ) const;
         
+        // Generates the names of all the given species that have not been
+        // named yet, canonicalizing them as one batch per naming strategy.
+        static void
+        generateNames( const std::vector<mzrPlexSpecies*>& rSpecies );
+        
+        std::size_t
+        getObjectBytes( void ) const;
+        
         xmlpp::Element*
         insertElt( xmlpp::Element* pExplicitSpeciesElt,
                    double molarFactor ) const
         throw( std::exception );
+        
+    protected:
+        // Overrides fnd::onceNotifier::recordNotification, so that a species
+        // restored as expanded is known to the features of its family.
+        void
+        recordNotification( int generateDepth );
     };
 }
 
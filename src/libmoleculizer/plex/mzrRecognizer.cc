@@ -43,7 +43,8 @@ namespace plx
         return new mzrPlexFamily( rPlex,
                                   rPlexUnit.bindingFeatures,
                                   rPlexUnit.omniPlexFamilies,
-                                  rNmrUnit );
+                                  rNmrUnit,
+                                  getExpansionProfiler() );
     }
     
     class insertFamilySpecies :
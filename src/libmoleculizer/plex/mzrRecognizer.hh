@@ -55,7 +55,11 @@ namespace plx
         
     public:
         mzrRecognizer( plexUnit& refPlexUnit,
-                       nmr::nmrUnit& refNmrUnit ) :
+                       nmr::nmrUnit& refNmrUnit,
+                       fnd::memoryAccount& rMemoryAccount,
+                       fnd::expansionProfiler& rExpansionProfiler ) :
+            cpx::recognizer<mzrPlex, mzrPlexFamily> ( rMemoryAccount,
+                                                      rExpansionProfiler ),
             rPlexUnit( refPlexUnit ),
             rNmrUnit( refNmrUnit )
         {}
@@ -49,7 +49,10 @@ namespace plx
         rMzrUnit( refMzrUnit ),
         rMolUnit( refMolUnit ),
         rNmrUnit( refNmrUnit ),
-        recognize( *this, rNmrUnit )
+        recognize( *this,
+                   rNmrUnit,
+                   rMoleculizer.getMemoryAccount(),
+                   rMoleculizer.getExpansionProfiler() )
     {
         // Model elements for which plex unit is responsible.
         inputCap.addModelContentName( eltName::allostericPlexes );
@@ -299,7 +302,8 @@ namespace plx
                 
                 // const std::string& modificationSiteName = ( *pMzrMol ).modSiteNames[ modificationIndex ];
                 
-                molState[modificationIndex] = rMolUnit.mustGetMod( iter->second.second );
+                molState.setModification( modificationIndex,
+                                          rMolUnit.mustGetMod( iter->second.second ) );
                 theParams[originalToResultIsomorphism.forward.applyToMolSpec( molIndex )] = pMzrMol->internState( molState );
             }
             
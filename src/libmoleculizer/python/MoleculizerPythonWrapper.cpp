@@ -31,8 +31,46 @@
 
 #include "MoleculizerPythonWrapper.hpp"
 
+// The vector's contents as a bytearray, in native byte order, for
+// numpy.frombuffer.
+template <typename T>
+object
+vectorAsByteArray( const std::vector<T>& theVector )
+{
+    const char* pBytes = theVector.empty() ? 0 : reinterpret_cast<const char*>( &theVector[0] );
+    
+    return object( handle<>( PyByteArray_FromStringAndSize( pBytes,
+                                                            theVector.size() * sizeof( T ) ) ) );
+}
+
+// ReactionNetworkGenerator::exportNetwork, as a dict of names (a list of
+// strings) and numeric arrays (bytearrays) for Python: the "species_masses"
+// and "rates" arrays hold float64, and the others int32.
+dict
+exportNetworkArrays( const ReactionNetworkGenerator& rGenerator )
+{
+    NetworkArrays arrays;
+    rGenerator.exportNetwork( arrays );
+    
+    dict network;
+    network["species_names"] = arrays.speciesNames;
+    network["species_masses"] = vectorAsByteArray( arrays.speciesMasses );
+    network["rates"] = vectorAsByteArray( arrays.rates );
+    network["reactant_offsets"] = vectorAsByteArray( arrays.reactantOffsets );
+    network["reactant_indices"] = vectorAsByteArray( arrays.reactantIndices );
+    network["reactant_stoichiometries"] = vectorAsByteArray( arrays.reactantStoichiometries );
+    network["product_offsets"] = vectorAsByteArray( arrays.productOffsets );
+    network["product_indices"] = vectorAsByteArray( arrays.productIndices );
+    network["product_stoichiometries"] = vectorAsByteArray( arrays.productStoichiometries );
+    
+    return network;
+}
+
 BOOST_PYTHON_MODULE( Moleculizer )
 {
+    // ReactionNetworkGenerator releases the GIL during expansion.
+    PyEval_InitThreads();
+    
     class_<Species> ( "Species", init<const mzr::mzrSpecies&>() )
         .add_property( "name", &Species::getName )
         .add_property( "mass", &Species::getMass )
@@ -54,16 +92,25 @@ BOOST_PYTHON_MODULE( Moleculizer )
         ;
     
     class_<ReactionNetworkGenerator> ( "ReactionNetworkGenerator" )
-        .def( "sayHi", &ReactionNetworkGenerator::sayHi );
+        .def( "sayHi", &ReactionNetworkGenerator::sayHi )
+        .def( "setExpansionProfiling", &ReactionNetworkGenerator::setExpansionProfiling )
+        .def( "resetExpansionProfile", &ReactionNetworkGenerator::resetExpansionProfile )
+        .def( "getExpansionProfile", &ReactionNetworkGenerator::getExpansionProfile )
+        .def( "getExpansionProfileStacks", &ReactionNetworkGenerator::getExpansionProfileStacks )
+        .def( "loadModelFile", &ReactionNetworkGenerator::loadModelFile )
+        .def( "loadModelString", &ReactionNetworkGenerator::loadModelString )
+        .def( "generateCompleteNetwork", &ReactionNetworkGenerator::generateCompleteNetwork )
+        .def( "generateNetwork", &ReactionNetworkGenerator::generateNetwork )
+        .def( "incrementSpecies", &ReactionNetworkGenerator::incrementSpecies )
+        .def( "getNumberOfSpecies", &ReactionNetworkGenerator::getNumberOfSpecies )
+        .def( "getNumberOfReactions", &ReactionNetworkGenerator::getNumberOfReactions )
+        .def( "exportNetwork", &exportNetworkArrays );
 //         .def( "addRules", &ReactionNetworkGenerator::addRules )
 //         .def( "getBinaryReactions", &ReactionNetworkGenerator::getBinaryReactions )
 //         .def( "getUnaryReactions", &ReactionNetworkGenerator::getUnaryReactions )
 //         .def( "getSpecies", &ReactionNetworkGenerator::getSpecies )
 //         .def( "checkSpeciesNameLegality", &ReactionNetworkGenerator::checkSpeciesNameLegality )
 //         .def( "showAllSpecies", &ReactionNetworkGenerator::showAllSpecies )
-//         .def( "incrementSpecies", &ReactionNetworkGenerator::incrementSpecies )
-//         .def( "getNumberOfSpecies", &ReactionNetworkGenerator::getNumberOfSpecies )
-//         .def( "getNumberOfReactions", &ReactionNetworkGenerator::getNumberOfReactions )
 //         .def( "showLiveSpecies", &ReactionNetworkGenerator::showLiveSpecies )
 //         .def( "showDeadSpecies", &ReactionNetworkGenerator::showDeadSpecies )
 //         .def( "getNumUnaryReactions",&ReactionNetworkGenerator::getNumUnary )
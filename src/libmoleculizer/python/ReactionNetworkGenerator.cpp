@@ -88,6 +88,159 @@ void BasicComplexRepresentation::addModificationToComplex( int molIndex,
                                                              modificationValue ) ) );
 }
 
+namespace
+{
+    // Holds a mutex for the life of the object.
+    class ExpansionLock
+    {
+    public:
+        ExpansionLock( pthread_mutex_t& rMutex )
+            :
+            rLockedMutex( rMutex )
+        {
+            pthread_mutex_lock( &rLockedMutex );
+        }
+        
+        ~ExpansionLock()
+        {
+            pthread_mutex_unlock( &rLockedMutex );
+        }
+        
+    private:
+        pthread_mutex_t& rLockedMutex;
+        
+        ExpansionLock( const ExpansionLock& );
+        ExpansionLock& operator=( const ExpansionLock& );
+    };
+}
+
+void NetworkArrays::clear()
+{
+    speciesNames.clear();
+    speciesMasses.clear();
+    rates.clear();
+    reactantOffsets.clear();
+    reactantIndices.clear();
+    reactantStoichiometries.clear();
+    productOffsets.clear();
+    productIndices.clear();
+    productStoichiometries.clear();
+}
+
+void ReactionNetworkGenerator::loadModelFile( const std::string& fileName )
+{
+    ReleasedGIL releasedGIL;
+    ExpansionLock expansionLock( expansionMutex );
+    ptrMoleculizer->loadXmlFileName( fileName );
+}
+
+void ReactionNetworkGenerator::loadModelString( const std::string& model )
+{
+    ReleasedGIL releasedGIL;
+    ExpansionLock expansionLock( expansionMutex );
+    ptrMoleculizer->loadXmlString( model );
+}
+
+void ReactionNetworkGenerator::generateCompleteNetwork()
+{
+    ReleasedGIL releasedGIL;
+    ExpansionLock expansionLock( expansionMutex );
+    ptrMoleculizer->generateCompleteNetwork();
+}
+
+void ReactionNetworkGenerator::generateNetwork( long maxNumSpecies,
+                                                long maxNumRxns )
+{
+    ReleasedGIL releasedGIL;
+    ExpansionLock expansionLock( expansionMutex );
+    ptrMoleculizer->generateCompleteNetwork( maxNumSpecies,
+                                             maxNumRxns );
+}
+
+void ReactionNetworkGenerator::incrementSpecies( const std::string& speciesTag )
+{
+    ReleasedGIL releasedGIL;
+    ExpansionLock expansionLock( expansionMutex );
+    ptrMoleculizer->incrementNetworkBySpeciesTag( speciesTag );
+}
+
+int ReactionNetworkGenerator::getNumberOfSpecies() const
+{
+    return ptrMoleculizer->getSnapshot()->getSpeciesCount();
+}
+
+int ReactionNetworkGenerator::getNumberOfReactions() const
+{
+    return ptrMoleculizer->getSnapshot()->getReactionCount();
+}
+
+namespace
+{
+    void
+    appendParticipants( const Reaction::CoreRxnType::multMap& rParticipants,
+                        const std::map<const mzr::mzrSpecies*, int>& rSpeciesIndices,
+                        std::vector<int>& rOffsets,
+                        std::vector<int>& rIndices,
+                        std::vector<int>& rStoichiometries )
+    {
+        for ( Reaction::CoreRxnType::multMap::const_iterator iParticipant = rParticipants.begin();
+              iParticipant != rParticipants.end();
+              ++iParticipant )
+        {
+            rIndices.push_back( rSpeciesIndices.find( iParticipant->first )->second );
+            rStoichiometries.push_back( iParticipant->second );
+        }
+        rOffsets.push_back( rIndices.size() );
+    }
+}
+
+void ReactionNetworkGenerator::exportNetwork( NetworkArrays& rArrays ) const
+{
+    ReleasedGIL releasedGIL;
+    
+    mzr::moleculizer::SnapshotHandle snapshot = ptrMoleculizer->getSnapshot();
+    
+    rArrays.clear();
+    
+    int speciesCount = snapshot->getSpeciesCount();
+    rArrays.speciesNames.reserve( speciesCount );
+    rArrays.speciesMasses.reserve( speciesCount );
+    
+    std::map<const mzr::mzrSpecies*, int> speciesIndices;
+    for ( int speciesNdx = 0; speciesNdx != speciesCount; ++speciesNdx )
+    {
+        const mzr::mzrSpecies* pSpecies = snapshot->getSpecies( speciesNdx );
+        
+        speciesIndices.insert( std::make_pair( pSpecies, speciesNdx ) );
+        rArrays.speciesNames.push_back( snapshot->getSpeciesID( speciesNdx ) );
+        rArrays.speciesMasses.push_back( pSpecies->getWeight() );
+    }
+    
+    int reactionCount = snapshot->getReactionCount();
+    rArrays.rates.reserve( reactionCount );
+    rArrays.reactantOffsets.reserve( reactionCount + 1 );
+    rArrays.productOffsets.reserve( reactionCount + 1 );
+    
+    rArrays.reactantOffsets.push_back( 0 );
+    rArrays.productOffsets.push_back( 0 );
+    for ( int rxnNdx = 0; rxnNdx != reactionCount; ++rxnNdx )
+    {
+        const mzr::mzrReaction* pRxn = snapshot->getReaction( rxnNdx );
+        
+        rArrays.rates.push_back( pRxn->getRate() );
+        appendParticipants( pRxn->getReactants(),
+                            speciesIndices,
+                            rArrays.reactantOffsets,
+                            rArrays.reactantIndices,
+                            rArrays.reactantStoichiometries );
+        appendParticipants( pRxn->getProducts(),
+                            speciesIndices,
+                            rArrays.productOffsets,
+                            rArrays.productIndices,
+                            rArrays.productStoichiometries );
+    }
+}
+
 // std::vector<Reaction>
 // ReactionNetworkGenerator::getBinaryReactions( const std::string& species1,
 //                                               const std::string& species2 ) throw( mzr::IllegalNameXcpt )
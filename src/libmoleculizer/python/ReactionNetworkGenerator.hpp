@@ -32,15 +32,19 @@
 #ifndef REACTIONNETWORKGENERATOR_HPP
 #define REACTIONNETWORKGENERATOR_HPP
 
+#include <Python.h>
+#include <pthread.h>
 #include "mzr/moleculizer.hh"
 #include "mzr/mzrException.hh"
 #include "fnd/basicReaction.hh"
+#include "fnd/expansionProfiler.hh"
 #include "mzr/mzrSpecies.hh"
 #include "utl/utility.hh"
 #include "nmr/complexSpecies.hh"
 #include "mol/mzrMol.hh"
 #include <vector>
 #include <string>
+#include <sstream>
 
 class Species
 {
@@ -127,6 +131,52 @@ struct BasicComplexRepresentation
 };
 
 
+// Lets other Python threads run for the life of the object.  Nothing
+// that touches Python objects may be done meanwhile.
+class ReleasedGIL
+{
+public:
+    ReleasedGIL()
+        :
+        pThreadState( PyEval_SaveThread() )
+    {}
+    
+    ~ReleasedGIL()
+    {
+        PyEval_RestoreThread( pThreadState );
+    }
+    
+private:
+    PyThreadState* pThreadState;
+    
+    ReleasedGIL( const ReleasedGIL& );
+    ReleasedGIL& operator=( const ReleasedGIL& );
+};
+
+// The whole network, as flat arrays for numpy.  Species are numbered in
+// the order they were generated, and reactions likewise.  The reactants
+// of reaction r are reactantIndices[reactantOffsets[r]] up to (but not
+// including) reactantIndices[reactantOffsets[r + 1]], each with the
+// stoichiometry in the same place of reactantStoichiometries; products
+// are laid out the same way.
+struct NetworkArrays
+{
+    std::vector<std::string> speciesNames;
+    std::vector<double> speciesMasses;
+    
+    std::vector<double> rates;
+    
+    std::vector<int> reactantOffsets;
+    std::vector<int> reactantIndices;
+    std::vector<int> reactantStoichiometries;
+    
+    std::vector<int> productOffsets;
+    std::vector<int> productIndices;
+    std::vector<int> productStoichiometries;
+    
+    void clear();
+};
+
 class ReactionNetworkGenerator
 {
     
@@ -134,10 +184,12 @@ public:
     ReactionNetworkGenerator()
     {
         ptrMoleculizer = new mzr::moleculizer;
+        pthread_mutex_init( &expansionMutex, 0 );
     }
     
     ~ReactionNetworkGenerator()
     {
+        pthread_mutex_destroy( &expansionMutex );
         delete ptrMoleculizer;
     }
     
@@ -146,6 +198,52 @@ public:
         std::cout << "Hello" << std::endl;
     }
     
+    // This generator's own profiler; see fnd/expansionProfiler.hh.
+    void setExpansionProfiling( bool enable )
+    {
+        ptrMoleculizer->getExpansionProfiler().setEnabled( enable );
+    }
+    
+    void resetExpansionProfile()
+    {
+        ptrMoleculizer->getExpansionProfiler().reset();
+    }
+    
+    // As a JSON document, for json.loads.
+    std::string getExpansionProfile() const
+    {
+        std::ostringstream profile;
+        ptrMoleculizer->getExpansionProfiler().writeJson( profile );
+        return profile.str();
+    }
+    
+    // In the folded-stacks format read by flamegraph.pl.
+    std::string getExpansionProfileStacks() const
+    {
+        std::ostringstream stacks;
+        ptrMoleculizer->getExpansionProfiler().writeFoldedStacks( stacks );
+        return stacks.str();
+    }
+    
+    // Loading and expansion release the GIL, so other Python threads
+    // keep running.  A call made while another thread is loading or
+    // expanding waits for it to finish; exportNetwork doesn't wait.
+    void loadModelFile( const std::string& fileName );
+    void loadModelString( const std::string& model );
+    
+    void generateCompleteNetwork();
+    void generateNetwork( long maxNumSpecies,
+                          long maxNumRxns );
+    void incrementSpecies( const std::string& speciesTag );
+    
+    int getNumberOfSpecies() const;
+    int getNumberOfReactions() const;
+    
+    // Fills rArrays with the network as of the last expansion call to
+    // finish.  This reads only a published snapshot of the network,
+    // never the species themselves, so the GIL is released here too.
+    void exportNetwork( NetworkArrays& rArrays ) const;
+    
 //     void
 //     runInteractiveMode()
 //     {
@@ -232,9 +330,6 @@ public:
 //     generateNameFromBasicComplexRepresentationStrict( const BasicComplexRepresentation& aBCR );
     
 //     void showAllReactions();
-//     void incrementSpecies( const std::string& species );
-//     int getNumberOfSpecies();
-//     int getNumberOfReactions();
     
 //     void
 //     showAllSpecies()
@@ -245,6 +340,9 @@ public:
     
 protected:
     mzr::moleculizer* ptrMoleculizer;
+    
+    // Held while loading or expanding, always after the GIL is released.
+    pthread_mutex_t expansionMutex;
 };
 
 class modificationNotOfNdx
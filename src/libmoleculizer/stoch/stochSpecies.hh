@@ -79,6 +79,12 @@ namespace stoch
             return weight;
         }
         
+        std::size_t
+        getObjectBytes( void ) const
+        {
+            return sizeof( stochSpecies ) + name.capacity();
+        }
+        
         xmlpp::Element*
         insertElt( xmlpp::Element* pExplicitSpeciesElt,
                    double molarFactor ) const throw( std::exception );
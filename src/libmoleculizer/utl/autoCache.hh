@@ -55,8 +55,8 @@ namespace utl
         getMember( const keyType& rKey )
         {
             typename std::pair<typename objectCache::iterator, bool> insertResult
-                = insert( typename objectCache::value_type( rKey,
-                                                            ( objectType* ) 0 ) );
+                = this->insert( typename objectCache::value_type( rKey,
+                                                                  ( objectType* ) 0 ) );
             
             if ( insertResult.second )
             {
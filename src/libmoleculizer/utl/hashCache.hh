@@ -0,0 +1,279 @@
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+//        This file is part of Libmoleculizer
+//
+//        Copyright (C) 2001-2009 The Molecular Sciences Institute.
+//
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//
+// Moleculizer is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// Moleculizer is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Moleculizer; if not, write to the Free Software Foundation
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307,  USA
+//
+// END HEADER
+//
+//
+
+#ifndef UTL_HASHCACHE_H
+#define UTL_HASHCACHE_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace utl
+{
+    // A short sequence of pointers, held inline up to inlineCount of them,
+    // so that most keys cost no allocation of their own.
+    template<class elementT,
+             int inlineCount>
+    class inlineKey
+    {
+        int length;
+        elementT inlineElements[inlineCount];
+        
+        // Only used for keys too long to be held inline.
+        std::vector<elementT> longElements;
+        
+    public:
+        inlineKey( const std::vector<elementT>& rElements ) :
+            length( rElements.size() )
+        {
+            if ( length <= inlineCount )
+            {
+                std::copy( rElements.begin(),
+                           rElements.end(),
+                           inlineElements );
+            }
+            else
+            {
+                longElements = rElements;
+            }
+        }
+        
+        int
+        size( void ) const
+        {
+            return length;
+        }
+        
+        const elementT*
+        data( void ) const
+        {
+            return length <= inlineCount ? inlineElements : &longElements[0];
+        }
+        
+        const elementT&
+        operator[]( int ndx ) const
+        {
+            return data()[ndx];
+        }
+        
+        bool
+        operator==( const std::vector<elementT>& rElements ) const
+        {
+            return length == ( int ) rElements.size()
+                && std::equal( rElements.begin(),
+                               rElements.end(),
+                               data() );
+        }
+        
+        std::vector<elementT>
+        toVector( void ) const
+        {
+            return std::vector<elementT>( data(),
+                                          data() + length );
+        }
+    };
+    
+    // Does the same job as objectCache, for keys that are sequences of
+    // pointers, but finds members by hashing the key rather than by
+    // comparing whole keys down a tree.  Members are kept, and iterated
+    // over, in the order in which they were made.
+    template<class elementT,
+             class objectType,
+             int inlineCount = 8>
+    class hashCache
+    {
+    public:
+        typedef inlineKey<elementT, inlineCount> keyType;
+        typedef std::pair<keyType, objectType*> value_type;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef const_iterator iterator;
+        
+    private:
+        std::vector<value_type> members;
+        std::vector<size_t> memberHashes;
+        
+        // Open addressing with linear probing.  Each slot holds the index of
+        // a member, or -1.  The number of slots is a power of two, and they
+        // are never more than half full.
+        std::vector<int> slots;
+        
+        // Multiplicative hashing of the addresses, less their alignment
+        // bits, done inline, since it is done for every element of every
+        // key looked up.
+        static size_t
+        hashKey( const std::vector<elementT>& rKey )
+        {
+            size_t hashValue = rKey.size();
+            for ( typename std::vector<elementT>::const_iterator iElement = rKey.begin();
+                  iElement != rKey.end();
+                  ++iElement )
+            {
+                hashValue = ( hashValue ^ ( ( size_t ) ( const void* ) *iElement >> 3 ) )
+                    * 2654435761ul;
+            }
+            
+            // Multiplying leaves the low bits, which pick the slot,
+            // depending only on the low bits of the input.
+            return hashValue ^ ( hashValue >> 16 );
+        }
+        
+        // The slot holding the member with the key, or else the empty slot
+        // where it would go.
+        size_t
+        findSlot( const std::vector<elementT>& rKey,
+                  size_t hashValue ) const
+        {
+            size_t mask = slots.size() - 1;
+            size_t slotNdx = hashValue & mask;
+            
+            while ( 0 <= slots[slotNdx] )
+            {
+                int memberNdx = slots[slotNdx];
+                if ( memberHashes[memberNdx] == hashValue
+                     && members[memberNdx].first == rKey ) break;
+                
+                slotNdx = ( slotNdx + 1 ) & mask;
+            }
+            return slotNdx;
+        }
+        
+        void
+        rehash( size_t slotCount )
+        {
+            slots.assign( slotCount, -1 );
+            size_t mask = slotCount - 1;
+            
+            for ( int memberNdx = 0;
+                  memberNdx < ( int ) members.size();
+                  ++memberNdx )
+            {
+                size_t slotNdx = memberHashes[memberNdx] & mask;
+                while ( 0 <= slots[slotNdx] ) slotNdx = ( slotNdx + 1 ) & mask;
+                slots[slotNdx] = memberNdx;
+            }
+        }
+        
+    public:
+        hashCache( void ) :
+            slots( 16, -1 )
+        {}
+        
+        virtual
+        ~hashCache( void )
+        {}
+        
+        virtual objectType*
+        makeMember( const std::vector<elementT>& rKey ) = 0;
+        
+        objectType*
+        getMember( const std::vector<elementT>& rKey )
+        {
+            size_t hashValue = hashKey( rKey );
+            size_t slotNdx = findSlot( rKey, hashValue );
+            if ( 0 <= slots[slotNdx] ) return members[slots[slotNdx]].second;
+            
+            // The member is made before it is entered, so that a member that
+            // fails to be made leaves no entry behind.
+            objectType* pMember = makeMember( rKey );
+            
+            if ( slots.size() < 2 * ( members.size() + 1 ) )
+            {
+                rehash( 2 * slots.size() );
+            }
+            slotNdx = findSlot( rKey, hashValue );
+            
+            slots[slotNdx] = members.size();
+            members.push_back( value_type( keyType( rKey ), pMember ) );
+            memberHashes.push_back( hashValue );
+            
+            return pMember;
+        }
+        
+        // Null if there is no member with the key yet.
+        objectType*
+        findMember( const std::vector<elementT>& rKey ) const
+        {
+            size_t slotNdx = findSlot( rKey, hashKey( rKey ) );
+            return 0 <= slots[slotNdx] ? members[slots[slotNdx]].second : 0;
+        }
+        
+        const_iterator
+        begin( void ) const
+        {
+            return members.begin();
+        }
+        
+        const_iterator
+        end( void ) const
+        {
+            return members.end();
+        }
+        
+        size_t
+        size( void ) const
+        {
+            return members.size();
+        }
+        
+        bool
+        empty( void ) const
+        {
+            return members.empty();
+        }
+    };
+    
+    // The hashCache counterpart of autoCache: deletes its members.
+    template<class elementT,
+             class objectType,
+             int inlineCount = 8>
+    class autoHashCache :
+        public hashCache<elementT, objectType, inlineCount>
+    {
+        class doDelete :
+            public std::unary_function<typename autoHashCache::value_type, void>
+        {
+        public:
+            void
+            operator()( const
+                        typename doDelete::argument_type&
+                        rKeyObjectPtrPair ) const
+            {
+                delete rKeyObjectPtrPair.second;
+            }
+        };
+        
+    public:
+        virtual
+        ~autoHashCache( void )
+        {
+            std::for_each( this->begin(),
+                           this->end(),
+                           doDelete() );
+        }
+    };
+}
+
+#endif // UTL_HASHCACHE_H
@@ -40,6 +40,12 @@ namespace utl
         return ( rData * multiplier ) + summand;
     }
     
+    size_t
+    linearHash::operator()( const void* pData ) const
+    {
+        return operator()( reinterpret_cast<size_t>( pData ) >> 3 );
+    }
+    
     // These will need to be adjusted, I expect.  Or maybe not.
     const size_t linearHash::multiplier = 2897564231ul;
     const size_t linearHash::summand = 3248630751ul;
@@ -66,7 +72,7 @@ namespace utl
     size_t
     linearHash::operator()( const std::string& rString ) const
     {
-        size_t hashValue;
+        size_t hashValue = 0;
         std::for_each( rString.begin(),
                        rString.end(),
                        charHashAccum( hashValue ) );
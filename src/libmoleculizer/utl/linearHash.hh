@@ -65,6 +65,10 @@ namespace utl
     public:
         size_t operator()( const size_t& rData ) const;
         size_t operator()( const std::string& rString ) const;
+        
+        // Hashes an address, dropping the alignment bits first so that
+        // consecutive objects don't all land in the same few buckets.
+        size_t operator()( const void* pData ) const;
     };
 }
 